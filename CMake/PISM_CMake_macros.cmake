@@ -142,6 +142,9 @@ macro(pism_find_prerequisites)
   # library
   find_package (MPI REQUIRED COMPONENTS C CXX)
 
+  # Used to write some output files in the background
+  find_package (Threads REQUIRED)
+
   # Other required libraries
   pism_find_library (NETCDF "netcdf>=4.4")
   pism_find_library (GSL "gsl>=1.15")
@@ -159,6 +162,24 @@ macro(pism_find_prerequisites)
     pism_find_library(PROJ "proj>=6.0")
   endif()
 
+  if (Pism_USE_OPENMP)
+    find_package (OpenMP REQUIRED COMPONENTS CXX)
+  endif()
+
+  if (Pism_USE_FFTW_MPI)
+    # FFTW does not provide a pkg-config file for its MPI interface, so we look for it
+    # next to the serial FFTW library.
+    find_library (FFTW_MPI_LIBRARY fftw3_mpi HINTS ${FFTW_LIBRARY_DIRS})
+    find_path (FFTW_MPI_INCLUDE_DIR fftw3-mpi.h HINTS ${FFTW_INCLUDE_DIRS})
+    mark_as_advanced (FFTW_MPI_LIBRARY FFTW_MPI_INCLUDE_DIR)
+
+    if (NOT FFTW_MPI_LIBRARY OR NOT FFTW_MPI_INCLUDE_DIR)
+      message(FATAL_ERROR
+        "Selected FFTW library (include: ${FFTW_INCLUDE_DIRS}, lib: ${FFTW_LIBRARY_DIRS}) does not provide the MPI interface.")
+    endif()
+    message(STATUS "Found FFTW-MPI: ${FFTW_MPI_LIBRARY}")
+  endif()
+
   if (Pism_USE_YAC_INTERPOLATION)
     if (NOT Pism_USE_PROJ)
       message(FATAL_ERROR "Please build PISM with PROJ to use YAC for interpolation")
@@ -207,6 +228,10 @@ macro(pism_set_dependencies)
     include_directories (BEFORE SYSTEM ${PNETCDF_INCLUDE_DIRS})
   endif()
 
+  if (Pism_USE_FFTW_MPI)
+    include_directories (BEFORE SYSTEM ${FFTW_MPI_INCLUDE_DIR})
+  endif()
+
   # Hide distracting CMake variables
   mark_as_advanced(file_cmd MPI_LIBRARY MPI_EXTRA_LIBRARY
     CMAKE_OSX_ARCHITECTURES CMAKE_OSX_DEPLOYMENT_TARGET CMAKE_OSX_SYSROOT
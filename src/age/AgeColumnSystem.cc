@@ -65,7 +65,7 @@ void AgeColumnSystem::init(int i, int j, double thickness) {
   The PDE being solved is
   \f[ \frac{\partial \tau}{\partial t} + \frac{\partial}{\partial x}\left(u \tau\right) + \frac{\partial}{\partial y}\left(v \tau\right) + \frac{\partial}{\partial z}\left(w \tau\right) = 1. \f]
  */
-void AgeColumnSystem::solve(std::vector<double> &x) {
+void AgeColumnSystem::assemble() {
 
   TridiagonalSystem &S = *m_solver;
 
@@ -115,10 +115,15 @@ void AgeColumnSystem::solve(std::vector<double> &x) {
     S.D(m_ks) = 1.0;   // ignore U[m_ks]
     S.RHS(m_ks) = 0.0;  // age zero at surface
   }
+}
+
+//! Assemble and solve the system in the current column.
+void AgeColumnSystem::solve(std::vector<double> &x) {
+  assemble();
 
   // solve it
   try {
-    S.solve(m_ks + 1, x);
+    m_solver->solve(m_ks + 1, x);
   }
   catch (RuntimeError &e) {
     e.add_context("solving the tri-diagonal system (AgeColumnSystem) at (%d, %d)\n"
@@ -134,4 +139,21 @@ void AgeColumnSystem::solve(std::vector<double> &x) {
   }
 }
 
+/*!
+ * Copy the solution in the lane `lane` of `batch` to `x`.
+ *
+ * The system in this lane has to be assembled by calling assemble() and add_to().
+ */
+void AgeColumnSystem::solution(const TridiagonalBatch &batch, int lane,
+                               std::vector<double> &x) const {
+  for (unsigned int k = 0; k <= m_ks; k++) {
+    x[k] = batch.x(k, lane);
+  }
+
+  // set age of ice above (and at) surface to zero years
+  for (unsigned int k = m_ks + 1; k < x.size(); k++) {
+    x[k] = 0.0;
+  }
+}
+
 } // end of namespace pism
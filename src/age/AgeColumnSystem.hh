@@ -37,7 +37,11 @@ public:
 
   void init(int i, int j, double thickness);
 
+  void assemble();
+
   void solve(std::vector<double> &x);
+
+  void solution(const TridiagonalBatch &batch, int lane, std::vector<double> &x) const;
 protected:
   const array::Array3D &m_age3;
   double m_nu;
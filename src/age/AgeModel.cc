@@ -103,7 +103,10 @@ velocity.  We use a finely-spaced, equally-spaced vertical grid in the
 calculation.  Note that the columnSystemCtx methods coarse_to_fine() and
 fine_to_coarse() interpolate back and forth between this fine grid and
 the storage grid.  The storage grid may or may not be equally-spaced.  See
-AgeColumnSystem::solve() for the actual method.
+AgeColumnSystem::assemble() for the actual method.
+
+Columns with the same number of levels within the ice are grouped into batches (see
+columnSystemCtx::batches()) and solved simultaneously using TridiagonalBatch.
  */
 void AgeModel::update(double t, double dt, const AgeModelInputs &inputs) {
 
@@ -119,35 +122,67 @@ void AgeModel::update(double t, double dt, const AgeModelInputs &inputs) {
     &v3 = *inputs.v3,
     &w3 = *inputs.w3;
 
-  AgeColumnSystem system(m_grid->z(), "age",
-                         m_grid->dx(), m_grid->dy(), dt,
-                         m_ice_age, u3, v3, w3); // linear system to solve in each column
+  const int width = TridiagonalBatch::width;
+
+  // linear systems to solve in each column of a batch
+  std::vector<std::unique_ptr<AgeColumnSystem>> systems(width);
+  for (auto &s : systems) {
+    s.reset(new AgeColumnSystem(m_grid->z(), "age", m_grid->dx(), m_grid->dy(), dt, m_ice_age,
+                                u3, v3, w3));
+  }
 
-  size_t Mz_fine = system.z().size();
+  size_t Mz_fine = systems[0]->z().size();
   std::vector<double> x(Mz_fine);   // space for solution
 
+  TridiagonalBatch solver(Mz_fine);
+
   array::AccessScope list{&ice_thickness, &u3, &v3, &w3, &m_ice_age, &m_work};
 
   unsigned int Mz = m_grid->Mz();
 
   ParallelSection loop(m_grid->com);
   try {
-    for (auto p = m_grid->points(); p; p.next()) {
-      const int i = p.i(), j = p.j();
+    // columns with the same number of levels within the ice are solved simultaneously
+    for (const auto &batch : systems[0]->batches(ice_thickness)) {
 
-      system.init(i, j, ice_thickness(i, j));
-
-      if (system.ks() == 0) {
+      if (batch.ks == 0) {
         // if no ice, set the entire column to zero age
-        m_work.set_column(i, j, 0.0);
-      } else {
-        // general case: solve advection PDE
+        for (int n = 0; n < batch.size; ++n) {
+          m_work.set_column(batch.i[n], batch.j[n], 0.0);
+        }
+        continue;
+      }
+
+      // general case: solve advection PDE
+      for (int n = 0; n < batch.size; ++n) {
+        const int i = batch.i[n], j = batch.j[n];
+
+        systems[n]->init(i, j, ice_thickness(i, j));
+        systems[n]->assemble();
+        systems[n]->add_to(solver, n);
+      }
+
+      try {
+        solver.solve(batch.ks + 1, batch.size);
+      } catch (RuntimeError &e) {
+        e.add_context("solving tri-diagonal systems (AgeColumnSystem) in columns %s",
+                      batch.columns().c_str());
+        int lane = solver.zero_pivot_lane();
+        if (lane >= 0) {
+          e.add_context("saving the system at (%d,%d) to m-file... ", batch.i[lane],
+                        batch.j[lane]);
+          systems[lane]->reportColumnZeroPivotErrorMFile(batch.ks + 1);
+        }
+        throw;
+      }
+
+      for (int n = 0; n < batch.size; ++n) {
+        const int i = batch.i[n], j = batch.j[n];
 
-        // solve the system for this column; call checks that params set
-        system.solve(x);
+        systems[n]->solution(solver, n, x);
 
         // put solution in array::Array3D
-        system.fine_to_coarse(x, i, j, m_work);
+        systems[n]->fine_to_coarse(x, i, j, m_work);
 
         // Ensure that the age of the ice is non-negative.
         //
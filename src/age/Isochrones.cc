@@ -26,6 +26,7 @@
 #include <vector>
 
 #include "pism/age/Isochrones.hh"
+#include "pism/geometry/Geometry.hh"
 #include "pism/util/Context.hh"
 #include "pism/util/MaxTimestep.hh"
 #include "pism/util/Time.hh"
@@ -548,23 +549,29 @@ void Isochrones::restart(const File &input_file, int record) {
  * @param[in] dt time step length, seconds
  * @param[in] u x-component of the ice velocity, m/s
  * @param[in] v y-component of the ice velocity, m/s
- * @param[in] ice thickness, m
+ * @param[in] geometry ice geometry (after the mass continuity step)
  * @param[in] top_surface_mass_balance total top surface mass balance over the time step, meters
  * @param[in] bottom_surface_mass_balance total bottom surface mass balance over the time step, meters
  *
  * For mass balance inputs, positive corresponds to mass gain.
  */
 void Isochrones::update(double t, double dt, const array::Array3D &u, const array::Array3D &v,
-                        const array::Scalar &ice_thickness,
+                        const Geometry &geometry,
                         const array::Scalar &top_surface_mass_balance,
                         const array::Scalar &bottom_surface_mass_balance) {
 
+  const auto &ice_thickness = geometry.ice_thickness;
+  const auto &columns       = geometry.active_columns;
+
   // apply top surface and basal mass balance terms:
+  //
+  // Layer thicknesses in inactive columns are not used below (the transport step sets
+  // them to zero), so we skip these columns here.
   {
     array::AccessScope scope{ &top_surface_mass_balance, &bottom_surface_mass_balance,
                               m_layer_thickness.get() };
 
-    for (auto p = m_grid->points(); p; p.next()) {
+    for (auto p = columns.active(); p; p.next()) {
       const int i = p.i(), j = p.j();
 
       double *H = m_layer_thickness->get_column(i, j);
@@ -622,7 +629,7 @@ void Isochrones::update(double t, double dt, const array::Array3D &u, const arra
     // flux estimated using first-order upwinding
     auto Q = [](double U, double f_n, double f_p) { return U * (U >= 0 ? f_n : f_p); };
 
-    for (auto p = m_grid->points(); p; p.next()) {
+    for (auto p = columns.active(); p; p.next()) {
       const int i = p.i(), j = p.j();
 
       const double *d_c = m_tmp->get_column(i, j), *d_n = m_tmp->get_column(i, j + 1),
@@ -692,6 +699,12 @@ void Isochrones::update(double t, double dt, const array::Array3D &u, const arra
         assert(ice_thickness(i, j) < H_min);
       }
     }
+
+    // inactive columns contain no ice and don't receive any from neighbors
+    for (auto p = columns.inactive(); p; p.next()) {
+      double *d = m_layer_thickness->get_column(p.i(), p.j());
+      std::fill_n(d, m_top_layer_index + 1, 0.0);
+    }
   }
 
   // add one more layer if we reached the next deposition time
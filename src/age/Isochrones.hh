@@ -32,6 +32,8 @@ namespace stressbalance {
 class StressBalance;
 }
 
+class Geometry;
+
 /*!
  * The isochrone tracing scheme of [@ref Born2016] and [@ref Born2021].
  */
@@ -48,7 +50,7 @@ public:
   void update(double t, double dt,
               const array::Array3D &u,
               const array::Array3D &v,
-              const array::Scalar &ice_thickness,
+              const Geometry &geometry,
               const array::Scalar &top_surface_mass_balance,
               const array::Scalar &bottom_surface_mass_balance);
 
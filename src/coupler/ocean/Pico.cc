@@ -35,6 +35,7 @@
 #include "pism/coupler/util/options.hh"
 #include "pism/geometry/Geometry.hh"
 #include "pism/util/ConfigInterface.hh"
+#include "pism/util/GlobalReduction.hh"
 #include "pism/util/Grid.hh"
 #include "pism/util/Mask.hh"
 #include "pism/util/Time.hh"
@@ -379,10 +380,6 @@ void Pico::compute_ocean_input_per_basin(const PicoPhysics &physics,
                                          std::vector<double> &temperature,
                                          std::vector<double> &salinity) const {
   std::vector<int> count(m_n_basins, 0);
-  // additional vectors to allreduce efficiently with IntelMPI
-  std::vector<int> countr(m_n_basins, 0);
-  std::vector<double> salinityr(m_n_basins);
-  std::vector<double> temperaturer(m_n_basins);
 
   temperature.resize(m_n_basins);
   salinity.resize(m_n_basins);
@@ -412,14 +409,19 @@ void Pico::compute_ocean_input_per_basin(const PicoPhysics &physics,
   // ocean_contshelf_mask values intersect with the basin, count is zero. In such case,
   // use dummy temperature and salinity. This could happen, for example, if the ice shelf
   // front advances beyond the continental shelf break.
-  GlobalSum(m_grid->com, count.data(), countr.data(), m_n_basins);
-  GlobalSum(m_grid->com, salinity.data(), salinityr.data(), m_n_basins);
-  GlobalSum(m_grid->com, temperature.data(), temperaturer.data(), m_n_basins);
-
-  // copy values
-  count       = countr;
-  salinity    = salinityr;
-  temperature = temperaturer;
+  {
+    GlobalReduction sums(m_grid->com);
+    int C = sums.sum(count);
+    int S = sums.sum(salinity);
+    int T = sums.sum(temperature);
+    sums.reduce();
+
+    for (int basin_id = 0; basin_id < m_n_basins; basin_id++) {
+      count[basin_id]       = static_cast<int>(sums[C + basin_id]);
+      salinity[basin_id]    = sums[S + basin_id];
+      temperature[basin_id] = sums[T + basin_id];
+    }
+  }
 
   // "dummy" basin
   {
@@ -473,10 +475,6 @@ void Pico::set_ocean_input_fields(const PicoPhysics &physics,
   std::vector<int> n_shelf_cells_per_basin(m_n_shelves * m_n_basins, 0);
   std::vector<int> n_shelf_cells(m_n_shelves, 0);
   std::vector<int> cfs_in_basins_per_shelf(m_n_shelves * m_n_basins, 0);
-  // additional vectors to allreduce efficiently with IntelMPI
-  std::vector<int> n_shelf_cells_per_basinr(m_n_shelves * m_n_basins, 0);
-  std::vector<int> n_shelf_cellsr(m_n_shelves, 0);
-  std::vector<int> cfs_in_basins_per_shelfr(m_n_shelves * m_n_basins, 0);
 
   // 1) count the number of cells in each shelf
   // 2) count the number of cells in the intersection of each shelf with all the basins
@@ -501,17 +499,22 @@ void Pico::set_ocean_input_fields(const PicoPhysics &physics,
         }
       }
     }
-    
-    GlobalSum(m_grid->com, n_shelf_cells.data(),
-              n_shelf_cellsr.data(), m_n_shelves);
-    GlobalSum(m_grid->com, n_shelf_cells_per_basin.data(),
-              n_shelf_cells_per_basinr.data(), m_n_shelves*m_n_basins);
-    GlobalSum(m_grid->com, cfs_in_basins_per_shelf.data(),
-              cfs_in_basins_per_shelfr.data(), m_n_shelves*m_n_basins);
-    // copy data
-    n_shelf_cells = n_shelf_cellsr;
-    n_shelf_cells_per_basin = n_shelf_cells_per_basinr;
-    cfs_in_basins_per_shelf = cfs_in_basins_per_shelfr;
+
+    {
+      GlobalReduction sums(m_grid->com);
+      int N  = sums.sum(n_shelf_cells);
+      int NB = sums.sum(n_shelf_cells_per_basin);
+      int CF = sums.sum(cfs_in_basins_per_shelf);
+      sums.reduce();
+
+      for (int s = 0; s < m_n_shelves; s++) {
+        n_shelf_cells[s] = static_cast<int>(sums[N + s]);
+      }
+      for (int sb = 0; sb < m_n_shelves * m_n_basins; sb++) {
+        n_shelf_cells_per_basin[sb] = static_cast<int>(sums[NB + sb]);
+        cfs_in_basins_per_shelf[sb] = static_cast<int>(sums[CF + sb]);
+      }
+    }
 
     for (int s = 0; s < m_n_shelves; s++) {
       for (int b = 0; b < m_n_basins; b++) {
@@ -823,32 +826,32 @@ void Pico::compute_box_average(int box_id,
   }
 
   // compute the sum of field in each shelf's box box_id
-  std::vector<int> n_cells(m_n_shelves);
+  std::vector<double> n_cells(m_n_shelves);
   {
-    std::vector<int> n_cells_per_box(m_n_shelves, 0);
+    std::vector<double> n_cells_per_box(m_n_shelves, 0.0);
     for (auto p = m_grid->points(); p; p.next()) {
       const int i = p.i(), j = p.j();
 
       int shelf_id = shelf_mask.as_int(i, j);
 
       if (box_mask.as_int(i, j) == box_id) {
-        n_cells_per_box[shelf_id] += 1;
+        n_cells_per_box[shelf_id] += 1.0;
         result[shelf_id] += field(i, j);
       }
     }
-    GlobalSum(m_grid->com, n_cells_per_box.data(), n_cells.data(), m_n_shelves);
-  }
 
-  {
-    std::vector<double> tmp(m_n_shelves);
-    GlobalSum(m_grid->com, result.data(), tmp.data(), m_n_shelves);
-    // copy data
-    result = tmp;
+    GlobalReduction sums(m_grid->com);
+    int N = sums.sum(n_cells_per_box);
+    int R = sums.sum(result);
+    sums.reduce();
+
+    n_cells = sums.values(N, m_n_shelves);
+    result  = sums.values(R, m_n_shelves);
   }
 
   for (int s = 0; s < m_n_shelves; ++s) {
     if (n_cells[s] > 0) {
-      result[s] /= static_cast<double>(n_cells[s]);
+      result[s] /= n_cells[s];
     }
   }
 }
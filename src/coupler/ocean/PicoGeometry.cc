@@ -18,6 +18,8 @@
  */
 
 #include <algorithm> // max_element
+#include <functional> // std::greater
+#include <queue>
 #include "pism/coupler/ocean/PicoGeometry.hh"
 #include "pism/util/connected_components/label_components.hh"
 #include "pism/util/array/CellType.hh"
@@ -26,6 +28,7 @@
 #include "pism/coupler/util/options.hh"
 #include "pism/util/Interpolation1D.hh"
 #include "pism/util/Profiling.hh"
+#include "pism/util/GlobalReduction.hh"
 
 namespace pism {
 namespace ocean {
@@ -41,7 +44,9 @@ PicoGeometry::PicoGeometry(std::shared_ptr<const Grid> grid)
       m_ocean_mask(grid, "pico_ocean_mask"),
       m_lake_mask(grid, "pico_lake_mask"),
       m_ice_rises(grid, "pico_ice_rise_mask"),
-      m_tmp(grid, "temporary_storage") {
+      m_tmp(grid, "temporary_storage"),
+      m_cell_type_previous(grid, "pico_previous_cell_type"),
+      m_bed_mask_previous(grid, "pico_previous_bed_mask") {
 
   m_continental_shelf.set_interpolation_type(NEAREST);
   m_boxes.set_interpolation_type(NEAREST);
@@ -62,6 +67,11 @@ PicoGeometry::PicoGeometry(std::shared_ptr<const Grid> grid)
 
   m_basin_mask.metadata(0).long_name("mask determines basins for PICO");
   m_n_basins = 0;
+
+  // these are not valid cell types and bed masks, so the first update() recomputes
+  // everything
+  m_cell_type_previous.set(-1.0);
+  m_bed_mask_previous.set(-1.0);
 }
 
 const array::Scalar &PicoGeometry::continental_shelf_mask() const {
@@ -91,6 +101,10 @@ void PicoGeometry::init() {
   m_basin_mask.regrid(opt.filename, io::Default::Nil());
 
   m_n_basins = static_cast<int>(max(m_basin_mask)) + 1;
+
+  // make sure that the next update() recomputes everything using new basins
+  m_cell_type_previous.set(-1.0);
+  m_bed_mask_previous.set(-1.0);
 }
 
 /*!
@@ -98,10 +112,34 @@ void PicoGeometry::init() {
  *
  * After this call box_mask(), ice_shelf_mask(), and continental_shelf_mask() will be up
  * to date.
+ *
+ * All masks except for the continental shelf mask depend on the cell type only, so they
+ * are re-computed only if the cell type changed since the last call. The continental
+ * shelf mask is re-computed if the cell type or the mask of areas where the bed is above
+ * the continental shelf depth changed.
  */
 void PicoGeometry::update(const array::Scalar &bed_elevation,
                           const array::CellType1 &cell_type) {
 
+  double continental_shelf_depth = m_config->get_number("ocean.pico.continental_shelf_depth");
+
+  bool cell_type_changed = true, bed_changed = true;
+  detect_changes(bed_elevation, cell_type, continental_shelf_depth, cell_type_changed,
+                 bed_changed);
+
+  if (not cell_type_changed) {
+    if (bed_changed) {
+      // the continental shelf mask is the only one that depends on the bed elevation
+      compute_continental_shelf_mask(bed_elevation, m_ice_rises, continental_shelf_depth,
+                                     m_continental_shelf);
+
+      save_inputs(bed_elevation, cell_type, continental_shelf_depth);
+    }
+
+    m_log->message(3, "PICO: cell type did not change; re-using ice shelf and box masks\n");
+    return;
+  }
+
   // Update basin adjacency.
   //
   // basin_neighbors() below uses the cell type mask to find
@@ -164,8 +202,6 @@ void PicoGeometry::update(const array::Scalar &bed_elevation,
                       most_shelf_cells_in_basin, cfs_in_basins_per_shelf, n_shelves,
                       m_ice_shelves);
 
-    double continental_shelf_depth = m_config->get_number("ocean.pico.continental_shelf_depth");
-
     compute_continental_shelf_mask(bed_elevation, m_ice_rises, continental_shelf_depth,
                                    m_continental_shelf);
   }
@@ -173,8 +209,71 @@ void PicoGeometry::update(const array::Scalar &bed_elevation,
   int n_boxes = static_cast<int>(m_config->get_number("ocean.pico.number_of_boxes"));
 
   compute_box_mask(m_distance_gl, m_distance_cf, m_ice_shelves, n_boxes, m_boxes);
+
+  // save inputs only after all masks are re-computed: if anything above fails, the next
+  // update() has to try again
+  save_inputs(bed_elevation, cell_type, continental_shelf_depth);
+}
+
+/*!
+ * Compare the cell type mask and the mask of areas with the bed elevation above
+ * `bed_elevation_threshold` to the ones used during the previous update.
+ *
+ * Sets `cell_type_changed` and `bed_changed` (on all ranks). See save_inputs().
+ *
+ * Note that we compare values instead of relying on state counters: the cell type mask is
+ * re-computed every time step and the bed elevation state counter is incremented by every
+ * bed deformation step, even if the thresholded mask stays the same.
+ */
+void PicoGeometry::detect_changes(const array::Scalar &bed_elevation,
+                                  const array::CellType &cell_type,
+                                  double bed_elevation_threshold,
+                                  bool &cell_type_changed,
+                                  bool &bed_changed) {
+  array::AccessScope list{ &bed_elevation, &cell_type, &m_cell_type_previous,
+                           &m_bed_mask_previous };
+
+  double cell_type_change_count = 0.0, bed_change_count = 0.0;
+
+  for (auto p = m_grid->points(); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    if (m_cell_type_previous(i, j) != cell_type(i, j)) {
+      cell_type_change_count += 1.0;
+    }
+
+    double bed_mask = bed_elevation(i, j) > bed_elevation_threshold ? 1.0 : 0.0;
+    if (m_bed_mask_previous(i, j) != bed_mask) {
+      bed_change_count += 1.0;
+    }
+  }
+
+  GlobalReduction sums(m_grid->com);
+  int C = sums.sum(cell_type_change_count);
+  int B = sums.sum(bed_change_count);
+  sums.reduce();
+
+  cell_type_changed = sums[C] > 0.0;
+  bed_changed       = sums[B] > 0.0;
 }
 
+/*!
+ * Save the cell type mask and the mask of areas with the bed elevation above
+ * `bed_elevation_threshold` for comparison during the next update (see detect_changes()).
+ */
+void PicoGeometry::save_inputs(const array::Scalar &bed_elevation,
+                               const array::CellType &cell_type,
+                               double bed_elevation_threshold) {
+  array::AccessScope list{ &bed_elevation, &cell_type, &m_cell_type_previous,
+                           &m_bed_mask_previous };
+
+  for (auto p = m_grid->points(); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    m_cell_type_previous(i, j) = cell_type(i, j);
+    m_bed_mask_previous(i, j)  = bed_elevation(i, j) > bed_elevation_threshold ? 1.0 : 0.0;
+  }
+}
 
 enum RelabelingType {BY_AREA, AREA_THRESHOLD};
 
@@ -617,10 +716,6 @@ void PicoGeometry::identify_calving_front_connection(const array::CellType1 &cel
                                                      std::vector<int> &cfs_in_basins_per_shelf) {
 
   std::vector<int> n_shelf_cells_per_basin(n_shelves * m_n_basins,0);
-  // additional vectors to allreduce efficiently with IntelMPI
-  std::vector<int> n_shelf_cells_per_basinr(n_shelves * m_n_basins,0);
-  std::vector<int> cfs_in_basins_per_shelfr(n_shelves * m_n_basins,0);
-  std::vector<int> most_shelf_cells_in_basinr(n_shelves, 0);
 
   array::AccessScope list{ &cell_type, &basin_mask, &shelf_mask };
 
@@ -645,13 +740,17 @@ void PicoGeometry::identify_calving_front_connection(const array::CellType1 &cel
       }
     }
 
-    GlobalSum(m_grid->com, cfs_in_basins_per_shelf.data(),
-              cfs_in_basins_per_shelfr.data(), n_shelves*m_n_basins);
-    GlobalSum(m_grid->com, n_shelf_cells_per_basin.data(),
-              n_shelf_cells_per_basinr.data(), n_shelves*m_n_basins);
-    // copy values
-    cfs_in_basins_per_shelf = cfs_in_basins_per_shelfr;
-    n_shelf_cells_per_basin = n_shelf_cells_per_basinr;
+    {
+      GlobalReduction sums(m_grid->com);
+      int CF = sums.sum(cfs_in_basins_per_shelf);
+      int NB = sums.sum(n_shelf_cells_per_basin);
+      sums.reduce();
+
+      for (int sb = 0; sb < n_shelves * m_n_basins; sb++) {
+        cfs_in_basins_per_shelf[sb] = static_cast<int>(sums[CF + sb]);
+        n_shelf_cells_per_basin[sb] = static_cast<int>(sums[NB + sb]);
+      }
+    }
 
     for (int s = 0; s < n_shelves; s++) {
       int n_shelf_cells_per_basin_max = 0;
@@ -843,6 +942,77 @@ void PicoGeometry::compute_distances_cf(const array::Scalar1 &ocean_mask,
   profiling().end("ocean.eikonal_equation");
 }
 
+namespace {
+
+//! A grid point and its tentative label.
+struct Label {
+  double value;
+  int i;
+  int j;
+
+  bool operator>(const Label &other) const {
+    return value > other.value;
+  }
+};
+
+typedef std::priority_queue<Label, std::vector<Label>, std::greater<Label> > LabelQueue;
+
+/*!
+ * Returns true if `label` is an improvement over the `current` label of a point in the
+ * domain. Zero means "no label assigned yet".
+ */
+bool improves(double label, double current) {
+  return current == 0 or label < current;
+}
+
+/*!
+ * Propagate labels from points in `queue` to the rest of the current sub-domain (this is
+ * Dijkstra's algorithm with unit edge weights).
+ *
+ * Returns true if a label was changed.
+ */
+bool propagate_labels(const Grid &grid, array::Scalar1 &mask, LabelQueue &queue) {
+  const int
+    xs = grid.xs(),
+    xe = xs + grid.xm(),
+    ys = grid.ys(),
+    ye = ys + grid.ym();
+
+  const int di[] = { 1, -1, 0, 0 };
+  const int dj[] = { 0, 0, 1, -1 };
+
+  bool changed = false;
+  while (not queue.empty()) {
+    auto p = queue.top();
+    queue.pop();
+
+    if (mask(p.i, p.j) != p.value) {
+      // this point was labeled again after p was added to the queue
+      continue;
+    }
+
+    for (int n = 0; n < 4; ++n) {
+      const int i = p.i + di[n], j = p.j + dj[n];
+
+      if (i < xs or i >= xe or j < ys or j >= ye) {
+        // this neighbor is owned by another rank
+        continue;
+      }
+
+      double label = p.value + 1;
+      if (mask(i, j) >= 0 and improves(label, mask(i, j))) {
+        mask(i, j) = label;
+        queue.push({label, i, j});
+        changed = true;
+      }
+    }
+  }
+
+  return changed;
+}
+
+} // namespace
+
 /*!
  * Find an approximate solution of the Eikonal equation on a given domain.
  *
@@ -856,11 +1026,17 @@ void PicoGeometry::compute_distances_cf(const array::Scalar1 &ocean_mask,
  * generic ice shelf locations with zeros, set neighbors of the grounding line to 1, and
  * the rest of the grid with -1 or some other negative number.
  *
- * Note that this implementation updates ghosts *every* iteration. We could speed this
- * up by checking if a point at a boundary of the processor sub-domain was updated and
- * update ghosts in those cases only.
+ * On return, each point within the domain is labeled with one plus the length of the
+ * shortest path (using the 4-neighbor connectivity within the domain) to a "wave front"
+ * location. Points that cannot be reached keep the label 0.
+ *
+ * Each rank computes labels in its sub-domain using Dijkstra's algorithm, using labels
+ * of ghost points as additional sources. Then ranks exchange ghosts and update labels
+ * that were improved by new ghost values. This is repeated until labels stop changing,
+ * so the number of ghost updates is proportional to the number of times shortest paths
+ * cross sub-domain boundaries (instead of the maximum distance).
  *
- * FIXME: replace this with a better algorithm.
+ * Expects ghosts of `mask` to be up to date. Updates ghosts of the result.
  */
 void eikonal_equation(array::Scalar1 &mask) {
 
@@ -868,34 +1044,51 @@ void eikonal_equation(array::Scalar1 &mask) {
 
   auto grid = mask.grid();
 
-  double current_label = 1;
-  double continue_loop = 1;
-  while (continue_loop != 0) {
+  array::AccessScope list{ &mask };
 
-    continue_loop = 0;
+  LabelQueue queue;
 
-    for (auto p = grid->points(); p; p.next()) {
-      const int i = p.i(), j = p.j();
+  // propagate labels within the sub-domain
+  for (auto p = grid->points(); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    if (mask(i, j) >= 1) {
+      queue.push({mask(i, j), i, j});
+    }
+  }
+  propagate_labels(*grid, mask, queue);
+
+  // fix-up iterations: propagate labels across sub-domain boundaries
+  double changed = 1;
+  while (changed != 0) {
+
+    mask.update_ghosts();
+
+    changed = 0;
 
-      if (mask.as_int(i, j) == 0) {
+    for (auto p = grid->points_boundary(1); p; p.next()) {
+      const int i = p.i(), j = p.j();
 
-        auto R = mask.star(i, j);
+      if (mask(i, j) < 0) {
+        // outside the domain
+        continue;
+      }
 
-        if (R.c == 0 and
-            (R.n == current_label or R.s == current_label or
-             R.e == current_label or R.w == current_label)) {
-          // i.e. this is an shelf cell with no distance assigned yet and with a neighbor
-          // that has a distance assigned
-          mask(i, j) = current_label + 1;
-          continue_loop = 1;
+      auto R = mask.star(i, j);
+      for (auto label : { R.n, R.e, R.s, R.w }) {
+        if (label >= 1 and improves(label + 1, mask(i, j))) {
+          mask(i, j) = label + 1;
+          queue.push({mask(i, j), i, j});
+          changed = 1;
         }
       }
-    } // loop over grid points
+    }
 
-    current_label++;
-    mask.update_ghosts();
+    if (propagate_labels(*grid, mask, queue)) {
+      changed = 1;
+    }
 
-    continue_loop = GlobalMax(grid->com, continue_loop);
+    changed = GlobalMax(grid->com, changed);
   }
 }
 
@@ -912,9 +1105,7 @@ void PicoGeometry::compute_box_mask(const array::Scalar &D_gl, const array::Scal
   int n_shelves = static_cast<int>(array::max(shelf_mask)) + 1;
 
   std::vector<double> GL_distance_max(n_shelves, 0.0);
-  std::vector<double> GL_distance_max1(n_shelves, 0.0);
   std::vector<double> CF_distance_max(n_shelves, 0.0);
-  std::vector<double> CF_distance_max1(n_shelves, 0.0);
 
   for (auto p = m_grid->points(); p; p.next()) {
     const int i = p.i(), j = p.j();
@@ -938,11 +1129,15 @@ void PicoGeometry::compute_box_mask(const array::Scalar &D_gl, const array::Scal
   }
 
   // compute global maximums
-  GlobalMax(m_grid->com, GL_distance_max.data(), GL_distance_max1.data(), n_shelves);
-  GlobalMax(m_grid->com, CF_distance_max.data(), CF_distance_max1.data(), n_shelves);
-  // copy data
-  GL_distance_max = GL_distance_max1;
-  CF_distance_max = CF_distance_max1;
+  {
+    GlobalReduction maxima(m_grid->com);
+    int GL = maxima.max(GL_distance_max);
+    int CF = maxima.max(CF_distance_max);
+    maxima.reduce();
+
+    GL_distance_max = maxima.values(GL, n_shelves);
+    CF_distance_max = maxima.values(CF, n_shelves);
+  }
 
   double GL_distance_ref = *std::max_element(GL_distance_max.begin(), GL_distance_max.end());
 
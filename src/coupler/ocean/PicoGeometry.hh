@@ -99,6 +99,16 @@ private:
 
   void relabel_by_size(array::Scalar &mask);
 
+  void detect_changes(const array::Scalar &bed_elevation,
+                      const array::CellType &cell_type,
+                      double bed_elevation_threshold,
+                      bool &cell_type_changed,
+                      bool &bed_changed);
+
+  void save_inputs(const array::Scalar &bed_elevation,
+                   const array::CellType &cell_type,
+                   double bed_elevation_threshold);
+
   // storage for outputs
   array::Scalar m_continental_shelf;
   array::Scalar m_boxes;
@@ -115,6 +125,10 @@ private:
   // temporary storage (ghosted to use with the connected component labeling code)
   array::Scalar1 m_tmp;
 
+  // inputs used during the last update (used to skip updates if inputs did not change)
+  array::Scalar m_cell_type_previous;
+  array::Scalar m_bed_mask_previous;
+
   int m_n_basins;
   std::vector<std::set<int> > m_basin_neighbors;
 };
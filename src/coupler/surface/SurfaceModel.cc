@@ -721,11 +721,13 @@ private:
 };
 
 /*!
- * Integrate a field over the computational domain.
+ * Integrate a field over the sub-domain owned by this rank.
  *
- * If the input has units kg/m^2, the output will be in kg.
+ * Returns the contribution of this rank to the integral over the computational domain
+ * (the caller has to sum over all ranks). If the input has units kg/m^2, the output will
+ * be in kg.
  */
-static double integrate(const array::Scalar &input) {
+static double integrate_local(const array::Scalar &input) {
   auto grid = input.grid();
 
   double cell_area = grid->cell_area();
@@ -740,7 +742,7 @@ static double integrate(const array::Scalar &input) {
     result += input(i, j) * cell_area;
   }
 
-  return GlobalSum(grid->com, result);
+  return result;
 }
 
 
@@ -755,8 +757,9 @@ public:
     m_variable["long_name"] = "surface accumulation rate (PDD model)";
   }
 
-  double compute() {
-    return integrate(model->accumulation());
+  bool compute_local_impl(double &result) {
+    result = integrate_local(model->accumulation());
+    return true;
   }
 };
 
@@ -772,8 +775,9 @@ public:
     m_variable["long_name"] = "surface melt rate (PDD model)";
   }
 
-  double compute() {
-    return integrate(model->melt());
+  bool compute_local_impl(double &result) {
+    result = integrate_local(model->melt());
+    return true;
   }
 };
 
@@ -789,8 +793,9 @@ public:
     m_variable["long_name"] = "surface runoff rate (PDD model)";
   }
 
-  double compute() {
-    return integrate(model->runoff());
+  bool compute_local_impl(double &result) {
+    result = integrate_local(model->runoff());
+    return true;
   }
 };
 
@@ -26,8 +26,13 @@
 #include "pism/util/fftw_utilities.hh"
 #include "pism/earth/LingleClarkSerial.hh"
 #include "pism/util/Context.hh"
+#include "pism/pism_config.hh"
 #include <memory>
 
+#if (Pism_USE_FFTW_MPI==1)
+#include "pism/earth/LingleClarkParallel.hh"
+#endif
+
 namespace pism {
 namespace bed {
 
@@ -44,8 +49,6 @@ LingleClark::LingleClark(std::shared_ptr<const Grid> grid)
           "total (viscous and elastic) displacement in the Lingle-Clark bed deformation model")
       .units("meters");
 
-  m_work0 = m_total_displacement.allocate_proc0_copy();
-
   m_relief.metadata(0)
       .long_name("bed relief relative to the modeled bed displacement")
       .units("meters");
@@ -56,7 +59,6 @@ LingleClark::LingleClark(std::shared_ptr<const Grid> grid)
       .long_name(
           "elastic part of the displacement in the Lingle-Clark bed deformation model; see :cite:`BLKfastearth`")
       .units("meters");
-  m_elastic_displacement0 = m_elastic_displacement.allocate_proc0_copy();
 
   const int
     Mx = m_grid->Mx(),
@@ -86,6 +88,19 @@ LingleClark::LingleClark(std::shared_ptr<const Grid> grid)
   // do not point to auxiliary coordinates "lon" and "lat".
   m_viscous_displacement->metadata()["coordinates"] = "";
 
+  if (m_config->get_flag("bed_deformation.lc.fftw_mpi")) {
+#if (Pism_USE_FFTW_MPI==1)
+    m_parallel_model.reset(new LingleClarkParallel(m_log, *m_config, use_elastic_model,
+                                                   m_grid, m_extended_grid));
+    return;
+#else
+    throw RuntimeError(PISM_ERROR_LOCATION,
+                       "bed_deformation.lc.fftw_mpi requires PISM built with FFTW-MPI");
+#endif
+  }
+
+  m_work0                 = m_total_displacement.allocate_proc0_copy();
+  m_elastic_displacement0 = m_elastic_displacement.allocate_proc0_copy();
   m_viscous_displacement0 = m_viscous_displacement->allocate_proc0_copy();
 
   ParallelSection rank0(m_grid->com);
@@ -121,6 +136,22 @@ void LingleClark::bootstrap_impl(const array::Scalar &bed_elevation,
                                  const array::Scalar &ice_thickness,
                                  const array::Scalar &sea_level_elevation) {
 
+#if (Pism_USE_FFTW_MPI==1)
+  if (m_parallel_model) {
+    m_load.set(0.0);
+    accumulate_load(bed_elevation, ice_thickness, sea_level_elevation, 1.0, m_load);
+
+    m_parallel_model->bootstrap(m_load, bed_uplift, *m_viscous_displacement,
+                                m_elastic_displacement);
+    m_parallel_model->total_displacement(*m_viscous_displacement, m_elastic_displacement,
+                                         m_total_displacement);
+
+    // compute bed relief
+    m_topg.add(-1.0, m_total_displacement, m_relief);
+    return;
+  }
+#endif
+
   auto load_proc0 = m_load.allocate_proc0_copy();
 
   auto &total_displacement = *m_work0;
@@ -174,6 +205,13 @@ void LingleClark::bootstrap_impl(const array::Scalar &bed_elevation,
 std::shared_ptr<array::Scalar> LingleClark::elastic_load_response_matrix() const {
   std::shared_ptr<array::Scalar> result(new array::Scalar(m_extended_grid, "lrm"));
 
+#if (Pism_USE_FFTW_MPI==1)
+  if (m_parallel_model) {
+    m_parallel_model->compute_load_response_matrix(*result);
+    return result;
+  }
+#endif
+
   int
     Nx = m_extended_grid->Mx(),
     Ny = m_extended_grid->My();
@@ -229,6 +267,21 @@ void LingleClark::init_impl(const InputOptions &opts, const array::Scalar &ice_t
   regrid("Lingle-Clark bed deformation model",
          m_elastic_displacement, REGRID_WITHOUT_REGRID_VARS);
 
+#if (Pism_USE_FFTW_MPI==1)
+  if (m_parallel_model) {
+    if (not m_config->get_flag("bed_deformation.lc.elastic_model")) {
+      m_elastic_displacement.set(0.0);
+    }
+
+    m_parallel_model->total_displacement(*m_viscous_displacement, m_elastic_displacement,
+                                         m_total_displacement);
+
+    // compute bed relief
+    m_topg.add(-1.0, m_total_displacement, m_relief);
+    return;
+  }
+#endif
+
   // Now that viscous displacement and elastic displacement are finally initialized,
   // put them on rank 0 and initialize the serial model itself.
   {
@@ -279,6 +332,18 @@ const array::Scalar& LingleClark::relief() const {
 void LingleClark::step(const array::Scalar &load_thickness,
                        double dt) {
 
+#if (Pism_USE_FFTW_MPI==1)
+  if (m_parallel_model) {
+    m_parallel_model->step(dt, load_thickness, *m_viscous_displacement, m_elastic_displacement);
+    m_parallel_model->total_displacement(*m_viscous_displacement, m_elastic_displacement,
+                                         m_total_displacement);
+
+    // Update bed elevation using bed displacement and relief.
+    m_total_displacement.add(1.0, m_relief, m_topg);
+    return;
+  }
+#endif
+
   load_thickness.put_on_proc0(*m_work0);
 
   ParallelSection rank0(m_grid->com);
@@ -0,0 +1,588 @@
+/* Copyright (C) 2024 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cmath>                // sqrt, std::abs
+#include <fftw3-mpi.h>
+#include <gsl/gsl_math.h>       // M_PI
+#include <petscdmda.h>          // DMDAGetAO
+
+#include "pism/earth/LingleClarkParallel.hh"
+#include "pism/earth/greens.hh"
+#include "pism/earth/matlablike.hh"
+
+#include "pism/util/ConfigInterface.hh"
+#include "pism/util/Grid.hh"
+#include "pism/util/error_handling.hh"
+#include "pism/util/fftw_utilities.hh"
+#include "pism/util/petscwrappers/DM.hh"
+#include "pism/util/petscwrappers/IS.hh"
+#include "pism/util/pism_utilities.hh"
+
+namespace pism {
+namespace bed {
+
+//! Free memory allocated by FFTW-MPI. Called by PetscFinalize().
+static PetscErrorCode fftw_mpi_finalize() {
+  fftw_mpi_cleanup();
+  return 0;
+}
+
+//! Initialize FFTW-MPI and arrange for fftw_mpi_cleanup() to be called at shutdown.
+static void fftw_mpi_initialize() {
+  static bool initialized = false;
+
+  if (not initialized) {
+    fftw_mpi_init();
+
+    PetscErrorCode ierr = PetscRegisterFinalize(fftw_mpi_finalize);
+    PISM_CHK(ierr, "PetscRegisterFinalize");
+
+    initialized = true;
+  }
+}
+
+/*!
+ * Create a scatter from a field on the `Mx*My` grid (a global Vec using the DMDA `dm`) to
+ * the slab of the extended grid stored in `slab`.
+ *
+ * The `Mx*My` grid is embedded in the `Nx*Ny` extended grid with offsets `(i0, j0)`.
+ * Points of the slab outside of this embedded grid are not affected by the scatter.
+ *
+ * The slab contains rows `[i_start, i_start + ni)` of the extended grid, stored in
+ * FFTW's ("row-major", `j` changes fastest) order.
+ */
+static void create_slab_scatter(std::shared_ptr<petsc::DM> dm, int Mx, int My, int i0, int j0,
+                                int Ny, int i_start, int ni, petsc::Vec &slab,
+                                petsc::VecScatter &result) {
+  PetscErrorCode ierr = 0;
+
+  MPI_Comm com = PetscObjectComm((PetscObject)slab.get());
+
+  PetscInt slab_start = 0, slab_end = 0;
+  ierr = VecGetOwnershipRange(slab, &slab_start, &slab_end);
+  PISM_CHK(ierr, "VecGetOwnershipRange");
+
+  std::vector<PetscInt> from, to;
+  for (int i = i_start; i < i_start + ni; ++i) {
+    for (int j = 0; j < Ny; ++j) {
+      int ii = i - i0, jj = j - j0;
+      if (ii >= 0 and ii < Mx and jj >= 0 and jj < My) {
+        // index in the "natural" ordering of the Mx*My grid
+        from.push_back(jj * Mx + ii);
+        to.push_back(slab_start + (i - i_start) * Ny + j);
+      }
+    }
+  }
+
+  // convert natural indexes to PETSc's ordering used by DMDA global vectors
+  AO ao = NULL;
+  ierr = DMDAGetAO(*dm, &ao);
+  PISM_CHK(ierr, "DMDAGetAO");
+
+  ierr = AOApplicationToPetsc(ao, (PetscInt)from.size(), from.data());
+  PISM_CHK(ierr, "AOApplicationToPetsc");
+
+  petsc::IS is_from, is_to;
+  ierr = ISCreateGeneral(com, (PetscInt)from.size(), from.data(), PETSC_COPY_VALUES,
+                         is_from.rawptr());
+  PISM_CHK(ierr, "ISCreateGeneral");
+
+  ierr = ISCreateGeneral(com, (PetscInt)to.size(), to.data(), PETSC_COPY_VALUES,
+                         is_to.rawptr());
+  PISM_CHK(ierr, "ISCreateGeneral");
+
+  petsc::TemporaryGlobalVec source(dm);
+
+  ierr = VecScatterCreate(source, is_from, slab, is_to, result.rawptr());
+  PISM_CHK(ierr, "VecScatterCreate");
+}
+
+/*!
+ * @param[in] log logger
+ * @param[in] config configuration database
+ * @param[in] include_elastic include elastic deformation component
+ * @param[in] grid PISM's grid
+ * @param[in] extended_grid the extended grid used by the spectral method
+ */
+LingleClarkParallel::LingleClarkParallel(Logger::ConstPtr log,
+                                         const Config &config,
+                                         bool include_elastic,
+                                         std::shared_ptr<const Grid> grid,
+                                         std::shared_ptr<const Grid> extended_grid)
+  : m_com(grid->com),
+    m_work(grid, "lc_work"),
+    m_extended_work(extended_grid, "lc_extended_work"),
+    m_t_infty(1e16),            // around 317 million years
+    m_log(log) {
+
+  m_include_elastic = include_elastic;
+
+  if (include_elastic) {
+    // See LingleClarkSerial::LingleClarkSerial() for the explanation.
+    if (config.get_number("bed_deformation.lc.grid_size_factor") < 2) {
+      throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                    "bed_deformation.lc.elastic_model"
+                                    " requires bed_deformation.lc.grid_size_factor > 1");
+    }
+  }
+
+  // grid parameters
+  m_Mx = grid->Mx();
+  m_My = grid->My();
+  m_dx = grid->dx();
+  m_dy = grid->dy();
+  m_Nx = extended_grid->Mx();
+  m_Ny = extended_grid->My();
+
+  m_load_density   = config.get_number("constants.ice.density");
+  m_mantle_density = config.get_number("bed_deformation.mantle_density");
+  m_eta            = config.get_number("bed_deformation.mantle_viscosity");
+  m_D              = config.get_number("bed_deformation.lithosphere_flexural_rigidity");
+
+  m_standard_gravity = config.get_number("constants.standard_gravity");
+
+  // derive more parameters
+  m_Lx = 0.5 * (m_Nx - 1.0) * m_dx;
+  m_Ly = 0.5 * (m_Ny - 1.0) * m_dy;
+
+  // Set up FFTW-MPI.
+  fftw_mpi_initialize();
+
+  ptrdiff_t n_local = fftw_mpi_local_size_2d(m_Nx, m_Ny, m_com, &m_ni, &m_i_start);
+  // some ranks may not own any part of the extended grid
+  n_local = std::max(n_local, (ptrdiff_t)1);
+
+  m_fftw_input  = fftw_alloc_complex(n_local);
+  m_fftw_output = fftw_alloc_complex(n_local);
+  m_loadhat     = fftw_alloc_complex(n_local);
+  m_lrm_hat     = fftw_alloc_complex(n_local);
+
+  clear_fftw_array(m_fftw_input, m_ni, m_Ny);
+  m_dft_forward = fftw_mpi_plan_dft_2d(m_Nx, m_Ny, m_fftw_input, m_fftw_output, m_com,
+                                       FFTW_FORWARD, FFTW_ESTIMATE);
+  m_dft_inverse = fftw_mpi_plan_dft_2d(m_Nx, m_Ny, m_fftw_input, m_fftw_output, m_com,
+                                       FFTW_BACKWARD, FFTW_ESTIMATE);
+
+  // real-valued storage for the slab and scatters to and from it
+  {
+    PetscErrorCode ierr = VecCreateMPI(m_com, m_ni * m_Ny, PETSC_DETERMINE, m_slab.rawptr());
+    PISM_CHK(ierr, "VecCreateMPI");
+
+    auto dm = m_work.dm();
+    int
+      i0 = (m_Nx - m_Mx) / 2,
+      j0 = (m_Ny - m_My) / 2;
+
+    create_slab_scatter(dm, m_Mx, m_My, i0, j0, m_Ny, m_i_start, m_ni, m_slab,
+                        m_center_scatter);
+    create_slab_scatter(dm, m_Mx, m_My, 0, 0, m_Ny, m_i_start, m_ni, m_slab,
+                        m_corner_scatter);
+    create_slab_scatter(dm, m_Mx, m_My, m_Nx / 2, m_Ny / 2, m_Ny, m_i_start, m_ni, m_slab,
+                        m_elastic_scatter);
+    create_slab_scatter(m_extended_work.dm(), m_Nx, m_Ny, 0, 0, m_Ny, m_i_start, m_ni, m_slab,
+                        m_extended_scatter);
+  }
+
+  precompute_coefficients();
+}
+
+LingleClarkParallel::~LingleClarkParallel() {
+  fftw_destroy_plan(m_dft_forward);
+  fftw_destroy_plan(m_dft_inverse);
+  fftw_free(m_fftw_input);
+  fftw_free(m_fftw_output);
+  fftw_free(m_loadhat);
+  fftw_free(m_lrm_hat);
+}
+
+/*!
+ * Scatter `input` to the slab, setting all the points of the slab not covered by the
+ * scatter to zero.
+ */
+void LingleClarkParallel::to_slab(petsc::VecScatter &scatter, petsc::Vec &input) {
+  PetscErrorCode ierr = VecSet(m_slab, 0.0);
+  PISM_CHK(ierr, "VecSet");
+
+  ierr = VecScatterBegin(scatter, input, m_slab, INSERT_VALUES, SCATTER_FORWARD);
+  PISM_CHK(ierr, "VecScatterBegin");
+
+  ierr = VecScatterEnd(scatter, input, m_slab, INSERT_VALUES, SCATTER_FORWARD);
+  PISM_CHK(ierr, "VecScatterEnd");
+}
+
+/*!
+ * Copy values from the slab to `output`.
+ */
+void LingleClarkParallel::from_slab(petsc::VecScatter &scatter, petsc::Vec &output) {
+  PetscErrorCode ierr = VecScatterBegin(scatter, m_slab, output, INSERT_VALUES, SCATTER_REVERSE);
+  PISM_CHK(ierr, "VecScatterBegin");
+
+  ierr = VecScatterEnd(scatter, m_slab, output, INSERT_VALUES, SCATTER_REVERSE);
+  PISM_CHK(ierr, "VecScatterEnd");
+}
+
+//! Set the real part of `output` to the slab times `normalization`.
+void LingleClarkParallel::set_real_part(double normalization, fftw_complex *output) {
+  petsc::VecArray slab(m_slab);
+  const double *input = slab.get();
+
+  for (int k = 0; k < m_ni * m_Ny; ++k) {
+    output[k][0] = input[k] * normalization;
+    output[k][1] = 0.0;
+  }
+}
+
+//! Set the slab to the real part of `input` times `normalization`.
+void LingleClarkParallel::get_real_part(fftw_complex *input, double normalization) {
+  petsc::VecArray slab(m_slab);
+  double *output = slab.get();
+
+  for (int k = 0; k < m_ni * m_Ny; ++k) {
+    output[k] = input[k][0] * normalization;
+  }
+}
+
+/*!
+ * Compute the part of the load response matrix corresponding to the slab owned by this
+ * rank.
+ *
+ * Uses the symmetry of the LRM: LRM(i, j) depends on `|Nx/2 - i|` and `|Ny/2 - j|` only.
+ * See LingleClarkSerial::compute_load_response_matrix().
+ */
+void LingleClarkParallel::compute_load_response_matrix(fftw_complex *output) {
+
+  FFTWArray LRM(output, m_ni, m_Ny);
+
+  greens_elastic G;
+  ge_data ge_data {m_dx, m_dy, 0, 0, &G};
+
+  int Nx2 = m_Nx / 2;
+  int Ny2 = m_Ny / 2;
+
+  for (int i = 0; i < m_ni; ++i) {
+    for (int j = 0; j < m_Ny; ++j) {
+      ge_data.p = std::abs(Nx2 - (int)(m_i_start + i));
+      ge_data.q = std::abs(Ny2 - j);
+
+      LRM(i, j) = dblquad_cubature(ge_integrand,
+                                   -m_dx / 2, m_dx / 2,
+                                   -m_dy / 2, m_dy / 2,
+                                   1.0e-8, &ge_data);
+    }
+  }
+}
+
+/*!
+ * Compute the load response matrix on the extended grid.
+ *
+ * This method is used for testing only.
+ */
+void LingleClarkParallel::compute_load_response_matrix(array::Scalar &output) {
+  compute_load_response_matrix(m_fftw_input);
+
+  get_real_part(m_fftw_input, 1.0);
+  from_slab(m_extended_scatter, m_extended_work.vec());
+
+  output.copy_from(m_extended_work);
+}
+
+/**
+ * Pre-compute coefficients used by the model.
+ */
+void LingleClarkParallel::precompute_coefficients() {
+
+  // Coefficients for Fourier spectral method Laplacian
+  m_cx = fftfreq(m_Nx, m_Lx / (m_Nx * M_PI));
+  m_cy = fftfreq(m_Ny, m_Ly / (m_Ny * M_PI));
+
+  if (m_include_elastic) {
+    m_log->message(2, "     computing spherical elastic load response matrix ...");
+    {
+      compute_load_response_matrix(m_fftw_input);
+      // Compute fft2(LRM) and save it in m_lrm_hat
+      fftw_execute(m_dft_forward);
+      copy_fftw_array(m_fftw_output, m_lrm_hat, m_ni, m_Ny);
+    }
+    m_log->message(2, " done\n");
+  }
+}
+
+/*!
+ * Initialize using provided load thickness and the bed uplift rate.
+ *
+ * See LingleClarkSerial::bootstrap() and LingleClarkSerial::uplift_problem().
+ *
+ * @param[in] load_thickness load thickness, meters
+ * @param[in] bed_uplift initial bed uplift on the PISM grid
+ * @param[out] viscous_displacement viscous plate displacement on the extended grid
+ * @param[out] elastic_displacement elastic plate displacement on the PISM grid
+ */
+void LingleClarkParallel::bootstrap(const array::Scalar &load_thickness,
+                                    const array::Scalar &bed_uplift,
+                                    array::Scalar &viscous_displacement,
+                                    array::Scalar &elastic_displacement) {
+  PetscErrorCode ierr = 0;
+
+  m_work.copy_from(load_thickness);
+
+  double H_sum = 0.0;
+  ierr = VecSum(m_work.vec(), &H_sum);
+  PISM_CHK(ierr, "VecSum");
+
+  // Compute fft2(-load_density * g * load_thickness)
+  {
+    to_slab(m_center_scatter, m_work.vec());
+    set_real_part(- m_load_density * m_standard_gravity, m_fftw_input);
+    fftw_execute(m_dft_forward);
+    // Save fft2(-load_density * g * load_thickness) in loadhat.
+    copy_fftw_array(m_fftw_output, m_loadhat, m_ni, m_Ny);
+  }
+
+  // fft2(uplift)
+  {
+    m_work.copy_from(bed_uplift);
+    to_slab(m_center_scatter, m_work.vec());
+    set_real_part(1.0, m_fftw_input);
+    fftw_execute(m_dft_forward);
+  }
+
+  {
+    FFTWArray
+      u0_hat(m_fftw_input, m_ni, m_Ny),
+      load_hat(m_loadhat, m_ni, m_Ny),
+      uplift_hat(m_fftw_output, m_ni, m_Ny);
+
+    for (int i = 0; i < m_ni; i++) {
+      const double cx = m_cx[m_i_start + i];
+      for (int j = 0; j < m_Ny; j++) {
+        const double
+          C = cx*cx + m_cy[j]*m_cy[j],
+          A = - 2.0 * m_eta * sqrt(C),
+          B = m_mantle_density * m_standard_gravity + m_D * C * C;
+
+        u0_hat(i, j) = (load_hat(i, j) + A * uplift_hat(i, j)) / B;
+      }
+    }
+  }
+
+  fftw_execute(m_dft_inverse);
+  get_real_part(m_fftw_output, 1.0 / (m_Nx * m_Ny));
+
+  tweak(H_sum);
+
+  from_slab(m_extended_scatter, m_extended_work.vec());
+  viscous_displacement.copy_from(m_extended_work);
+
+  if (m_include_elastic) {
+    compute_elastic_response(load_thickness, elastic_displacement);
+  } else {
+    elastic_displacement.set(0.0);
+  }
+}
+
+/*!
+ * Perform a time step.
+ *
+ * See LingleClarkSerial::step().
+ *
+ * @param[in] dt time step length
+ * @param[in] H load thickness on the PISM grid
+ * @param[in,out] viscous_displacement viscous plate displacement on the extended grid
+ * @param[out] elastic_displacement elastic plate displacement on the PISM grid
+ */
+void LingleClarkParallel::step(double dt,
+                               const array::Scalar &H,
+                               array::Scalar &viscous_displacement,
+                               array::Scalar &elastic_displacement) {
+  if (dt > 0.0) {
+    PetscErrorCode ierr = 0;
+
+    m_work.copy_from(H);
+
+    double H_sum = 0.0;
+    ierr = VecSum(m_work.vec(), &H_sum);
+    PISM_CHK(ierr, "VecSum");
+
+    // Compute fft2(-load_density * g * dt * H)
+    {
+      to_slab(m_center_scatter, m_work.vec());
+      set_real_part(- m_load_density * m_standard_gravity * dt, m_fftw_input);
+      fftw_execute(m_dft_forward);
+
+      // Save fft2(-load_density * g * H * dt) in loadhat.
+      copy_fftw_array(m_fftw_output, m_loadhat, m_ni, m_Ny);
+    }
+
+    // Compute fft2(u).
+    {
+      m_extended_work.copy_from(viscous_displacement);
+      to_slab(m_extended_scatter, m_extended_work.vec());
+      set_real_part(1.0, m_fftw_input);
+      fftw_execute(m_dft_forward);
+    }
+
+    {
+      FFTWArray input(m_fftw_input, m_ni, m_Ny),
+        u_hat(m_fftw_output, m_ni, m_Ny), load_hat(m_loadhat, m_ni, m_Ny);
+      for (int i = 0; i < m_ni; i++) {
+        const double cx = m_cx[m_i_start + i];
+        for (int j = 0; j < m_Ny; j++) {
+          const double
+            C     = cx*cx + m_cy[j]*m_cy[j],
+            part1 = 2.0 * m_eta * sqrt(C),
+            part2 = (dt / 2.0) * (m_mantle_density * m_standard_gravity + m_D * C * C),
+            A = part1 - part2,
+            B = part1 + part2;
+
+          input(i, j) = (load_hat(i, j) + A * u_hat(i, j)) / B;
+        }
+      }
+    }
+
+    fftw_execute(m_dft_inverse);
+    get_real_part(m_fftw_output, 1.0 / (m_Nx * m_Ny));
+
+    // Now tweak. (See the "correction" in section 5 of BuelerLingleBrown.)
+    tweak(H_sum);
+
+    from_slab(m_extended_scatter, m_extended_work.vec());
+    viscous_displacement.copy_from(m_extended_work);
+  } else {
+    // zero time step: viscous displacement is zero
+    viscous_displacement.set(0.0);
+  }
+
+  if (m_include_elastic) {
+    compute_elastic_response(H, elastic_displacement);
+  }
+}
+
+/*!
+ * Compute elastic response to the load H
+ *
+ * @param[in] H load thickness (ice equivalent meters)
+ * @param[out] dE elastic plate displacement
+ */
+void LingleClarkParallel::compute_elastic_response(const array::Scalar &H, array::Scalar &dE) {
+
+  // Compute fft2(load_density * H)
+  //
+  // Note that here the load is placed in the corner of the extended grid.
+  {
+    m_work.copy_from(H);
+    to_slab(m_corner_scatter, m_work.vec());
+    set_real_part(m_load_density, m_fftw_input);
+    fftw_execute(m_dft_forward);
+  }
+
+  // fft2(m_response_matrix) * fft2(load_density*H)
+  {
+    FFTWArray
+      input(m_fftw_input, m_ni, m_Ny),
+      LRM_hat(m_lrm_hat, m_ni, m_Ny),
+      load_hat(m_fftw_output, m_ni, m_Ny);
+    for (int i = 0; i < m_ni; i++) {
+      for (int j = 0; j < m_Ny; j++) {
+        input(i, j) = LRM_hat(i, j) * load_hat(i, j);
+      }
+    }
+  }
+
+  // Compute the inverse transform and extract the elastic response (at offsets Nx/2 and
+  // Ny/2).
+  fftw_execute(m_dft_inverse);
+  get_real_part(m_fftw_output, 1.0 / (m_Nx * m_Ny));
+
+  from_slab(m_elastic_scatter, m_work.vec());
+  dE.copy_from(m_work);
+}
+
+/*!
+ * Compute total displacement by combining viscous and elastic contributions.
+ *
+ * @param[in] viscous_displacement viscous displacement on the extended grid
+ * @param[in] elastic_displacement elastic displacement on the PISM grid
+ * @param[out] result total displacement on the PISM grid
+ */
+void LingleClarkParallel::total_displacement(const array::Scalar &viscous_displacement,
+                                             const array::Scalar &elastic_displacement,
+                                             array::Scalar &result) {
+  m_extended_work.copy_from(viscous_displacement);
+  to_slab(m_extended_scatter, m_extended_work.vec());
+  from_slab(m_center_scatter, m_work.vec());
+
+  m_work.add(1.0, elastic_displacement);
+
+  result.copy_from(m_work);
+}
+
+/*!
+ * Modify the viscous plate displacement stored in the slab to correct for the effect of
+ * imposing periodic boundary conditions at a finite distance.
+ *
+ * See LingleClarkSerial::tweak() and Section 5 in [@ref BuelerLingleBrown].
+ *
+ * @param[in] load_thickness_sum sum of load thickness values over PISM's grid
+ */
+void LingleClarkParallel::tweak(double load_thickness_sum) {
+  PetscErrorCode ierr = 0;
+
+  // find average value along "distant" boundary of [-Lx, Lx]X[-Ly, Ly]
+  double average = 0.0;
+  {
+    petsc::VecArray slab(m_slab);
+    const double *u = slab.get();
+
+    // u(i, 0)
+    for (int i = 0; i < m_ni; i++) {
+      average += u[i * m_Ny + 0];
+    }
+
+    // u(0, j)
+    if (m_i_start == 0 and m_ni > 0) {
+      for (int j = 0; j < m_Ny; j++) {
+        average += u[0 * m_Ny + j];
+      }
+    }
+  }
+  average = GlobalSum(m_com, average) / (double) (m_Nx + m_Ny);
+
+  double shift = 0.0;
+  {
+    const double L_average = (m_Lx + m_Ly) / 2.0;
+    const double R         = L_average * (2.0 / 3.0);
+
+    // compute disc thickness by dividing its volume by the area
+    const double H = (load_thickness_sum * m_dx * m_dy) / (M_PI * R * R);
+
+    shift = viscDisc(m_t_infty,                        // time in seconds
+                     H,                                // disc thickness
+                     R,                                // disc radius
+                     L_average,                        // compute deflection at this radius
+                     m_mantle_density, m_load_density, // mantle and load densities
+                     m_standard_gravity,               //
+                     m_D,                              // flexural rigidity
+                     m_eta);                           // mantle viscosity
+  }
+
+  ierr = VecShift(m_slab, shift - average); PISM_CHK(ierr, "VecShift");
+}
+
+} // end of namespace bed
+} // end of namespace pism
@@ -0,0 +1,163 @@
+/* Copyright (C) 2024 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PISM_LINGLECLARKPARALLEL_H
+#define PISM_LINGLECLARKPARALLEL_H
+
+#include <cstddef>              // ptrdiff_t
+#include <memory>
+#include <vector>
+
+#include <fftw3.h>
+
+#include "pism/util/Logger.hh"
+#include "pism/util/array/Scalar.hh"
+#include "pism/util/petscwrappers/Vec.hh"
+#include "pism/util/petscwrappers/VecScatter.hh"
+
+namespace pism {
+
+class Config;
+class Grid;
+
+namespace bed {
+
+//! Distributed implementation of the Lingle-Clark bed deformation model.
+/*!
+ * This class implements the same model as LingleClarkSerial (see [@ref BLKfastearth]),
+ * but uses FFTW's MPI interface instead of computing on rank 0.
+ *
+ * FFTW-MPI distributes the extended (spectral) grid in "slabs": each rank owns a range
+ * of rows in the X direction and all the grid points in the Y direction. Inputs and
+ * outputs use PISM's usual 2D domain decomposition; this class scatters them to and from
+ * slabs as needed.
+ *
+ * Unlike LingleClarkSerial, this class does not store the plate displacement: the
+ * caller owns the model state and passes it to bootstrap() and step().
+ */
+class LingleClarkParallel {
+public:
+  LingleClarkParallel(Logger::ConstPtr log,
+                      const Config &config,
+                      bool include_elastic,
+                      std::shared_ptr<const Grid> grid,
+                      std::shared_ptr<const Grid> extended_grid);
+  ~LingleClarkParallel();
+
+  void bootstrap(const array::Scalar &load_thickness,
+                 const array::Scalar &bed_uplift,
+                 array::Scalar &viscous_displacement,
+                 array::Scalar &elastic_displacement);
+
+  void step(double dt,
+            const array::Scalar &load_thickness,
+            array::Scalar &viscous_displacement,
+            array::Scalar &elastic_displacement);
+
+  void total_displacement(const array::Scalar &viscous_displacement,
+                          const array::Scalar &elastic_displacement,
+                          array::Scalar &result);
+
+  void compute_load_response_matrix(array::Scalar &output);
+private:
+  void precompute_coefficients();
+
+  void compute_load_response_matrix(fftw_complex *output);
+
+  void compute_elastic_response(const array::Scalar &H, array::Scalar &dE);
+
+  void tweak(double load_thickness_sum);
+
+  void to_slab(petsc::VecScatter &scatter, petsc::Vec &input);
+  void from_slab(petsc::VecScatter &scatter, petsc::Vec &output);
+
+  void set_real_part(double normalization, fftw_complex *output);
+  void get_real_part(fftw_complex *input, double normalization);
+
+  MPI_Comm m_com;
+
+  bool m_include_elastic;
+  // grid size
+  int m_Mx;
+  int m_My;
+  // grid spacing
+  double m_dx;
+  double m_dy;
+  //! load density (for computing load from its thickness)
+  double m_load_density;
+  //! mantle density
+  double m_mantle_density;
+  //! mantle viscosity
+  double m_eta;
+  //! lithosphere flexural rigidity
+  double m_D;
+
+  // acceleration due to gravity
+  double m_standard_gravity;
+
+  // size of the extended grid
+  int m_Nx;
+  int m_Ny;
+
+  // half-lengths of the extended (FFT, spectral) computational domain
+  double m_Lx;
+  double m_Ly;
+
+  // the slab of the extended grid owned by this rank: rows [m_i_start, m_i_start + m_ni)
+  ptrdiff_t m_ni;
+  ptrdiff_t m_i_start;
+
+  // Coefficients of derivatives in Fourier space
+  std::vector<double> m_cx, m_cy;
+
+  fftw_complex *m_fftw_input;
+  fftw_complex *m_fftw_output;
+  fftw_complex *m_loadhat;
+  fftw_complex *m_lrm_hat;
+
+  fftw_plan m_dft_forward;
+  fftw_plan m_dft_inverse;
+
+  //! real-valued storage for the slab owned by this rank (in FFTW's ordering)
+  petsc::Vec m_slab;
+
+  //! PISM's grid embedded in the center of the extended grid (load and uplift)
+  petsc::VecScatter m_center_scatter;
+  //! PISM's grid embedded in the corner of the extended grid (load used by the elastic
+  //! model)
+  petsc::VecScatter m_corner_scatter;
+  //! PISM's grid at the offset (Nx/2, Ny/2) (elastic response)
+  petsc::VecScatter m_elastic_scatter;
+  //! the whole extended grid (viscous displacement)
+  petsc::VecScatter m_extended_scatter;
+
+  //! work space on PISM's grid (never ghosted)
+  array::Scalar m_work;
+  //! work space on the extended grid (never ghosted)
+  array::Scalar m_extended_work;
+
+  const double m_t_infty;
+
+  Logger::ConstPtr m_log;
+};
+
+} // end of namespace bed
+} // end of namespace pism
+
+#endif /* PISM_LINGLECLARKPARALLEL_H */
@@ -168,26 +168,50 @@ void BTU_Full::update_impl(const array::Scalar &bedrock_top_temperature,
 
   array::AccessScope list{m_temp.get(), &m_bottom_surface_flux, &bedrock_top_temperature};
 
-  ParallelSection loop(m_grid->com);
-  try {
-    for (auto p = m_grid->points(); p; p.next()) {
-      const int i = p.i(), j = p.j();
+  // columns are processed in batches of up to `width` columns (see BedrockColumn::solve())
+  const int width = TridiagonalBatch::width;
 
-      double *T = m_temp->get_column(i, j);
+  int n_columns = 0;
+  int I[width], J[width];
+  double Q_bottom[width], T_top[width];
+  double *T[width];
 
-      m_column->solve(dt, m_bottom_surface_flux(i, j), bedrock_top_temperature(i, j),
-                      T,  // input
-                      T); // output
+  auto solve_batch = [&]() {
+    m_column->solve(dt, n_columns, Q_bottom, T_top, T);
 
-      // Check that T is positive:
+    // Check that T is positive:
+    for (int n = 0; n < n_columns; ++n) {
       for (unsigned int k = 0; k < m_Mbz; ++k) {
-        if (T[k] <= 0.0) {
+        if (T[n][k] <= 0.0) {
           throw RuntimeError::formatted(PISM_ERROR_LOCATION,
                                         "invalid bedrock temperature: %f kelvin at %d,%d,%d",
-                                        T[k], i, j, k);
+                                        T[n][k], I[n], J[n], k);
         }
       }
     }
+    n_columns = 0;
+  };
+
+  ParallelSection loop(m_grid->com);
+  try {
+    for (auto p = m_grid->points(); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      I[n_columns]        = i;
+      J[n_columns]        = j;
+      Q_bottom[n_columns] = m_bottom_surface_flux(i, j);
+      T_top[n_columns]    = bedrock_top_temperature(i, j);
+      T[n_columns]        = m_temp->get_column(i, j);
+      n_columns += 1;
+
+      if (n_columns == width) {
+        solve_batch();
+      }
+    }
+
+    if (n_columns > 0) {
+      solve_batch();
+    }
   } catch (...) {
     loop.failed();
   }
@@ -18,16 +18,19 @@
  */
 
 #include <cassert>
+#include <fstream>
 
 #include "pism/energy/BedrockColumn.hh"
 #include "pism/util/ConfigInterface.hh"
+#include "pism/util/error_handling.hh"
+#include "pism/util/pism_utilities.hh"
 
 namespace pism {
 namespace energy {
 
 BedrockColumn::BedrockColumn(const std::string& prefix,
                              const Config& config, double dz, unsigned int M)
-  : m_dz(dz), m_M(M), m_system(M, prefix) {
+  : m_dz(dz), m_M(M), m_prefix(prefix), m_dt(-1.0), m_R(0.0) {
 
   assert(M > 1);
 
@@ -37,6 +40,87 @@ BedrockColumn::BedrockColumn(const std::string& prefix,
 
   m_k   = config.get_number("energy.bedrock_thermal.conductivity");
   m_D   = m_k / (rho * c);
+
+  m_L.resize(M);
+  m_work.resize(M);
+  m_inverse_pivot.resize(M);
+  m_x.resize(M * TridiagonalBatch::width);
+}
+
+/*!
+ * Compute the LU factorization of the system matrix corresponding to the time step `dt`
+ * (unless it is already available).
+ *
+ * The matrix is
+ *
+ * @verbatim
+   [1 + 2R   -2R                          ]
+   [  -R   1 + 2R   -R                    ]
+   [            ...                       ]
+   [              -R   1 + 2R   -R        ]
+   [                     0       1        ]
+   @endverbatim
+ *
+ * with @f$ R = D \Delta t / \Delta z^2 @f$. It is strictly diagonally dominant for
+ * @f$ \Delta t \ge 0 @f$, so all pivots are positive.
+ *
+ * Saves the matrix to a Python script and throws RuntimeError if a zero pivot is
+ * encountered anyway.
+ */
+void BedrockColumn::factorize(double dt) {
+  if (dt == m_dt) {
+    return;
+  }
+
+  const unsigned int N = m_M - 1;
+
+  const double R = m_D * dt / (m_dz * m_dz);
+
+  // diagonal and super-diagonal entries of the matrix
+  auto D = [N, R](unsigned int k) { return k < N ? 1.0 + 2.0 * R : 1.0; };
+  auto U = [R](unsigned int k) { return k == 0 ? -2.0 * R : -R; };
+
+  m_L[0] = 0.0; // not used
+  for (unsigned int k = 1; k < N; ++k) {
+    m_L[k] = -R;
+  }
+  m_L[N] = 0.0;
+
+  m_work[0] = 0.0; // not used
+  double b  = D(0);
+  for (unsigned int k = 0; k < m_M; ++k) {
+    if (k > 0) {
+      m_work[k] = U(k - 1) / b;
+
+      b = D(k) - m_L[k] * m_work[k];
+    }
+
+    if (b == 0.0) {
+      TridiagonalSystem system(m_M, m_prefix);
+      for (unsigned int n = 0; n < m_M; ++n) {
+        system.L(n)   = m_L[n];
+        system.D(n)   = D(n);
+        system.U(n)   = n < N ? U(n) : 0.0;
+        system.RHS(n) = 0.0;
+      }
+
+      auto filename = pism::printf("%s_ZERO_PIVOT_ERROR.py", m_prefix.c_str());
+      std::ofstream output(filename);
+      output << "# system has 1-norm = " << system.norm1(m_M)
+             << " and diagonal-dominance ratio = " << system.ddratio(m_M) << std::endl;
+      system.save_system(output, m_M);
+
+      throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                    "zero pivot at row %d (dt = %f seconds)\n"
+                                    "saved the system to %s",
+                                    k + 1, dt, filename.c_str());
+    }
+
+    m_inverse_pivot[k] = 1.0 / b;
+  }
+
+  m_R  = R;
+  m_dt = dt;
 }
 
 /*!
@@ -52,30 +136,95 @@ BedrockColumn::BedrockColumn(const std::string& prefix,
  */
 void BedrockColumn::solve(double dt, double Q_bottom, double T_top,
                           const double *T_old, double *T_new) {
+  factorize(dt);
 
-  double R = m_D * dt / (m_dz * m_dz);
-  double G = -Q_bottom / m_k;
-
-  m_system.L(0)   = 0.0;                 // not used
-  m_system.D(0)   = 1.0 + 2.0 * R;
-  m_system.U(0)   = -2.0 * R;
-  m_system.RHS(0) = T_old[0] - 2.0 * G * m_dz * R;
+  const double G = -Q_bottom / m_k;
 
-  unsigned int N = m_M - 1;
+  const unsigned int N = m_M - 1;
 
+  // forward substitution (reads T_old[k] before T_new[k] is set, so T_old and T_new may
+  // be the same)
+  T_new[0] = (T_old[0] - 2.0 * G * m_dz * m_R) * m_inverse_pivot[0];
   for (unsigned int k = 1; k < N; ++k) {
-    m_system.L(k)   = -R;
-    m_system.D(k)   = 1.0 + 2.0 * R;
-    m_system.U(k)   = -R;
-    m_system.RHS(k) = T_old[k];
+    T_new[k] = (T_old[k] - m_L[k] * T_new[k - 1]) * m_inverse_pivot[k];
   }
+  T_new[N] = (T_top - m_L[N] * T_new[N - 1]) * m_inverse_pivot[N];
 
-  m_system.L(N)   = 0.0;
-  m_system.D(N)   = 1.0;
-  m_system.U(N)   = 0.0;                 // not used
-  m_system.RHS(N) = T_top;
+  // back substitution
+  for (int k = static_cast<int>(N) - 1; k >= 0; --k) {
+    T_new[k] -= m_work[k + 1] * T_new[k + 1];
+  }
+}
 
-  m_system.solve(m_M, T_new);
+/*!
+ * Advance the heat equation in time in `n_columns` columns at once.
+ *
+ * @param[in] dt time step length
+ * @param[in] n_columns number of columns (at most `TridiagonalBatch::width`)
+ * @param[in] Q_bottom heat flux into each column through the bottom surface
+ * @param[in] T_top temperature at the top surface of each column
+ * @param[in,out] T pointers to temperatures in each column (updated in place)
+ *
+ * Columns are interleaved so that substitution loops over columns can be vectorized.
+ */
+void BedrockColumn::solve(double dt, int n_columns, const double *Q_bottom, const double *T_top,
+                          double *const *T) {
+  const int width = TridiagonalBatch::width;
+
+  assert(n_columns >= 1 and n_columns <= width);
+
+  factorize(dt);
+
+  const unsigned int N = m_M - 1;
+
+  // right-hand sides; unused lanes are set to zero
+  for (unsigned int k = 0; k < m_M; ++k) {
+    for (int n = 0; n < width; ++n) {
+      m_x[k * width + n] = 0.0;
+    }
+  }
+  for (int n = 0; n < n_columns; ++n) {
+    const double *T_n = T[n];
+    for (unsigned int k = 0; k < N; ++k) {
+      m_x[k * width + n] = T_n[k];
+    }
+    m_x[0 * width + n] += 2.0 * (Q_bottom[n] / m_k) * m_dz * m_R;
+    m_x[N * width + n] = T_top[n];
+  }
+
+  // forward substitution
+  for (int n = 0; n < width; ++n) {
+    m_x[n] *= m_inverse_pivot[0];
+  }
+  for (unsigned int k = 1; k < m_M; ++k) {
+    const double L = m_L[k], inverse_pivot = m_inverse_pivot[k];
+
+    const double *x_0 = &m_x[(k - 1) * width];
+    double *x = &m_x[k * width];
+
+    for (int n = 0; n < width; ++n) {
+      x[n] = (x[n] - L * x_0[n]) * inverse_pivot;
+    }
+  }
+
+  // back substitution
+  for (int k = static_cast<int>(N) - 1; k >= 0; --k) {
+    const double work = m_work[k + 1];
+
+    const double *x_1 = &m_x[(k + 1) * width];
+    double *x = &m_x[k * width];
+
+    for (int n = 0; n < width; ++n) {
+      x[n] -= work * x_1[n];
+    }
+  }
+
+  for (int n = 0; n < n_columns; ++n) {
+    double *T_n = T[n];
+    for (unsigned int k = 0; k < m_M; ++k) {
+      T_n[k] = m_x[k * width + n];
+    }
+  }
 }
 
 /*!
@@ -35,6 +35,11 @@ namespace energy {
  *
  * The implementation uses a second-order discretization in space and the backward-Euler
  * (first-order, fully implicit) time-discretization.
+ *
+ * Bedrock thermal properties and the vertical grid are the same in all columns, so the
+ * matrix of this system depends on the time step length only. We factor it once per
+ * distinct `dt` and re-use the factorization: solving the system in a column requires
+ * forward and back substitution only.
  */
 class BedrockColumn {
 public:
@@ -49,7 +54,12 @@ public:
              const std::vector<double> &T_old,
              std::vector<double> &result);
 
+  void solve(double dt, int n_columns, const double *Q_bottom, const double *T_top,
+             double *const *T);
+
 private:
+  void factorize(double dt);
+
   // temperature diffusivity coefficient
   double m_D;
   // thermal conductivity
@@ -58,8 +68,20 @@ private:
   double m_dz;
   // system size
   unsigned int m_M;
+  // prefix used in names of files containing systems that could not be factored
+  std::string m_prefix;
+
+  // time step length used to compute the factorization below (negative if not computed yet)
+  double m_dt;
+  // m_D * m_dt / m_dz^2
+  double m_R;
+  // LU factorization of the system matrix: sub-diagonal, multipliers used in the
+  // back substitution and reciprocals of pivots
+  std::vector<double> m_L, m_work, m_inverse_pivot;
 
-  TridiagonalSystem m_system;
+  // storage for the right-hand sides and solutions in the "structure of arrays" form
+  // (see TridiagonalBatch)
+  std::vector<double> m_x;
 };
 
 } // end of namespace energy
@@ -22,9 +22,14 @@
 #include "pism/energy/enthSystem.hh"
 #include "pism/energy/utilities.hh"
 #include "pism/util/Context.hh"
+#include "pism/util/Profiling.hh"
 #include "pism/util/EnthalpyConverter.hh"
 #include "pism/util/array/CellType.hh"
 #include "pism/util/io/File.hh"
+#include "pism/util/pism_utilities.hh"
+#include "pism/pism_config.hh"
+
+#include <memory>
 
 namespace pism {
 namespace energy {
@@ -32,7 +37,21 @@ namespace energy {
 EnthalpyModel::EnthalpyModel(std::shared_ptr<const Grid> grid,
                              std::shared_ptr<const stressbalance::StressBalance> stress_balance)
   : EnergyModel(grid, stress_balance) {
-  // empty
+
+  int n_threads = static_cast<int>(m_config->get_number("energy.threads"));
+  if (n_threads < 1) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "energy.threads = %d is invalid (has to be 1 or greater)",
+                                  n_threads);
+  }
+
+#if (Pism_USE_OPENMP == 0)
+  if (n_threads > 1) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "energy.threads = %d requires PISM built with OpenMP",
+                                  n_threads);
+  }
+#endif
 }
 
 void EnthalpyModel::restart_impl(const File &input_file, int record) {
@@ -99,7 +118,11 @@ AschwandenBuelerKhroulevBlatter].
 This method updates array::Array3D m_work and array::Scalar basal_melt_rate.
 No communication of ghosts is done for any of these fields.
 
-We use an instance of enthSystemCtx.
+Columns with the same number of levels within the ice are grouped into batches of
+TridiagonalBatch::width columns; systems in all columns of a batch are solved
+simultaneously. Batches are distributed among `energy.threads` OpenMP threads (if PISM
+was built with OpenMP); each thread uses one instance of enthSystemCtx per column of a
+batch.
 
 Regarding drainage, see [\ref AschwandenBuelerKhroulevBlatter] and references therein.
  */
@@ -138,12 +161,33 @@ void EnthalpyModel::update_impl(double t, double dt, const Inputs &inputs) {
 
   const array::Scalar1 &ice_thickness = *inputs.ice_thickness;
 
-  energy::enthSystemCtx system(m_grid->z(), "energy.enthalpy", m_grid->dx(), m_grid->dy(), dt,
-                               *m_config, m_ice_enthalpy, u3, v3, w3, strain_heating3, EC);
+  const int n_threads = thread_count(static_cast<int>(m_config->get_number("energy.threads")));
+
+  const int width = TridiagonalBatch::width;
+
+  // Each thread uses one column system (and one work vector) per lane of a batch and a
+  // batched tridiagonal solver.
+  struct Workspace {
+    std::vector<std::unique_ptr<energy::enthSystemCtx>> systems;
+    std::vector<std::vector<double>> Enthnew;
+    std::unique_ptr<TridiagonalBatch> solver;
+  };
+
+  std::vector<Workspace> workspace(n_threads);
+  for (auto &w : workspace) {
+    w.systems.resize(width);
+    for (auto &s : w.systems) {
+      s.reset(new energy::enthSystemCtx(m_grid->z(), "energy.enthalpy", m_grid->dx(),
+                                        m_grid->dy(), dt, *m_config, m_ice_enthalpy, u3, v3, w3,
+                                        strain_heating3, EC));
+    }
+    const size_t Mz_fine = w.systems[0]->z().size();
+    // new enthalpy in columns
+    w.Enthnew.resize(width, std::vector<double>(Mz_fine));
+    w.solver.reset(new TridiagonalBatch(Mz_fine));
+  }
 
-  const size_t Mz_fine = system.z().size();
-  const double dz = system.dz();
-  std::vector<double> Enthnew(Mz_fine); // new enthalpy in column
+  const double dz = workspace[0].systems[0]->dz();
 
   array::AccessScope list{&ice_surface_temp, &shelf_base_temp, &surface_liquid_fraction,
       &ice_thickness, &basal_frictional_heating, &basal_heat_flux, &till_water_thickness,
@@ -152,197 +196,260 @@ void EnthalpyModel::update_impl(double t, double dt, const Inputs &inputs) {
 
   double margin_threshold = m_config->get_number("energy.margin_ice_thickness_limit");
 
-  unsigned int liquifiedCount = 0;
+  unsigned int
+    liquifiedCount           = 0,
+    bulge_counter            = 0,
+    reduced_accuracy_counter = 0,
+    column_counter           = 0;
+
+  // Columns with the same number of levels within the ice are grouped into batches: we
+  // set up systems in all columns of a batch, solve them simultaneously, then
+  // post-process.
+  const auto batches = workspace[0].systems[0]->batches(ice_thickness);
+  const int N        = static_cast<int>(batches.size());
 
   ParallelSection loop(m_grid->com);
-  try {
-    for (auto pt = m_grid->points(); pt; pt.next()) {
-      const int i = pt.i(), j = pt.j();
 
-      const double H = ice_thickness(i, j);
+#pragma omp parallel for num_threads(n_threads) schedule(dynamic, 1)  \
+  reduction(+ : liquifiedCount, bulge_counter, reduced_accuracy_counter, column_counter)
+  for (int b = 0; b < N; ++b) {
+    const auto &batch = batches[b];
 
-      system.init(i, j,
-                  marginal(ice_thickness, i, j, margin_threshold),
-                  H);
+    auto &W = workspace[thread_index()];
 
-      // enthalpy and pressures at top of ice
-      const double
-        depth_ks = H - system.ks() * dz,
-        p_ks     = EC->pressure(depth_ks); // FIXME issue #15
+    try {
+      // enthalpy at the top of the ice and the type of the ice base in each column
+      double Enth_ks[width];
+      bool is_floating[width];
 
-      const double Enth_ks = EC->enthalpy_permissive(ice_surface_temp(i, j),
-                                                     surface_liquid_fraction(i, j), p_ks);
+      for (int n = 0; n < batch.size; ++n) {
+        const int i = batch.i[n], j = batch.j[n];
 
-      const bool ice_free_column = (system.ks() == 0);
+        auto &system = *W.systems[n];
 
-      // deal completely with columns with no ice; enthalpy and basal_melt_rate need setting
-      if (ice_free_column) {
-        m_work.set_column(i, j, Enth_ks);
-        // The floating basal melt rate will be set later; cover this
-        // case and set to zero for now. Also, there is no basal melt
-        // rate on ice free land and ice free ocean
-        m_basal_melt_rate(i, j) = 0.0;
-        continue;
-      } // end of if (ice_free_column)
+        const double H = ice_thickness(i, j);
 
-      if (system.lambda() < 1.0) {
-        m_stats.reduced_accuracy_counter += 1; // count columns with lambda < 1
-      }
+        system.init(i, j,
+                    marginal(ice_thickness, i, j, margin_threshold),
+                    H);
+
+        // enthalpy and pressures at top of ice
+        const double
+          depth_ks = H - system.ks() * dz,
+          p_ks     = EC->pressure(depth_ks); // FIXME issue #15
+
+        Enth_ks[n] = EC->enthalpy_permissive(ice_surface_temp(i, j),
+                                             surface_liquid_fraction(i, j), p_ks);
+
+        const bool ice_free_column = (system.ks() == 0);
 
-      const bool
-        is_floating        = cell_type.ocean(i, j),
-        base_is_warm       = system.Enth(0) >= system.Enth_s(0),
-        above_base_is_warm = system.Enth(1) >= system.Enth_s(1);
-
-      // set boundary conditions and update enthalpy
-      {
-        system.set_surface_dirichlet_bc(Enth_ks);
-
-        // determine lowest-level equation at bottom of ice; see
-        // decision chart in the source code browser and page
-        // documenting BOMBPROOF
-        if (is_floating) {
-          // floating base: Dirichlet application of known temperature from ocean
-          //   coupler; assumes base of ice shelf has zero liquid fraction
-          double Enth0 = EC->enthalpy_permissive(shelf_base_temp(i, j), 0.0, EC->pressure(H));
-
-          system.set_basal_dirichlet_bc(Enth0);
-        } else {
-          // grounded ice warm and wet
-          if (base_is_warm && (till_water_thickness(i, j) > 0.0)) {
-            if (above_base_is_warm) {
-              // temperate layer at base (Neumann) case:  q . n = 0  (K0 grad E . n = 0)
-              system.set_basal_heat_flux(0.0);
+        // deal completely with columns with no ice; enthalpy and basal_melt_rate need setting
+        if (ice_free_column) {
+          m_work.set_column(i, j, Enth_ks[n]);
+          // The floating basal melt rate will be set later; cover this
+          // case and set to zero for now. Also, there is no basal melt
+          // rate on ice free land and ice free ocean
+          m_basal_melt_rate(i, j) = 0.0;
+          continue;
+        } // end of if (ice_free_column)
+
+        column_counter += 1;
+
+        if (system.lambda() < 1.0) {
+          reduced_accuracy_counter += 1; // count columns with lambda < 1
+        }
+
+        is_floating[n] = cell_type.ocean(i, j);
+
+        const bool
+          base_is_warm       = system.Enth(0) >= system.Enth_s(0),
+          above_base_is_warm = system.Enth(1) >= system.Enth_s(1);
+
+        // set boundary conditions and assemble the system
+        {
+          system.set_surface_dirichlet_bc(Enth_ks[n]);
+
+          // determine lowest-level equation at bottom of ice; see
+          // decision chart in the source code browser and page
+          // documenting BOMBPROOF
+          if (is_floating[n]) {
+            // floating base: Dirichlet application of known temperature from ocean
+            //   coupler; assumes base of ice shelf has zero liquid fraction
+            double Enth0 = EC->enthalpy_permissive(shelf_base_temp(i, j), 0.0, EC->pressure(H));
+
+            system.set_basal_dirichlet_bc(Enth0);
+          } else {
+            // grounded ice warm and wet
+            if (base_is_warm && (till_water_thickness(i, j) > 0.0)) {
+              if (above_base_is_warm) {
+                // temperate layer at base (Neumann) case:  q . n = 0  (K0 grad E . n = 0)
+                system.set_basal_heat_flux(0.0);
+              } else {
+                // only the base is warm: E = E_s(p) (Dirichlet)
+                // ( Assumes ice has zero liquid fraction. Is this a valid assumption here?
+                system.set_basal_dirichlet_bc(system.Enth_s(0));
+              }
             } else {
-              // only the base is warm: E = E_s(p) (Dirichlet)
-              // ( Assumes ice has zero liquid fraction. Is this a valid assumption here?
-              system.set_basal_dirichlet_bc(system.Enth_s(0));
+              // (Neumann) case:  q . n = q_lith . n + F_b
+              // a) cold and dry base, or
+              // b) base that is still warm from the last time step, but without basal water
+              system.set_basal_heat_flux(basal_heat_flux(i, j) + basal_frictional_heating(i, j));
             }
-          } else {
-            // (Neumann) case:  q . n = q_lith . n + F_b
-            // a) cold and dry base, or
-            // b) base that is still warm from the last time step, but without basal water
-            system.set_basal_heat_flux(basal_heat_flux(i, j) + basal_frictional_heating(i, j));
           }
+
+          system.assemble();
+          system.add_to(*W.solver, n);
         }
+      }
 
-        // solve the system
-        system.solve(Enthnew);
+      if (batch.ks == 0) {
+        // all columns in this batch are ice-free
+        continue;
+      }
 
+      // solve systems in all columns of this batch
+      try {
+        W.solver->solve(batch.ks + 1, batch.size);
+      } catch (RuntimeError &e) {
+        e.add_context("solving tri-diagonal systems (enthSystemCtx) in columns %s",
+                      batch.columns().c_str());
+        int lane = W.solver->zero_pivot_lane();
+        if (lane >= 0) {
+          e.add_context("saving the system at (%d,%d) to m-file... ", batch.i[lane],
+                        batch.j[lane]);
+          W.systems[lane]->reportColumnZeroPivotErrorMFile(batch.ks + 1);
+        }
+        throw;
       }
 
-      // post-process (drainage and bulge-limiting)
-      double Hdrainedtotal = 0.0;
-      {
-        // drain ice segments by mechanism in [\ref AschwandenBuelerKhroulevBlatter],
-        //   using DrainageCalculator dc
-        for (unsigned int k=0; k < system.ks(); k++) {
-          if (Enthnew[k] > system.Enth_s(k)) { // avoid doing any more work if cold
-
-            const double
-              depth = H - k * dz,
-              p     = EC->pressure(depth), // FIXME issue #15
-              T_m   = EC->melting_temperature(p),
-              L     = EC->L(T_m);
-
-            if (Enthnew[k] >= system.Enth_s(k) + 0.5 * L) {
-              liquifiedCount++; // count these rare events...
-              Enthnew[k] = system.Enth_s(k) + 0.5 * L; //  but lose the energy
-            }
+      for (int n = 0; n < batch.size; ++n) {
+        const int i = batch.i[n], j = batch.j[n];
+
+        auto &system  = *W.systems[n];
+        auto &Enthnew = W.Enthnew[n];
 
-            double omega = EC->water_fraction(Enthnew[k], p);
+        const double H = ice_thickness(i, j);
 
-            if (omega > target_water_fraction) {
-              double fractiondrained = dc.get_drainage_rate(omega) * dt; // pure number
+        system.solution(*W.solver, n, Enthnew);
 
-              fractiondrained  = std::min(fractiondrained,
-                                          omega - target_water_fraction);
-              Hdrainedtotal   += fractiondrained * dz; // always a positive contribution
-              Enthnew[k]      -= fractiondrained * L;
+        // post-process (drainage and bulge-limiting)
+        double Hdrainedtotal = 0.0;
+        {
+          // drain ice segments by mechanism in [\ref AschwandenBuelerKhroulevBlatter],
+          //   using DrainageCalculator dc
+          for (unsigned int k=0; k < system.ks(); k++) {
+            if (Enthnew[k] > system.Enth_s(k)) { // avoid doing any more work if cold
+
+              const double
+                depth = H - k * dz,
+                p     = EC->pressure(depth), // FIXME issue #15
+                T_m   = EC->melting_temperature(p),
+                L     = EC->L(T_m);
+
+              if (Enthnew[k] >= system.Enth_s(k) + 0.5 * L) {
+                liquifiedCount++; // count these rare events...
+                Enthnew[k] = system.Enth_s(k) + 0.5 * L; //  but lose the energy
+              }
+
+              double omega = EC->water_fraction(Enthnew[k], p);
+
+              if (omega > target_water_fraction) {
+                double fractiondrained = dc.get_drainage_rate(omega) * dt; // pure number
+
+                fractiondrained  = std::min(fractiondrained,
+                                            omega - target_water_fraction);
+                Hdrainedtotal   += fractiondrained * dz; // always a positive contribution
+                Enthnew[k]      -= fractiondrained * L;
+              }
             }
           }
-        }
 
-        // apply bulge limiter
-        const double lowerEnthLimit = Enth_ks - bulgeEnthMax;
-        for (unsigned int k=0; k < system.ks(); k++) {
-          if (Enthnew[k] < lowerEnthLimit) {
-            // Count grid points which have very large cold limit advection bulge... enthalpy not
-            // too low.
-            m_stats.bulge_counter += 1;
-            Enthnew[k] = lowerEnthLimit;
+          // apply bulge limiter
+          const double lowerEnthLimit = Enth_ks[n] - bulgeEnthMax;
+          for (unsigned int k=0; k < system.ks(); k++) {
+            if (Enthnew[k] < lowerEnthLimit) {
+              // Count grid points which have very large cold limit advection bulge... enthalpy not
+              // too low.
+              bulge_counter += 1;
+              Enthnew[k] = lowerEnthLimit;
+            }
           }
-        }
 
-        // if there is subglacial water, don't allow ice base enthalpy to be below
-        // pressure-melting; that is, assume subglacial water is at the pressure-
-        // melting temperature and enforce continuity of temperature
-        if (till_water_thickness(i, j) > 0.0) {
-          Enthnew[0] = std::max(Enthnew[0], system.Enth_s(0));
-        }
-      } // end of post-processing
-
-      // compute basal melt rate
-      {
-        bool base_is_cold = (Enthnew[0] < system.Enth_s(0)) && (till_water_thickness(i,j) == 0.0);
-        // Determine melt rate, but only preliminarily because of
-        // drainage, from heat flux out of bedrock, heat flux into
-        // ice, and frictional heating
-        if (is_floating) {
-          // The floating basal melt rate will be set later; cover
-          // this case and set to zero for now. Note that
-          // Hdrainedtotal is discarded (the ocean model determines
-          // the basal melt).
-          m_basal_melt_rate(i, j) = 0.0;
-        } else {
-          if (base_is_cold) {
-            m_basal_melt_rate(i, j) = 0.0;  // zero melt rate if cold base
+          // if there is subglacial water, don't allow ice base enthalpy to be below
+          // pressure-melting; that is, assume subglacial water is at the pressure-
+          // melting temperature and enforce continuity of temperature
+          if (till_water_thickness(i, j) > 0.0) {
+            Enthnew[0] = std::max(Enthnew[0], system.Enth_s(0));
+          }
+        } // end of post-processing
+
+        // compute basal melt rate
+        {
+          bool base_is_cold = (Enthnew[0] < system.Enth_s(0)) && (till_water_thickness(i,j) == 0.0);
+          // Determine melt rate, but only preliminarily because of
+          // drainage, from heat flux out of bedrock, heat flux into
+          // ice, and frictional heating
+          if (is_floating[n]) {
+            // The floating basal melt rate will be set later; cover
+            // this case and set to zero for now. Note that
+            // Hdrainedtotal is discarded (the ocean model determines
+            // the basal melt).
+            m_basal_melt_rate(i, j) = 0.0;
           } else {
-            const double
-              p_0 = EC->pressure(H),
-              p_1 = EC->pressure(H - dz), // FIXME issue #15
-              Tpmp_0 = EC->melting_temperature(p_0);
-
-            const bool k1_istemperate = EC->is_temperate(Enthnew[1], p_1); // level  z = + \Delta z
-            double hf_up = 0.0;
-            if (k1_istemperate) {
-              const double
-                Tpmp_1 = EC->melting_temperature(p_1);
-
-              hf_up = -system.k_from_T(Tpmp_0) * (Tpmp_1 - Tpmp_0) / dz;
+            if (base_is_cold) {
+              m_basal_melt_rate(i, j) = 0.0;  // zero melt rate if cold base
             } else {
-              double T_0 = EC->temperature(Enthnew[0], p_0);
-              const double K_0 = system.k_from_T(T_0) / EC->c();
-
-              hf_up = -K_0 * (Enthnew[1] - Enthnew[0]) / dz;
-            }
-
-            // compute basal melt rate from flux balance:
-            //
-            // basal_melt_rate = - Mb / rho in [\ref AschwandenBuelerKhroulevBlatter];
-            //
-            // after we compute it we make sure there is no refreeze if
-            // there is no available basal water
-            m_basal_melt_rate(i, j) = (basal_frictional_heating(i, j) + basal_heat_flux(i, j) - hf_up) / (ice_density * EC->L(Tpmp_0));
-
-            if (till_water_thickness(i, j) <= 0 && m_basal_melt_rate(i, j) < 0) {
-              m_basal_melt_rate(i, j) = 0.0;
+              const double
+                p_0 = EC->pressure(H),
+                p_1 = EC->pressure(H - dz), // FIXME issue #15
+                Tpmp_0 = EC->melting_temperature(p_0);
+
+              const bool k1_istemperate = EC->is_temperate(Enthnew[1], p_1); // level  z = + \Delta z
+              double hf_up = 0.0;
+              if (k1_istemperate) {
+                const double
+                  Tpmp_1 = EC->melting_temperature(p_1);
+
+                hf_up = -system.k_from_T(Tpmp_0) * (Tpmp_1 - Tpmp_0) / dz;
+              } else {
+                double T_0 = EC->temperature(Enthnew[0], p_0);
+                const double K_0 = system.k_from_T(T_0) / EC->c();
+
+                hf_up = -K_0 * (Enthnew[1] - Enthnew[0]) / dz;
+              }
+
+              // compute basal melt rate from flux balance:
+              //
+              // basal_melt_rate = - Mb / rho in [\ref AschwandenBuelerKhroulevBlatter];
+              //
+              // after we compute it we make sure there is no refreeze if
+              // there is no available basal water
+              m_basal_melt_rate(i, j) = (basal_frictional_heating(i, j) + basal_heat_flux(i, j) - hf_up) / (ice_density * EC->L(Tpmp_0));
+
+              if (till_water_thickness(i, j) <= 0 && m_basal_melt_rate(i, j) < 0) {
+                m_basal_melt_rate(i, j) = 0.0;
+              }
             }
-          }
 
-          // Add drained water from the column to basal melt rate.
-          m_basal_melt_rate(i, j) += Hdrainedtotal / dt;
-        } // end of the grounded case
-      } // end of the basal melt rate computation
+            // Add drained water from the column to basal melt rate.
+            m_basal_melt_rate(i, j) += Hdrainedtotal / dt;
+          } // end of the grounded case
+        } // end of the basal melt rate computation
 
-      system.fine_to_coarse(Enthnew, i, j, m_work);
+        system.fine_to_coarse(Enthnew, i, j, m_work);
+      }
+    } catch (...) {
+#pragma omp critical
+      loop.failed();
     }
-  } catch (...) {
-    loop.failed();
   }
   loop.check();
 
+  m_stats.bulge_counter            += bulge_counter;
+  m_stats.reduced_accuracy_counter += reduced_accuracy_counter;
   m_stats.liquified_ice_volume = ((double) liquifiedCount) * dz * m_grid->cell_area();
+
+  profiling().count("columns", column_counter);
 }
 
 void EnthalpyModel::define_model_state_impl(const File &output) const {
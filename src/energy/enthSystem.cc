@@ -435,7 +435,7 @@ void enthSystemCtx::assemble_R() {
 }
 
 
-/*! \brief Solve the tridiagonal system, in a single column, which
+/*! \brief Assemble the tridiagonal system, in a single column, which
  *  determines the new values of the ice enthalpy.
  *
  * We are solving a convection-diffusion equation, treating the @f$ z @f$ direction implicitly and
@@ -477,7 +477,7 @@ void enthSystemCtx::assemble_R() {
  * This method is _unconditionally stable_ and has a maximum principle (see [@ref MortonMayers,
  * section 2.11]).
  */
-void enthSystemCtx::solve(std::vector<double> &result) {
+void enthSystemCtx::assemble() {
 
   TridiagonalSystem &S = *m_solver;
 
@@ -545,10 +545,15 @@ void enthSystemCtx::solve(std::vector<double> &result) {
     S.U(m_ks) = m_U_ks;
   }
   S.RHS(m_ks) = m_B_ks;
+}
+
+//! Assemble and solve the system in the current column.
+void enthSystemCtx::solve(std::vector<double> &result) {
+  assemble();
 
   // Solve it; note drainage is not addressed yet and post-processing may occur
   try {
-    S.solve(m_ks + 1, result);
+    m_solver->solve(m_ks + 1, result);
   }
   catch (RuntimeError &e) {
     e.add_context("solving the tri-diagonal system (enthSystemCtx) at (%d,%d)\n"
@@ -557,6 +562,25 @@ void enthSystemCtx::solve(std::vector<double> &result) {
     throw;
   }
 
+  finish_column(result);
+}
+
+/*!
+ * Copy the solution in the lane `lane` of `batch` to `result`.
+ *
+ * The system in this lane has to be assembled by calling assemble() and add_to().
+ */
+void enthSystemCtx::solution(const TridiagonalBatch &batch, int lane,
+                             std::vector<double> &result) {
+  for (unsigned int k = 0; k <= m_ks; k++) {
+    result[k] = batch.x(k, lane);
+  }
+
+  finish_column(result);
+}
+
+//! Set enthalpy above the ice surface and mark this column as done.
+void enthSystemCtx::finish_column(std::vector<double> &result) {
   // air above
   for (unsigned int k = m_ks+1; k < result.size(); k++) {
     result[k] = m_B_ks;
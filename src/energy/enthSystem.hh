@@ -64,8 +64,12 @@ public:
 
   virtual void save_system(std::ostream &output, unsigned int M) const;
 
+  void assemble();
+
   void solve(std::vector<double> &result);
 
+  void solution(const TridiagonalBatch &batch, int lane, std::vector<double> &result);
+
   double lambda() const {
     return m_lambda;
   }
@@ -114,6 +118,7 @@ protected:
 
   void assemble_R();
   void checkReadyToSolve() const;
+  void finish_column(std::vector<double> &result);
 };
 
 } // end of namespace energy
@@ -21,6 +21,7 @@
 #include "pism/util/array/CellType.hh"
 #include "pism/util/MaxTimestep.hh"
 #include "pism/util/pism_utilities.hh"
+#include "pism/util/GlobalReduction.hh"
 #include "pism/geometry/part_grid_threshold_thickness.hh"
 #include "pism/geometry/Geometry.hh"
 #include "pism/util/Context.hh"
@@ -102,9 +103,17 @@ MaxTimestep FrontRetreat::max_timestep(const array::CellType1 &cell_type,
     }
   }
 
-  N_cells           = GlobalSum(grid->com, N_cells);
-  retreat_rate_mean = GlobalSum(grid->com, retreat_rate_mean);
-  retreat_rate_max  = GlobalMax(grid->com, retreat_rate_max);
+  {
+    GlobalReduction r(grid->com);
+    int N    = r.sum(N_cells);
+    int mean = r.sum(retreat_rate_mean);
+    int max  = r.max(retreat_rate_max);
+    r.reduce();
+
+    N_cells           = static_cast<int>(r[N]);
+    retreat_rate_mean = r[mean];
+    retreat_rate_max  = r[max];
+  }
 
   if (N_cells > 0.0) {
     retreat_rate_mean /= N_cells;
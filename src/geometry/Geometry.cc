@@ -169,6 +169,8 @@ void Geometry::ensure_consistency(double ice_free_thickness_threshold) {
   cell_type.update_ghosts();
   ice_surface_elevation.update_ghosts();
 
+  active_columns.update(ice_thickness);
+
   const double
     ice_density = config->get_number("constants.ice.density"),
     ocean_density = config->get_number("constants.sea_water.density");
@@ -192,6 +194,34 @@ void Geometry::ensure_consistency(double ice_free_thickness_threshold) {
   }
 }
 
+/*!
+ * Re-build lists of active and inactive columns.
+ *
+ * Uses ghost values of `ice_thickness` (they have to be up to date).
+ */
+void ActiveColumns::update(const array::Scalar &ice_thickness) {
+  auto grid = ice_thickness.grid();
+
+  assert(ice_thickness.stencil_width() >= 1);
+
+  array::AccessScope list{ &ice_thickness };
+
+  m_active.clear();
+  m_inactive.clear();
+
+  for (auto p = grid->points(); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    auto H = ice_thickness.star(i, j);
+
+    bool active = H.c > 0.0 or H.n > 0.0 or H.e > 0.0 or H.s > 0.0 or H.w > 0.0;
+
+    auto &columns = active ? m_active : m_inactive;
+    columns.push_back(i);
+    columns.push_back(j);
+  }
+}
+
 void Geometry::dump(const char *filename) const {
   auto grid = ice_thickness.grid();
 
@@ -250,8 +280,8 @@ void ice_bottom_surface(const Geometry &geometry, array::Scalar &result) {
   result.update_ghosts();
 }
 
-//! Computes the ice volume, in m^3.
-double ice_volume(const Geometry &geometry, double thickness_threshold) {
+//! Computes the contribution of the current sub-domain to the ice volume, in m^3.
+double ice_volume_local(const Geometry &geometry, double thickness_threshold) {
   auto grid = geometry.ice_thickness.grid();
   auto config = grid->ctx()->config();
 
@@ -281,11 +311,17 @@ double ice_volume(const Geometry &geometry, double thickness_threshold) {
     }
   }
 
-  return GlobalSum(grid->com, volume);
+  return volume;
 }
 
-double ice_volume_not_displacing_seawater(const Geometry &geometry,
-                                          double thickness_threshold) {
+//! Computes the ice volume, in m^3.
+double ice_volume(const Geometry &geometry, double thickness_threshold) {
+  return GlobalSum(geometry.ice_thickness.grid()->com,
+                   ice_volume_local(geometry, thickness_threshold));
+}
+
+double ice_volume_not_displacing_seawater_local(const Geometry &geometry,
+                                                double thickness_threshold) {
   auto grid = geometry.ice_thickness.grid();
   auto config = grid->ctx()->config();
 
@@ -314,7 +350,13 @@ double ice_volume_not_displacing_seawater(const Geometry &geometry,
     }
   } // end of the loop over grid points
 
-  return GlobalSum(grid->com, volume);
+  return volume;
+}
+
+double ice_volume_not_displacing_seawater(const Geometry &geometry,
+                                          double thickness_threshold) {
+  return GlobalSum(geometry.ice_thickness.grid()->com,
+                   ice_volume_not_displacing_seawater_local(geometry, thickness_threshold));
 }
 
 static double compute_area(const Grid &grid, std::function<bool(int, int)> condition) {
@@ -329,19 +371,25 @@ static double compute_area(const Grid &grid, std::function<bool(int, int)> condi
     }
   }
 
-  return GlobalSum(grid.com, area);
+  return area;
 }
 
-//! Computes ice area, in m^2.
-double ice_area(const Geometry &geometry, double thickness_threshold) {
+//! Computes the contribution of the current sub-domain to the ice area, in m^2.
+double ice_area_local(const Geometry &geometry, double thickness_threshold) {
   array::AccessScope list{ &geometry.ice_thickness };
   return compute_area(*geometry.ice_thickness.grid(), [&](int i, int j) {
     return geometry.ice_thickness(i, j) >= thickness_threshold;
   });
 }
 
-//! Computes grounded ice area, in m^2.
-double ice_area_grounded(const Geometry &geometry, double thickness_threshold) {
+//! Computes ice area, in m^2.
+double ice_area(const Geometry &geometry, double thickness_threshold) {
+  return GlobalSum(geometry.ice_thickness.grid()->com,
+                   ice_area_local(geometry, thickness_threshold));
+}
+
+//! Computes the contribution of the current sub-domain to the grounded ice area, in m^2.
+double ice_area_grounded_local(const Geometry &geometry, double thickness_threshold) {
   array::AccessScope list{ &geometry.cell_type, &geometry.ice_thickness };
   return compute_area(*geometry.ice_thickness.grid(), [&](int i, int j) {
     return (geometry.cell_type.grounded(i, j) and
@@ -349,17 +397,28 @@ double ice_area_grounded(const Geometry &geometry, double thickness_threshold) {
   });
 }
 
-//! Computes floating ice area, in m^2.
-double ice_area_floating(const Geometry &geometry, double thickness_threshold) {
+//! Computes grounded ice area, in m^2.
+double ice_area_grounded(const Geometry &geometry, double thickness_threshold) {
+  return GlobalSum(geometry.ice_thickness.grid()->com,
+                   ice_area_grounded_local(geometry, thickness_threshold));
+}
+
+//! Computes the contribution of the current sub-domain to the floating ice area, in m^2.
+double ice_area_floating_local(const Geometry &geometry, double thickness_threshold) {
   array::AccessScope list{ &geometry.cell_type, &geometry.ice_thickness };
   return compute_area(*geometry.ice_thickness.grid(), [&](int i, int j) {
     return (geometry.cell_type.ocean(i, j) and geometry.ice_thickness(i, j) >= thickness_threshold);
   });
 }
 
+//! Computes floating ice area, in m^2.
+double ice_area_floating(const Geometry &geometry, double thickness_threshold) {
+  return GlobalSum(geometry.ice_thickness.grid()->com,
+                   ice_area_floating_local(geometry, thickness_threshold));
+}
 
-//! Computes the sea level rise that would result if all the ice were melted.
-double sea_level_rise_potential(const Geometry &geometry, double thickness_threshold) {
+//! Computes the contribution of the current sub-domain to the sea level rise potential.
+double sea_level_rise_potential_local(const Geometry &geometry, double thickness_threshold) {
   auto config = geometry.ice_thickness.grid()->ctx()->config();
 
   const double
@@ -368,14 +427,20 @@ double sea_level_rise_potential(const Geometry &geometry, double thickness_thres
     ocean_area    = config->get_number("constants.global_ocean_area");
 
   const double
-    volume                  = ice_volume_not_displacing_seawater(geometry,
-                                                                 thickness_threshold),
+    volume                  = ice_volume_not_displacing_seawater_local(geometry,
+                                                                       thickness_threshold),
     additional_water_volume = (ice_density / water_density) * volume,
     sea_level_change        = additional_water_volume / ocean_area;
 
   return sea_level_change;
 }
 
+//! Computes the sea level rise that would result if all the ice were melted.
+double sea_level_rise_potential(const Geometry &geometry, double thickness_threshold) {
+  return GlobalSum(geometry.ice_thickness.grid()->com,
+                   sea_level_rise_potential_local(geometry, thickness_threshold));
+}
+
 
 /*!
  * @brief Set no_model_mask variable to have value 1 in strip of width 'strip' m around
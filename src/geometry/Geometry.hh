@@ -1,4 +1,4 @@
-/* Copyright (C) 2016, 2017, 2018, 2019, 2020, 2021, 2022 PISM Authors
+/* Copyright (C) 2016, 2017, 2018, 2019, 2020, 2021, 2022, 2024 PISM Authors
  *
  * This file is part of PISM.
  *
@@ -20,12 +20,75 @@
 #ifndef GEOMETRY_H
 #define GEOMETRY_H
 
+#include <cassert>
+#include <vector>
+
 #include "pism/util/array/CellType.hh"
 
 namespace pism {
 
 class Grid;
 
+/*!
+ * Compacted lists of indexes of "active" and "inactive" columns in the sub-domain owned by
+ * the current rank.
+ *
+ * A column is *active* if it or one of its four direct neighbors contains ice (ice
+ * thickness is positive). Inactive columns contain no ice and cannot receive ice from
+ * neighbors, so column physics can replace the full computation there with a (cheap)
+ * fill.
+ *
+ * Usage:
+ *
+ * `for (auto p = columns.active(); p; p.next()) { int i = p.i(), j = p.j(); ... }`
+ */
+class ActiveColumns {
+public:
+  //! Iterator traversing a list of columns (see Points).
+  class Iterator {
+  public:
+    Iterator(const std::vector<int> &indexes) : m_indexes(indexes), m_n(0) {
+    }
+
+    int i() const {
+      return m_indexes[m_n];
+    }
+    int j() const {
+      return m_indexes[m_n + 1];
+    }
+
+    void next() {
+      assert(m_n < m_indexes.size());
+      m_n += 2;
+    }
+
+    operator bool() const {
+      return m_n < m_indexes.size();
+    }
+  private:
+    const std::vector<int> &m_indexes;
+    size_t m_n;
+  };
+
+  void update(const array::Scalar &ice_thickness);
+
+  Iterator active() const {
+    return { m_active };
+  }
+  Iterator inactive() const {
+    return { m_inactive };
+  }
+
+  //! Number of active columns in this sub-domain
+  int n_active() const {
+    return static_cast<int>(m_active.size() / 2);
+  }
+private:
+  // (i, j) pairs, stored in the order of grid traversal
+  std::vector<int> m_active;
+  std::vector<int> m_inactive;
+};
+
 class Geometry {
 public:
   Geometry(const std::shared_ptr<const Grid> &grid);
@@ -56,6 +119,9 @@ public:
   array::Scalar cell_grounded_fraction;
   array::Scalar2 ice_surface_elevation;
 
+  // columns containing ice and their neighbors; re-computed by ensure_consistency()
+  ActiveColumns active_columns;
+
   void dump(const char *filename) const;
 };
 
@@ -69,6 +135,16 @@ double ice_volume_not_displacing_seawater(const Geometry &geometry,
                                           double thickness_threshold);
 double sea_level_rise_potential(const Geometry &geometry, double thickness_threshold);
 
+// Contributions of the current sub-domain to the quantities above. These do not
+// communicate: use GlobalSum() or GlobalReduction to combine them.
+double ice_volume_local(const Geometry &geometry, double thickness_threshold);
+double ice_area_floating_local(const Geometry &geometry, double thickness_threshold);
+double ice_area_grounded_local(const Geometry &geometry, double thickness_threshold);
+double ice_area_local(const Geometry &geometry, double thickness_threshold);
+double ice_volume_not_displacing_seawater_local(const Geometry &geometry,
+                                                double thickness_threshold);
+double sea_level_rise_potential_local(const Geometry &geometry, double thickness_threshold);
+
 void set_no_model_strip(const Grid &grid, double width, array::Scalar &result);
 
 } // end of namespace pism
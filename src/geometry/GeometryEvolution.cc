@@ -34,6 +34,7 @@
 #include "pism/util/pism_utilities.hh"
 
 #include "pism/geometry/flux_limiter.hh"
+#include "pism/util/array/GhostExchange.hh"
 
 namespace pism {
 
@@ -89,6 +90,9 @@ struct GeometryEvolution::Impl {
   array::CellType1 cell_type;          // updated to maintain consistency
   array::Scalar1 residual;             // temporary storage
   array::Scalar1 thickness;            // temporary storage
+
+  //! Updates ghosts of copies of input fields
+  array::GhostExchange input_ghosts;
 };
 
 GeometryEvolution::Impl::Impl(std::shared_ptr<const Grid> grid)
@@ -108,7 +112,9 @@ GeometryEvolution::Impl::Impl(std::shared_ptr<const Grid> grid)
       surface_elevation(grid, "surface_elevation"),
       cell_type(grid, "cell_type"),
       residual(grid, "residual"),
-      thickness(grid, "thickness") {
+      thickness(grid, "thickness"),
+      input_ghosts{ &ice_thickness, &area_specific_volume, &sea_level, &bed_elevation,
+                    &input_velocity } {
 
   Config::ConstPtr config = grid->ctx()->config();
 
@@ -254,12 +260,14 @@ void GeometryEvolution::flow_step(const Geometry &geometry, double dt,
 
   profiling().begin("ge.update_ghosted_copies");
   {
-    // make ghosted copies of input fields
-    m_impl->ice_thickness.copy_from(geometry.ice_thickness);
-    m_impl->area_specific_volume.copy_from(geometry.ice_area_specific_volume);
-    m_impl->sea_level.copy_from(geometry.sea_level_elevation);
-    m_impl->bed_elevation.copy_from(geometry.bed_elevation);
-    m_impl->input_velocity.copy_from(advective_velocity);
+    // make ghosted copies of input fields (updating all ghosts at once)
+    const bool scatter = false;
+    m_impl->ice_thickness.copy_from(geometry.ice_thickness, scatter);
+    m_impl->area_specific_volume.copy_from(geometry.ice_area_specific_volume, scatter);
+    m_impl->sea_level.copy_from(geometry.sea_level_elevation, scatter);
+    m_impl->bed_elevation.copy_from(geometry.bed_elevation, scatter);
+    m_impl->input_velocity.copy_from(advective_velocity, scatter);
+    m_impl->input_ghosts.update();
 
     // Compute cell_type and surface_elevation. Ghosts of results are updated.
     m_impl->gc.compute(m_impl->sea_level,          // in (uses ghosts)
@@ -279,8 +287,6 @@ void GeometryEvolution::flow_step(const Geometry &geometry, double dt,
                            m_impl->flux_staggered); // out
   profiling().end("ge.interface_fluxes");
 
-  m_impl->flux_staggered.update_ghosts();
-
   {
     // allocate temporary storage (FIXME: at some point I should evaluate whether it's OK
     // to allocate this every time step)
@@ -288,7 +294,7 @@ void GeometryEvolution::flow_step(const Geometry &geometry, double dt,
 
     make_nonnegative_preserving(dt,
                                 m_impl->ice_thickness,  // in (uses ghosts)
-                                m_impl->flux_staggered, // in (uses ghosts)
+                                m_impl->flux_staggered, // in (ghosts are updated)
                                 flux_limited);
 
     m_impl->flux_staggered.copy_from(flux_limited);
@@ -1299,6 +1305,12 @@ void ice_flow_rate_across_grounding_line(const array::CellType1 &cell_type,
 double total_grounding_line_flux(const array::CellType1 &cell_type,
                                  const array::Staggered1 &flux,
                                  double dt) {
+  return GlobalSum(cell_type.grid()->com, total_grounding_line_flux_local(cell_type, flux, dt));
+}
+
+double total_grounding_line_flux_local(const array::CellType1 &cell_type,
+                                       const array::Staggered1 &flux,
+                                       double dt) {
   auto grid = cell_type.grid();
 
   const double
@@ -1334,7 +1346,7 @@ double total_grounding_line_flux(const array::CellType1 &cell_type,
   }
   loop.check();
 
-  return GlobalSum(grid->com, total_flux);
+  return total_flux;
 }
 
 } // end of namespace pism
@@ -174,6 +174,13 @@ void ice_flow_rate_across_grounding_line(const array::CellType1 &cell_type,
 double total_grounding_line_flux(const array::CellType1 &cell_type,
                                  const array::Staggered1 &flux,
                                  double dt);
+
+/*!
+ * Compute the contribution of the current sub-domain to the total grounding line flux.
+ */
+double total_grounding_line_flux_local(const array::CellType1 &cell_type,
+                                       const array::Staggered1 &flux,
+                                       double dt);
 } // end of namespace pism
 
 #endif /* GEOMETRYEVOLUTION_H */
@@ -314,12 +314,13 @@ void UNO::update(double dt,
 
   compute_interface_fluxes(cell_type, m_v_ghosted, m_x_ghosted, dt, m_q);
 
-  m_q.update_ghosts();
-
   // limit fluxes to preserve non-negativity
   if (nonnegative) {
+    // updates ghosts of m_q
     make_nonnegative_preserving(dt, m_x_ghosted, m_q, m_q_limited);
     m_q.copy_from(m_q_limited);
+  } else {
+    m_q.update_ghosts();
   }
 
   step(dt, m_q, x, m_x);
@@ -71,10 +71,11 @@ static inline double flux_out(const stencils::Star<double> &u, double dx, double
  * "regular" flux instead of the "anti-diffusive" flux and with a different limiting
  * criterion (non-negativity instead of monotonicity).
  *
+ * Updates ghosts of `flux` (they don't have to be up to date on input).
  */
 void make_nonnegative_preserving(double dt,
                                  const array::Scalar1 &x,
-                                 const array::Staggered1 &flux,
+                                 array::Staggered1 &flux,
                                  array::Staggered &result) {
 
   using details::pp;
@@ -97,9 +98,7 @@ void make_nonnegative_preserving(double dt,
 
   int limiter_count = 0;
 
-  for (auto p = grid->points(); p; p.next()) {
-    const int i = p.i(), j = p.j();
-
+  auto limit = [&](int i, int j) {
     auto Q   = flux.star(i, j);
     auto Q_n = flux.star(i, j + 1);
     auto Q_e = flux.star(i + 1, j);
@@ -119,7 +118,7 @@ void make_nonnegative_preserving(double dt,
       // areas where mass conservation is not an issue.
       result(i, j, 0) = Q.e;
       result(i, j, 1) = Q.n;
-      continue;
+      return;
     }
 
     limiter_count += 1;
@@ -170,6 +169,18 @@ void make_nonnegative_preserving(double dt,
     // convert back to fluxes:
     result(i, j, 0) = F_e_limited * dx / dt;
     result(i, j, 1) = F_n_limited * dy / dt;
+  };
+
+  // Ghosts of `flux` are used at points near sub-domain boundaries only: process
+  // interior points while they are being communicated.
+  flux.update_ghosts_begin();
+  for (auto p = grid->points_interior(1); p; p.next()) {
+    limit(p.i(), p.j());
+  }
+  flux.update_ghosts_end();
+
+  for (auto p = grid->points_boundary(1); p; p.next()) {
+    limit(p.i(), p.j());
   }
 
   limiter_count = GlobalSum(grid->com, limiter_count);
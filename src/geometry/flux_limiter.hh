@@ -27,10 +27,11 @@ class Staggered1;
 
 /*! Limit fluxes to preserve non-negativity of a transported quantity.
  *
+ * Updates ghosts of `flux`.
  */
 void make_nonnegative_preserving(double dt,
                                  const array::Scalar1 &x,
-                                 const array::Staggered1 &flux,
+                                 array::Staggered1 &flux,
                                  array::Staggered &result);
 
 } // end of namespace pism
@@ -353,7 +353,13 @@ void Distributed::update_impl(double t, double dt, const Inputs& inputs) {
     // to get Q, W needs valid ghosts
     advective_fluxes(m_Vstag, m_W, m_Qstag);
 
-    m_Qstag_average.add(hdt, m_Qstag);
+    // Ghosts of m_Wstag, m_Kstag, m_Qstag are not needed until update_P() below:
+    // communicate them (in one message per neighbor) while computing the time step length
+    // and updating the till water thickness.
+    m_staggered_ghosts.begin();
+
+    // length of the previous hydrology time step (used to accumulate the flux)
+    const double hdt_previous = hdt;
 
     {
       const double
@@ -386,6 +392,10 @@ void Distributed::update_impl(double t, double dt, const Inputs& inputs) {
                    m_conservation_error_change,
                    m_no_model_mask_change);
 
+    m_staggered_ghosts.end();
+
+    m_Qstag_average.add(hdt_previous, m_Qstag);
+
     update_P(hdt,
              inputs.geometry->cell_type,
              *inputs.ice_sliding_speed,
@@ -250,6 +250,7 @@ Routing::Routing(std::shared_ptr<const Grid> grid)
     m_Vstag(grid, "water_velocity"),
     m_Wstag(grid, "W_staggered"),
     m_Kstag(grid, "K_staggered"),
+    m_staggered_ghosts{ &m_Wstag, &m_Kstag, &m_Qstag },
     m_Wnew(grid, "W_new"),
     m_Wtillnew(grid, "Wtill_new"),
     m_R(grid, "potential_workspace"), /* box stencil used */
@@ -373,7 +374,9 @@ const array::Staggered& Routing::velocity_staggered() const {
 
 //! Average the regular grid water thickness to values at the center of cell edges.
 /*! Uses mask values to avoid averaging using water thickness values from
-  either ice-free or floating areas. */
+  either ice-free or floating areas.
+
+  Ghosts of the result are *not* updated. */
 void Routing::water_thickness_staggered(const array::Scalar &W,
                                         const array::CellType1 &mask,
                                         array::Staggered &result) {
@@ -413,8 +416,6 @@ void Routing::water_thickness_staggered(const array::Scalar &W,
       }
     }
   }
-
-  result.update_ghosts();
 }
 
 
@@ -432,6 +433,8 @@ void Routing::water_thickness_staggered(const array::Scalar &W,
   scheme. This requires \f$R\f$ to be defined on a box stencil of width 1.
 
   Also returns the maximum over all staggered points of \f$ K W \f$.
+
+  Uses values of `W` at owned points only. Ghosts of the result are *not* updated.
 */
 void Routing::compute_conductivity(const array::Staggered &W,
                                    const array::Scalar &P,
@@ -506,8 +509,6 @@ void Routing::compute_conductivity(const array::Staggered &W,
   }
 
   KW_max = GlobalMax(m_grid->com, KW_max);
-
-  result.update_ghosts();
 }
 
 
@@ -665,6 +666,9 @@ void Routing::compute_velocity(const array::Staggered &W,
 /*!
   The field W must have valid ghost values, but V does not need them.
 
+  Ghosts of the result are *not* updated. This allows the caller to overlap the ghost
+  update with computations that do not need them (see update_ghosts_begin()).
+
   FIXME:  This could be re-implemented using the Koren (1993) flux-limiter.
 */
 void Routing::advective_fluxes(const array::Staggered &V,
@@ -680,8 +684,6 @@ void Routing::advective_fluxes(const array::Staggered &V,
     result(i, j, 0) = V(i, j, 0) * (V(i, j, 0) >= 0.0 ? W(i, j) :  W(i + 1, j));
     result(i, j, 1) = V(i, j, 1) * (V(i, j, 1) >= 0.0 ? W(i, j) :  W(i, j + 1));
   }
-
-  result.update_ghosts();
 }
 
 /*!
@@ -860,13 +862,13 @@ void Routing::update_impl(double t, double dt, const Inputs& inputs) {
     check_bounds(m_Wtill, tillwat_max);
 #endif
 
-    // updates ghosts of m_Wstag
+    // ghosts of m_Wstag are not updated
     water_thickness_staggered(m_W,
                               inputs.geometry->cell_type,
                               m_Wstag);
 
     double maxKW = 0.0;
-    // updates ghosts of m_Kstag
+    // ghosts of m_Kstag are not updated
     profiling().begin("routing_conductivity");
     compute_conductivity(m_Wstag,
                          subglacial_water_pressure(),
@@ -885,12 +887,17 @@ void Routing::update_impl(double t, double dt, const Inputs& inputs) {
     profiling().end("routing_velocity");
 
     // to get Q, W needs valid ghosts (ghosts of m_Vstag are not used)
-    // updates ghosts of m_Qstag
     profiling().begin("routing_flux");
     advective_fluxes(m_Vstag, m_W, m_Qstag);
     profiling().end("routing_flux");
 
-    m_Qstag_average.add(hdt, m_Qstag);
+    // Ghosts of m_Wstag, m_Kstag, m_Qstag are not needed until update_W() below:
+    // communicate them (in one message per neighbor) while computing the time step length
+    // and updating the till water thickness.
+    m_staggered_ghosts.begin();
+
+    // length of the previous hydrology time step (used to accumulate the flux)
+    const double hdt_previous = hdt;
 
     {
       const double
@@ -925,6 +932,10 @@ void Routing::update_impl(double t, double dt, const Inputs& inputs) {
       profiling().end("routing_Wtill");
     }
 
+    m_staggered_ghosts.end();
+
+    m_Qstag_average.add(hdt_previous, m_Qstag);
+
     // update Wnew from W, Wtill, Wtillnew, Wstag, Q, input_rate
     // uses ghosts of m_W, m_Wstag, m_Qstag, m_Kstag
     {
@@ -20,6 +20,7 @@
 #define _ROUTING_H_
 
 #include "pism/hydrology/Hydrology.hh"
+#include "pism/util/array/GhostExchange.hh"
 #include "pism/util/array/Staggered.hh"
 
 namespace pism {
@@ -123,6 +124,9 @@ protected:
   // edge-centered (staggered) values of nonlinear conductivity
   array::Staggered1 m_Kstag;
 
+  // updates ghosts of m_Wstag, m_Kstag, and m_Qstag
+  array::GhostExchange m_staggered_ghosts;
+
   // work space
   array::Scalar m_Wnew, m_Wtillnew;
 
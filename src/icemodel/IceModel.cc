@@ -46,6 +46,7 @@
 #include "pism/age/Isochrones.hh"
 #include "pism/energy/EnergyModel.hh"
 #include "pism/util/io/File.hh"
+#include "pism/util/io/BackgroundWriter.hh"
 #include "pism/util/array/Forcing.hh"
 #include "pism/fracturedensity/FractureDensity.hh"
 #include "pism/coupler/util/options.hh" // ForcingOptions
@@ -617,7 +618,7 @@ void IceModel::step(bool do_mass_continuity,
     m_isochrones->update(current_time, m_dt,
                          m_stress_balance->velocity_u(),
                          m_stress_balance->velocity_v(),
-                         m_geometry.ice_thickness,
+                         m_geometry,
                          m_geometry_evolution->top_surface_mass_balance(),
                          m_geometry_evolution->bottom_surface_mass_balance());
   }
@@ -769,9 +770,7 @@ IceModelTerminationReason IceModel::run() {
   // This is needed to compute rates of change of the ice mass, volume, etc.
   {
     const double time = m_time->current();
-    for (const auto &d : m_ts_diagnostics) {
-      d.second->update(time, time);
-    }
+    update_timeseries(m_grid->com, m_ts_diagnostics, time, time);
   }
 
   m_log->message(2, "running forward ...\n");
@@ -784,6 +783,7 @@ IceModelTerminationReason IceModel::run() {
   dt_TempAge = 0.0;
 
   IceModelTerminationReason termination_reason = PISM_DONE;
+  bool do_imbalance_report = m_config->get_flag("output.profiling.load_imbalance");
   // main loop for time evolution
   // IceModel::step calls Time::step(dt), ensuring that this while loop
   // will terminate
@@ -792,7 +792,14 @@ IceModelTerminationReason IceModel::run() {
 
     m_stdout_flags.erase();  // clear it out
 
-    step(do_mass_conserve, do_skip);
+    {
+      Profiling::Scope scope(profiling, "step");
+      step(do_mass_conserve, do_skip);
+    }
+
+    if (do_imbalance_report) {
+      report_load_imbalance(false);
+    }
 
     update_diagnostics(m_dt);
 
@@ -826,6 +833,21 @@ IceModelTerminationReason IceModel::run() {
   } // end of the time-stepping loop
   profiling.stage_end("time-stepping loop");
 
+  if (m_background_writer) {
+    // make sure that checkpoints and snapshots are on disk before we return
+    m_background_writer->wait();
+  }
+
+  if (do_imbalance_report) {
+    report_load_imbalance(true);
+  }
+
+  auto summary_file = m_config->get_string("output.profiling.file");
+  if (not summary_file.empty()) {
+    m_log->message(2, "saving the profiling summary to '%s'...\n", summary_file.c_str());
+    profiling.save_summary(m_grid->com, summary_file);
+  }
+
   return termination_reason;
 }
 
@@ -1033,9 +1055,7 @@ void IceModel::update_diagnostics(double dt) {
   }
 
   const double time = m_time->current();
-  for (const auto &d : m_ts_diagnostics) {
-    d.second->update(time - dt, time);
-  }
+  update_timeseries(m_grid->com, m_ts_diagnostics, time - dt, time);
 }
 
 /*!
@@ -98,6 +98,11 @@ namespace bed {
 class BedDef;
 }
 
+namespace io {
+class BackgroundWriter;
+class IOServer;
+}
+
 namespace array {
 class Forcing;
 class CellType;
@@ -137,6 +142,8 @@ public:
 
   void list_diagnostics(const std::string &list_type) const;
 
+  void set_io_server(std::shared_ptr<io::IOServer> server);
+
   const array::Scalar &calving() const;
   const array::Scalar &frontal_melt() const;
   const array::Scalar &forced_retreat() const;
@@ -381,6 +388,11 @@ protected:
                                   double delta_t,
                                   double volume, double area,
                                   double meltfrac, double max_diffusivity);
+  virtual void report_load_imbalance(bool final_report);
+  //! wall-clock times of phases of a time step on this rank (used to compute increments)
+  std::map<std::string, double> m_phase_times;
+  //! accumulated maximum and average (across ranks) times of phases of a time step
+  std::map<std::string, std::pair<double, double> > m_phase_imbalance;
 
 
   // see iMutil.cc
@@ -449,6 +461,8 @@ protected:
   double m_last_extra;
   std::set<std::string> m_extra_vars;
   std::unique_ptr<File> m_extra_file;
+  //! I/O server ranks writing m_extra_file (if any)
+  std::shared_ptr<io::IOServer> m_io_server;
   void init_extras();
   void write_extras();
   MaxTimestep extras_max_timestep(double my_t);
@@ -460,6 +474,9 @@ protected:
   void init_checkpoints();
   bool write_checkpoint();
 
+  //! writes checkpoints and split snapshots in the background (if enabled)
+  std::shared_ptr<io::BackgroundWriter> m_background_writer;
+
   // last time at which PISM hit a multiple of X years, see the configuration parameter
   // time_stepping.hit_multiples
   double m_timestep_hit_multiples_last_time;
@@ -622,6 +622,7 @@ namespace pism {
 namespace details {
 enum IceKind {ICE_COLD, ICE_TEMPERATE};
 
+//! Computes the contribution of the current sub-domain to the volume of cold or temperate ice.
 static double ice_volume(const array::Scalar &ice_thickness,
                          const array::Array3D &ice_enthalpy,
                          IceKind kind,
@@ -683,9 +684,10 @@ static double ice_volume(const array::Scalar &ice_thickness,
   }
   loop.check();
 
-  return GlobalSum(grid->com, volume);
+  return volume;
 }
 
+//! Computes the contribution of the current sub-domain to the cold or temperate base area.
 static double base_area(const array::Scalar &ice_thickness,
                         const array::Array3D &ice_enthalpy,
                         IceKind kind,
@@ -728,7 +730,7 @@ static double base_area(const array::Scalar &ice_thickness,
   }
   loop.check();
 
-  return GlobalSum(grid->com, area);
+  return area;
 }
 
 } // end of namespace details
@@ -1607,9 +1609,10 @@ public:
     m_variable["long_name"] = "volume of the ice in glacierized areas";
     m_variable["valid_min"] = { 0.0 };
   }
-  double compute() {
-    return ice_volume(model->geometry(),
-                      m_config->get_number("output.ice_free_thickness_standard"));
+  bool compute_local_impl(double &result) {
+    result = ice_volume_local(model->geometry(),
+                              m_config->get_number("output.ice_free_thickness_standard"));
+    return true;
   }
 };
 
@@ -1623,8 +1626,9 @@ public:
     m_variable["valid_min"] = { 0.0 };
   }
 
-  double compute() {
-    return ice_volume(model->geometry(), 0.0);
+  bool compute_local_impl(double &result) {
+    result = ice_volume_local(model->geometry(), 0.0);
+    return true;
   }
 };
 
@@ -1639,9 +1643,10 @@ public:
     m_variable["valid_min"] = { 0.0 };
   }
 
-  double compute() {
-    return sea_level_rise_potential(model->geometry(),
-                                    m_config->get_number("output.ice_free_thickness_standard"));
+  bool compute_local_impl(double &result) {
+    result = sea_level_rise_potential_local(
+        model->geometry(), m_config->get_number("output.ice_free_thickness_standard"));
+    return true;
   }
 };
 
@@ -1655,9 +1660,10 @@ public:
     m_variable["long_name"] = "rate of change of the ice volume in glacierized areas";
   }
 
-  double compute() {
-    return ice_volume(model->geometry(),
-                      m_config->get_number("output.ice_free_thickness_standard"));
+  bool compute_local_impl(double &result) {
+    result = ice_volume_local(model->geometry(),
+                              m_config->get_number("output.ice_free_thickness_standard"));
+    return true;
   }
 };
 
@@ -1671,8 +1677,9 @@ public:
     m_variable["long_name"] = "rate of change of the ice volume, including seasonal cover";
   }
 
-  double compute() {
-    return ice_volume(model->geometry(), 0.0);
+  bool compute_local_impl(double &result) {
+    result = ice_volume_local(model->geometry(), 0.0);
+    return true;
   }
 };
 
@@ -1687,8 +1694,10 @@ public:
     m_variable["valid_min"] = { 0.0 };
   }
 
-  double compute() {
-    return ice_area(model->geometry(), m_config->get_number("output.ice_free_thickness_standard"));
+  bool compute_local_impl(double &result) {
+    result = ice_area_local(model->geometry(),
+                            m_config->get_number("output.ice_free_thickness_standard"));
+    return true;
   }
 };
 
@@ -1704,15 +1713,16 @@ public:
     m_variable["valid_min"]     = { 0.0 };
   }
 
-  double compute() {
+  bool compute_local_impl(double &result) {
 
     const double thickness_standard = m_config->get_number("output.ice_free_thickness_standard"),
                  ice_density        = m_config->get_number("constants.ice.density"),
-                 ice_volume =
-                     ice_volume_not_displacing_seawater(model->geometry(), thickness_standard),
-                 ice_mass = ice_volume * ice_density;
+                 ice_volume         = ice_volume_not_displacing_seawater_local(model->geometry(),
+                                                                               thickness_standard),
+                 ice_mass           = ice_volume * ice_density;
 
-    return ice_mass;
+    result = ice_mass;
+    return true;
   }
 };
 
@@ -1727,10 +1737,11 @@ public:
     m_variable["valid_min"] = { 0.0 };
   }
 
-  double compute() {
+  bool compute_local_impl(double &result) {
     double ice_density        = m_config->get_number("constants.ice.density"),
            thickness_standard = m_config->get_number("output.ice_free_thickness_standard");
-    return ice_volume(model->geometry(), thickness_standard) * ice_density;
+    result = ice_volume_local(model->geometry(), thickness_standard) * ice_density;
+    return true;
   }
 };
 
@@ -1749,8 +1760,10 @@ public:
     m_variable["valid_min"]     = { 0.0 };
   }
 
-  double compute() {
-    return (ice_volume(model->geometry(), 0.0) * m_config->get_number("constants.ice.density"));
+  bool compute_local_impl(double &result) {
+    result = (ice_volume_local(model->geometry(), 0.0) *
+              m_config->get_number("constants.ice.density"));
+    return true;
   }
 };
 
@@ -1764,10 +1777,11 @@ public:
     m_variable["long_name"] = "rate of change of the ice mass in glacierized areas";
   }
 
-  double compute() {
+  bool compute_local_impl(double &result) {
     double ice_density         = m_config->get_number("constants.ice.density"),
            thickness_threshold = m_config->get_number("output.ice_free_thickness_standard");
-    return ice_volume(model->geometry(), thickness_threshold) * ice_density;
+    result = ice_volume_local(model->geometry(), thickness_threshold) * ice_density;
+    return true;
   }
 };
 
@@ -1786,7 +1800,7 @@ public:
                               " (i.e. prescribed ice thickness)";
   }
 
-  double compute() {
+  bool compute_local_impl(double &result) {
 
     const double ice_density = m_config->get_number("constants.ice.density");
 
@@ -1805,7 +1819,8 @@ public:
     }
 
     // (kg/m^3) * m^3 = kg
-    return ice_density * GlobalSum(m_grid->com, volume_change);
+    result = ice_density * volume_change;
+    return true;
   }
 };
 
@@ -1818,9 +1833,10 @@ public:
     m_variable["long_name"] = "rate of change of the mass of ice, including seasonal cover";
   }
 
-  double compute() {
+  bool compute_local_impl(double &result) {
     const double ice_density = m_config->get_number("constants.ice.density");
-    return ice_volume(model->geometry(), 0.0) * ice_density;
+    result = ice_volume_local(model->geometry(), 0.0) * ice_density;
+    return true;
   }
 };
 
@@ -1836,11 +1852,12 @@ public:
     m_variable["valid_min"] = { 0.0 };
   }
 
-  double compute() {
+  bool compute_local_impl(double &result) {
     auto thickness_threshold = m_config->get_number("output.ice_free_thickness_standard");
-    return details::ice_volume(model->geometry().ice_thickness,
-                               model->energy_balance_model()->enthalpy(), details::ICE_TEMPERATE,
-                               thickness_threshold);
+    result = details::ice_volume(model->geometry().ice_thickness,
+                                 model->energy_balance_model()->enthalpy(), details::ICE_TEMPERATE,
+                                 thickness_threshold);
+    return true;
   }
 };
 
@@ -1855,10 +1872,11 @@ public:
     m_variable["valid_min"] = { 0.0 };
   }
 
-  double compute() {
-    return details::ice_volume(model->geometry().ice_thickness,
-                               model->energy_balance_model()->enthalpy(), details::ICE_TEMPERATE,
-                               0.0);
+  bool compute_local_impl(double &result) {
+    result = details::ice_volume(model->geometry().ice_thickness,
+                                 model->energy_balance_model()->enthalpy(), details::ICE_TEMPERATE,
+                                 0.0);
+    return true;
   }
 };
 
@@ -1873,11 +1891,12 @@ public:
     m_variable["valid_min"] = { 0.0 };
   }
 
-  double compute() {
+  bool compute_local_impl(double &result) {
     auto thickness_threshold = m_config->get_number("output.ice_free_thickness_standard");
-    return details::ice_volume(model->geometry().ice_thickness,
-                               model->energy_balance_model()->enthalpy(), details::ICE_COLD,
-                               thickness_threshold);
+    result = details::ice_volume(model->geometry().ice_thickness,
+                                 model->energy_balance_model()->enthalpy(), details::ICE_COLD,
+                                 thickness_threshold);
+    return true;
   }
 };
 
@@ -1891,10 +1910,11 @@ public:
     m_variable["valid_min"] = { 0.0 };
   }
 
-  double compute() {
-    return details::ice_volume(model->geometry().ice_thickness,
-                               model->energy_balance_model()->enthalpy(), details::ICE_COLD,
-                               0.0);
+  bool compute_local_impl(double &result) {
+    result = details::ice_volume(model->geometry().ice_thickness,
+                                 model->energy_balance_model()->enthalpy(), details::ICE_COLD,
+                                 0.0);
+    return true;
   }
 };
 
@@ -1909,11 +1929,12 @@ public:
     m_variable["valid_min"] = { 0.0 };
   }
 
-  double compute() {
+  bool compute_local_impl(double &result) {
     auto thickness_threshold = m_config->get_number("output.ice_free_thickness_standard");
-    return details::base_area(model->geometry().ice_thickness,
-                              model->energy_balance_model()->enthalpy(), details::ICE_TEMPERATE,
-                              thickness_threshold);
+    result = details::base_area(model->geometry().ice_thickness,
+                                model->energy_balance_model()->enthalpy(), details::ICE_TEMPERATE,
+                                thickness_threshold);
+    return true;
   }
 };
 
@@ -1928,11 +1949,12 @@ public:
     m_variable["valid_min"] = { 0.0 };
   }
 
-  double compute() {
+  bool compute_local_impl(double &result) {
     auto thickness_threshold = m_config->get_number("output.ice_free_thickness_standard");
-    return details::base_area(model->geometry().ice_thickness,
-                              model->energy_balance_model()->enthalpy(), details::ICE_COLD,
-                              thickness_threshold);
+    result = details::base_area(model->geometry().ice_thickness,
+                                model->energy_balance_model()->enthalpy(), details::ICE_COLD,
+                                thickness_threshold);
+    return true;
   }
 };
 
@@ -1947,10 +1969,11 @@ public:
     m_variable["valid_min"] = { 0.0 };
   }
 
-  double compute() {
-    return energy::total_ice_enthalpy(m_config->get_number("output.ice_free_thickness_standard"),
-                                      model->energy_balance_model()->enthalpy(),
-                                      model->geometry().ice_thickness);
+  bool compute_local_impl(double &result) {
+    result = energy::total_ice_enthalpy_local(
+        m_config->get_number("output.ice_free_thickness_standard"),
+        model->energy_balance_model()->enthalpy(), model->geometry().ice_thickness);
+    return true;
   }
 };
 
@@ -1964,9 +1987,10 @@ public:
     m_variable["valid_min"] = { 0.0 };
   }
 
-  double compute() {
-    return energy::total_ice_enthalpy(0.0, model->energy_balance_model()->enthalpy(),
-                                      model->geometry().ice_thickness);
+  bool compute_local_impl(double &result) {
+    result = energy::total_ice_enthalpy_local(0.0, model->energy_balance_model()->enthalpy(),
+                                              model->geometry().ice_thickness);
+    return true;
   }
 };
 
@@ -1986,9 +2010,10 @@ public:
     m_variable["valid_min"]     = { 0.0 };
   }
 
-  double compute() {
-    return ice_area_grounded(model->geometry(),
-                             m_config->get_number("output.ice_free_thickness_standard"));
+  bool compute_local_impl(double &result) {
+    result = ice_area_grounded_local(model->geometry(),
+                                     m_config->get_number("output.ice_free_thickness_standard"));
+    return true;
   }
 };
 
@@ -2008,9 +2033,10 @@ public:
     m_variable["valid_min"]     = { 0.0 };
   }
 
-  double compute() {
-    return ice_area_floating(model->geometry(),
-                             m_config->get_number("output.ice_free_thickness_standard"));
+  bool compute_local_impl(double &result) {
+    result = ice_area_floating_local(model->geometry(),
+                                     m_config->get_number("output.ice_free_thickness_standard"));
+    return true;
   }
 };
 
@@ -2025,7 +2051,7 @@ public:
     m_variable["valid_min"] = { 0.0 };
   }
 
-  double compute() {
+  bool compute_local_impl(double &result) {
     const auto &cell_type = model->geometry().cell_type;
 
     const array::Scalar &ice_thickness = model->geometry().ice_thickness;
@@ -2046,7 +2072,8 @@ public:
       }
     }
 
-    return GlobalSum(m_grid->com, volume);
+    result = volume;
+    return true;
   }
 };
 
@@ -2061,7 +2088,7 @@ public:
     m_variable["valid_min"] = { 0.0 };
   }
 
-  double compute() {
+  bool compute_local_impl(double &result) {
     const auto &cell_type = model->geometry().cell_type;
 
     const array::Scalar &ice_thickness = model->geometry().ice_thickness;
@@ -2082,7 +2109,8 @@ public:
       }
     }
 
-    return GlobalSum(m_grid->com, volume);
+    result = volume;
+    return true;
   }
 };
 
@@ -2202,6 +2230,8 @@ public:
  * to the other does not change the mass in a cell. This explains the
  * special case used when `term == FLOW`. (Note that surface and basal
  * mass balances do not affect the area specific volume field.)
+ *
+ * Returns the contribution of the current sub-domain.
  */
 double mass_change(const IceModel *model, TermType term, AreaType area) {
   const Grid &grid     = *model->grid();
@@ -2256,7 +2286,7 @@ double mass_change(const IceModel *model, TermType term, AreaType area) {
   }
 
   // (kg / m^3) * m^3 = kg
-  return ice_density * GlobalSum(grid.com, volume_change);
+  return ice_density * volume_change;
 }
 
 //! \brief Reports the total bottom surface ice flux.
@@ -2275,8 +2305,9 @@ public:
     m_variable["comment"]       = "positive means ice gain";
   }
 
-  double compute() {
-    return mass_change(model, BMB, BOTH);
+  bool compute_local_impl(double &result) {
+    result = mass_change(model, BMB, BOTH);
+    return true;
   }
 };
 
@@ -2296,8 +2327,9 @@ public:
     m_variable["comment"]       = "positive means ice gain";
   }
 
-  double compute() {
-    return mass_change(model, SMB, BOTH);
+  bool compute_local_impl(double &result) {
+    result = mass_change(model, SMB, BOTH);
+    return true;
   }
 };
 
@@ -2313,8 +2345,9 @@ public:
     m_variable["comment"]       = "positive means ice gain";
   }
 
-  double compute() {
-    return mass_change(model, BMB, GROUNDED);
+  bool compute_local_impl(double &result) {
+    result = mass_change(model, BMB, GROUNDED);
+    return true;
   }
 };
 
@@ -2334,8 +2367,9 @@ public:
     m_variable["comment"]       = "positive means ice gain";
   }
 
-  double compute() {
-    return mass_change(model, BMB, SHELF);
+  bool compute_local_impl(double &result) {
+    result = mass_change(model, BMB, SHELF);
+    return true;
   }
 };
 
@@ -2352,8 +2386,9 @@ public:
     m_variable["comment"]   = "positive means ice gain";
   }
 
-  double compute() {
-    return mass_change(model, ERROR, BOTH);
+  bool compute_local_impl(double &result) {
+    result = mass_change(model, ERROR, BOTH);
+    return true;
   }
 };
 
@@ -2373,7 +2408,7 @@ public:
     m_variable["comment"]       = "positive means ice gain";
   }
 
-  double compute() {
+  bool compute_local_impl(double &result) {
     const double ice_density = m_config->get_number("constants.ice.density");
 
     const array::Scalar &calving        = model->calving();
@@ -2393,7 +2428,8 @@ public:
     }
 
     // (kg/m^3) * m^3 = kg
-    return ice_density * GlobalSum(m_grid->com, volume_change);
+    result = ice_density * volume_change;
+    return true;
   }
 };
 
@@ -2413,7 +2449,7 @@ public:
     m_variable["comment"]       = "positive means ice gain";
   }
 
-  double compute() {
+  bool compute_local_impl(double &result) {
     const double ice_density = m_config->get_number("constants.ice.density");
 
     const array::Scalar &calving = model->calving();
@@ -2431,7 +2467,8 @@ public:
     }
 
     // (kg/m^3) * m^3 = kg
-    return ice_density * GlobalSum(m_grid->com, volume_change);
+    result = ice_density * volume_change;
+    return true;
   }
 };
 
@@ -2451,9 +2488,11 @@ public:
     m_variable["comment"]   = "negative flux corresponds to ice loss into the ocean";
   }
 
-  double compute() {
-    return total_grounding_line_flux(model->geometry().cell_type,
-                                     model->geometry_evolution().flux_staggered(), model->dt());
+  bool compute_local_impl(double &result) {
+    result = total_grounding_line_flux_local(model->geometry().cell_type,
+                                             model->geometry_evolution().flux_staggered(),
+                                             model->dt());
+    return true;
   }
 };
 
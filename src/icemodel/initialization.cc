@@ -40,6 +40,7 @@
 #include "pism/util/Time.hh"
 #include "pism/util/error_handling.hh"
 #include "pism/util/io/File.hh"
+#include "pism/util/io/BackgroundWriter.hh"
 #include "pism/coupler/OceanModel.hh"
 #include "pism/coupler/SurfaceModel.hh"
 #include "pism/coupler/atmosphere/Factory.hh"
@@ -797,6 +798,15 @@ void IceModel::misc_setup() {
   init_frontal_melt();
   init_front_retreat();
   init_diagnostics();
+
+  if (m_config->get_flag("output.background_writes")) {
+    if (string_to_backend(m_config->get_string("output.format")) != io::PISM_NETCDF3) {
+      throw RuntimeError(PISM_ERROR_LOCATION,
+                         "output.background_writes requires output.format = netcdf3");
+    }
+    m_background_writer = std::make_shared<io::BackgroundWriter>(m_grid->com);
+  }
+
   init_snapshots();
   init_checkpoints();
   init_timeseries();
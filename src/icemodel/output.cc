@@ -157,6 +157,9 @@ void IceModel::save_variables(const File &file,
   // supports it.
   file.set_compression_level(m_config->get_number("output.compression_level"));
 
+  // Aggregate data written by the serial NetCDF backends (no-op for parallel backends).
+  file.set_aggregator_count(m_config->get_number("output.aggregators"));
+
   // define the time dimension if necessary (no-op if it is already defined)
   io::define_time(file, *m_grid->ctx());
 
@@ -71,15 +71,22 @@ bool IceModel::write_checkpoint() {
   {
     // Note: we open a new file every time we write a checkpoint, moving the old file
     // aside if it exists.
-    File file(m_grid->com,
-              m_checkpoint_filename,
-              string_to_backend(m_config->get_string("output.format")),
-              io::PISM_READWRITE_MOVE);
+    std::unique_ptr<File> file;
+    if (m_background_writer) {
+      // build the file in memory and write it to disk in the background
+      file.reset(new File(m_grid->com, m_checkpoint_filename, m_background_writer,
+                          io::PISM_READWRITE_MOVE));
+    } else {
+      file.reset(new File(m_grid->com,
+                          m_checkpoint_filename,
+                          string_to_backend(m_config->get_string("output.format")),
+                          io::PISM_READWRITE_MOVE));
+    }
 
-    write_metadata(file, WRITE_MAPPING, PREPEND_HISTORY);
-    write_run_stats(file, run_stats());
+    write_metadata(*file, WRITE_MAPPING, PREPEND_HISTORY);
+    write_run_stats(*file, run_stats());
 
-    save_variables(file, INCLUDE_MODEL_STATE, m_checkpoint_vars, m_time->current());
+    save_variables(*file, INCLUDE_MODEL_STATE, m_checkpoint_vars, m_time->current());
   }
   profiling.end("io.checkpoint");
   double checkpoint_end_time = get_time(m_grid->com);
@@ -88,8 +95,9 @@ bool IceModel::write_checkpoint() {
   flush_timeseries();
 
   m_log->message(2,
-                 "  [%s] Done saving a checkpoint in %f seconds (%f minutes).\n",
+                 "  [%s] Done %s a checkpoint in %f seconds (%f minutes).\n",
                  timestamp(m_grid->com).c_str(),
+                 m_background_writer ? "preparing" : "saving",
                  checkpoint_end_time - checkpoint_start_time,
                  (checkpoint_end_time - checkpoint_start_time) / 60.0);
 
@@ -21,6 +21,7 @@
 
 #include "pism/util/pism_utilities.hh"
 #include "pism/util/Profiling.hh"
+#include "pism/util/io/IOServer.hh"
 
 namespace pism {
 
@@ -106,6 +107,15 @@ static std::set<std::string> process_extra_shortcuts(const Config &config,
   return result;
 }
 
+/*!
+ * Use I/O server ranks to write the -extra_file.
+ *
+ * Has to be called before init().
+ */
+void IceModel::set_io_server(std::shared_ptr<io::IOServer> server) {
+  m_io_server = server;
+}
+
 //! Initialize the code saving spatially-variable diagnostic quantities.
 void IceModel::init_extras() {
 
@@ -308,8 +318,13 @@ void IceModel::write_extras() {
         filename = pism::printf("%s_%s.nc", m_extra_filename.c_str(), date_without_spaces.c_str());
       }
 
-      m_extra_file.reset(new File(m_grid->com, filename,
-                                  string_to_backend(m_config->get_string("output.format")), mode));
+      auto backend = string_to_backend(m_config->get_string("output.format"));
+      if (m_io_server) {
+        // forward all I/O to server ranks to avoid waiting for the file system
+        m_extra_file.reset(new File(m_grid->com, filename, m_io_server->create_file(backend), mode));
+      } else {
+        m_extra_file.reset(new File(m_grid->com, filename, backend, mode));
+      }
 
       // Prepare the file:
       io::define_time(*m_extra_file, *m_ctx);
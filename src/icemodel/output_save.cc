@@ -139,9 +139,15 @@ void IceModel::write_snapshot() {
       filename = m_snapshots_filename;
     }
 
-    m_snapshot_file = std::make_shared<File>(
-        m_grid->com, filename, string_to_backend(m_config->get_string("output.format")),
-        io::PISM_READWRITE_MOVE);
+    if (m_split_snapshots and m_background_writer) {
+      // build the file in memory and write it to disk in the background
+      m_snapshot_file = std::make_shared<File>(m_grid->com, filename, m_background_writer,
+                                               io::PISM_READWRITE_MOVE);
+    } else {
+      m_snapshot_file = std::make_shared<File>(
+          m_grid->com, filename, string_to_backend(m_config->get_string("output.format")),
+          io::PISM_READWRITE_MOVE);
+    }
 
     write_metadata(*m_snapshot_file, WRITE_MAPPING, PREPEND_HISTORY);
   }
@@ -28,6 +28,8 @@
 #include "pism/util/Grid.hh"
 #include "pism/util/ConfigInterface.hh"
 #include "pism/util/Time.hh"
+#include "pism/util/Profiling.hh"
+#include "pism/util/GlobalReduction.hh"
 
 #include "pism/util/pism_utilities.hh"
 
@@ -110,9 +112,14 @@ void IceModel::print_summary(bool tempAndAge) {
 
   // get maximum diffusivity
   double max_diffusivity = m_stress_balance->max_diffusivity();
-  // get volumes in m^3 and areas in m^2
-  double volume = ice_volume(m_geometry, 0.0);
-  double area = ice_area(m_geometry, 0.0);
+  // get volumes in m^3 and areas in m^2 (using one reduction)
+  GlobalReduction sums(m_grid->com);
+  int volume_index = sums.sum(ice_volume_local(m_geometry, 0.0));
+  int area_index   = sums.sum(ice_area_local(m_geometry, 0.0));
+  sums.reduce();
+
+  double volume = sums[volume_index];
+  double area   = sums[area_index];
 
   double meltfrac = 0.0;
   if (tempAndAge or m_log->get_threshold() >= 3) {
@@ -248,5 +255,92 @@ void IceModel::print_summary_line(bool printPrototype,  bool tempAndAge,
   }
 }
 
+//! Phases of IceModel::step() (and the step itself) included in the load imbalance report.
+/*!
+ * All ranks use this list to reduce times spent in these phases: a rank may not have
+ * recorded some of them (or may have recorded other events).
+ */
+static const std::vector<std::string> step_phases = {
+  "age",
+  "basal_hydrology",
+  "basal_yield_stress",
+  "bed_deformation",
+  "energy",
+  "fracture_density",
+  "front_retreat",
+  "mass_transport",
+  "ocean",
+  "sea_level",
+  "step",
+  "stress_balance",
+  "surface",
+};
+
+/*!
+ * Report the load imbalance of each phase of the last time step.
+ *
+ * The imbalance of a phase is the ratio of the maximum (across ranks) of the time spent in
+ * it to the average: ranks that finish early wait for the slowest one. Maximum and average
+ * times are accumulated over the run; if `final_report` is true, reports the imbalance
+ * over the whole run instead.
+ */
+void IceModel::report_load_imbalance(bool final_report) {
+
+  if (final_report) {
+    if (m_phase_imbalance.empty()) {
+      return;
+    }
+
+    std::vector<std::string> phases;
+    for (const auto &p : m_phase_imbalance) {
+      if (p.second.second > 0.0) {
+        phases.push_back(pism::printf("%s %.2f", p.first.c_str(), p.second.first / p.second.second));
+      }
+    }
+
+    const auto &step = m_phase_imbalance["step"];
+    m_log->message(2,
+                   "Load imbalance (max/avg time across ranks): %s\n"
+                   "  time spent waiting for other ranks: %.1f s out of %.1f s\n",
+                   join(phases, ", ").c_str(), step.first - step.second, step.first);
+    return;
+  }
+
+  const Profiling &profiling = m_ctx->profiling();
+
+  auto times    = profiling.times("step");
+  times["step"] = profiling.times("")["step"];
+
+  // phases this rank did not record contribute zeros
+  std::vector<double> dt;
+  for (const auto &name : step_phases) {
+    auto t = times.find(name);
+    double total = t != times.end() ? t->second : 0.0;
+
+    dt.push_back(total - m_phase_times[name]);
+    m_phase_times[name] = total;
+  }
+
+  int N = static_cast<int>(dt.size());
+  std::vector<double> max_dt(N), sum_dt(N);
+  GlobalMax(m_grid->com, dt.data(), max_dt.data(), N);
+  GlobalSum(m_grid->com, dt.data(), sum_dt.data(), N);
+
+  std::vector<std::string> phases;
+  for (int k = 0; k < N; ++k) {
+    const auto &name = step_phases[k];
+    double avg = sum_dt[k] / m_grid->size();
+
+    auto &total = m_phase_imbalance[name];
+    total.first += max_dt[k];
+    total.second += avg;
+
+    if (avg > 0.0) {
+      phases.push_back(pism::printf("%s %.2f", name.c_str(), max_dt[k] / avg));
+    }
+  }
+
+  m_log->message(3, "  load imbalance (max/avg): %s\n", join(phases, ", ").c_str());
+}
 
 } // end of namespace pism
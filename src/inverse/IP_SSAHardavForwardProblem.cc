@@ -154,6 +154,9 @@ void IP_SSAHardavForwardProblem::set_design(array::Scalar &new_zeta) {
     m_coefficients(i, j).hardness = m_hardav(i, j);
   }
 
+  // Values of coefficients at quadrature points are out of date.
+  m_quad_point_values_valid = false;
+
   // Flag the state jacobian as needing rebuilding.
   m_rebuild_J_state = true;
 }
@@ -160,6 +160,9 @@ void IP_SSATaucForwardProblem::set_design(array::Scalar &new_zeta) {
     m_coefficients(i, j).tauc = tauc(i, j);
   }
 
+  // Values of coefficients at quadrature points are out of date.
+  m_quad_point_values_valid = false;
+
   // Flag the state jacobian as needing rebuilding.
   m_rebuild_J_state = true;
 }
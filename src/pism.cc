@@ -36,6 +36,8 @@ static char help[] =
 #include "pism/util/petscwrappers/PetscInitializer.hh"
 #include "pism/util/pism_options.hh"
 #include "pism/util/EnthalpyConverter.hh"
+#include "pism/util/Logger.hh"
+#include "pism/util/io/IOServer.hh"
 
 #include "pism/regional/IceRegionalModel.hh"
 
@@ -210,6 +212,30 @@ int main(int argc, char *argv[]) {
   com = PETSC_COMM_WORLD;
 
   int exit_code = 0;
+
+  // Set aside ranks used to write -extra_file (if requested). These ranks wait for
+  // requests from the rest and do not participate in the simulation.
+  std::shared_ptr<io::IOServer> io_server;
+  try {
+    Logger quiet(com, 1);
+    auto config = config_from_options(com, quiet, std::make_shared<units::System>());
+
+    int n_io_ranks = static_cast<int>(config->get_number("output.extra.io_ranks"));
+    if (n_io_ranks > 0) {
+      io_server = std::make_shared<io::IOServer>(com, n_io_ranks);
+
+      if (io_server->is_server()) {
+        io_server->run();
+        return 0;
+      }
+
+      com = io_server->compute_comm();
+    }
+  } catch (...) {
+    handle_fatal_errors(com);
+    return 1;
+  }
+
   try {
     // Note: EISMINT II experiments G and H are not supported.
     auto eisII = options::Keyword("-eisII",
@@ -304,6 +330,8 @@ int main(int argc, char *argv[]) {
       }
     }
 
+    model->set_io_server(io_server);
+
     model->init();
 
     auto list_type = options::Keyword("-list_diagnostics",
@@ -346,7 +374,7 @@ int main(int argc, char *argv[]) {
     print_unused_parameters(*log, 3, *config);
 
     if (profiling_log.is_set()) {
-      ctx->profiling().report(profiling_log);
+      ctx->profiling().report(com, profiling_log);
     }
   }
   catch (...) {
@@ -354,5 +382,15 @@ int main(int argc, char *argv[]) {
     exit_code = 1;
   }
 
+  if (io_server) {
+    try {
+      // report errors encountered by I/O server ranks (if any) and let them exit
+      io_server->shutdown();
+    } catch (...) {
+      handle_fatal_errors(com);
+      exit_code = 1;
+    }
+  }
+
   return exit_code;
 }
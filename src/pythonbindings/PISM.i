@@ -57,6 +57,7 @@
 #include "stressbalance/timestepping.hh"
 #include "util/Context.hh"
 #include "util/Profiling.hh"
+#include "util/GlobalReduction.hh"
 
 #include "util/projection.hh"
 #include "energy/bootstrapping.hh"
@@ -112,6 +113,7 @@
 %template(StringSet) std::set<std::string>;
 %template(DoubleVectorMap) std::map<std::string, std::vector<double> >;
 %template(BoolMap) std::map<std::string, bool >;
+%template(DoubleMap) std::map<std::string, double>;
 %template(StringMap) std::map<std::string, std::string>;
 %template(DiagnosticMap) std::map<std::string, std::shared_ptr<pism::Diagnostic> >;
 %template(SizeDoubleMap) std::map<size_t, double>;
@@ -218,6 +220,9 @@ pism_class(pism::Logger, "pism/util/Logger.hh");
 %shared_ptr(pism::MaxTimestep)
 %include "util/MaxTimestep.hh"
 
+%rename(__getitem__) pism::GlobalReduction::operator[];
+%include "util/GlobalReduction.hh"
+
 %include pism_DM.i
 %include pism_Vec.i
 /* End of independent PISM classes. */
@@ -239,6 +244,8 @@ pism_class(pism::EnthalpyConverter, "pism/util/EnthalpyConverter.hh");
 
 pism_class(pism::Time, "pism/util/Time.hh")
 
+/* RAII helper: not useful in Python */
+%ignore pism::Profiling::Scope;
 %include "util/Profiling.hh"
 %shared_ptr(pism::Context);
 %include "util/Context.hh"
@@ -6,6 +6,11 @@
 
 %shared_ptr(pism::Geometry)
 
+// Iterators over lists of columns are not useful in Python.
+%ignore pism::ActiveColumns::Iterator;
+%ignore pism::ActiveColumns::active;
+%ignore pism::ActiveColumns::inactive;
+
 // Treat data members of Geometry as read-only.
 %feature("immutable", "1");
 %include "geometry/Geometry.hh"
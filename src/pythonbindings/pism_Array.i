@@ -7,6 +7,7 @@
 #include "util/array/Vector.hh"
 #include "util/array/Array3D.hh"
 #include "util/array/Staggered.hh"
+#include "util/array/GhostExchange.hh"
 
 using namespace pism;
 %}
@@ -23,6 +24,7 @@ using namespace pism;
 %shared_ptr(pism::array::Array3D)
 
 %ignore pism::array::AccessScope::AccessScope(std::initializer_list<const PetscAccessible *>);
+%ignore pism::array::GhostExchange::GhostExchange(std::initializer_list<Array *>);
 
 %ignore pism::array::Scalar::array;
 %ignore pism::array::Vector::array;
@@ -153,5 +155,6 @@ std::vector<double> interp(int i, int j) {
 
 %include "util/array/Array3D.hh"
 %include "util/array/Staggered.hh"
+%include "util/array/GhostExchange.hh"
 
 %include "util/Vector2d.hh"
@@ -1,13 +1,30 @@
 %{
 #include "util/io/File.hh"
 #include "util/io/io_helpers.hh"
+#include "util/io/BackgroundWriter.hh"
+#include "util/io/IOServer.hh"
+#include "util/io/NCFile.hh"
 %}
 
+%shared_ptr(pism::io::NCFile)
+%shared_ptr(pism::io::IOServer)
+// these are used by NC_Remote
+%ignore pism::io::IOServer::send_command;
+%ignore pism::io::IOServer::send_block;
+%ignore pism::io::IOServer::exchange_block;
+%ignore pism::io::IOServer::receive_reply;
+%ignore pism::io::IOServer::wait;
+
+%shared_ptr(pism::io::BackgroundWriter)
+%ignore pism::io::BackgroundWriter::submit;
+
 %ignore pism::File::read_variable(const std::string &, const std::vector<unsigned int> &, const std::vector<unsigned int> &, double *) const;
 %ignore pism::File::write_variable(const std::string &, const std::vector<unsigned int> &, const std::vector<unsigned int> &, const double *) const;
 
 %include "util/io/IO_Flags.hh"
+%include "util/io/BackgroundWriter.hh"
 %include "util/io/File.hh"
+%include "util/io/IOServer.hh"
 %include "util/io/io_helpers.hh"
 
 %extend pism::File
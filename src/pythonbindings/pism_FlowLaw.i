@@ -14,7 +14,23 @@
 %shared_ptr(pism::rheology::PatersonBuddCold)
 %shared_ptr(pism::rheology::PatersonBuddWarm)
 
+%ignore pism::rheology::FlowLaw::flow_n(const double *, const double *, const double *, const double *, unsigned int, double *) const;
+
 %include "rheology/FlowLaw.hh"
+
+%extend pism::rheology::FlowLaw
+{
+  std::vector<double> flow_n(const std::vector<double> &stress,
+                             const std::vector<double> &enthalpy,
+                             const std::vector<double> &pressure,
+                             const std::vector<double> &grain_size) const {
+    std::vector<double> result(stress.size());
+    $self->flow_n(stress.data(), enthalpy.data(), pressure.data(), grain_size.data(),
+                  stress.size(), result.data());
+    return result;
+  }
+};
+
 %include "rheology/GPBLD.hh"
 %include "rheology/PatersonBudd.hh"
 %include "rheology/PatersonBuddCold.hh"
@@ -31,6 +31,9 @@
     }
 }
 
+%rename(__bool__) pism::PointsInterior::operator bool;
+%rename(__bool__) pism::PointsBoundary::operator bool;
+
 %rename("GridParameters") "pism::grid::Parameters";
 %shared_ptr(pism::Grid);
 %include "util/Grid.hh"
@@ -13,8 +13,21 @@ using pism::MaskValue;
 
 /* wrap the enthalpy solver to make testing easier */
 %ignore pism::TridiagonalSystem::solve(unsigned int, double *);
+%ignore pism::ColumnBatch;
+%ignore pism::columnSystemCtx::batches;
 %include "util/ColumnSystem.hh"
 
+%extend pism::TridiagonalSystem
+{
+  //! Set coefficients and the right-hand side in the row `k`.
+  void set_row(size_t k, double L, double D, double U, double rhs) {
+    $self->L(k) = L;
+    $self->D(k) = D;
+    $self->U(k) = U;
+    $self->RHS(k) = rhs;
+  }
+};
+
 %rename(get_lambda) pism::energy::enthSystemCtx::lambda;
 %include "energy/enthSystem.hh"
 
@@ -39,6 +52,30 @@ using pism::MaskValue;
 %include "regional/EnthalpyModel_Regional.hh"
 
 %ignore pism::energy::BedrockColumn::solve(double, double, double, const double *, double *);
+%ignore pism::energy::BedrockColumn::solve(double, int, const double *, const double *, double *const *);
 %include "energy/BedrockColumn.hh"
 
+%extend pism::energy::BedrockColumn
+{
+  //! Advance the heat equation in `Q_bottom.size()` columns at once. `T` contains
+  //! temperatures in all columns, one column after another.
+  std::vector<double> solve_batch(double dt,
+                                  const std::vector<double> &Q_bottom,
+                                  const std::vector<double> &T_top,
+                                  const std::vector<double> &T) {
+    int n_columns = Q_bottom.size();
+    size_t M = T.size() / n_columns;
+
+    std::vector<double> result(T);
+    std::vector<double*> columns(n_columns);
+    for (int n = 0; n < n_columns; ++n) {
+      columns[n] = &result[n * M];
+    }
+
+    $self->solve(dt, n_columns, Q_bottom.data(), T_top.data(), columns.data());
+
+    return result;
+  }
+};
+
 %include "energy/utilities.hh"
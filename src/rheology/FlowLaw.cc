@@ -18,6 +18,9 @@
 
 #include "pism/rheology/FlowLaw.hh"
 
+#include <cmath>                // std::floor
+#include <cstdint>              // int64_t
+#include <cstring>              // std::memcpy
 #include <petsc.h>
 
 #include "pism/util/EnthalpyConverter.hh"
@@ -56,6 +59,8 @@ FlowLaw::FlowLaw(const std::string &prefix, const Config &config,
   m_Q_warm = config.get_number("flow_law.Paterson_Budd.Q_warm");
   m_crit_temp = config.get_number("flow_law.Paterson_Budd.T_critical");
 
+  m_fast_exp = config.get_flag("flow_law.fast_exp");
+
   double
     schoofLen = config.get_number("flow_law.Schoof_regularizing_length", "m"),
     schoofVel = config.get_number("flow_law.Schoof_regularizing_velocity", "m second-1");
@@ -84,6 +89,72 @@ double FlowLaw::softness_paterson_budd(double T_pa) const {
   return A * exp(-Q / (m_ideal_gas_constant * T_pa));
 }
 
+namespace {
+
+/*!
+ * Approximation of `exp(x)` with the relative error below 1e-14 for `x` in [-700, 700].
+ *
+ * Unlike `exp()` from the standard library, this function can be inlined and the
+ * compiler can vectorize loops using it.
+ */
+inline double fast_exp(double x) {
+  // exp(x) = 2^m exp(r), where m = round(x / ln 2) and |r| <= ln(2) / 2
+  const double log2e  = 1.4426950408889634;
+  const double ln2_hi = 6.93145751953125e-1;
+  const double ln2_lo = 1.42860682030941723212e-6;
+
+  const double m = std::floor(x * log2e + 0.5);
+  const double r = (x - m * ln2_hi) - m * ln2_lo;
+
+  // degree 11 Taylor polynomial approximating exp(r)
+  double p = 1.0 / 39916800.0;
+  p = p * r + 1.0 / 3628800.0;
+  p = p * r + 1.0 / 362880.0;
+  p = p * r + 1.0 / 40320.0;
+  p = p * r + 1.0 / 5040.0;
+  p = p * r + 1.0 / 720.0;
+  p = p * r + 1.0 / 120.0;
+  p = p * r + 1.0 / 24.0;
+  p = p * r + 1.0 / 6.0;
+  p = p * r + 0.5;
+  p = p * r + 1.0;
+  p = p * r + 1.0;
+
+  // multiply by 2^m by adding m to the binary exponent
+  int64_t bits = 0;
+  std::memcpy(&bits, &p, sizeof(p));
+  bits += static_cast<int64_t>(m) * (int64_t(1) << 52);
+  std::memcpy(&p, &bits, sizeof(p));
+
+  return p;
+}
+
+} // end of anonymous namespace
+
+//! Compute softness_paterson_budd() for `n` values of the pressure-adjusted temperature.
+/*!
+ * Uses fast_exp() if `flow_law.fast_exp` is set.
+ */
+void FlowLaw::softness_paterson_budd_n(const double *T_pa, unsigned int n, double *result) const {
+  const double R = m_ideal_gas_constant;
+
+  if (m_fast_exp) {
+    for (unsigned int k = 0; k < n; ++k) {
+      const bool cold = T_pa[k] < m_crit_temp;
+      const double A = cold ? m_A_cold : m_A_warm, Q = cold ? m_Q_cold : m_Q_warm;
+
+      result[k] = A * fast_exp(-Q / (R * T_pa[k]));
+    }
+  } else {
+    for (unsigned int k = 0; k < n; ++k) {
+      const bool cold = T_pa[k] < m_crit_temp;
+      const double A = cold ? m_A_cold : m_A_warm, Q = cold ? m_Q_cold : m_Q_warm;
+
+      result[k] = A * exp(-Q / (R * T_pa[k]));
+    }
+  }
+}
+
 //! The flow law itself.
 double FlowLaw::flow(double stress, double enthalpy,
                      double pressure, double grain_size) const {
@@ -126,6 +126,10 @@ protected:
   EnthalpyConverter::Ptr m_EC;
 
   double softness_paterson_budd(double T_pa) const;
+  void softness_paterson_budd_n(const double *T_pa, unsigned int n, double *result) const;
+
+  //! true if batched methods should use an approximation of exp()
+  bool m_fast_exp;
 
   //! regularization parameter for @f$ \gamma @f$
   double m_schoofReg;
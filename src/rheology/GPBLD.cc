@@ -17,6 +17,10 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include <algorithm>            // std::min
+#include <cmath>                // pow
+#include <vector>
+
 #include "pism/rheology/GPBLD.hh"
 #include "pism/util/ConfigInterface.hh"
 
@@ -60,20 +64,40 @@ double GPBLD::softness_impl(double enthalpy, double pressure) const {
   }
 }
 
+/*!
+ * Evaluates the flow law for `n` points at once.
+ *
+ * Each step of the computation is done for all points before moving on to the next one.
+ * This avoids virtual calls per point and lets the compiler vectorize these loops.
+ */
 void GPBLD::flow_n_impl(const double *stress, const double *enthalpy,
-                        const double *pressure, const double *grainsize,
+                        const double *pressure, const double * /* grainsize */,
                         unsigned int n, double *result) const {
-  // optimize the common case of Glen n=3
-  if (m_n == 3.0) {
-    for (unsigned int k = 0; k < n; ++k) {
-      result[k] = this->softness(enthalpy[k], pressure[k]) * (stress[k] * stress[k]);
-    }
+  std::vector<double> T_pa(n), omega(n);
 
-    return;
+  m_EC->pressure_adjusted_temperature_n(enthalpy, pressure, n, T_pa.data());
+  m_EC->water_fraction_n(enthalpy, pressure, n, omega.data());
+
+  // temperate ice uses the softness at the melting point (see softness_impl())
+  for (unsigned int k = 0; k < n; ++k) {
+    T_pa[k] = omega[k] > 0.0 ? m_T_0 : T_pa[k];
   }
 
+  softness_paterson_budd_n(T_pa.data(), n, result);
+
   for (unsigned int k = 0; k < n; ++k) {
-    result[k] = this->flow(stress[k], enthalpy[k], pressure[k], grainsize[k]);
+    result[k] *= 1.0 + m_water_frac_coeff * std::min(omega[k], m_water_frac_observed_limit);
+  }
+
+  // optimize the common case of Glen n=3
+  if (m_n == 3.0) {
+    for (unsigned int k = 0; k < n; ++k) {
+      result[k] *= stress[k] * stress[k];
+    }
+  } else {
+    for (unsigned int k = 0; k < n; ++k) {
+      result[k] *= pow(stress[k], m_n - 1);
+    }
   }
 }
 
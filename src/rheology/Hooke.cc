@@ -44,5 +44,12 @@ double Hooke::softness_from_temp(double T_pa) const {
                          + 3.0 * m_C_Hooke * pow(m_Tr_Hooke - T_pa, -m_K_Hooke));
 }
 
+// uses a formula different from PatersonBudd::flow_n_impl()
+void Hooke::flow_n_impl(const double *stress, const double *E,
+                        const double *pressure, const double *grainsize,
+                        unsigned int n, double *result) const {
+  FlowLaw::flow_n_impl(stress, E, pressure, grainsize, n, result);
+}
+
 } // end of namespace rheology
 } // end of namespace pism
@@ -32,6 +32,9 @@ public:
   virtual ~Hooke() = default;
 protected:
   virtual double softness_from_temp(double T_pa) const;
+  virtual void flow_n_impl(const double *stress, const double *E,
+                           const double *pressure, const double *grainsize,
+                           unsigned int n, double *result) const;
 
   double m_A_Hooke, m_Q_Hooke, m_C_Hooke, m_K_Hooke, m_Tr_Hooke; // constants from Hooke (1981)
   // R_Hooke is the ideal_gas_constant.
@@ -38,6 +38,14 @@ double IsothermalGlen::flow_impl(double stress, double, double, double) const {
   return m_softness_A * pow(stress, m_n-1);
 }
 
+void IsothermalGlen::flow_n_impl(const double *stress, const double *,
+                                 const double *, const double *,
+                                 unsigned int n, double *result) const {
+  for (unsigned int k = 0; k < n; ++k) {
+    result[k] = m_softness_A * pow(stress[k], m_n-1);
+  }
+}
+
 double IsothermalGlen::softness_impl(double, double) const {
   return m_softness_A;
 }
@@ -20,6 +20,7 @@
 #include "pism/rheology/PatersonBudd.hh"
 #include <cmath>   // for pow
 #include <memory>  // for __shared_ptr_access
+#include <vector>
 
 namespace pism {
 namespace rheology {
@@ -46,6 +47,38 @@ double PatersonBudd::flow_impl(double stress, double E,
   return flow_from_temp(stress, temp, pressure, gs);
 }
 
+/*!
+ * Evaluates the flow law for `n` points at once (see GPBLD::flow_n_impl()).
+ *
+ * Derived classes that override flow_from_temp() or softness_from_temp() have to override
+ * this method, too.
+ */
+void PatersonBudd::flow_n_impl(const double *stress, const double *E,
+                               const double *pressure, const double * /* grainsize */,
+                               unsigned int n, double *result) const {
+  std::vector<double> T_pa(n);
+
+  m_EC->temperature_n(E, pressure, n, T_pa.data());
+
+  // pressure-adjusted temperature (see flow_from_temp()):
+  const double beta = m_beta_CC_grad / (m_rho * m_standard_gravity);
+  for (unsigned int k = 0; k < n; ++k) {
+    T_pa[k] = T_pa[k] + beta * pressure[k];
+  }
+
+  softness_paterson_budd_n(T_pa.data(), n, result);
+
+  if (m_n == 3.0) {
+    for (unsigned int k = 0; k < n; ++k) {
+      result[k] *= stress[k] * stress[k];
+    }
+  } else {
+    for (unsigned int k = 0; k < n; ++k) {
+      result[k] *= pow(stress[k], m_n - 1);
+    }
+  }
+}
+
 //! The flow law (temperature-dependent version).
 double PatersonBudd::flow_from_temp(double stress, double temp,
                                     double pressure, double /*gs*/) const {
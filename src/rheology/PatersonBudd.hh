@@ -39,6 +39,9 @@ public:
 protected:
   virtual double flow_impl(double stress, double E,
                            double pressure, double gs) const;
+  virtual void flow_n_impl(const double *stress, const double *E,
+                           const double *pressure, const double *grainsize,
+                           unsigned int n, double *result) const;
   // This also takes care of hardness
   virtual double softness_impl(double enthalpy, double pressure) const;
 
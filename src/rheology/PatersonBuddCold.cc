@@ -46,6 +46,13 @@ double PatersonBuddCold::flow_from_temp(double stress, double temp,
   return softness_from_temp(temp) * pow(stress,m_n-1);
 }
 
+// uses a formula different from PatersonBudd::flow_n_impl()
+void PatersonBuddCold::flow_n_impl(const double *stress, const double *E,
+                                   const double *pressure, const double *grainsize,
+                                   unsigned int n, double *result) const {
+  FlowLaw::flow_n_impl(stress, E, pressure, grainsize, n, result);
+}
+
 
 // Rather than make this part of the base class, we just check at some reference values.
 bool FlowLawIsPatersonBuddCold(const FlowLaw &flow_law, const Config &config,
@@ -45,6 +45,13 @@ double PatersonBuddWarm::flow_from_temp(double stress, double temp,
   return softness_from_temp(temp) * pow(stress,m_n-1);
 }
 
+// uses a formula different from PatersonBudd::flow_n_impl()
+void PatersonBuddWarm::flow_n_impl(const double *stress, const double *E,
+                                   const double *pressure, const double *grainsize,
+                                   unsigned int n, double *result) const {
+  FlowLaw::flow_n_impl(stress, E, pressure, grainsize, n, result);
+}
+
 
 } // end of namespace rheology
 } // end of namespace pism
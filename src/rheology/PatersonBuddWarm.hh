@@ -41,6 +41,9 @@ protected:
   // ignores pressure and uses non-pressure-adjusted temperature
   double flow_from_temp(double stress, double temp,
                         double , double) const;
+  void flow_n_impl(const double *stress, const double *E,
+                   const double *pressure, const double *grainsize,
+                   unsigned int n, double *result) const;
 };
 
 } // end of namespace rheology
@@ -37,6 +37,8 @@
 #include "pism/util/array/Array3D.hh"
 #include "pism/util/pism_options.hh"
 #include "pism/util/pism_utilities.hh" // pism::printf()
+#include "pism/util/Profiling.hh"
+#include "pism/util/Time.hh"
 #include "pism/util/fem/Quadrature.hh"
 
 namespace pism {
@@ -490,6 +492,13 @@ PetscErrorCode Blatter::setup(DM pism_da, grid::Periodicity periodicity, int Mz,
     ierr = VecSetFromOptions(m_x); CHKERRQ(ierr);
 
     ierr = VecDuplicate(m_x, m_x_old.rawptr()); CHKERRQ(ierr);
+
+    ierr = VecDuplicate(m_x, m_x_previous.rawptr()); CHKERRQ(ierr);
+
+    m_n_accepted = 0;
+    m_t_last     = 0.0;
+    m_t_previous = 0.0;
+    m_extrapolate = m_config->get_flag("stress_balance.blatter.extrapolate_initial_guess");
   }
 
   // SNES
@@ -516,14 +525,113 @@ PetscErrorCode Blatter::setup(DM pism_da, grid::Periodicity periodicity, int Mz,
 #endif
                                     this); CHKERRQ(ierr);
 
+    // Lag the Jacobian and the preconditioner across Newton iterations *and* time steps.
+    // These settings can be overridden using -bp_snes_lag_jacobian, etc.
+    {
+      int lag_jacobian =
+          static_cast<int>(m_config->get_number("stress_balance.blatter.lag_jacobian"));
+      int lag_preconditioner =
+          static_cast<int>(m_config->get_number("stress_balance.blatter.lag_preconditioner"));
+
+      if (lag_jacobian < 1 or lag_preconditioner < 1) {
+        throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                      "stress_balance.blatter.lag_jacobian (%d) and "
+                                      "stress_balance.blatter.lag_preconditioner (%d) "
+                                      "have to be positive",
+                                      lag_jacobian, lag_preconditioner);
+      }
+
+      ierr = SNESSetLagJacobian(m_snes, lag_jacobian); CHKERRQ(ierr);
+      ierr = SNESSetLagJacobianPersists(m_snes, (PetscBool)(lag_jacobian > 1)); CHKERRQ(ierr);
+
+      ierr = SNESSetLagPreconditioner(m_snes, lag_preconditioner); CHKERRQ(ierr);
+      ierr = SNESSetLagPreconditionerPersists(m_snes, (PetscBool)(lag_preconditioner > 1));
+      CHKERRQ(ierr);
+    }
+
     ierr = SNESSetFromOptions(m_snes); CHKERRQ(ierr);
 
+    ierr = SNESGetLagJacobian(m_snes, &m_lag_jacobian); CHKERRQ(ierr);
+    ierr = SNESGetLagPreconditioner(m_snes, &m_lag_preconditioner); CHKERRQ(ierr);
+
 
     PetscBool ksp_use_ew = PETSC_FALSE;
     ierr = SNESKSPGetUseEW(m_snes, &ksp_use_ew); CHKERRQ(ierr);
     m_ksp_use_ew = (ksp_use_ew != 0U);
   }
 
+  m_matrix_free = m_config->get_flag("stress_balance.blatter.matrix_free");
+  if (m_matrix_free) {
+    ierr = setup_matrix_free(prefix, mg_levels); CHKERRQ(ierr);
+  }
+
+  return 0;
+}
+
+/*!
+ * Set up the matrix-free Jacobian on the finest multigrid level.
+ *
+ * The Jacobian on the finest level is a MATSHELL applying element Jacobians (see
+ * jacobian_mf_apply()). Coarser multigrid levels use assembled Jacobians, so this
+ * requires a multigrid preconditioner with re-discretization on coarse levels. The
+ * finest level smoother uses the Jacobi preconditioner since it needs only the diagonal
+ * of the Jacobian.
+ */
+PetscErrorCode Blatter::setup_matrix_free(const std::string &prefix, int mg_levels) {
+  PetscErrorCode ierr;
+
+  MPI_Comm comm;
+  ierr = PetscObjectGetComm((PetscObject)m_da.get(), &comm); CHKERRQ(ierr);
+
+  KSP ksp;
+  ierr = SNESGetKSP(m_snes, &ksp); CHKERRQ(ierr);
+
+  PC pc;
+  ierr = KSPGetPC(ksp, &pc); CHKERRQ(ierr);
+
+  PetscBool mg = PETSC_FALSE;
+  ierr = PetscObjectTypeCompare((PetscObject)pc, PCMG, &mg); CHKERRQ(ierr);
+
+  if (not mg or mg_levels < 2) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "stress_balance.blatter.matrix_free requires a multigrid "
+                                  "preconditioner with at least 2 levels\n"
+                                  "(use '-%spc_type mg -%spc_mg_levels N' with N >= 2)",
+                                  prefix.c_str(), prefix.c_str());
+  }
+
+  PetscInt n = 0, N = 0;
+  ierr = VecGetLocalSize(m_x, &n); CHKERRQ(ierr);
+  ierr = VecGetSize(m_x, &N); CHKERRQ(ierr);
+
+  ierr = MatCreateShell(comm, n, n, N, N, this, m_J_mf.rawptr()); CHKERRQ(ierr);
+
+  ierr = MatShellSetOperation(m_J_mf, MATOP_MULT,
+                              (void (*)(void))jacobian_mf_mult_callback); CHKERRQ(ierr);
+  // the Jacobian is symmetric
+  ierr = MatShellSetOperation(m_J_mf, MATOP_MULT_TRANSPOSE,
+                              (void (*)(void))jacobian_mf_mult_callback); CHKERRQ(ierr);
+  ierr = MatShellSetOperation(m_J_mf, MATOP_GET_DIAGONAL,
+                              (void (*)(void))jacobian_mf_diagonal_callback); CHKERRQ(ierr);
+
+  ierr = MatSetOption(m_J_mf, MAT_SYMMETRIC, PETSC_TRUE); CHKERRQ(ierr);
+
+  ierr = PetscObjectSetName((PetscObject)m_J_mf.get(), "bp_jacobian_mf"); CHKERRQ(ierr);
+
+  // Use the shell matrix on the finest level. Note that the Jacobian callback set using
+  // DMDASNESSetJacobianLocal() is still used on all levels.
+  ierr = SNESSetJacobian(m_snes, m_J_mf, m_J_mf, NULL, NULL); CHKERRQ(ierr);
+
+  // The finest level smoother needs a preconditioner that does not require an assembled
+  // matrix. (This can be overridden using -bp_mg_levels_pc_type.)
+  KSP smoother;
+  ierr = PCMGGetSmoother(pc, mg_levels - 1, &smoother); CHKERRQ(ierr);
+
+  PC smoother_pc;
+  ierr = KSPGetPC(smoother, &smoother_pc); CHKERRQ(ierr);
+
+  ierr = PCSetType(smoother_pc, PCJACOBI); CHKERRQ(ierr);
+
   return 0;
 }
 
@@ -687,6 +795,9 @@ void Blatter::init_impl() {
   } else {
     int ierr = VecSet(m_x, 0.0); PISM_CHK(ierr, "VecSet");
   }
+
+  // the time corresponding to the initial guess is not known: do not extrapolate
+  m_n_accepted = 0;
 }
 
 void Blatter::define_model_state_impl(const File &output) const {
@@ -784,6 +895,9 @@ Blatter::SolutionInfo Blatter::solve() {
   ierr = SNESGetLinearSolveIterations(m_snes, &result.ksp_it);
   PISM_CHK(ierr, "SNESGetLinearSolveIterations");
 
+  profiling().count("snes_iterations", result.snes_it);
+  profiling().count("ksp_iterations", result.ksp_it);
+
   KSP ksp;
   ierr = SNESGetKSP(m_snes, &ksp);
   PISM_CHK(ierr, "SNESGetKSP");
@@ -980,6 +1094,77 @@ static void enable_ew(::SNES snes) {
   ierr = SNESKSPSetUseEW(snes, PETSC_TRUE); PISM_CHK(ierr, "SNESKSPSetUseEW");
 }
 
+/*!
+ * Set Jacobian and preconditioner lags.
+ *
+ * Setting both to 1 (re-build every Newton iteration) discards lagged Jacobians and
+ * preconditioners computed during earlier time steps.
+ */
+static void set_lags(::SNES snes, PetscInt lag_jacobian, PetscInt lag_preconditioner) {
+  PetscErrorCode ierr;
+
+  ierr = SNESSetLagJacobian(snes, lag_jacobian);
+  PISM_CHK(ierr, "SNESSetLagJacobian");
+
+  ierr = SNESSetLagPreconditioner(snes, lag_preconditioner);
+  PISM_CHK(ierr, "SNESSetLagPreconditioner");
+}
+
+namespace {
+
+/*!
+ * Restores Jacobian and preconditioner lags when it goes out of scope, i.e. both after a
+ * successful solve and if all attempts to solve fail.
+ */
+class LagsGuard {
+public:
+  LagsGuard(::SNES snes, PetscInt lag_jacobian, PetscInt lag_preconditioner, bool enabled)
+    : m_snes(snes),
+      m_lag_jacobian(lag_jacobian),
+      m_lag_preconditioner(lag_preconditioner),
+      m_enabled(enabled) {
+    // empty
+  }
+
+  ~LagsGuard() {
+    if (m_enabled) {
+      // ignore errors: destructors should not throw
+      (void) SNESSetLagJacobian(m_snes, m_lag_jacobian);
+      (void) SNESSetLagPreconditioner(m_snes, m_lag_preconditioner);
+    }
+  }
+private:
+  ::SNES m_snes;
+  PetscInt m_lag_jacobian, m_lag_preconditioner;
+  bool m_enabled;
+};
+
+} // end of anonymous namespace
+
+/*!
+ * Extrapolate the initial guess for the solve at time `t` from the last two accepted
+ * solutions (the last one is in `m_x`).
+ *
+ * Uses linear extrapolation. The extrapolation step is limited to the length of the
+ * interval between the last two solutions.
+ *
+ * Returns true if `m_x` was modified.
+ */
+bool Blatter::extrapolate_initial_guess(double t) {
+  if (not m_extrapolate or m_n_accepted < 2 or
+      not (t > m_t_last and m_t_last > m_t_previous)) {
+    return false;
+  }
+
+  double ratio = std::min((t - m_t_last) / (m_t_last - m_t_previous), 1.0);
+
+  // m_x = (1 + ratio) * m_x - ratio * m_x_previous
+  PetscErrorCode ierr = VecAXPBY(m_x, -ratio, 1.0 + ratio, m_x_previous);
+  PISM_CHK(ierr, "VecAXPBY");
+
+  return true;
+}
+
 void Blatter::update(const Inputs &inputs, bool full_update) {
   PetscErrorCode ierr;
   (void) full_update;
@@ -1001,6 +1186,23 @@ void Blatter::update(const Inputs &inputs, bool full_update) {
   // Store the "old" initial guess: it may be needed to re-try.
   ierr = VecCopy(m_x, m_x_old); PISM_CHK(ierr, "VecCopy");
 
+  const double t = time().current();
+
+  bool extrapolated = extrapolate_initial_guess(t);
+
+  // m_x_old contains the solution from the previous time step: save it to extrapolate
+  // from during the next time step
+  bool new_time_step = m_n_accepted > 0 and t > m_t_last;
+  if (m_extrapolate and new_time_step) {
+    ierr = VecCopy(m_x_old, m_x_previous); PISM_CHK(ierr, "VecCopy");
+    m_t_previous = m_t_last;
+  }
+
+  bool lagging = m_lag_jacobian != 1 or m_lag_preconditioner != 1;
+
+  // restore lags (this has no effect if they are not changed below)
+  LagsGuard lags_guard(m_snes, m_lag_jacobian, m_lag_preconditioner, lagging);
+
   SolutionInfo info;
   int snes_total_it = 0;
   int ksp_total_it = 0;
@@ -1034,6 +1236,29 @@ void Blatter::update(const Inputs &inputs, bool full_update) {
     m_log->message(2, "Blatter solver: %s\n", SNESConvergedReasons[info.snes_reason]);
   }
 
+  // Safe fallback: start from the previous solution and re-build the Jacobian and the
+  // preconditioner every Newton iteration
+  if (extrapolated or lagging) {
+    if (lagging) {
+      m_log->message(2, "  Trying without lagging the Jacobian and the preconditioner\n");
+      set_lags(m_snes, 1, 1);
+    }
+
+    if (extrapolated) {
+      m_log->message(2, "  Trying the previous solution as the initial guess\n");
+      ierr = VecCopy(m_x_old, m_x); PISM_CHK(ierr, "VecCopy");
+    }
+
+    info = solve();
+    snes_total_it += info.snes_it;
+    ksp_total_it += info.ksp_it;
+
+    if (info.snes_reason > 0) {
+      goto bp_done;
+    }
+    m_log->message(2, "Blatter solver: %s\n", SNESConvergedReasons[info.snes_reason]);
+  }
+
   if (m_ksp_use_ew and norm > 0.0) {
     m_log->message(2,"  Trying without the Eisenstat-Walker method of adjusting solver tolerances\n");
 
@@ -1076,6 +1301,13 @@ void Blatter::update(const Inputs &inputs, bool full_update) {
   throw RuntimeError(PISM_ERROR_LOCATION, "Blatter solver failed");
 
  bp_done:
+  if (new_time_step) {
+    m_n_accepted = 2;
+  } else if (m_n_accepted == 0) {
+    m_n_accepted = 1;
+  }
+  m_t_last = t;
+
   // report the total number of iterations
   m_log->message(2,
                  "Blatter solver: %s. Done.\n"
@@ -1207,5 +1439,12 @@ std::shared_ptr<array::Array3D> Blatter::velocity_v_sigma() const {
   return m_v_sigma;
 }
 
+/*!
+ * Returns the SNES solver (used in regression tests to access Jacobians).
+ */
+::SNES Blatter::snes() const {
+  return m_snes;
+}
+
 } // end of namespace stressbalance
 } // end of namespace pism
@@ -19,10 +19,14 @@
 #ifndef PISM_BLATTER_H
 #define PISM_BLATTER_H
 
+#include <functional>
+#include <vector>
+
 #include "pism/stressbalance/ShallowStressBalance.hh"
 #include "pism/util/petscwrappers/SNES.hh"
 #include "pism/util/petscwrappers/DM.hh"
 #include "pism/util/petscwrappers/Vec.hh"
+#include "pism/util/petscwrappers/Mat.hh"
 #include "pism/util/fem/FEM.hh"
 #include "pism/util/fem/Element.hh"
 
@@ -45,6 +49,8 @@ public:
   std::shared_ptr<array::Array3D> velocity_u_sigma() const;
   std::shared_ptr<array::Array3D> velocity_v_sigma() const;
 
+  ::SNES snes() const;
+
   /*!
    * 2D input parameters
    */
@@ -74,9 +80,45 @@ protected:
   petsc::Vec m_x;
   // storage for the old solution during parameter continuation
   petsc::Vec m_x_old;
+  // solution at the time m_t_previous (used to extrapolate the initial guess)
+  petsc::Vec m_x_previous;
+  // number of accepted solutions available to extrapolate from (0, 1 or 2)
+  int m_n_accepted;
+  // model times corresponding to the last accepted solution and m_x_previous
+  double m_t_last, m_t_previous;
+  // True if the initial guess is extrapolated in time
+  bool m_extrapolate;
   // solver
   petsc::SNES m_snes;
 
+  // True if the Jacobian on the finest multigrid level is applied element by element
+  // instead of being assembled
+  bool m_matrix_free;
+  // matrix-free Jacobian (MATSHELL) on the finest multigrid level
+  petsc::Mat m_J_mf;
+
+  // Linearization of the "main" part of the system at a quadrature point
+  struct LinearizationF {
+    // effective viscosity (including the enhancement factor) and its derivative with
+    // respect to the second invariant of the strain rate
+    double eta, deta;
+    // strain rate terms: 2 u_x + v_y, 2 v_y + u_x, u_y + v_x, u_z, v_z
+    double a, b, c, u_z, v_z;
+  };
+
+  // Linearization of the basal boundary condition at a quadrature point
+  struct LinearizationBasal {
+    // basal drag coefficient and its derivative
+    double beta, dbeta;
+    // basal velocity
+    Vector2d u;
+  };
+
+  // linearization at quadrature points of all elements with at least one owned node at
+  // the iterate used by m_J_mf
+  std::vector<LinearizationF> m_mf_f;
+  std::vector<LinearizationBasal> m_mf_basal;
+
   array::Array2D<Parameters> m_parameters;
 
   // Scaling of quadrature weights (note: this does not seem to matter).
@@ -103,6 +145,9 @@ protected:
   // True if the Eisenstat-Walker method of adjusting linear solver tolerances is enabled.
   bool m_ksp_use_ew;
 
+  // Jacobian and preconditioner lags (1 means "re-build every Newton iteration")
+  PetscInt m_lag_jacobian, m_lag_preconditioner;
+
   static const int m_Nq = 100;
   static const int m_n_work = 9;
 
@@ -150,16 +195,64 @@ protected:
 
   void jacobian_dirichlet(const DMDALocalInfo &info, Parameters **P, Mat J);
 
-  virtual void jacobian_f(const fem::Q1Element3 &element,
-                          const Vector2d *u_nodal,
-                          const double *B_nodal,
-                          double K[2 * fem::q13d::n_chi][2 * fem::q13d::n_chi]);
+  void jacobian_elements(const DMDALocalInfo &info,
+                         const std::function<void(const fem::Q1Element3 &element,
+                                                  const fem::Q1Element3Face *face,
+                                                  const double *tauc,
+                                                  const double *floatation)> &f);
 
-  virtual void jacobian_basal(const fem::Q1Element3Face &face,
-                              const double *tauc_nodal,
-                              const double *f_nodal,
-                              const Vector2d *u_nodal,
-                              double K[2 * fem::q13d::n_chi][2 * fem::q13d::n_chi]);
+  void jacobian_linearization(const DMDALocalInfo &info, const Vector2d ***X,
+                              const std::function<void(const fem::Q1Element3 &element,
+                                                       const fem::Q1Element3Face *face,
+                                                       const LinearizationF *L_f,
+                                                       const LinearizationBasal *L_basal)> &f);
+
+  void jacobian_mf_update(const DMDALocalInfo &info, const Vector2d ***X, Mat J);
+
+  void jacobian_mf_apply(Vec x, Vec y);
+
+  static PetscErrorCode jacobian_mf_mult_callback(Mat A, Vec x, Vec y);
+
+  static PetscErrorCode jacobian_mf_diagonal_callback(Mat A, Vec d);
+
+  PetscErrorCode setup_matrix_free(const std::string &prefix, int mg_levels);
+
+  virtual void linearization_f(const fem::Q1Element3 &element,
+                               const Vector2d *u_nodal,
+                               const double *B_nodal,
+                               LinearizationF *result);
+
+  virtual void linearization_basal(const fem::Q1Element3Face &face,
+                                   const double *tauc_nodal,
+                                   const double *f_nodal,
+                                   const Vector2d *u_nodal,
+                                   LinearizationBasal *result);
+
+  void jacobian_f(const fem::Q1Element3 &element,
+                  const LinearizationF *L,
+                  double K[2 * fem::q13d::n_chi][2 * fem::q13d::n_chi]);
+
+  void jacobian_f_apply(const fem::Q1Element3 &element,
+                        const LinearizationF *L,
+                        const Vector2d *x_nodal,
+                        Vector2d *y_nodal);
+
+  void jacobian_f_diagonal(const fem::Q1Element3 &element,
+                           const LinearizationF *L,
+                           Vector2d *y_nodal);
+
+  void jacobian_basal(const fem::Q1Element3Face &face,
+                      const LinearizationBasal *L,
+                      double K[2 * fem::q13d::n_chi][2 * fem::q13d::n_chi]);
+
+  void jacobian_basal_apply(const fem::Q1Element3Face &face,
+                            const LinearizationBasal *L,
+                            const Vector2d *x_nodal,
+                            Vector2d *y_nodal);
+
+  void jacobian_basal_diagonal(const fem::Q1Element3Face &face,
+                               const LinearizationBasal *L,
+                               Vector2d *y_nodal);
 
   void compute_residual(DMDALocalInfo *info, const Vector2d ***X, Vector2d ***R);
 
@@ -215,6 +308,8 @@ protected:
 
   void set_initial_guess(const array::Array3D &u_sigma, const array::Array3D &v_sigma);
 
+  bool extrapolate_initial_guess(double t);
+
   void copy_solution();
 
   void compute_averaged_velocity(array::Vector &result);
@@ -31,14 +31,13 @@ namespace pism {
 namespace stressbalance {
 
 /*!
- * Computes the Jacobian contribution of the "main" part of the Blatter system.
+ * Computes the linearization of the "main" part of the Blatter system at quadrature
+ * points of an element (see jacobian_f()).
  */
-void Blatter::jacobian_f(const fem::Q1Element3 &element,
-                         const Vector2d *u_nodal,
-                         const double *B_nodal,
-                         double K[16][16]) {
-  int Nk = fem::q13d::n_chi;
-
+void Blatter::linearization_f(const fem::Q1Element3 &element,
+                              const Vector2d *u_nodal,
+                              const double *B_nodal,
+                              LinearizationF *result) {
   Vector2d
     *u   = m_work2[0],
     *u_x = m_work2[1],
@@ -50,10 +49,7 @@ void Blatter::jacobian_f(const fem::Q1Element3 &element,
   element.evaluate(u_nodal, u, u_x, u_y, u_z);
   element.evaluate(B_nodal, B);
 
-  // loop over all quadrature points
   for (unsigned int q = 0; q < element.n_pts(); ++q) {
-    auto W = element.weight(q) / m_scaling;
-
     double
       ux = u_x[q].u,
       uy = u_y[q].u,
@@ -69,8 +65,26 @@ void Blatter::jacobian_f(const fem::Q1Element3 &element,
     m_flow_law->effective_viscosity(B[q], gamma, m_viscosity_eps, &eta, &deta);
 
     // add the enhancement factor
-    eta *= m_E_viscosity;
-    deta *= m_E_viscosity;
+    result[q] = {eta * m_E_viscosity, deta * m_E_viscosity,
+                 2.0 * ux + vy, 2.0 * vy + ux, uy + vx, uz, vz};
+  }
+}
+
+/*!
+ * Computes the Jacobian contribution of the "main" part of the Blatter system.
+ *
+ * `L` contains the linearization computed by linearization_f().
+ */
+void Blatter::jacobian_f(const fem::Q1Element3 &element,
+                         const LinearizationF *L,
+                         double K[16][16]) {
+  int Nk = fem::q13d::n_chi;
+
+  // loop over all quadrature points
+  for (unsigned int q = 0; q < element.n_pts(); ++q) {
+    auto W = element.weight(q) / m_scaling;
+
+    const auto &l = L[q];
 
     // loop over test and trial functions, computing the upper-triangular part of
     // the element Jacobian
@@ -81,19 +95,19 @@ void Blatter::jacobian_f(const fem::Q1Element3 &element,
 
         // partial derivatives of gamma with respect to u_i and v_i
         double
-          gamma_u = 2.0 * ux * phi.dx + vy * phi.dx + 0.5 * phi.dy * (uy + vx) + 0.5 * uz * phi.dz,
-          gamma_v = 2.0 * vy * phi.dy + ux * phi.dy + 0.5 * phi.dx * (uy + vx) + 0.5 * vz * phi.dz;
+          gamma_u = l.a * phi.dx + 0.5 * (l.c * phi.dy + l.u_z * phi.dz),
+          gamma_v = l.b * phi.dy + 0.5 * (l.c * phi.dx + l.v_z * phi.dz);
 
         // partial derivatives of eta with respect to u_i and v_i, using chain rule
         double
-          eta_u = deta * gamma_u,
-          eta_v = deta * gamma_v;
+          eta_u = l.deta * gamma_u,
+          eta_v = l.deta * gamma_v;
 
         // F_u = grad(psi) . (4ux + 2vy, uy + vx, uz) and
         // F_v = grad(psi) . (uy + vx, 4vy + 2ux, vz)
         double
-          F_u = (psi.dx * (4.0 * ux + 2.0 * vy) + psi.dy * (uy + vx) + psi.dz * uz),
-          F_v = (psi.dx * (uy + vx) + psi.dy * (4.0 * vy + 2.0 * ux) + psi.dz * vz);
+          F_u = (psi.dx * 2.0 * l.a + psi.dy * l.c + psi.dz * l.u_z),
+          F_v = (psi.dx * l.c + psi.dy * 2.0 * l.b + psi.dz * l.v_z);
 
         // partial derivatives of F_u with respect to u_i and v_i
         double
@@ -105,10 +119,10 @@ void Blatter::jacobian_f(const fem::Q1Element3 &element,
           F_vu = 2.0 * psi.dy * phi.dx + psi.dx * phi.dy,
           F_vv = 4.0 * psi.dy * phi.dy + psi.dx * phi.dx + psi.dz * phi.dz;
 
-        K[t * 2 + 0][s * 2 + 0] += W * (eta * F_uu + eta_u * F_u);
-        K[t * 2 + 0][s * 2 + 1] += W * (eta * F_uv + eta_v * F_u);
-        K[t * 2 + 1][s * 2 + 0] += W * (eta * F_vu + eta_u * F_v);
-        K[t * 2 + 1][s * 2 + 1] += W * (eta * F_vv + eta_v * F_v);
+        K[t * 2 + 0][s * 2 + 0] += W * (l.eta * F_uu + eta_u * F_u);
+        K[t * 2 + 0][s * 2 + 1] += W * (l.eta * F_uv + eta_v * F_u);
+        K[t * 2 + 1][s * 2 + 0] += W * (l.eta * F_vu + eta_u * F_v);
+        K[t * 2 + 1][s * 2 + 1] += W * (l.eta * F_vv + eta_v * F_v);
       }
     }
   } // end of the loop over q
@@ -116,17 +130,98 @@ void Blatter::jacobian_f(const fem::Q1Element3 &element,
 }
 
 /*!
- * Compute the Jacobian contribution of the basal boundary condition.
- *
- * This method implements basal sliding.
+ * Computes the product of the element Jacobian of the "main" part of the Blatter system
+ * (see jacobian_f()) and `x_nodal`, adding it to `y_nodal`.
  */
-void Blatter::jacobian_basal(const fem::Q1Element3Face &face,
-                             const double *tauc_nodal,
-                             const double *f_nodal,
-                             const Vector2d *u_nodal,
-                             double K[16][16]) {
+void Blatter::jacobian_f_apply(const fem::Q1Element3 &element,
+                               const LinearizationF *L,
+                               const Vector2d *x_nodal,
+                               Vector2d *y_nodal) {
+  int Nk = fem::q13d::n_chi;
+
+  Vector2d
+    *x   = m_work2[0],
+    *x_x = m_work2[1],
+    *x_y = m_work2[2],
+    *x_z = m_work2[3];
+
+  element.evaluate(x_nodal, x, x_x, x_y, x_z);
+
+  for (unsigned int q = 0; q < element.n_pts(); ++q) {
+    auto W = element.weight(q) / m_scaling;
+
+    const auto &l = L[q];
+
+    // partial derivatives of x
+    double
+      ux = x_x[q].u,
+      uy = x_y[q].u,
+      uz = x_z[q].u,
+      vx = x_x[q].v,
+      vy = x_y[q].v,
+      vz = x_z[q].v;
+
+    // directional derivative of gamma
+    double gamma_x = l.a * ux + l.b * vy + 0.5 * (l.c * (uy + vx) + l.u_z * uz + l.v_z * vz);
+
+    for (int t = 0; t < Nk; ++t) {
+      auto psi = element.chi(q, t);
+
+      double
+        F_u = (psi.dx * 2.0 * l.a + psi.dy * l.c + psi.dz * l.u_z),
+        F_v = (psi.dx * l.c + psi.dy * 2.0 * l.b + psi.dz * l.v_z);
+
+      y_nodal[t].u += W * (l.eta * (psi.dx * (4.0 * ux + 2.0 * vy) +
+                                    psi.dy * (uy + vx) +
+                                    psi.dz * uz) +
+                           l.deta * gamma_x * F_u);
+      y_nodal[t].v += W * (l.eta * (psi.dx * (uy + vx) +
+                                    psi.dy * (4.0 * vy + 2.0 * ux) +
+                                    psi.dz * vz) +
+                           l.deta * gamma_x * F_v);
+    }
+  }
+}
+
+/*!
+ * Computes the diagonal of the element Jacobian of the "main" part of the Blatter system
+ * (see jacobian_f()), adding it to `y_nodal`.
+ */
+void Blatter::jacobian_f_diagonal(const fem::Q1Element3 &element,
+                                  const LinearizationF *L,
+                                  Vector2d *y_nodal) {
   int Nk = fem::q13d::n_chi;
 
+  for (unsigned int q = 0; q < element.n_pts(); ++q) {
+    auto W = element.weight(q) / m_scaling;
+
+    const auto &l = L[q];
+
+    for (int t = 0; t < Nk; ++t) {
+      auto psi = element.chi(q, t);
+
+      double
+        gamma_u = l.a * psi.dx + 0.5 * (l.c * psi.dy + l.u_z * psi.dz),
+        gamma_v = l.b * psi.dy + 0.5 * (l.c * psi.dx + l.v_z * psi.dz);
+
+      // note that F_u = 2 gamma_u and F_v = 2 gamma_v if phi == psi
+      y_nodal[t].u += W * (l.eta * (4.0 * psi.dx * psi.dx + psi.dy * psi.dy + psi.dz * psi.dz) +
+                           2.0 * l.deta * gamma_u * gamma_u);
+      y_nodal[t].v += W * (l.eta * (4.0 * psi.dy * psi.dy + psi.dx * psi.dx + psi.dz * psi.dz) +
+                           2.0 * l.deta * gamma_v * gamma_v);
+    }
+  }
+}
+
+/*!
+ * Computes the linearization of the basal boundary condition at quadrature points of a
+ * face (see jacobian_basal()).
+ */
+void Blatter::linearization_basal(const fem::Q1Element3Face &face,
+                                  const double *tauc_nodal,
+                                  const double *f_nodal,
+                                  const Vector2d *u_nodal,
+                                  LinearizationBasal *result) {
   Vector2d *u = m_work2[0];
 
   double
@@ -138,14 +233,35 @@ void Blatter::jacobian_basal(const fem::Q1Element3Face &face,
   face.evaluate(f_nodal, floatation);
 
   for (unsigned int q = 0; q < face.n_pts(); ++q) {
-    auto W = face.weight(q) / m_scaling;
-
     bool grounded = floatation[q] <= 0.0;
     double beta = 0.0, dbeta = 0.0;
     if (grounded) {
       m_basal_sliding_law->drag_with_derivative(tauc[q], u[q].u, u[q].v, &beta, &dbeta);
     }
 
+    result[q] = {beta, dbeta, u[q]};
+  }
+}
+
+/*!
+ * Compute the Jacobian contribution of the basal boundary condition.
+ *
+ * This method implements basal sliding. `L` contains the linearization computed by
+ * linearization_basal().
+ */
+void Blatter::jacobian_basal(const fem::Q1Element3Face &face,
+                             const LinearizationBasal *L,
+                             double K[16][16]) {
+  int Nk = fem::q13d::n_chi;
+
+  for (unsigned int q = 0; q < face.n_pts(); ++q) {
+    auto W = face.weight(q) / m_scaling;
+
+    double
+      beta  = L[q].beta,
+      dbeta = L[q].dbeta;
+    auto u = L[q].u;
+
     // loop over all test functions
     for (int t = 0; t < Nk; ++t) {
       auto psi = face.chi(q, t);
@@ -154,15 +270,69 @@ void Blatter::jacobian_basal(const fem::Q1Element3Face &face,
 
         double p = psi * phi;
 
-        K[t * 2 + 0][s * 2 + 0] += W * p * (beta + dbeta * u[q].u * u[q].u);
-        K[t * 2 + 0][s * 2 + 1] += W * p * dbeta * u[q].u * u[q].v;
-        K[t * 2 + 1][s * 2 + 0] += W * p * dbeta * u[q].v * u[q].u;
-        K[t * 2 + 1][s * 2 + 1] += W * p * (beta + dbeta * u[q].v * u[q].v);
+        K[t * 2 + 0][s * 2 + 0] += W * p * (beta + dbeta * u.u * u.u);
+        K[t * 2 + 0][s * 2 + 1] += W * p * dbeta * u.u * u.v;
+        K[t * 2 + 1][s * 2 + 0] += W * p * dbeta * u.v * u.u;
+        K[t * 2 + 1][s * 2 + 1] += W * p * (beta + dbeta * u.v * u.v);
       }
     }
   }
 }
 
+/*!
+ * Computes the product of the element Jacobian of the basal boundary condition (see
+ * jacobian_basal()) and `x_nodal`, adding it to `y_nodal`.
+ */
+void Blatter::jacobian_basal_apply(const fem::Q1Element3Face &face,
+                                   const LinearizationBasal *L,
+                                   const Vector2d *x_nodal,
+                                   Vector2d *y_nodal) {
+  int Nk = fem::q13d::n_chi;
+
+  Vector2d *x = m_work2[0];
+
+  face.evaluate(x_nodal, x);
+
+  for (unsigned int q = 0; q < face.n_pts(); ++q) {
+    auto W = face.weight(q) / m_scaling;
+
+    auto u = L[q].u;
+    double u_x = u.u * x[q].u + u.v * x[q].v;
+
+    Vector2d r = L[q].beta * x[q] + (L[q].dbeta * u_x) * u;
+
+    for (int t = 0; t < Nk; ++t) {
+      y_nodal[t] += (W * face.chi(q, t)) * r;
+    }
+  }
+}
+
+/*!
+ * Computes the diagonal of the element Jacobian of the basal boundary condition (see
+ * jacobian_basal()), adding it to `y_nodal`.
+ */
+void Blatter::jacobian_basal_diagonal(const fem::Q1Element3Face &face,
+                                      const LinearizationBasal *L,
+                                      Vector2d *y_nodal) {
+  int Nk = fem::q13d::n_chi;
+
+  for (unsigned int q = 0; q < face.n_pts(); ++q) {
+    auto W = face.weight(q) / m_scaling;
+
+    double
+      beta  = L[q].beta,
+      dbeta = L[q].dbeta;
+    auto u = L[q].u;
+
+    for (int t = 0; t < Nk; ++t) {
+      auto psi = face.chi(q, t);
+
+      y_nodal[t] += (W * psi * psi) * Vector2d(beta + dbeta * u.u * u.u,
+                                               beta + dbeta * u.v * u.v);
+    }
+  }
+}
+
 /*!
  * Set the Jacobian to identity at Dirichlet nodes.
  */
@@ -195,28 +365,20 @@ void Blatter::jacobian_dirichlet(const DMDALocalInfo &info, Parameters **P, Mat
 }
 
 /*!
- * Compute the Jacobian matrix.
+ * Loop over all the elements that have at least one owned node.
+ *
+ * Calls `f(element, face, tauc, floatation)` for each element. Here `element` is
+ * initialized using the geometry of the current element and rows and columns
+ * corresponding to Dirichlet nodes are marked as "invalid". `face` is the basal face of
+ * the current element if it is at the base of the ice and NULL otherwise. `tauc` and
+ * `floatation` contain nodal values of the basal yield stress and the floatation function
+ * (only if `face` is not NULL).
  */
-void Blatter::compute_jacobian(DMDALocalInfo *petsc_info,
-                               const Vector2d ***X, Mat A, Mat J) {
-  auto info = grid_transpose(*petsc_info);
-
-  // Zero out the Jacobian in preparation for updating it.
-  PetscErrorCode ierr = MatZeroEntries(J);
-  PISM_CHK(ierr, "MatZeroEntries");
-
-  ierr = MatSetOption(A, MAT_SUBSET_OFF_PROC_ENTRIES, PETSC_TRUE);
-  PISM_CHK(ierr, "MatSetOption");
-
-  ierr = MatSetOption(J, MAT_NEW_NONZERO_LOCATION_ERR, PETSC_TRUE);
-  PISM_CHK(ierr, "MatSetOption");
-
-  ierr = MatSetOption(J, MAT_SYMMETRIC, PETSC_TRUE);
-  PISM_CHK(ierr, "MatSetOption");
-
-  ierr = PetscObjectSetName((PetscObject)J, "bp_jacobian");
-  PISM_CHK(ierr, "PetscObjectSetName");
-
+void Blatter::jacobian_elements(const DMDALocalInfo &info,
+                                const std::function<void(const fem::Q1Element3 &element,
+                                                         const fem::Q1Element3Face *face,
+                                                         const double *tauc,
+                                                         const double *floatation)> &f) {
   // Stencil width of 1 is not very important, but if info.sw > 1 will lead to more
   // redundant computation (we would be looping over elements that don't contribute to any
   // owned nodes).
@@ -241,18 +403,9 @@ void Blatter::compute_jacobian(DMDALocalInfo *petsc_info,
   // scalar quantities
   double z[Nk];
   double floatation[Nk], bottom_elevation[Nk], ice_thickness[Nk];
-  double B_nodal[Nk], basal_yield_stress[Nk];
+  double basal_yield_stress[Nk];
   int node_type[Nk];
 
-  // 2D vector quantities
-  Vector2d velocity[Nk];
-
-  // note: we use info.da below because ice hardness is on the grid corresponding to the
-  // current multigrid level
-  //
-  // FIXME: This communicates ghosts of ice hardness
-  DataAccess<double***> hardness(info.da, 3, GHOSTED);
-
   array::AccessScope list(m_parameters);
   auto *P = m_parameters.array();
 
@@ -275,11 +428,6 @@ void Blatter::compute_jacobian(DMDALocalInfo *petsc_info,
 
       for (int k = info.gzs; k < info.gzs + info.gzm - 1; k++) {
 
-        // Element-local Jacobian matrix (there are Nk vector valued degrees of freedom
-        // per element, for a total of Nk*Nk = 64 entries in the local Jacobian.
-        double K[2*Nk][2*Nk];
-        memset(K, 0, sizeof(K));
-
         // Compute coordinates of the nodes of this element and fetch node types.
         for (int n = 0; n < Nk; ++n) {
           auto I = element.local_to_global(i, j, k, n);
@@ -291,24 +439,16 @@ void Blatter::compute_jacobian(DMDALocalInfo *petsc_info,
         // points on this physical element
         element.reset(i, j, k, z);
 
-        // Get nodal values of ice velocity.
-        {
-          element.nodal_values(X, velocity);
-
-          // Don't contribute to Dirichlet nodes
-          for (int n = 0; n < Nk; ++n) {
-            auto I = element.local_to_global(n);
-            if (dirichlet_node(info, I)) {
-              element.mark_row_invalid(n);
-              element.mark_col_invalid(n);
-              velocity[n] = u_bc(element.x(n), element.y(n), element.z(n));
-            }
+        // Don't contribute to Dirichlet nodes
+        for (int n = 0; n < Nk; ++n) {
+          auto I = element.local_to_global(n);
+          if (dirichlet_node(info, I)) {
+            element.mark_row_invalid(n);
+            element.mark_col_invalid(n);
           }
         }
 
-        element.nodal_values((double***)hardness, B_nodal);
-
-        jacobian_f(element, velocity, B_nodal, K);
+        fem::Q1Element3Face *face = nullptr;
 
         // basal boundary
         if (k == 0) {
@@ -319,30 +459,137 @@ void Blatter::compute_jacobian(DMDALocalInfo *petsc_info,
             floatation[n]         = P[I.j][I.i].floatation;
           }
 
-          fem::Q1Element3Face *face = grounding_line(floatation) ? &m_face100 : &m_face4;
+          face = grounding_line(floatation) ? &m_face100 : &m_face4;
 
           face->reset(fem::q13d::FACE_BOTTOM, z);
-
-          jacobian_basal(*face, basal_yield_stress, floatation, velocity, K);
         }
 
-        // fill the lower-triangular part of the element Jacobian using the fact that J is
-        // symmetric
-        for (int t = 0; t < Nk; ++t) {
-          for (int s = 0; s < t; ++s) {
-            K[t * 2 + 0][s * 2 + 0] = K[s * 2 + 0][t * 2 + 0];
-            K[t * 2 + 1][s * 2 + 0] = K[s * 2 + 0][t * 2 + 1];
-            K[t * 2 + 0][s * 2 + 1] = K[s * 2 + 1][t * 2 + 0];
-            K[t * 2 + 1][s * 2 + 1] = K[s * 2 + 1][t * 2 + 1];
-          }
-        }
+        f(element, face, basal_yield_stress, floatation);
+      } // end of the loop over k
+    } // end of the loop over i
+  } // end of the loop over j
+}
+
+/*!
+ * Compute the linearization of the Blatter system at the iterate `X` at quadrature points
+ * of all the elements that have at least one owned node.
+ *
+ * Calls `f(element, face, L_f, L_basal)` for each element, where `L_f` is computed by
+ * linearization_f() and `L_basal` by linearization_basal() (only if `face` is not NULL).
+ */
+void Blatter::jacobian_linearization(const DMDALocalInfo &info, const Vector2d ***X,
+                                     const std::function<void(const fem::Q1Element3 &element,
+                                                              const fem::Q1Element3Face *face,
+                                                              const LinearizationF *L_f,
+                                                              const LinearizationBasal *L_basal)> &f) {
+  const int Nk = fem::q13d::n_chi;
+
+  // nodal values
+  double B_nodal[Nk];
+  Vector2d velocity[Nk];
+
+  // linearization at quadrature points
+  LinearizationF L_f[m_Nq];
+  LinearizationBasal L_basal[m_Nq];
+
+  // note: we use info.da below because ice hardness is on the grid corresponding to the
+  // current multigrid level
+  //
+  // FIXME: This communicates ghosts of ice hardness
+  DataAccess<double***> hardness(info.da, 3, GHOSTED);
+
+  jacobian_elements(info,
+                    [&](const fem::Q1Element3 &element,
+                        const fem::Q1Element3Face *face,
+                        const double *tauc,
+                        const double *floatation) {
+    // Get nodal values of ice velocity.
+    element.nodal_values(X, velocity);
+    for (int n = 0; n < Nk; ++n) {
+      auto I = element.local_to_global(n);
+      if (dirichlet_node(info, I)) {
+        velocity[n] = u_bc(element.x(n), element.y(n), element.z(n));
+      }
+    }
+
+    element.nodal_values((double***)hardness, B_nodal);
+
+    linearization_f(element, velocity, B_nodal, L_f);
+
+    if (face != nullptr) {
+      linearization_basal(*face, tauc, floatation, velocity, L_basal);
+    }
+
+    f(element, face, L_f, L_basal);
+  });
+}
+
+/*!
+ * Compute the Jacobian matrix.
+ */
+void Blatter::compute_jacobian(DMDALocalInfo *petsc_info,
+                               const Vector2d ***X, Mat A, Mat J) {
+  auto info = grid_transpose(*petsc_info);
+
+  if (m_matrix_free and J == m_J_mf) {
+    // The Jacobian on the finest multigrid level is not assembled: just save the
+    // linearization at the current iterate.
+    jacobian_mf_update(info, X, J);
+    return;
+  }
+
+  // Zero out the Jacobian in preparation for updating it.
+  PetscErrorCode ierr = MatZeroEntries(J);
+  PISM_CHK(ierr, "MatZeroEntries");
+
+  ierr = MatSetOption(A, MAT_SUBSET_OFF_PROC_ENTRIES, PETSC_TRUE);
+  PISM_CHK(ierr, "MatSetOption");
+
+  ierr = MatSetOption(J, MAT_NEW_NONZERO_LOCATION_ERR, PETSC_TRUE);
+  PISM_CHK(ierr, "MatSetOption");
+
+  ierr = MatSetOption(J, MAT_SYMMETRIC, PETSC_TRUE);
+  PISM_CHK(ierr, "MatSetOption");
+
+  ierr = PetscObjectSetName((PetscObject)J, "bp_jacobian");
+  PISM_CHK(ierr, "PetscObjectSetName");
+
+  const int Nk = fem::q13d::n_chi;
+
+  jacobian_linearization(info, X,
+                         [this, J](const fem::Q1Element3 &element,
+                                   const fem::Q1Element3Face *face,
+                                   const LinearizationF *L_f,
+                                   const LinearizationBasal *L_basal) {
+    // Element-local Jacobian matrix (there are Nk vector valued degrees of freedom
+    // per element, for a total of Nk*Nk = 64 entries in the local Jacobian.
+    double K[2*Nk][2*Nk];
+    memset(K, 0, sizeof(K));
+
+    jacobian_f(element, L_f, K);
+
+    if (face != nullptr) {
+      jacobian_basal(*face, L_basal, K);
+    }
+
+    // fill the lower-triangular part of the element Jacobian using the fact that J is
+    // symmetric
+    for (int t = 0; t < Nk; ++t) {
+      for (int s = 0; s < t; ++s) {
+        K[t * 2 + 0][s * 2 + 0] = K[s * 2 + 0][t * 2 + 0];
+        K[t * 2 + 1][s * 2 + 0] = K[s * 2 + 0][t * 2 + 1];
+        K[t * 2 + 0][s * 2 + 1] = K[s * 2 + 1][t * 2 + 0];
+        K[t * 2 + 1][s * 2 + 1] = K[s * 2 + 1][t * 2 + 1];
+      }
+    }
 
-        element.add_contribution(&K[0][0], J);
-      } // end of the loop over i
-    } // end of the loop over j
-  } // end of the loop over k
+    element.add_contribution(&K[0][0], J);
+  });
 
-  jacobian_dirichlet(info, P, J);
+  {
+    array::AccessScope list(m_parameters);
+    jacobian_dirichlet(info, m_parameters.array(), J);
+  }
 
   ierr = MatAssemblyBegin(J, MAT_FINAL_ASSEMBLY); PISM_CHK(ierr, "MatAssemblyBegin");
   ierr = MatAssemblyEnd(J, MAT_FINAL_ASSEMBLY); PISM_CHK(ierr, "MatAssemblyEnd");
@@ -352,6 +599,170 @@ void Blatter::compute_jacobian(DMDALocalInfo *petsc_info,
   }
 }
 
+/*!
+ * Compute and store the linearization of the system at the iterate `X` used by the
+ * matrix-free Jacobian `J`.
+ *
+ * This is the only place where the flow law and the sliding law are evaluated: products
+ * with `J` use stored values (see jacobian_mf_apply()).
+ */
+void Blatter::jacobian_mf_update(const DMDALocalInfo &info, const Vector2d ***X, Mat J) {
+  m_mf_f.clear();
+  m_mf_basal.clear();
+
+  jacobian_linearization(info, X,
+                         [this](const fem::Q1Element3 &element,
+                                const fem::Q1Element3Face *face,
+                                const LinearizationF *L_f,
+                                const LinearizationBasal *L_basal) {
+    m_mf_f.insert(m_mf_f.end(), L_f, L_f + element.n_pts());
+
+    if (face != nullptr) {
+      m_mf_basal.insert(m_mf_basal.end(), L_basal, L_basal + face->n_pts());
+    }
+  });
+
+  // Increase the "state" of J to tell preconditioners that the operator changed.
+  PetscErrorCode ierr;
+  ierr = MatAssemblyBegin(J, MAT_FINAL_ASSEMBLY); PISM_CHK(ierr, "MatAssemblyBegin");
+  ierr = MatAssemblyEnd(J, MAT_FINAL_ASSEMBLY); PISM_CHK(ierr, "MatAssemblyEnd");
+}
+
+/*!
+ * Compute `y = J x` or the diagonal of `J` (if `x` is NULL) using the matrix-free
+ * Jacobian on the finest multigrid level.
+ *
+ * Uses the linearization stored by jacobian_mf_update(), shape functions and quadrature
+ * weights: the flow law and the sliding law are not evaluated here. The result is the
+ * same as the product of the assembled Jacobian and `x`.
+ */
+void Blatter::jacobian_mf_apply(Vec x, Vec y) {
+  PetscErrorCode ierr;
+
+  DMDALocalInfo petsc_info;
+  ierr = DMDAGetLocalInfo(m_da, &petsc_info); PISM_CHK(ierr, "DMDAGetLocalInfo");
+  auto info = grid_transpose(petsc_info);
+
+  const int Nk = fem::q13d::n_chi;
+
+  ierr = VecSet(y, 0.0); PISM_CHK(ierr, "VecSet");
+
+  // ghosted copy of x
+  Vec x_local = nullptr;
+  if (x != nullptr) {
+    ierr = DMGetLocalVector(m_da, &x_local); PISM_CHK(ierr, "DMGetLocalVector");
+    ierr = DMGlobalToLocalBegin(m_da, x, INSERT_VALUES, x_local);
+    PISM_CHK(ierr, "DMGlobalToLocalBegin");
+    ierr = DMGlobalToLocalEnd(m_da, x, INSERT_VALUES, x_local);
+    PISM_CHK(ierr, "DMGlobalToLocalEnd");
+  }
+
+  Vector2d ***X = nullptr, ***Y = nullptr;
+  ierr = DMDAVecGetArray(m_da, y, &Y); PISM_CHK(ierr, "DMDAVecGetArray");
+  if (x_local != nullptr) {
+    ierr = DMDAVecGetArray(m_da, x_local, &X); PISM_CHK(ierr, "DMDAVecGetArray");
+  }
+
+  // positions of the linearization of the current element in m_mf_f and m_mf_basal
+  size_t n_f = 0, n_basal = 0;
+
+  jacobian_elements(info,
+                    [&](const fem::Q1Element3 &element,
+                        const fem::Q1Element3Face *face,
+                        const double * /* tauc (unused) */,
+                        const double * /* floatation (unused) */) {
+    Vector2d x_nodal[Nk], y_nodal[Nk];
+
+    for (int n = 0; n < Nk; ++n) {
+      y_nodal[n] = 0.0;
+
+      if (X != nullptr) {
+        auto I = element.local_to_global(n);
+        // Dirichlet columns are excluded from the Jacobian: use zeros
+        bool dirichlet = dirichlet_node(info, I);
+        x_nodal[n] = dirichlet ? Vector2d(0.0, 0.0) : X[I.j][I.i][I.k]; // STORAGE_ORDER
+      }
+    }
+
+    assert(n_f + element.n_pts() <= m_mf_f.size());
+    const auto *L_f = &m_mf_f[n_f];
+    n_f += element.n_pts();
+
+    if (X != nullptr) {
+      jacobian_f_apply(element, L_f, x_nodal, y_nodal);
+    } else {
+      jacobian_f_diagonal(element, L_f, y_nodal);
+    }
+
+    if (face != nullptr) {
+      assert(n_basal + face->n_pts() <= m_mf_basal.size());
+      const auto *L_basal = &m_mf_basal[n_basal];
+      n_basal += face->n_pts();
+
+      if (X != nullptr) {
+        jacobian_basal_apply(*face, L_basal, x_nodal, y_nodal);
+      } else {
+        jacobian_basal_diagonal(*face, L_basal, y_nodal);
+      }
+    }
+
+    // note: this skips Dirichlet rows and rows we don't own
+    element.add_contribution(y_nodal, Y);
+  });
+
+  assert(n_f == m_mf_f.size());
+  assert(n_basal == m_mf_basal.size());
+
+  // Dirichlet nodes: see jacobian_dirichlet()
+  {
+    array::AccessScope list(m_parameters);
+    auto *P = m_parameters.array();
+
+    for (int j = info.ys; j < info.ys + info.ym; j++) {
+      for (int i = info.xs; i < info.xs + info.xm; i++) {
+        for (int k = info.zs; k < info.zs + info.zm; k++) {
+          if ((int)P[j][i].node_type == NODE_EXTERIOR or dirichlet_node(info, {i, j, k})) {
+            // STORAGE_ORDER
+            Y[j][i][k] += (X != nullptr) ? X[j][i][k] : Vector2d(1.0, 1.0);
+          }
+        }
+      }
+    }
+  }
+
+  if (x_local != nullptr) {
+    ierr = DMDAVecRestoreArray(m_da, x_local, &X); PISM_CHK(ierr, "DMDAVecRestoreArray");
+    ierr = DMRestoreLocalVector(m_da, &x_local); PISM_CHK(ierr, "DMRestoreLocalVector");
+  }
+  ierr = DMDAVecRestoreArray(m_da, y, &Y); PISM_CHK(ierr, "DMDAVecRestoreArray");
+}
+
+PetscErrorCode Blatter::jacobian_mf_mult_callback(Mat A, Vec x, Vec y) {
+  Blatter *solver = nullptr;
+  PetscErrorCode ierr = MatShellGetContext(A, &solver); CHKERRQ(ierr);
+  try {
+    solver->jacobian_mf_apply(x, y);
+  } catch (...) {
+    MPI_Comm com = solver->grid()->com;
+    handle_fatal_errors(com);
+    SETERRQ(com, 1, "A PISM callback failed");
+  }
+  return 0;
+}
+
+PetscErrorCode Blatter::jacobian_mf_diagonal_callback(Mat A, Vec d) {
+  Blatter *solver = nullptr;
+  PetscErrorCode ierr = MatShellGetContext(A, &solver); CHKERRQ(ierr);
+  try {
+    solver->jacobian_mf_apply(nullptr, d);
+  } catch (...) {
+    MPI_Comm com = solver->grid()->com;
+    handle_fatal_errors(com);
+    SETERRQ(com, 1, "A PISM callback failed");
+  }
+  return 0;
+}
+
 PetscErrorCode Blatter::jacobian_callback(DMDALocalInfo *info,
                                           const Vector2d ***x,
                                           Mat A, Mat J,
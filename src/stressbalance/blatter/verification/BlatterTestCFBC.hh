@@ -56,11 +56,11 @@ private:
                       const Vector2d *u_nodal,
                       Vector2d *residual);
 
-  void jacobian_basal(const fem::Q1Element3Face &face,
-                      const double *tauc_nodal,
-                      const double *f_nodal,
-                      const Vector2d *u_nodal,
-                      double K[2 * fem::q13d::n_chi][2 * fem::q13d::n_chi]);
+  void linearization_basal(const fem::Q1Element3Face &face,
+                           const double *tauc_nodal,
+                           const double *f_nodal,
+                           const Vector2d *u_nodal,
+                           LinearizationBasal *result);
   double m_B;
   double m_g;
   double m_rho_i;
@@ -236,17 +236,18 @@ void BlatterTestHalfar::residual_basal(const fem::Q1Element3 &element,
   }
 }
 
-void BlatterTestHalfar::jacobian_basal(const fem::Q1Element3Face &face,
-                                       const double *tauc_nodal,
-                                       const double *f_nodal,
-                                       const Vector2d *u_nodal,
-                                       double K[2 * fem::q13d::n_chi][2 * fem::q13d::n_chi]) {
-  (void) face;
+void BlatterTestHalfar::linearization_basal(const fem::Q1Element3Face &face,
+                                            const double *tauc_nodal,
+                                            const double *f_nodal,
+                                            const Vector2d *u_nodal,
+                                            LinearizationBasal *result) {
   (void) tauc_nodal;
   (void) f_nodal;
   (void) u_nodal;
-  (void) K;
-  // empty: residual contribution from the basal boundary does not depend on ice velocity
+  // the residual contribution from the basal boundary does not depend on ice velocity
+  for (unsigned int q = 0; q < face.n_pts(); ++q) {
+    result[q] = {0.0, 0.0, {0.0, 0.0}};
+  }
 }
 
 } // end of namespace stressbalance
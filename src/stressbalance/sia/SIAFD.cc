@@ -16,6 +16,7 @@
 // along with PISM; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
+#include <algorithm> // std::fill_n
 #include <cstdlib>
 #include <cassert>
 
@@ -46,8 +47,6 @@ SIAFD::SIAFD(std::shared_ptr<const Grid> g)
       m_h_x(m_grid, "h_x"),
       m_h_y(m_grid, "h_y"),
       m_D(m_grid, "diffusivity"),
-      m_delta_0(m_grid, "delta_0", array::WITH_GHOSTS, m_grid->z()),
-      m_delta_1(m_grid, "delta_1", array::WITH_GHOSTS, m_grid->z()),
       m_work_3d_0(m_grid, "work_3d_0", array::WITH_GHOSTS, m_grid->z()),
       m_work_3d_1(m_grid, "work_3d_1", array::WITH_GHOSTS, m_grid->z()) {
   // bed smoother
@@ -137,8 +136,7 @@ void SIAFD::update(const array::Vector &sliding_velocity, const Inputs &inputs,
 
   profiling().begin("sia.flux");
   compute_diffusivity(full_update, *inputs.geometry, inputs.enthalpy, inputs.age, m_h_x, m_h_y,
-                      m_D);
-  compute_diffusive_flux(m_h_x, m_h_y, m_D, m_diffusive_flux);
+                      m_D, m_diffusive_flux);
   profiling().end("sia.flux");
 
   if (full_update) {
@@ -481,12 +479,16 @@ void SIAFD::surface_gradient_haseloff(const array::Scalar2 &ice_surface_elevatio
     } // end of "y-derivative, i-offset"
   }
 
-  h_x.update_ghosts();
-  h_y.update_ghosts();
+  // communicate ghosts of both components at the same time
+  h_x.update_ghosts_begin();
+  h_y.update_ghosts_begin();
+  h_x.update_ghosts_end();
+  h_y.update_ghosts_end();
 }
 
 
-//! \brief Compute the SIA diffusivity. If full_update, also store delta on the staggered grid.
+//! \brief Compute the SIA diffusivity and flux. If full_update, also compute I on the
+//! staggered grid.
 /*!
  * Recall that \f$ Q = -D \nabla h \f$ is the diffusive flux in the mass-continuity equation
  *
@@ -517,22 +519,32 @@ void SIAFD::surface_gradient_haseloff(const array::Scalar2 &ice_surface_elevatio
  * \f$F(z)\f$ (which is computationally expensive) in the horizontal ice
  * velocity (see compute_3d_horizontal_velocity()) computation.
  *
- * This method computes \f$D\f$ and stores \f$\delta\f$ in delta[0,1] if full_update is true.
+ * This method computes \f$D\f$ and the flux \f$Q\f$. If full_update is true it also
+ * computes
  *
- * The trapezoidal rule is used to approximate the integral.
+ * \f[ I(z) = \int_b^z\delta(s)ds \f]
+ *
+ * and stores it in work_3d[0,1] (see compute_3d_horizontal_velocity()).
+ *
+ * All these quantities are computed in one pass over staggered grid points: \f$\delta\f$
+ * is stored in a buffer containing one column and is not written to (and then read
+ * back from) a 3D field.
+ *
+ * The trapezoidal rule is used to approximate integrals.
  *
  * \param[in]  full_update the flag specitying if we're doing a "full" update.
  * \param[in]  h_x x-component of the surface gradient, on the staggered grid
  * \param[in]  h_y y-component of the surface gradient, on the staggered grid
  * \param[out] result diffusivity of the SIA flow
+ * \param[out] flux diffusive flux of the SIA flow
  */
 void SIAFD::compute_diffusivity(bool full_update, const Geometry &geometry,
                                 const array::Array3D *enthalpy, const array::Array3D *age,
                                 const array::Staggered1 &h_x, const array::Staggered1 &h_y,
-                                array::Staggered1 &result) {
+                                array::Staggered1 &result, array::Staggered1 &flux) {
   array::Scalar2 &thk_smooth = m_work_2d_0, &theta = m_work_2d_1;
 
-  array::Array3D *delta[] = { &m_delta_0, &m_delta_1 };
+  array::Array3D *I[] = { &m_work_3d_0, &m_work_3d_1 };
 
   result.set(0.0);
 
@@ -555,7 +567,7 @@ void SIAFD::compute_diffusivity(bool full_update, const Geometry &geometry,
   m_bed_smoother->smoothed_thk(geometry.ice_surface_elevation, geometry.ice_thickness,
                                geometry.cell_type, thk_smooth);
 
-  array::AccessScope list{ &result, &theta, &thk_smooth, &h_x, &h_y, enthalpy };
+  array::AccessScope list{ &result, &flux, &theta, &thk_smooth, &h_x, &h_y, enthalpy };
 
   if (use_age) {
     assert(age->stencil_width() >= 2);
@@ -563,14 +575,15 @@ void SIAFD::compute_diffusivity(bool full_update, const Geometry &geometry,
   }
 
   if (full_update) {
-    list.add({ delta[0], delta[1] });
-    assert(m_delta_0.stencil_width() >= 1);
-    assert(m_delta_1.stencil_width() >= 1);
+    list.add({ I[0], I[1] });
+    assert(I[0]->stencil_width() >= 1);
+    assert(I[1]->stencil_width() >= 1);
   }
 
   assert(theta.stencil_width() >= 2);
   assert(thk_smooth.stencil_width() >= 2);
   assert(result.stencil_width() >= 1);
+  assert(flux.stencil_width() >= 1);
   assert(h_x.stencil_width() >= 1);
   assert(h_y.stencil_width() >= 1);
   assert(enthalpy->stencil_width() >= 2);
@@ -578,14 +591,110 @@ void SIAFD::compute_diffusivity(bool full_update, const Geometry &geometry,
   const std::vector<double> &z = m_grid->z();
   const unsigned int Mx = m_grid->Mx(), My = m_grid->My(), Mz = m_grid->Mz();
 
-  std::vector<double> depth(Mz), stress(Mz), pressure(Mz), E(Mz), flow(Mz);
-  std::vector<double> delta_ij(Mz);
-  std::vector<double> A(Mz),
-      ice_grain_size(Mz, m_config->get_number("constants.ice.grain_size", "m"));
-  std::vector<double> e_factor(Mz, m_e_factor);
+  // Flow law evaluations are batched: inputs corresponding to up to `batch_size` staggered
+  // grid points are stored in contiguous arrays and passed to flow_n() at once. This
+  // amortizes the cost of a virtual call and lets flow laws vectorize their loops.
+  const unsigned int batch_size = 64, buffer_size = batch_size * Mz;
+
+  // a staggered grid point with inputs stored in the current batch
+  struct Point {
+    int i, j, ks;
+    // offset of the first value corresponding to this point in buffers below
+    unsigned int offset;
+    double thk, theta;
+  };
+  std::vector<Point> batch;
+  batch.reserve(batch_size);
+  unsigned int n_values = 0;
+
+  std::vector<double> depth(buffer_size), stress(buffer_size), pressure(buffer_size),
+      E(buffer_size), flow(buffer_size);
+  std::vector<double> ice_grain_size(buffer_size,
+                                     m_config->get_number("constants.ice.grain_size", "m"));
+  std::vector<double> e_factor(buffer_size, m_e_factor);
+  // delta and I in the current column
+  std::vector<double> delta_ij(Mz), I_ij(Mz), A(Mz);
 
   double D_max                 = 0.0;
   int high_diffusivity_counter = 0;
+
+  // evaluate the flow law for all points in the current batch and finish computing the
+  // diffusivity at these points
+  auto process_batch = [&](int o) {
+    m_flow_law->flow_n(stress.data(), E.data(), pressure.data(), ice_grain_size.data(),
+                       n_values, flow.data());
+
+    for (const auto &p : batch) {
+      const int i = p.i, j = p.j, ks = p.ks;
+      const double *P = &pressure[p.offset], *F = &flow[p.offset], *e = &e_factor[p.offset],
+                   *d = &depth[p.offset];
+
+      for (int k = 0; k <= ks; ++k) {
+        delta_ij[k] = e[k] * p.theta * 2.0 * P[k] * F[k];
+      }
+
+      double D = 0.0; // diffusivity for deformational SIA flow
+      {
+        for (int k = 1; k <= ks; ++k) {
+          // trapezoidal rule
+          const double dz = z[k] - z[k - 1];
+          D += 0.5 * dz * ((d[k] + dz) * delta_ij[k - 1] + d[k] * delta_ij[k]);
+        }
+        // finish off D with (1/2) dz (0 + (H-z[ks])*delta_ij[ks]), but dz=H-z[ks]:
+        const double dz = p.thk - z[ks];
+        D += 0.5 * dz * dz * delta_ij[ks];
+      }
+
+      // Override diffusivity at the edges of the domain. (At these
+      // locations PISM uses ghost cells *beyond* the boundary of
+      // the computational domain. This does not matter if the ice
+      // does not extend all the way to the domain boundary, as in
+      // whole-ice-sheet simulations. In a regional setup, though,
+      // this adjustment lets us avoid taking very small time-steps
+      // because of the possible thickness and bed elevation
+      // "discontinuities" at the boundary.)
+      {
+        if ((i < 0 or i >= (int)Mx - 1) and not(m_grid->periodicity() & grid::X_PERIODIC)) {
+          D = 0.0;
+        }
+        if ((j < 0 or j >= (int)My - 1) and not(m_grid->periodicity() & grid::Y_PERIODIC)) {
+          D = 0.0;
+        }
+      }
+
+      if (limit_diffusivity and D >= D_limit) {
+        D = D_limit;
+        high_diffusivity_counter += 1;
+      }
+
+      D_max = std::max(D_max, D);
+
+      result(i, j, o) = D;
+
+      flux(i, j, o) = -D * (o == 0 ? h_x(i, j, o) : h_y(i, j, o));
+
+      // if doing the full update, compute and store I:
+      if (full_update) {
+        // within the ice:
+        I_ij[0]          = 0.0;
+        double I_current = 0.0;
+        for (int k = 1; k <= ks; ++k) {
+          // trapezoidal rule
+          I_current += 0.5 * (z[k] - z[k - 1]) * (delta_ij[k - 1] + delta_ij[k]);
+          I_ij[k] = I_current;
+        }
+        // above the ice:
+        for (unsigned int k = ks + 1; k < Mz; ++k) {
+          I_ij[k] = I_current;
+        }
+        I[o]->set_column(i, j, I_ij.data());
+      }
+    }
+
+    batch.clear();
+    n_values = 0;
+  };
+
   for (int o = 0; o < 2; o++) {
     ParallelSection loop(m_grid->com);
     try {
@@ -601,21 +710,29 @@ void SIAFD::compute_diffusivity(bool full_update, const Geometry &geometry,
         // zero thickness case:
         if (thk == 0.0) {
           result(i, j, o) = 0.0;
+          flux(i, j, o)   = 0.0;
           if (full_update) {
-            delta[o]->set_column(i, j, 0.0);
+            I[o]->set_column(i, j, 0.0);
           }
           continue;
         }
 
         const int ks = m_grid->kBelowHeight(thk);
 
+        if (n_values + ks + 1 > buffer_size) {
+          process_batch(o);
+        }
+        const unsigned int offset = n_values;
+
         for (int k = 0; k <= ks; ++k) {
-          depth[k] = thk - z[k];
+          depth[offset + k] = thk - z[k];
         }
 
         // pressure added by the ice (i.e. pressure difference between the
         // current level and the top of the column)
-        m_EC->pressure(depth, ks, pressure); // FIXME issue #15
+        for (int k = 0; k <= ks; ++k) {
+          pressure[offset + k] = m_EC->pressure(depth[offset + k]); // FIXME issue #15
+        }
 
         if (use_age) {
           const double *age_ij     = age->get_column(i, j),
@@ -628,7 +745,7 @@ void SIAFD::compute_diffusivity(bool full_update, const Geometry &geometry,
           if (compute_grain_size_using_age) {
             for (int k = 0; k <= ks; ++k) {
               // convert age from seconds to years:
-              ice_grain_size[k] = gs_vostok(A[k] * m_seconds_per_year);
+              ice_grain_size[offset + k] = gs_vostok(A[k] * m_seconds_per_year);
             }
           }
 
@@ -636,9 +753,9 @@ void SIAFD::compute_diffusivity(bool full_update, const Geometry &geometry,
             for (int k = 0; k <= ks; ++k) {
               const double accumulation_time = current_time - A[k];
               if (interglacial(accumulation_time)) {
-                e_factor[k] = m_e_factor_interglacial;
+                e_factor[offset + k] = m_e_factor_interglacial;
               } else {
-                e_factor[k] = m_e_factor;
+                e_factor[offset + k] = m_e_factor;
               }
             }
           }
@@ -648,70 +765,28 @@ void SIAFD::compute_diffusivity(bool full_update, const Geometry &geometry,
           const double *E_ij     = enthalpy->get_column(i, j),
                        *E_offset = enthalpy->get_column(i + oi, j + oj);
           for (int k = 0; k <= ks; ++k) {
-            E[k] = 0.5 * (E_ij[k] + E_offset[k]);
+            E[offset + k] = 0.5 * (E_ij[k] + E_offset[k]);
           }
         }
 
         const double alpha = sqrt(PetscSqr(h_x(i, j, o)) + PetscSqr(h_y(i, j, o)));
         for (int k = 0; k <= ks; ++k) {
-          stress[k] = alpha * pressure[k];
+          stress[offset + k] = alpha * pressure[offset + k];
         }
 
-        m_flow_law->flow_n(stress.data(), E.data(), pressure.data(), ice_grain_size.data(), ks + 1,
-                           flow.data());
-
         const double theta_local = 0.5 * (theta(i, j) + theta(i + oi, j + oj));
-        for (int k = 0; k <= ks; ++k) {
-          delta_ij[k] = e_factor[k] * theta_local * 2.0 * pressure[k] * flow[k];
-        }
 
-        double D = 0.0; // diffusivity for deformational SIA flow
-        {
-          for (int k = 1; k <= ks; ++k) {
-            // trapezoidal rule
-            const double dz = z[k] - z[k - 1];
-            D += 0.5 * dz * ((depth[k] + dz) * delta_ij[k - 1] + depth[k] * delta_ij[k]);
-          }
-          // finish off D with (1/2) dz (0 + (H-z[ks])*delta_ij[ks]), but dz=H-z[ks]:
-          const double dz = thk - z[ks];
-          D += 0.5 * dz * dz * delta_ij[ks];
-        }
+        batch.push_back({ i, j, ks, offset, thk, theta_local });
+        n_values += ks + 1;
 
-        // Override diffusivity at the edges of the domain. (At these
-        // locations PISM uses ghost cells *beyond* the boundary of
-        // the computational domain. This does not matter if the ice
-        // does not extend all the way to the domain boundary, as in
-        // whole-ice-sheet simulations. In a regional setup, though,
-        // this adjustment lets us avoid taking very small time-steps
-        // because of the possible thickness and bed elevation
-        // "discontinuities" at the boundary.)
-        {
-          if ((i < 0 or i >= (int)Mx - 1) and not(m_grid->periodicity() & grid::X_PERIODIC)) {
-            D = 0.0;
-          }
-          if ((j < 0 or j >= (int)My - 1) and not(m_grid->periodicity() & grid::Y_PERIODIC)) {
-            D = 0.0;
-          }
-        }
-
-        if (limit_diffusivity and D >= D_limit) {
-          D = D_limit;
-          high_diffusivity_counter += 1;
-        }
-
-        D_max = std::max(D_max, D);
-
-        result(i, j, o) = D;
-
-        // if doing the full update, fill the delta column above the ice and
-        // store it:
-        if (full_update) {
-          for (unsigned int k = ks + 1; k < Mz; ++k) {
-            delta_ij[k] = 0.0;
-          }
-          delta[o]->set_column(i, j, delta_ij.data());
+        if (batch.size() == batch_size) {
+          process_batch(o);
         }
       } // i, j-loop
+
+      if (not batch.empty()) {
+        process_batch(o);
+      }
     } catch (...) {
       loop.failed();
     }
@@ -745,109 +820,13 @@ void SIAFD::compute_diffusivity(bool full_update, const Geometry &geometry,
   }
 }
 
-void SIAFD::compute_diffusive_flux(const array::Staggered &h_x, const array::Staggered &h_y,
-                                   const array::Staggered &diffusivity, array::Staggered &result) {
-
-  array::AccessScope list{ &diffusivity, &h_x, &h_y, &result };
-
-  for (int o = 0; o < 2; o++) {
-    ParallelSection loop(m_grid->com);
-    try {
-      for (auto p = m_grid->points(1); p; p.next()) {
-        const int i = p.i(), j = p.j();
-
-        const double slope = (o == 0) ? h_x(i, j, o) : h_y(i, j, o);
-
-        result(i, j, o) = -diffusivity(i, j, o) * slope;
-      }
-    } catch (...) {
-      loop.failed();
-    }
-    loop.check();
-  } // o-loop
-}
-
-//! \brief Compute I.
-/*!
- * This computes
- * \f[ I(z) = \int_b^z\delta(s)ds.\f]
- *
- * Uses the trapezoidal rule to approximate the integral.
- *
- * See compute_diffusive_flux() for the definition of \f$\delta\f$.
- *
- * The result is stored in work_3d[0,1] and is used to compute the SIA component
- * of the 3D-distributed horizontal ice velocity.
- */
-void SIAFD::compute_I(const Geometry &geometry) {
-
-  array::Scalar &thk_smooth = m_work_2d_0;
-  array::Array3D *I[]       = { &m_work_3d_0, &m_work_3d_1 };
-  array::Array3D *delta[]   = { &m_delta_0, &m_delta_1 };
-
-  const array::Scalar &h = geometry.ice_surface_elevation, &H = geometry.ice_thickness;
-
-  const auto &mask = geometry.cell_type;
-
-  m_bed_smoother->smoothed_thk(h, H, mask, thk_smooth);
-
-  array::AccessScope list{ delta[0], delta[1], I[0], I[1], &thk_smooth };
-
-  assert(I[0]->stencil_width() >= 1);
-  assert(I[1]->stencil_width() >= 1);
-  assert(delta[0]->stencil_width() >= 1);
-  assert(delta[1]->stencil_width() >= 1);
-  assert(thk_smooth.stencil_width() >= 2);
-
-  const unsigned int Mz = m_grid->Mz();
-
-  std::vector<double> dz(Mz);
-  for (unsigned int k = 1; k < Mz; ++k) {
-    dz[k] = m_grid->z(k) - m_grid->z(k - 1);
-  }
-
-  for (int o = 0; o < 2; ++o) {
-    ParallelSection loop(m_grid->com);
-    try {
-      for (auto p = m_grid->points(1); p; p.next()) {
-        const int i = p.i(), j = p.j();
-
-        const int oi = 1 - o, oj = o;
-        const double thk = 0.5 * (thk_smooth(i, j) + thk_smooth(i + oi, j + oj));
-
-        const double *delta_ij = delta[o]->get_column(i, j);
-        double *I_ij           = I[o]->get_column(i, j);
-
-        const unsigned int ks = m_grid->kBelowHeight(thk);
-
-        // within the ice:
-        I_ij[0]          = 0.0;
-        double I_current = 0.0;
-        for (unsigned int k = 1; k <= ks; ++k) {
-          // trapezoidal rule
-          I_current += 0.5 * dz[k] * (delta_ij[k - 1] + delta_ij[k]);
-          I_ij[k] = I_current;
-        }
-
-        // above the ice:
-        for (unsigned int k = ks + 1; k < Mz; ++k) {
-          I_ij[k] = I_current;
-        }
-      }
-    } catch (...) {
-      loop.failed();
-    }
-    loop.check();
-  } // o-loop
-}
-
 //! \brief Compute horizontal components of the SIA velocity (in 3D).
 /*!
  * Recall that
  *
  * \f[ \mathbf{U}(z) = -2 \nabla h \int_b^z F(s)P(s)ds + \mathbf{U}_b,\f]
  *
- * which can be written in terms of \f$I(z)\f$ defined in compute_I():
+ * which can be written in terms of \f$I(z)\f$ computed by compute_diffusivity():
  *
  * \f[ \mathbf{U}(z) = -I(z) \nabla h + \mathbf{U}_b. \f]
  *
@@ -864,15 +843,15 @@ void SIAFD::compute_3d_horizontal_velocity(const Geometry &geometry, const array
                                            const array::Vector &sliding_velocity,
                                            array::Array3D &u_out, array::Array3D &v_out) {
 
-  compute_I(geometry);
-  // after the compute_I() call work_3d[0,1] contains I on the staggered grid
+  // compute_diffusivity() (called with full_update == true) stored I on the staggered grid
+  // in work_3d[0,1]
   array::Array3D *I[] = { &m_work_3d_0, &m_work_3d_1 };
 
   array::AccessScope list{ &u_out, &v_out, &h_x, &h_y, &sliding_velocity, I[0], I[1] };
 
   const unsigned int Mz = m_grid->Mz();
 
-  for (auto p = m_grid->points(); p; p.next()) {
+  for (auto p = geometry.active_columns.active(); p; p.next()) {
     const int i = p.i(), j = p.j();
 
     const double
@@ -913,6 +892,16 @@ void SIAFD::compute_3d_horizontal_velocity(const Geometry &geometry, const array
     }
   }
 
+  // I is zero on all staggered grid points surrounding an inactive column (smoothed ice
+  // thickness is zero at all the neighboring regular grid points), so the velocity there
+  // is equal to the sliding velocity
+  for (auto p = geometry.active_columns.inactive(); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    std::fill_n(u_out.get_column(i, j), Mz, sliding_velocity(i, j).u);
+    std::fill_n(v_out.get_column(i, j), Mz, sliding_velocity(i, j).v);
+  }
+
   // Communicate to get ghosts:
   u_out.update_ghosts();
   v_out.update_ghosts();
@@ -91,11 +91,8 @@ protected:
                                    const array::Array3D *age,
                                    const array::Staggered1 &h_x,
                                    const array::Staggered1 &h_y,
-                                   array::Staggered1 &result);
-
-  virtual void compute_diffusive_flux(const array::Staggered &h_x, const array::Staggered &h_y,
-                                      const array::Staggered &diffusivity,
-                                      array::Staggered &result);
+                                   array::Staggered1 &result,
+                                   array::Staggered1 &flux);
 
   virtual void compute_3d_horizontal_velocity(const Geometry &geometry,
                                               const array::Staggered &h_x,
@@ -103,8 +100,6 @@ protected:
                                               const array::Vector &sliding_velocity,
                                               array::Array3D &u_out, array::Array3D &v_out);
 
-  virtual void compute_I(const Geometry &geometry);
-
   bool interglacial(double accumulation_time) const;
 
   const unsigned int m_stencil_width;
@@ -114,10 +109,7 @@ protected:
   array::Scalar2 m_work_2d_1;
   //! temporary storage for the surface gradient and the diffusivity
   array::Staggered1 m_h_x, m_h_y, m_D;
-  //! temporary storage for delta on the staggered grid
-  array::Array3D m_delta_0;
-  array::Array3D m_delta_1;
-  //! temporary storage used to store I and strain_heating on the staggered grid
+  //! temporary storage used to store I on the staggered grid
   array::Array3D m_work_3d_0;
   array::Array3D m_work_3d_1;
 
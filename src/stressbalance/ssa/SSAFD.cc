@@ -16,13 +16,16 @@
 // along with PISM; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <memory>
 #include <stdexcept>
 
 #include "pism/geometry/Geometry.hh"
 #include "pism/stressbalance/StressBalance.hh"
 #include "pism/stressbalance/ssa/SSAFD.hh"
+#include "pism/util/GlobalReduction.hh"
 #include "pism/util/Grid.hh"
 #include "pism/util/array/CellType.hh"
 #include "pism/util/petscwrappers/DM.hh"
@@ -64,6 +67,20 @@ SSAFD::SSAFD(std::shared_ptr<const Grid> grid, bool regional_mode)
       .long_name("ice thickness times effective viscosity (before an update)")
       .units("Pa s m");
 
+  m_anderson_depth =
+      static_cast<unsigned int>(m_config->get_number("stress_balance.ssa.fd.anderson_depth"));
+  m_anderson_count   = 0;
+  m_anderson_next    = 0;
+  m_anderson_started = false;
+  if (m_anderson_depth > 0) {
+    for (unsigned int k = 0; k < m_anderson_depth; ++k) {
+      m_anderson_dF.emplace_back(std::make_shared<array::Staggered>(grid, "anderson_dF"));
+      m_anderson_dG.emplace_back(std::make_shared<array::Staggered>(grid, "anderson_dG"));
+    }
+    m_anderson_f = std::make_shared<array::Staggered>(grid, "anderson_f");
+    m_anderson_g = std::make_shared<array::Staggered>(grid, "anderson_g");
+  }
+
   // The nuH viewer:
   m_nuh_viewer = nullptr;
 
@@ -93,6 +110,84 @@ SSAFD::SSAFD(std::shared_ptr<const Grid> grid, bool regional_mode)
     ierr = KSPConvergedDefaultSetUIRNorm(m_KSP);
     PISM_CHK(ierr, "KSPConvergedDefaultSetUIRNorm");
   }
+
+  m_mg_levels = static_cast<int>(m_config->get_number("stress_balance.ssa.fd.multigrid_levels"));
+  if (m_mg_levels > 1) {
+    create_multigrid_dm();
+  }
+}
+
+/*!
+ * Create the DM used by the geometric multigrid preconditioner (see pc_setup_mg()).
+ *
+ * PETSc coarsens this DM to get the grid hierarchy and uses it to build interpolation
+ * operators. It has the same parallel layout as the DM used to create the SSA matrix,
+ * but (unlike DMs created by Grid) it is periodic only in directions in which the grid is
+ * periodic. This way interpolation does not couple opposite edges of the domain.
+ */
+void SSAFD::create_multigrid_dm() {
+  PetscErrorCode ierr;
+
+  auto periodicity = m_grid->periodicity();
+  bool
+    x_periodic = (periodicity & grid::X_PERIODIC) != 0,
+    y_periodic = (periodicity & grid::Y_PERIODIC) != 0;
+
+  // Check if the grid can be coarsened (by the factor of 2) m_mg_levels - 1 times.
+  {
+    int N  = 1 << (m_mg_levels - 1);
+    int Mx = (int)m_grid->Mx(), My = (int)m_grid->My();
+
+    int nx = x_periodic ? Mx : Mx - 1, ny = y_periodic ? My : My - 1;
+
+    if (nx % N != 0 or ny % N != 0) {
+      throw RuntimeError::formatted(
+          PISM_ERROR_LOCATION,
+          "SSAFD: the grid size (Mx = %d, My = %d) is not compatible with\n"
+          "stress_balance.ssa.fd.multigrid_levels = %d.\n"
+          "To use N multigrid levels Mx - 1 and My - 1 (Mx and My in periodic directions)\n"
+          "have to be divisible by 2^(N - 1) = %d.",
+          Mx, My, m_mg_levels, N);
+    }
+  }
+
+  auto dm = m_velocity_global.dm();
+
+  PetscInt Mx, My, mx, my;
+  ierr = DMDAGetInfo(*dm,
+                     NULL,             // dimensions
+                     &Mx, &My, NULL,   // grid size
+                     &mx, &my, NULL,   // numbers of processors in each direction
+                     NULL,             // number of degrees of freedom
+                     NULL,             // stencil width
+                     NULL, NULL, NULL, // types of ghost nodes at the boundary
+                     NULL);            // stencil type
+  PISM_CHK(ierr, "DMDAGetInfo");
+
+  const PetscInt *lx = NULL, *ly = NULL;
+  ierr = DMDAGetOwnershipRanges(*dm, &lx, &ly, NULL);
+  PISM_CHK(ierr, "DMDAGetOwnershipRanges");
+
+  DMBoundaryType
+    bx = x_periodic ? DM_BOUNDARY_PERIODIC : DM_BOUNDARY_NONE,
+    by = y_periodic ? DM_BOUNDARY_PERIODIC : DM_BOUNDARY_NONE;
+
+  PetscInt dof = 2, stencil_width = 1;
+
+  ierr = DMDACreate2d(m_grid->com, bx, by, DMDA_STENCIL_BOX, Mx, My, mx, my, dof,
+                      stencil_width, lx, ly, m_mg_dm.rawptr());
+  PISM_CHK(ierr, "DMDACreate2d");
+
+  ierr = DMSetUp(m_mg_dm);
+  PISM_CHK(ierr, "DMSetUp");
+
+  ierr = KSPSetDM(m_KSP, m_mg_dm);
+  PISM_CHK(ierr, "KSPSetDM");
+
+  // The matrix is assembled by assemble_matrix(): use the DM to build the grid hierarchy
+  // only.
+  ierr = KSPSetDMActive(m_KSP, PETSC_FALSE);
+  PISM_CHK(ierr, "KSPSetDMActive");
 }
 
 //! @note Uses `PetscErrorCode` *intentionally*.
@@ -110,6 +205,14 @@ void SSAFD::pc_setup_bjacobi() {
   ierr = KSPGetPC(m_KSP, &pc);
   PISM_CHK(ierr, "KSPGetPC");
 
+  // Changing the PC type destroys the current preconditioner
+  PetscBool same_type = PETSC_FALSE;
+  ierr = PetscObjectTypeCompare((PetscObject)pc, PCBJACOBI, &same_type);
+  PISM_CHK(ierr, "PetscObjectTypeCompare");
+  if (not same_type) {
+    m_pc_valid = false;
+  }
+
   // Set the PC type:
   ierr = PCSetType(pc, PCBJACOBI);
   PISM_CHK(ierr, "PCSetType");
@@ -145,27 +248,96 @@ void SSAFD::pc_setup_asm() {
   ierr = KSPGetPC(m_KSP, &pc);
   PISM_CHK(ierr, "KSPGetPC");
 
-  // Set the PC type:
-  ierr = PCSetType(pc, PCASM);
-  PISM_CHK(ierr, "PCSetType");
+  PetscBool same_type = PETSC_FALSE;
+  ierr = PetscObjectTypeCompare((PetscObject)pc, PCASM, &same_type);
+  PISM_CHK(ierr, "PetscObjectTypeCompare");
+
+  // Sub-domain solvers are already set up if we are using ASM. Skip PCSetUp() below to
+  // avoid re-computing (and then possibly discarding) LU factorizations.
+  if (not same_type) {
+    m_pc_valid = false;
+
+    // Set the PC type:
+    ierr = PCSetType(pc, PCASM);
+    PISM_CHK(ierr, "PCSetType");
+
+    // Set the sub-KSP object to "preonly"
+    KSP *sub_ksp;
+    ierr = PCSetUp(pc);
+    PISM_CHK(ierr, "PCSetUp");
+
+    ierr = PCASMGetSubKSP(pc, NULL, NULL, &sub_ksp);
+    PISM_CHK(ierr, "PCASMGetSubKSP");
+
+    ierr = KSPSetType(*sub_ksp, KSPPREONLY);
+    PISM_CHK(ierr, "KSPSetType");
+
+    // Set the PC of the sub-KSP to "LU".
+    ierr = KSPGetPC(*sub_ksp, &sub_pc);
+    PISM_CHK(ierr, "KSPGetPC");
+
+    ierr = PCSetType(sub_pc, PCLU);
+    PISM_CHK(ierr, "PCSetType");
+  }
+
+  // Let the user override all this:
+  // Process options:
+  ierr = KSPSetFromOptions(m_KSP);
+  PISM_CHK(ierr, "KSPSetFromOptions");
+}
 
-  // Set the sub-KSP object to "preonly"
-  KSP *sub_ksp;
-  ierr = PCSetUp(pc);
-  PISM_CHK(ierr, "PCSetUp");
+/*!
+ * Set up the geometric multigrid preconditioner.
+ *
+ * Coarse grid operators are computed using the Galerkin process (\f$ R A P \f$), so they
+ * are consistent with boundary conditions and the cell type mask on the fine grid.
+ *
+ * @note Uses `PetscErrorCode` *intentionally*.
+ */
+void SSAFD::pc_setup_mg() {
+  PetscErrorCode ierr;
+  PC pc;
 
-  ierr = PCASMGetSubKSP(pc, NULL, NULL, &sub_ksp);
-  PISM_CHK(ierr, "PCASMGetSubKSP");
+  // Set parameters equivalent to
+  // -ksp_type gmres -ksp_norm_type unpreconditioned -ksp_pc_side right -pc_type mg
+  // -pc_mg_levels N -pc_mg_galerkin
 
-  ierr = KSPSetType(*sub_ksp, KSPPREONLY);
+  ierr = KSPSetType(m_KSP, KSPGMRES);
   PISM_CHK(ierr, "KSPSetType");
 
-  // Set the PC of the sub-KSP to "LU".
-  ierr = KSPGetPC(*sub_ksp, &sub_pc);
+  ierr = KSPSetOperators(m_KSP, m_A, m_A);
+  PISM_CHK(ierr, "KSPSetOperators");
+
+  // Switch to using the "unpreconditioned" norm.
+  ierr = KSPSetNormType(m_KSP, KSP_NORM_UNPRECONDITIONED);
+  PISM_CHK(ierr, "KSPSetNormType");
+
+  // Switch to "right" preconditioning.
+  ierr = KSPSetPCSide(m_KSP, PC_RIGHT);
+  PISM_CHK(ierr, "KSPSetPCSide");
+
+  // Get the PC from the KSP solver:
+  ierr = KSPGetPC(m_KSP, &pc);
   PISM_CHK(ierr, "KSPGetPC");
 
-  ierr = PCSetType(sub_pc, PCLU);
-  PISM_CHK(ierr, "PCSetType");
+  PetscBool same_type = PETSC_FALSE;
+  ierr = PetscObjectTypeCompare((PetscObject)pc, PCMG, &same_type);
+  PISM_CHK(ierr, "PetscObjectTypeCompare");
+
+  if (not same_type) {
+    m_pc_valid = false;
+
+    // Set the PC type:
+    ierr = PCSetType(pc, PCMG);
+    PISM_CHK(ierr, "PCSetType");
+
+    // PCMG coarsens the DM set by create_multigrid_dm() to get coarse grids.
+    ierr = PCMGSetLevels(pc, m_mg_levels, NULL);
+    PISM_CHK(ierr, "PCMGSetLevels");
+
+    ierr = PCMGSetGalerkin(pc, PC_MG_GALERKIN_BOTH);
+    PISM_CHK(ierr, "PCMGSetGalerkin");
+  }
 
   // Let the user override all this:
   // Process options:
@@ -190,8 +362,19 @@ void SSAFD::init_impl() {
     m_log->message(2, "  using PISM-PIK calving-front stress boundary condition ...\n");
   }
 
+  if (m_mg_levels > 1) {
+    m_log->message(2, "  using the geometric multigrid preconditioner with %d levels ...\n",
+                   m_mg_levels);
+  }
+
   m_default_pc_failure_count     = 0;
   m_default_pc_failure_max_count = 5;
+
+  m_pc_max_age = static_cast<int>(m_config->get_number("stress_balance.ssa.fd.pc_reuse.max_age"));
+  m_pc_iteration_growth = m_config->get_number("stress_balance.ssa.fd.pc_reuse.iteration_growth");
+  m_pc_age                  = 0;
+  m_pc_reference_iterations = 0;
+  m_pc_valid                = false;
 }
 
 void SSAFD::assemble_matrix(const Inputs &inputs, const array::Vector1 &velocity,
@@ -318,7 +501,25 @@ void SSAFD::solve(const Inputs &inputs) {
 void SSAFD::picard_iteration(const Inputs &inputs, double nuH_regularization,
                              double nuH_iter_failure_underrelax) {
 
-  if (m_default_pc_failure_count < m_default_pc_failure_max_count) {
+  if (m_mg_levels > 1) {
+    // Use multigrid if requested, falling back to ASM if it fails
+
+    try {
+      pc_setup_mg();
+      picard_manager(inputs, nuH_regularization, nuH_iter_failure_underrelax);
+
+    } catch (KSPFailure &f) {
+
+      m_log->message(1, "  re-trying using the Additive Schwarz preconditioner...\n");
+
+      pc_setup_asm();
+
+      m_velocity.copy_from(m_velocity_old);
+
+      picard_manager(inputs, nuH_regularization, nuH_iter_failure_underrelax);
+    }
+
+  } else if (m_default_pc_failure_count < m_default_pc_failure_max_count) {
     // Give BJACOBI another shot if we haven't tried it enough yet
 
     try {
@@ -349,11 +550,11 @@ void SSAFD::picard_iteration(const Inputs &inputs, double nuH_regularization,
 //! \brief Manages the Picard iteration loop.
 void SSAFD::picard_manager(const Inputs &inputs, double nuH_regularization,
                            double nuH_iter_failure_underrelax) {
-  PetscErrorCode ierr;
   // ksp_iterations should be a PetscInt because it is used in the
   // KSPGetIterationNumber() call below
   PetscInt ksp_iterations, ksp_iterations_total = 0, outer_iterations;
-  KSPConvergedReason reason;
+  // number of linear solves that re-used the preconditioner
+  int pc_reuse_count = 0;
 
   int max_iterations =
       static_cast<int>(m_config->get_number("stress_balance.ssa.fd.max_iterations"));
@@ -376,6 +577,11 @@ void SSAFD::picard_manager(const Inputs &inputs, double nuH_regularization,
     update_nuH_viewers(m_nuH);
   }
 
+  // discard Anderson acceleration history from previous solves
+  m_anderson_count   = 0;
+  m_anderson_next    = 0;
+  m_anderson_started = false;
+
   // outer loop
   for (int k = 0; k < max_iterations; ++k) {
 
@@ -391,36 +597,14 @@ void SSAFD::picard_manager(const Inputs &inputs, double nuH_regularization,
     }
 
     // Call PETSc to solve linear system by iterative method; "inner iteration":
-    ierr = KSPSetOperators(m_KSP, m_A, m_A);
-    PISM_CHK(ierr, "KSPSetOperator");
-
-    ierr = KSPSolve(m_KSP, m_rhs.vec(), m_velocity_global.vec());
-    PISM_CHK(ierr, "KSPSolve");
-
-    // Check if diverged; report to standard out about iteration
-    ierr = KSPGetConvergedReason(m_KSP, &reason);
-    PISM_CHK(ierr, "KSPGetConvergedReason");
-
-    if (reason < 0) {
-      // KSP diverged
-      m_log->message(1, "PISM WARNING:  KSPSolve() reports 'diverged'; reason = %d = '%s'\n",
-                     reason, KSPConvergedReasons[reason]);
-
-      write_system_petsc("kspdivergederror");
-
-      // Tell the caller that we failed. (The caller might try again,
-      // though.)
-      throw KSPFailure(KSPConvergedReasons[reason]);
-    }
-
-    // report on KSP success; the "inner" iteration is done
-    ierr = KSPGetIterationNumber(m_KSP, &ksp_iterations);
-    PISM_CHK(ierr, "KSPGetIterationNumber");
+    bool pc_reused = false;
+    ksp_iterations = ksp_solve(pc_reused);
 
     ksp_iterations_total += ksp_iterations;
+    pc_reuse_count += pc_reused ? 1 : 0;
 
     if (very_verbose) {
-      m_stdout_ssa += pism::printf("S:%d,%d: ", (int)ksp_iterations, reason);
+      m_stdout_ssa += pism::printf("S:%d%s: ", (int)ksp_iterations, pc_reused ? ",r" : "");
     }
 
     // limit ice speed
@@ -495,6 +679,12 @@ void SSAFD::picard_manager(const Inputs &inputs, double nuH_regularization,
     if (nuH_norm == 0 || nuH_norm_change / nuH_norm < ssa_relative_tolerance) {
       goto done;
     }
+
+    // Note: compute_nuH_norm() set m_nuH_old to the difference between the old nuH and
+    // its Picard update.
+    if (m_anderson_depth > 0 and anderson_step(m_nuH, m_nuH_old, nuH_regularization)) {
+      m_log->message(3, "  (accelerated nuH update)\n");
+    }
   } // outer loop (k)
 
   // If we're here, it means that we exceeded max_iterations and still
@@ -520,11 +710,343 @@ done:
     m_stdout_ssa += tempstr;
   }
 
+  if (verbose and m_pc_max_age > 0) {
+    m_stdout_ssa += pism::printf("       preconditioner re-used in %d of %d linear solves\n",
+                                 pc_reuse_count, (int)outer_iterations);
+  }
+
   if (verbose) {
     m_stdout_ssa = "  SSA: " + m_stdout_ssa;
   }
 }
 
+//! Solve the linear system `m_A x = m_rhs`, re-using the preconditioner if possible.
+/*!
+ * The preconditioner (block Jacobi or ASM with ILU or LU on sub-domains) is re-used for at
+ * most `stress_balance.ssa.fd.pc_reuse.max_age` solves. It is re-built sooner if the
+ * number of KSP iterations grows by more than the factor of
+ * `stress_balance.ssa.fd.pc_reuse.iteration_growth` compared to the first solve with the
+ * current preconditioner or if the KSP solver diverges with a lagged preconditioner.
+ *
+ * The preconditioner is kept across time steps: the matrix changes only slightly from one
+ * time step to the next.
+ *
+ * Sets `pc_reused` to true if the solve used an old preconditioner. Returns the number of
+ * KSP iterations, including iterations of a failed attempt with a lagged preconditioner.
+ *
+ * @note Uses `PetscErrorCode` *intentionally*.
+ */
+PetscInt SSAFD::ksp_solve(bool &pc_reused) {
+  PetscErrorCode ierr;
+  KSPConvergedReason reason;
+  PetscInt ksp_iterations = 0;
+
+  pc_reused = m_pc_valid and m_pc_age < m_pc_max_age;
+
+  ierr = KSPSetReusePreconditioner(m_KSP, pc_reused ? PETSC_TRUE : PETSC_FALSE);
+  PISM_CHK(ierr, "KSPSetReusePreconditioner");
+
+  ierr = KSPSetOperators(m_KSP, m_A, m_A);
+  PISM_CHK(ierr, "KSPSetOperators");
+
+  ierr = KSPSolve(m_KSP, m_rhs.vec(), m_velocity_global.vec());
+  PISM_CHK(ierr, "KSPSolve");
+
+  ierr = KSPGetConvergedReason(m_KSP, &reason);
+  PISM_CHK(ierr, "KSPGetConvergedReason");
+
+  if (reason < 0 and pc_reused) {
+    m_log->message(3, "  KSPSolve() with a lagged preconditioner diverged; re-building...\n");
+
+    // iterations of the failed attempt count towards the total
+    PetscInt failed_iterations = 0;
+    ierr = KSPGetIterationNumber(m_KSP, &failed_iterations);
+    PISM_CHK(ierr, "KSPGetIterationNumber");
+
+    // restore the initial guess (m_velocity contains the result of the previous solve)
+    m_velocity_global.copy_from(m_velocity);
+    m_pc_valid = false;
+
+    return failed_iterations + ksp_solve(pc_reused);
+  }
+
+  // Check if diverged; report to standard out about iteration
+  if (reason < 0) {
+    m_pc_valid = false;
+
+    // KSP diverged
+    m_log->message(1, "PISM WARNING:  KSPSolve() reports 'diverged'; reason = %d = '%s'\n",
+                   reason, KSPConvergedReasons[reason]);
+
+    write_system_petsc("kspdivergederror");
+
+    // Tell the caller that we failed. (The caller might try again,
+    // though.)
+    throw KSPFailure(KSPConvergedReasons[reason]);
+  }
+
+  // report on KSP success; the "inner" iteration is done
+  ierr = KSPGetIterationNumber(m_KSP, &ksp_iterations);
+  PISM_CHK(ierr, "KSPGetIterationNumber");
+
+  if (pc_reused) {
+    m_pc_age += 1;
+
+    if (ksp_iterations > m_pc_iteration_growth * std::max(m_pc_reference_iterations, (PetscInt)1)) {
+      // the preconditioner is too old: re-build it before the next solve
+      m_pc_valid = false;
+    }
+  } else {
+    m_pc_age                  = 0;
+    m_pc_reference_iterations = ksp_iterations;
+    m_pc_valid                = true;
+  }
+
+  return ksp_iterations;
+}
+
+namespace {
+
+/*!
+ * Solve the linear system `A x = b` of size `N` using Gaussian elimination with partial
+ * pivoting. `A` is stored in the row-major order and is overwritten.
+ *
+ * Returns false if the system is (numerically) singular.
+ */
+bool solve_dense(int N, std::vector<double> &A, std::vector<double> &b, std::vector<double> &x) {
+  for (int k = 0; k < N; ++k) {
+    int pivot = k;
+    for (int r = k + 1; r < N; ++r) {
+      if (std::abs(A[r * N + k]) > std::abs(A[pivot * N + k])) {
+        pivot = r;
+      }
+    }
+
+    if (A[pivot * N + k] == 0.0) {
+      return false;
+    }
+
+    if (pivot != k) {
+      for (int c = 0; c < N; ++c) {
+        std::swap(A[k * N + c], A[pivot * N + c]);
+      }
+      std::swap(b[k], b[pivot]);
+    }
+
+    for (int r = k + 1; r < N; ++r) {
+      double factor = A[r * N + k] / A[k * N + k];
+      for (int c = k; c < N; ++c) {
+        A[r * N + c] -= factor * A[k * N + c];
+      }
+      b[r] -= factor * b[k];
+    }
+  }
+
+  x.resize(N);
+  for (int k = N - 1; k >= 0; --k) {
+    double sum = b[k];
+    for (int c = k + 1; c < N; ++c) {
+      sum -= A[k * N + c] * x[c];
+    }
+    x[k] = sum / A[k * N + k];
+  }
+
+  return true;
+}
+
+} // namespace
+
+//! Anderson acceleration of the Picard iteration for `nu H`.
+/*!
+ * On input `nuH` contains the Picard update \f$ G(\nu H_k) \f$ of the current iterate
+ * \f$\nu H_k\f$ and `nuH_change` contains \f$\nu H_k - G(\nu H_k)\f$, i.e. the
+ * residual \f$f_k\f$ with the opposite sign.
+ *
+ * Using differences \f$\Delta f_j\f$ and \f$\Delta G_j\f$ of residuals and Picard
+ * updates from the last `stress_balance.ssa.fd.anderson_depth` iterations, this method
+ * finds \f$\gamma\f$ minimizing \f$\| f_k - \sum_j \gamma_j \Delta f_j \|_2\f$ and
+ * sets
+ *
+ * \f[ \nu H_{k+1} = G(\nu H_k) - \sum_j \gamma_j \Delta G_j. \f]
+ *
+ * The Picard update is bounded below by `nuH_regularization` (it is added to \f$\nu H\f$),
+ * so values of the accelerated `nu H` below this bound are replaced by
+ * `nuH_regularization`.
+ *
+ * If the least squares problem is singular or (without regularization) the accelerated
+ * `nu H` is not positive everywhere, this method leaves the Picard update in `nuH` and
+ * discards the history.
+ *
+ * The convergence criterion is not affected: it uses the change in `nu H` due to the
+ * Picard update.
+ *
+ * Returns true if the acceleration was applied.
+ */
+bool SSAFD::anderson_step(array::Staggered1 &nuH, const array::Staggered &nuH_change,
+                          double nuH_regularization) {
+  auto &f_old = *m_anderson_f;
+  auto &G_old = *m_anderson_g;
+
+  // update the history and save the current residual and the Picard update
+  {
+    auto &dF = *m_anderson_dF[m_anderson_next];
+    auto &dG = *m_anderson_dG[m_anderson_next];
+
+    array::AccessScope list{ &nuH, &nuH_change, &f_old, &G_old, &dF, &dG };
+
+    for (auto p = m_grid->points(); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      for (int k = 0; k < 2; ++k) {
+        double f = -nuH_change(i, j, k), G = nuH(i, j, k);
+
+        if (m_anderson_started) {
+          dF(i, j, k) = f - f_old(i, j, k);
+          dG(i, j, k) = G - G_old(i, j, k);
+        }
+
+        f_old(i, j, k) = f;
+        G_old(i, j, k) = G;
+      }
+    }
+
+    if (m_anderson_started) {
+      m_anderson_next  = (m_anderson_next + 1) % m_anderson_depth;
+      m_anderson_count = std::min(m_anderson_count + 1, m_anderson_depth);
+    }
+    m_anderson_started = true;
+  }
+
+  const int M = (int)m_anderson_count;
+  if (M == 0) {
+    // the first iteration: use the Picard update
+    return false;
+  }
+
+  // assemble normal equations (dF^T dF) gamma = dF^T f, computing all dot products using
+  // one global reduction
+  std::vector<double> A(M * M, 0.0), b(M, 0.0), gamma;
+  {
+    std::vector<array::Staggered *> dF(M);
+    for (int m = 0; m < M; ++m) {
+      dF[m] = m_anderson_dF[m].get();
+    }
+
+    array::AccessScope list{ &f_old };
+    for (auto *v : dF) {
+      list.add(*v);
+    }
+
+    for (auto p = m_grid->points(); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      for (int k = 0; k < 2; ++k) {
+        double f = f_old(i, j, k);
+        for (int r = 0; r < M; ++r) {
+          double dF_r = (*dF[r])(i, j, k);
+          b[r] += dF_r * f;
+          for (int c = r; c < M; ++c) {
+            A[r * M + c] += dF_r * (*dF[c])(i, j, k);
+          }
+        }
+      }
+    }
+
+    GlobalReduction reduction(m_grid->com);
+    int A_index = reduction.sum(A);
+    int b_index = reduction.sum(b);
+    reduction.reduce();
+
+    A = reduction.values(A_index, M * M);
+    b = reduction.values(b_index, M);
+
+    // fill in the lower triangle and add a small Tikhonov regularization term to protect
+    // against nearly linearly dependent columns of dF
+    double max_diagonal = 0.0;
+    for (int r = 0; r < M; ++r) {
+      max_diagonal = std::max(max_diagonal, A[r * M + r]);
+      for (int c = 0; c < r; ++c) {
+        A[r * M + c] = A[c * M + r];
+      }
+    }
+    for (int r = 0; r < M; ++r) {
+      A[r * M + r] += 1e-10 * max_diagonal;
+    }
+
+    if (max_diagonal == 0.0 or not solve_dense(M, A, b, gamma)) {
+      m_anderson_count = 0;
+      m_anderson_next  = 0;
+      return false;
+    }
+  }
+
+  // compute the accelerated iterate G - dG gamma, using m_nuH_old as storage
+  int n_non_positive = 0, n_clamped = 0;
+  {
+    std::vector<array::Staggered *> dG(M);
+    for (int m = 0; m < M; ++m) {
+      dG[m] = m_anderson_dG[m].get();
+    }
+
+    array::AccessScope list{ &G_old, &m_nuH_old };
+    for (auto *v : dG) {
+      list.add(*v);
+    }
+
+    for (auto p = m_grid->points(); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      for (int k = 0; k < 2; ++k) {
+        double result = G_old(i, j, k);
+        for (int m = 0; m < M; ++m) {
+          result -= gamma[m] * (*dG[m])(i, j, k);
+        }
+
+        if (G_old(i, j, k) > 0.0) {
+          if (not(result > 0.0) and nuH_regularization <= 0.0) {
+            n_non_positive += 1;
+          }
+
+          // keep the accelerated iterate above the regularization floor
+          if (not(result >= nuH_regularization)) {
+            result = nuH_regularization;
+            n_clamped += 1;
+          }
+        } else {
+          // nuH is zero in ice-free areas: do not modify it there
+          result = G_old(i, j, k);
+        }
+
+        m_nuH_old(i, j, k) = result;
+      }
+    }
+
+    GlobalReduction reduction(m_grid->com);
+    int non_positive_index = reduction.sum(n_non_positive);
+    int clamped_index      = reduction.sum(n_clamped);
+    reduction.reduce();
+
+    n_non_positive = static_cast<int>(reduction[non_positive_index]);
+    n_clamped      = static_cast<int>(reduction[clamped_index]);
+  }
+
+  if (n_non_positive > 0) {
+    // the accelerated iterate is not admissible: use the Picard update and restart
+    m_anderson_count = 0;
+    m_anderson_next  = 0;
+    return false;
+  }
+
+  if (n_clamped > 0) {
+    m_log->message(3, "  accelerated nuH was below nuH_regularization at %d locations\n",
+                   n_clamped);
+  }
+
+  nuH.copy_from(m_nuH_old);
+
+  return true;
+}
+
 //! Old SSAFD recovery strategy: increase the SSA regularization parameter.
 void SSAFD::picard_strategy_regularization(const Inputs &inputs) {
   // this has no units; epsilon goes up by this ratio when previous value failed
@@ -20,10 +20,12 @@
 #define _SSAFD_H_
 
 #include <array>
+#include <vector>
 
 #include "pism/stressbalance/ssa/SSAFDBase.hh"
 
 #include "pism/util/petscwrappers/Viewer.hh"
+#include "pism/util/petscwrappers/DM.hh"
 #include "pism/util/petscwrappers/KSP.hh"
 #include "pism/util/petscwrappers/Mat.hh"
 #include "pism/util/array/Staggered.hh"
@@ -46,6 +48,10 @@ protected:
 
   void pc_setup_asm();
 
+  void pc_setup_mg();
+
+  void create_multigrid_dm();
+
   void solve(const Inputs &inputs);
 
   void picard_iteration(const Inputs &inputs, double nuH_regularization,
@@ -56,6 +62,8 @@ protected:
 
   void picard_strategy_regularization(const Inputs &inputs);
 
+  PetscInt ksp_solve(bool &pc_reused);
+
   std::array<double, 2> compute_nuH_norm(const array::Staggered &nuH,
                                          array::Staggered &nuH_old);
 
@@ -66,13 +74,45 @@ protected:
 
   void update_nuH_viewers(const array::Staggered &nuH);
 
+  bool anderson_step(array::Staggered1 &nuH, const array::Staggered &nuH_change,
+                     double nuH_regularization);
+
   array::Staggered1 m_nuH_old;
 
   petsc::KSP m_KSP;
   petsc::Mat m_A;
 
+  // number of levels of the geometric multigrid preconditioner (not used if less than 2)
+  int m_mg_levels;
+  // DM used to create the grid hierarchy for the multigrid preconditioner
+  petsc::DM m_mg_dm;
+
   array::Vector1 m_velocity_old;
 
+  // Anderson acceleration of Picard iterations: differences of residuals and of Picard
+  // updates of nuH from the last m_anderson_depth iterations (stored in a circular buffer)
+  unsigned int m_anderson_depth;
+  unsigned int m_anderson_count;
+  unsigned int m_anderson_next;
+  bool m_anderson_started;
+  std::vector<std::shared_ptr<array::Staggered> > m_anderson_dF;
+  std::vector<std::shared_ptr<array::Staggered> > m_anderson_dG;
+  // residual and the Picard update from the previous iteration
+  std::shared_ptr<array::Staggered> m_anderson_f;
+  std::shared_ptr<array::Staggered> m_anderson_g;
+
+  // Preconditioner lagging: the preconditioner is re-used for at most m_pc_max_age linear
+  // solves or until the number of KSP iterations exceeds m_pc_iteration_growth times the
+  // number of iterations needed right after the last update.
+  int m_pc_max_age;
+  double m_pc_iteration_growth;
+  // number of solves since the last preconditioner update
+  int m_pc_age;
+  // number of KSP iterations needed right after the last preconditioner update
+  PetscInt m_pc_reference_iterations;
+  // false if the preconditioner has to be re-built before the next solve
+  bool m_pc_valid;
+
   unsigned int m_default_pc_failure_count;
   unsigned int m_default_pc_failure_max_count;
   
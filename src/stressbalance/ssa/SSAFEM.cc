@@ -64,6 +64,8 @@ SSAFEM::SSAFEM(std::shared_ptr<const Grid> grid)
   m_driving_stress_x = NULL;
   m_driving_stress_y = NULL;
 
+  m_quad_point_values_valid = false;
+
   PetscErrorCode ierr;
 
   m_dirichletScale        = 1.0;
@@ -339,6 +341,105 @@ void SSAFEM::cache_inputs(const Inputs &inputs) {
 
   cache_residual_cfbc(inputs);
 
+  m_quad_point_values_valid = false;
+}
+
+/*!
+ * Compute element types and values of coefficients at quadrature points of all elements.
+ *
+ * Coefficients (and therefore these values) do not change during a solve, so this
+ * avoids re-computing them in every residual and Jacobian evaluation. Note that shape
+ * functions are the same in all elements of a given type (the grid is uniform).
+ */
+void SSAFEM::cache_quadrature_values() {
+
+  const bool use_explicit_driving_stress = (m_driving_stress_x != NULL) && (m_driving_stress_y != NULL);
+
+  const bool use_cfbc = m_config->get_flag("stress_balance.calving_front_stress_bc");
+
+  const unsigned int Nk = fem::q1::n_chi;
+  const unsigned int Nq_max = fem::MAX_QUADRATURE_SIZE;
+
+  using fem::P1Element2;
+  fem::P1Quadrature3 Q_p1;
+  P1Element2 p1_element[Nk] = {P1Element2(*m_grid, Q_p1, 0),
+                               P1Element2(*m_grid, Q_p1, 1),
+                               P1Element2(*m_grid, Q_p1, 2),
+                               P1Element2(*m_grid, Q_p1, 3)};
+
+  // number of quadrature points per element in m_quad_point_values
+  const unsigned int Nq_element = m_q1_element.n_pts();
+  if (p1_element[0].n_pts() > Nq_element) {
+    throw RuntimeError(PISM_ERROR_LOCATION,
+                       "P1 elements cannot use more quadrature points than Q1 elements");
+  }
+
+  const int
+    xs = m_element_index.xs,
+    xm = m_element_index.xm,
+    ys = m_element_index.ys,
+    ym = m_element_index.ym;
+
+  m_element_type.resize(xm * ym);
+  m_quad_point_values.resize(xm * ym * Nq_element);
+
+  array::AccessScope list{&m_node_type, &m_coefficients};
+
+  for (int j = ys; j < ys + ym; j++) {
+    for (int i = xs; i < xs + xm; i++) {
+      const int index = element_index(i, j);
+
+      m_q1_element.reset(i, j);
+
+      int type = fem::ELEMENT_Q;
+      if (use_cfbc) {
+        int node_type[Nk];
+        m_q1_element.nodal_values(m_node_type, node_type);
+
+        type = fem::element_type(node_type);
+      }
+
+      m_element_type[index] = type;
+
+      if (type == fem::ELEMENT_EXTERIOR) {
+        continue;
+      }
+
+      fem::Element2 *E = &m_q1_element;
+      if (type != fem::ELEMENT_Q) {
+        E = &p1_element[type];
+        E->reset(i, j);
+      }
+
+      int    mask[Nq_max];
+      double thickness[Nq_max];
+      double tauc[Nq_max];
+      double hardness[Nq_max];
+      Vector2d tau_d[Nq_max];
+
+      Coefficients coeffs[Nk];
+      E->nodal_values(m_coefficients.array(), coeffs);
+
+      quad_point_values(*E, coeffs, mask, thickness, tauc, hardness);
+
+      if (use_explicit_driving_stress) {
+        explicit_driving_stress(*E, coeffs, tau_d);
+      } else {
+        driving_stress(*E, coeffs, tau_d);
+      }
+
+      auto *values = &m_quad_point_values[index * Nq_element];
+      for (unsigned int q = 0; q < E->n_pts(); ++q) {
+        values[q].mask           = mask[q];
+        values[q].thickness      = thickness[q];
+        values[q].tauc           = tauc[q];
+        values[q].hardness       = hardness[q];
+        values[q].driving_stress = tau_d[q];
+      }
+    }
+  }
+
+  m_quad_point_values_valid = true;
 }
 
 //! Compute quadrature point values of various coefficients given a quadrature `Q` and nodal values.
@@ -735,13 +836,16 @@ void SSAFEM::cache_residual_cfbc(const Inputs &inputs) {
 void SSAFEM::compute_local_function(Vector2d const *const *const velocity_global,
                                     Vector2d **residual_global) {
 
-  const bool use_explicit_driving_stress = (m_driving_stress_x != NULL) && (m_driving_stress_y != NULL);
-
   const bool use_cfbc = m_config->get_flag("stress_balance.calving_front_stress_bc");
 
   const unsigned int Nk = fem::q1::n_chi;
   const unsigned int Nq_max = fem::MAX_QUADRATURE_SIZE;
 
+  if (not m_quad_point_values_valid) {
+    cache_quadrature_values();
+  }
+  const unsigned int Nq_element = m_q1_element.n_pts();
+
   using fem::P1Element2;
   fem::P1Quadrature3 Q_p1;
   P1Element2 p1_element[Nk] = {P1Element2(*m_grid, Q_p1, 0),
@@ -749,7 +853,7 @@ void SSAFEM::compute_local_function(Vector2d const *const *const velocity_global
                                P1Element2(*m_grid, Q_p1, 2),
                                P1Element2(*m_grid, Q_p1, 3)};
 
-  array::AccessScope list{&m_node_type, &m_coefficients, &m_boundary_integral};
+  array::AccessScope list{&m_node_type, &m_boundary_integral};
 
   // Set the boundary contribution of the residual. This is computed at the nodes, so we don't want
   // to set it using Element::add_contribution() because that would lead to
@@ -778,59 +882,38 @@ void SSAFEM::compute_local_function(Vector2d const *const *const velocity_global
     for (int j = ys; j < ys + ym; j++) {
       for (int i = xs; i < xs + xm; i++) {
 
+        const int index = element_index(i, j);
+
         fem::Element2 *E = nullptr;
         {
-          m_q1_element.reset(i, j);
-
-          int node_type[Nk];
-          m_q1_element.nodal_values(m_node_type, node_type);
-
-          auto type = fem::element_type(node_type);
+          // note: if use_cfbc == false all elements are interior and Q1
+          auto type = m_element_type[index];
 
-          if (use_cfbc) {
-            if (type == fem::ELEMENT_EXTERIOR) {
-              // skip exterior elements
-              continue;
-            }
+          if (type == fem::ELEMENT_EXTERIOR) {
+            // skip exterior elements
+            continue;
+          }
 
-            if (type == fem::ELEMENT_Q) {
-              E = &m_q1_element;
-            } else {
-              E = &p1_element[type];
+          m_q1_element.reset(i, j);
 
-              E->reset(i, j);
-            }
-          } else {
-            // if use_cfbc == false all elements are interior and Q1
+          if (type == fem::ELEMENT_Q) {
             E = &m_q1_element;
+          } else {
+            E = &p1_element[type];
+
+            E->reset(i, j);
           }
         }
 
+        // Coefficients at quadrature points
+        const QuadPointValues *coefficients = &m_quad_point_values[index * Nq_element];
+
         // Number of quadrature points.
         const unsigned int Nq = E->n_pts();
 
         // Storage for the solution and residuals at element nodes.
         Vector2d residual[Nk];
 
-        int    mask[Nq_max];
-        double thickness[Nq_max];
-        double tauc[Nq_max];
-        double hardness[Nq_max];
-        Vector2d tau_d[Nq_max];
-
-        {
-          Coefficients coeffs[Nk];
-          E->nodal_values(m_coefficients.array(), coeffs);
-
-          quad_point_values(*E, coeffs, mask, thickness, tauc, hardness);
-
-          if (use_explicit_driving_stress) {
-            explicit_driving_stress(*E, coeffs, tau_d);
-          } else {
-            driving_stress(*E, coeffs, tau_d);
-          }
-        }
-
         {
           // Obtain the value of the solution at the nodes
           Vector2d velocity_nodal[Nk];
@@ -861,8 +944,11 @@ void SSAFEM::compute_local_function(Vector2d const *const *const velocity_global
 
           auto W = E->weight(q);
 
+          const auto &c = coefficients[q];
+          const Vector2d &tau_d = c.driving_stress;
+
           double eta = 0.0, beta = 0.0;
-          PointwiseNuHAndBeta(thickness[q], hardness[q], mask[q], tauc[q],
+          PointwiseNuHAndBeta(c.thickness, c.hardness, c.mask, c.tauc,
                               U[q], U_x[q], U_y[q], // inputs
                               &eta, NULL, &beta, NULL);              // outputs
 
@@ -879,9 +965,9 @@ void SSAFEM::compute_local_function(Vector2d const *const *const velocity_global
             const fem::Germ &psi = E->chi(q, k);
 
             residual[k].u += W * (eta * (psi.dx * (4.0 * u_x + 2.0 * v_y) + psi.dy * u_y_plus_v_x)
-                                   - psi.val * (tau_b.u + tau_d[q].u));
+                                   - psi.val * (tau_b.u + tau_d.u));
             residual[k].v += W * (eta * (psi.dx * u_y_plus_v_x + psi.dy * (2.0 * u_x + 4.0 * v_y))
-                                   - psi.val * (tau_b.v + tau_d[q].v));
+                                   - psi.val * (tau_b.v + tau_d.v));
           } // k (test functions)
         }   // q (quadrature points)
 
@@ -961,6 +1047,11 @@ void SSAFEM::compute_local_jacobian(Vector2d const *const *const velocity_global
   const unsigned int Nk     = fem::q1::n_chi;
   const unsigned int Nq_max = fem::MAX_QUADRATURE_SIZE;
 
+  if (not m_quad_point_values_valid) {
+    cache_quadrature_values();
+  }
+  const unsigned int Nq_element = m_q1_element.n_pts();
+
   using fem::P1Element2;
   fem::P1Quadrature3 Q_p1;
   P1Element2 p1_element[Nk] = {P1Element2(*m_grid, Q_p1, 0),
@@ -972,7 +1063,7 @@ void SSAFEM::compute_local_jacobian(Vector2d const *const *const velocity_global
   PetscErrorCode ierr = MatZeroEntries(Jac);
   PISM_CHK(ierr, "MatZeroEntries");
 
-  array::AccessScope list{&m_node_type, &m_coefficients};
+  array::AccessScope list{&m_node_type};
 
   // Start access to Dirichlet data if present.
   fem::DirichletData_Vector dirichlet_data(&m_bc_mask, &m_bc_values, m_dirichletScale);
@@ -992,52 +1083,37 @@ void SSAFEM::compute_local_jacobian(Vector2d const *const *const velocity_global
     for (int j = ys; j < ys + ym; j++) {
       for (int i = xs; i < xs + xm; i++) {
 
+        const int index = element_index(i, j);
+
         fem::Element2 *E = nullptr;
         {
-          m_q1_element.reset(i, j);
-
-          int node_type[Nk];
-          m_q1_element.nodal_values(m_node_type, node_type);
-
-          auto type = fem::element_type(node_type);
+          // note: if use_cfbc == false all elements are interior and Q1
+          auto type = m_element_type[index];
 
-          if (use_cfbc) {
-            if (type == fem::ELEMENT_EXTERIOR) {
-              // skip exterior elements
-              continue;
-            }
+          if (type == fem::ELEMENT_EXTERIOR) {
+            // skip exterior elements
+            continue;
+          }
 
-            if (type == fem::ELEMENT_Q) {
-              E = &m_q1_element;
-            } else {
-              E = &p1_element[type];
+          m_q1_element.reset(i, j);
 
-              E->reset(i, j);
-            }
-          } else {
-            // if use_cfbc == false all elements are interior and Q1
+          if (type == fem::ELEMENT_Q) {
             E = &m_q1_element;
+          } else {
+            E = &p1_element[type];
+
+            E->reset(i, j);
           }
         }
 
+        // Coefficients at quadrature points
+        const QuadPointValues *coefficients = &m_quad_point_values[index * Nq_element];
+
         // Number of quadrature points.
         const unsigned int
           Nq = E->n_pts(),
           n_chi = E->n_chi();
 
-        int    mask[Nq_max];
-        double thickness[Nq_max];
-        double tauc[Nq_max];
-        double hardness[Nq_max];
-
-        {
-          Coefficients coeffs[Nk];
-          E->nodal_values(m_coefficients.array(), coeffs);
-
-          quad_point_values(*E, coeffs,
-                            mask, thickness, tauc, hardness);
-        }
-
         {
           // Values of the solution at the nodes of the current element.
           Vector2d velocity_nodal[Nk];
@@ -1071,8 +1147,10 @@ void SSAFEM::compute_local_jacobian(Vector2d const *const *const velocity_global
             v_y          = U_y[q].v,
             u_y_plus_v_x = U_y[q].u + U_x[q].v;
 
+          const auto &c = coefficients[q];
+
           double eta = 0.0, deta = 0.0, beta = 0.0, dbeta = 0.0;
-          PointwiseNuHAndBeta(thickness[q], hardness[q], mask[q], tauc[q],
+          PointwiseNuHAndBeta(c.thickness, c.hardness, c.mask, c.tauc,
                               U[q], U_x[q], U_y[q],
                               &eta, &deta, &beta, &dbeta);
 
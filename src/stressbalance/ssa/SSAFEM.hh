@@ -26,6 +26,8 @@
 #include "pism/util/TerminationReason.hh"
 #include "pism/util/Mask.hh"
 
+#include <vector>
+
 namespace pism {
 
 namespace stressbalance {
@@ -73,6 +75,35 @@ protected:
 
   array::Array2D<Coefficients> m_coefficients;
 
+  //! Values of coefficients at a quadrature point.
+  struct QuadPointValues {
+    //! cell type
+    int mask;
+    //! ice thickness
+    double thickness;
+    //! basal yield stress
+    double tauc;
+    //! ice hardness
+    double hardness;
+    //! gravitational driving stress
+    Vector2d driving_stress;
+  };
+
+  void cache_quadrature_values();
+
+  int element_index(int i, int j) const {
+    return (j - m_element_index.ys) * m_element_index.xm + (i - m_element_index.xs);
+  }
+
+  //! Types (fem::ElementType) of elements in m_element_index. Depend on m_node_type only.
+  std::vector<int> m_element_type;
+  //! Values of coefficients at quadrature points of elements in m_element_index
+  //! (m_q1_element.n_pts() entries per element). Computed once per solve.
+  std::vector<QuadPointValues> m_quad_point_values;
+  //! False if m_element_type and m_quad_point_values have to be re-computed because
+  //! m_coefficients or m_node_type changed.
+  bool m_quad_point_values_valid;
+
   void quad_point_values(const fem::Element &E,
                          const Coefficients *x,
                          int *mask,
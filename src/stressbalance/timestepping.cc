@@ -24,6 +24,7 @@
 #include "pism/util/array/CellType.hh"
 #include "pism/util/array/Vector.hh"
 #include "pism/util/pism_utilities.hh"
+#include "pism/util/GlobalReduction.hh"
 #include "pism/util/Context.hh"
 #include <vector>
 
@@ -97,12 +98,15 @@ CFLData max_timestep_cfl_3d(const array::Scalar &ice_thickness,
 
   CFLData result;
 
-  std::vector<double> data = {u_max, v_max, w_max}, tmp(3, 0.0);
-  GlobalMax(grid->com, data.data(), tmp.data(), 3);
-  result.u_max = tmp[0];
-  result.v_max = tmp[1];
-  result.w_max = tmp[2];
-  result.dt_max = MaxTimestep(GlobalMin(grid->com, dt_max));
+  GlobalReduction r(grid->com);
+  int U  = r.max({u_max, v_max, w_max});
+  int DT = r.min(dt_max);
+  r.reduce();
+
+  result.u_max = r[U + 0];
+  result.v_max = r[U + 1];
+  result.w_max = r[U + 2];
+  result.dt_max = MaxTimestep(r[DT]);
 
   return result;
 }
@@ -153,12 +157,15 @@ CFLData max_timestep_cfl_2d(const array::Scalar &ice_thickness,
 
   CFLData result;
 
-  std::vector<double> data = {u_max, v_max}, tmp(2, 0.0);
-  GlobalMax(grid->com, data.data(), tmp.data(), 2);
-  result.u_max = tmp[0];
-  result.v_max = tmp[1];
+  GlobalReduction r(grid->com);
+  int U  = r.max({u_max, v_max});
+  int DT = r.min(dt_max);
+  r.reduce();
+
+  result.u_max = r[U + 0];
+  result.v_max = r[U + 1];
   result.w_max = 0.0;
-  result.dt_max = MaxTimestep(GlobalMin(grid->com, dt_max));
+  result.dt_max = MaxTimestep(r[DT]);
 
   return result;
 }
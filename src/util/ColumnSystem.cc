@@ -16,6 +16,7 @@
 // along with PISM; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
+#include <algorithm>            // std::min
 #include <cmath>                // fabs()
 #include <cassert>
 #include <fstream>
@@ -24,7 +25,9 @@
 
 #include "pism/util/pism_utilities.hh"
 #include "pism/util/array/Array3D.hh"
+#include "pism/util/array/Scalar.hh"
 #include "pism/util/ColumnSystem.hh"
+#include "pism/util/Grid.hh"
 
 #include "pism/util/error_handling.hh"
 #include "pism/util/ColumnInterpolation.hh"
@@ -244,6 +247,121 @@ std::string TridiagonalSystem::prefix() const {
   return m_prefix;
 }
 
+TridiagonalBatch::TridiagonalBatch(unsigned int max_size)
+  : m_max_system_size(max_size), m_zero_pivot_lane(-1) {
+  assert(max_size >= 1);
+
+  size_t N = static_cast<size_t>(max_size) * width;
+  m_L.resize(N);
+  m_D.resize(N);
+  m_U.resize(N);
+  m_rhs.resize(N);
+  m_work.resize(N);
+  m_x.resize(N);
+}
+
+//! Copy the first `system_size` rows of `system` to the lane `lane`.
+void TridiagonalBatch::set(int lane, const TridiagonalSystem &system, unsigned int system_size) {
+  assert(lane >= 0 and lane < width);
+  assert(system_size <= m_max_system_size);
+
+  for (unsigned int k = 0; k < system_size; ++k) {
+    m_L[k * width + lane]   = system.m_L[k];
+    m_D[k * width + lane]   = system.m_D[k];
+    m_U[k * width + lane]   = system.m_U[k];
+    m_rhs[k * width + lane] = system.m_rhs[k];
+  }
+}
+
+/*!
+ * Solve systems in lanes `0, ..., n_lanes - 1`. All of them have to have the size
+ * `system_size`.
+ *
+ * Throws RuntimeError if a zero pivot is encountered; use zero_pivot_lane() to find the
+ * system that caused the failure.
+ */
+void TridiagonalBatch::solve(unsigned int system_size, int n_lanes) {
+  assert(system_size >= 1);
+  assert(system_size <= m_max_system_size);
+  assert(n_lanes >= 1 and n_lanes <= width);
+
+  // fill unused lanes with trivial systems
+  for (unsigned int k = 0; k < system_size; ++k) {
+    for (int n = n_lanes; n < width; ++n) {
+      m_L[k * width + n]   = 0.0;
+      m_D[k * width + n]   = 1.0;
+      m_U[k * width + n]   = 0.0;
+      m_rhs[k * width + n] = 0.0;
+    }
+  }
+
+  m_zero_pivot_lane = -1;
+
+  auto check_pivots = [this](const double *b, unsigned int row) {
+    bool zero_pivot = false;
+    for (int n = 0; n < width; ++n) {
+      zero_pivot = zero_pivot or (b[n] == 0.0);
+    }
+
+    if (zero_pivot) {
+      for (int n = 0; n < width; ++n) {
+        if (b[n] == 0.0) {
+          m_zero_pivot_lane = n;
+          throw RuntimeError::formatted(PISM_ERROR_LOCATION, "zero pivot at row %d in system %d",
+                                        row + 1, n);
+        }
+      }
+    }
+  };
+
+  double b[width];
+
+  for (int n = 0; n < width; ++n) {
+    b[n]   = m_D[n];
+    m_x[n] = m_rhs[n] / b[n];
+  }
+  check_pivots(b, 0);
+
+  for (unsigned int k = 1; k < system_size; ++k) {
+    const double
+      *L   = &m_L[k * width],
+      *D   = &m_D[k * width],
+      *U   = &m_U[(k - 1) * width],
+      *rhs = &m_rhs[k * width],
+      *x_0 = &m_x[(k - 1) * width];
+    double
+      *work = &m_work[k * width],
+      *x    = &m_x[k * width];
+
+    for (int n = 0; n < width; ++n) {
+      work[n] = U[n] / b[n];
+      b[n]    = D[n] - L[n] * work[n];
+      x[n]    = (rhs[n] - L[n] * x_0[n]) / b[n];
+    }
+    check_pivots(b, k);
+  }
+
+  for (int k = static_cast<int>(system_size) - 2; k >= 0; --k) {
+    const double
+      *work = &m_work[(k + 1) * width],
+      *x_1  = &m_x[(k + 1) * width];
+    double *x = &m_x[k * width];
+
+    for (int n = 0; n < width; ++n) {
+      x[n] -= work[n] * x_1[n];
+    }
+  }
+}
+
+//! Human-readable list of columns in a batch (used in error messages).
+std::string ColumnBatch::columns() const {
+  std::string result;
+  for (int n = 0; n < size; ++n) {
+    result += pism::printf("%s(%d, %d)", n > 0 ? ", " : "", i[n], j[n]);
+  }
+  return result;
+}
+
 //! A column system is a kind of a tridiagonal system.
 columnSystemCtx::columnSystemCtx(const std::vector<double>& storage_grid,
                                  const std::string &prefix,
@@ -315,16 +433,72 @@ void columnSystemCtx::init_fine_grid(const std::vector<double>& storage_grid) {
   // Note that it *is* allowed to go over Lz.
 }
 
+//! Index of the top-most level of the fine grid within the ice.
+unsigned int columnSystemCtx::compute_ks(double ice_thickness) const {
+  unsigned int result = static_cast<unsigned int>(floor(ice_thickness / m_dz));
+
+  // Force the result to be in the allowed range.
+  if (result >= m_z.size()) {
+    result = m_z.size() - 1;
+  }
+
+  return result;
+}
+
+/*!
+ * Group grid columns in the current sub-domain into batches of up to
+ * `TridiagonalBatch::width` columns with the same size of the system.
+ *
+ * Batches are sorted by the system size (largest first) to help balance the load among
+ * threads.
+ */
+std::vector<ColumnBatch> columnSystemCtx::batches(const array::Scalar &ice_thickness) const {
+  auto grid = ice_thickness.grid();
+
+  // columns sorted by ks
+  std::vector<std::vector<int> > columns(m_z.size());
+  {
+    array::AccessScope list{ &ice_thickness };
+
+    for (auto p = grid->points(); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      auto &c = columns[compute_ks(ice_thickness(i, j))];
+      c.push_back(i);
+      c.push_back(j);
+    }
+  }
+
+  std::vector<ColumnBatch> result;
+  for (int ks = static_cast<int>(columns.size()) - 1; ks >= 0; --ks) {
+    const auto &c = columns[ks];
+    int N = static_cast<int>(c.size() / 2);
+
+    for (int start = 0; start < N; start += TridiagonalBatch::width) {
+      ColumnBatch batch;
+      batch.ks   = ks;
+      batch.size = std::min(N - start, (int)TridiagonalBatch::width);
+      for (int n = 0; n < batch.size; ++n) {
+        batch.i[n] = c[2 * (start + n) + 0];
+        batch.j[n] = c[2 * (start + n) + 1];
+      }
+      result.push_back(batch);
+    }
+  }
+
+  return result;
+}
+
+//! Copy the system assembled in the current column to the lane `lane` of `batch`.
+void columnSystemCtx::add_to(TridiagonalBatch &batch, int lane) const {
+  batch.set(lane, *m_solver, m_ks + 1);
+}
+
 void columnSystemCtx::init_column(int i, int j,
                                   double ice_thickness) {
   m_i  = i;
   m_j  = j;
-  m_ks = static_cast<unsigned int>(floor(ice_thickness / m_dz));
-
-  // Force m_ks to be in the allowed range.
-  if (m_ks >= m_z.size()) {
-    m_ks = m_z.size() - 1;
-  }
+  m_ks = compute_ks(ice_thickness);
 
   m_solver->reset();
 
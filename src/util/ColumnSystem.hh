@@ -27,8 +27,11 @@ namespace pism {
 
 namespace array {
 class Array3D;
+class Scalar;
 } // end of namespace array
 
+class TridiagonalBatch;
+
 //! Virtual base class.  Abstracts a tridiagonal system to solve in a column of ice and/or bedrock.
 /*!
   Because both the age evolution and conservation of energy equations require us to set up
@@ -129,12 +132,62 @@ public:
     return m_rhs[i];
   }
 private:
+  friend class TridiagonalBatch;
+
   unsigned int m_max_system_size;         // maximum system size
   std::vector<double> m_L, m_D, m_U, m_rhs, m_work; // vectors for tridiagonal system
 
   std::string m_prefix;
 };
 
+//! Solves up to `width` tridiagonal systems of the same size simultaneously.
+/*!
+  Uses the same algorithm as TridiagonalSystem::solve(), but stores coefficients of all
+  systems in the "structure of arrays" form (row `k` of the system in the lane `n` is at
+  `k * width + n`) so that the compiler can vectorize loops over lanes. This removes the
+  per-column overhead and hides latency of the serial dependency chain in the Thomas
+  algorithm.
+
+  Lanes that are not used are filled with trivial systems.
+*/
+class TridiagonalBatch {
+public:
+  //! number of lanes (systems solved simultaneously)
+  static const int width = 8;
+
+  TridiagonalBatch(unsigned int max_size);
+
+  void set(int lane, const TridiagonalSystem &system, unsigned int system_size);
+
+  void solve(unsigned int system_size, int n_lanes);
+
+  //! Element `k` of the solution in the lane `lane`.
+  double x(unsigned int k, int lane) const {
+    return m_x[k * width + lane];
+  }
+
+  //! Lane containing the system that caused the last solve() call to fail (-1 if none).
+  int zero_pivot_lane() const {
+    return m_zero_pivot_lane;
+  }
+private:
+  unsigned int m_max_system_size;
+  std::vector<double> m_L, m_D, m_U, m_rhs, m_work, m_x;
+  int m_zero_pivot_lane;
+};
+
+//! Grid columns with the same size of the column system.
+struct ColumnBatch {
+  //! index of the top-most level within the ice (the same in all columns)
+  unsigned int ks;
+  //! number of columns in this batch
+  int size;
+  //! grid indexes of columns
+  int i[TridiagonalBatch::width], j[TridiagonalBatch::width];
+
+  std::string columns() const;
+};
+
 class ColumnInterpolation;
 
 //! Base class for tridiagonal systems in the ice.
@@ -153,6 +206,10 @@ public:
 
   unsigned int ks() const;
   double dz() const;
+
+  std::vector<ColumnBatch> batches(const array::Scalar &ice_thickness) const;
+  void add_to(TridiagonalBatch &batch, int lane) const;
+  void reportColumnZeroPivotErrorMFile(unsigned int M);
   const std::vector<double>& z() const;
   void fine_to_coarse(const std::vector<double> &input, int i, int j,
                       array::Array3D& output) const;
@@ -182,7 +239,7 @@ protected:
 
   void init_column(int i, int j, double ice_thickness);
 
-  void reportColumnZeroPivotErrorMFile(unsigned int M);
+  unsigned int compute_ks(double ice_thickness) const;
 
   void init_fine_grid(const std::vector<double>& storage_grid);
 
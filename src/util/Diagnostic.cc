@@ -25,6 +25,7 @@
 #include "pism/util/Logger.hh"
 #include "pism/util/pism_utilities.hh"
 #include "pism/util/Context.hh"
+#include "pism/util/GlobalReduction.hh"
 
 namespace pism {
 
@@ -154,6 +155,9 @@ TSDiagnostic::TSDiagnostic(std::shared_ptr<const Grid> grid, const std::string &
   m_current_time = 0;
   m_start        = 0;
 
+  m_value        = 0.0;
+  m_value_is_set = false;
+
   m_buffer_size = static_cast<size_t>(m_config->get_number("output.timeseries.buffer_size"));
 
   m_variable["ancillary_variables"] = name + "_aux";
@@ -292,6 +296,82 @@ void TSDiagnostic::update(double t0, double t1) {
   this->update_impl(t0, t1);
 }
 
+//! Update using a `value` computed elsewhere (see update_timeseries()).
+void TSDiagnostic::update(double t0, double t1, double value) {
+  m_value        = value;
+  m_value_is_set = true;
+  try {
+    this->update_impl(t0, t1);
+  } catch (...) {
+    m_value_is_set = false;
+    throw;
+  }
+  m_value_is_set = false;
+}
+
+/*!
+ * Compute the contribution of the current sub-domain if this diagnostic is a sum over grid
+ * points.
+ *
+ * Returns `false` if it is not.
+ */
+bool TSDiagnostic::compute_local(double &result) {
+  return this->compute_local_impl(result);
+}
+
+bool TSDiagnostic::compute_local_impl(double &result) {
+  (void) result;
+  return false;
+}
+
+double TSDiagnostic::compute() {
+  double result = 0.0;
+  if (not this->compute_local_impl(result)) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "scalar diagnostic '%s' does not implement compute()",
+                                  m_variable.get_name().c_str());
+  }
+  return GlobalSum(m_grid->com, result);
+}
+
+//! Returns the value passed to update() or calls compute().
+double TSDiagnostic::value() {
+  if (m_value_is_set) {
+    return m_value;
+  }
+  return this->compute();
+}
+
+/*!
+ * Update all scalar diagnostics in `diagnostics`.
+ *
+ * Diagnostics that are sums over grid points (see TSDiagnostic::compute_local_impl()) are
+ * computed using one reduction instead of one reduction per diagnostic.
+ */
+void update_timeseries(MPI_Comm com, const TSDiagnosticList &diagnostics, double t0, double t1) {
+  GlobalReduction sums(com);
+  std::vector<std::pair<TSDiagnostic *, int> > summed;
+
+  for (const auto &d : diagnostics) {
+    double local = 0.0;
+    if (d.second->compute_local(local)) {
+      summed.emplace_back(d.second.get(), sums.sum(local));
+    } else {
+      d.second->update(t0, t1);
+    }
+  }
+
+  if (summed.empty()) {
+    return;
+  }
+
+  sums.reduce();
+
+  for (const auto &d : summed) {
+    d.first->update(t0, t1, sums[d.second]);
+  }
+}
+
 void TSSnapshotDiagnostic::update_impl(double t0, double t1) {
   static const double epsilon = 1e-4; // seconds
 
@@ -301,11 +381,11 @@ void TSSnapshotDiagnostic::update_impl(double t0, double t1) {
 
   assert(t1 > t0);
 
-  evaluate(t0, t1, this->compute());
+  evaluate(t0, t1, this->value());
 }
 
 void TSRateDiagnostic::update_impl(double t0, double t1) {
-  const double v = this->compute();
+  const double v = this->value();
 
   if (m_v_previous_set) {
     assert(t1 > t0);
@@ -325,7 +405,7 @@ void TSFluxDiagnostic::update_impl(double t0, double t1) {
 
   assert(t1 > t0);
 
-  evaluate(t0, t1, this->compute());
+  evaluate(t0, t1, this->value());
 }
 
 void TSDiagnostic::flush() {
@@ -283,6 +283,9 @@ public:
   virtual ~TSDiagnostic();
 
   void update(double t0, double t1);
+  void update(double t0, double t1, double value);
+
+  bool compute_local(double &result);
 
   void flush();
 
@@ -297,8 +300,20 @@ protected:
    * Compute the diagnostic. Regular (snapshot) quantity should be computed here; for rates of
    * change, compute() should return the total change during the time step from t0 to t1. The rate
    * itself is computed in evaluate_rate().
+   *
+   * The default implementation adds up contributions computed by compute_local_impl().
+   */
+  virtual double compute();
+
+  /*!
+   * Diagnostics that are sums over grid points should override this instead of compute(),
+   * setting `result` to the contribution of the current sub-domain and returning `true`.
+   * This makes it possible to compute all such diagnostics using one reduction (see
+   * update_timeseries()).
    */
-  virtual double compute() = 0;
+  virtual bool compute_local_impl(double &result);
+
+  double value();
 
   /*!
    * Set internal (MKS) and "output" units.
@@ -338,10 +353,16 @@ protected:
   unsigned int m_start;
   //! size of the buffer used to store data
   size_t m_buffer_size;
+
+  //! value computed by update_timeseries() (if set)
+  double m_value;
+  bool m_value_is_set;
 };
 
 typedef std::map<std::string, TSDiagnostic::Ptr> TSDiagnosticList;
 
+void update_timeseries(MPI_Comm com, const TSDiagnosticList &diagnostics, double t0, double t1);
+
 //! Scalar diagnostic reporting a snapshot of a quantity modeled by PISM.
 /*!
  * The method compute() should return the instantaneous "snapshot" value.
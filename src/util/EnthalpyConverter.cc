@@ -223,6 +223,53 @@ double EnthalpyConverter::water_fraction(double E, double P) const {
 }
 
 
+/*!
+ * Compute temperature() for `n` values of enthalpy `E` and pressure `P`.
+ *
+ * Methods evaluating the enthalpy converter for many points at once avoid the function
+ * call overhead and use branch-free loops the compiler can vectorize.
+ */
+void EnthalpyConverter::temperature_n(const double *E, const double *P, unsigned int n,
+                                      double *result) const {
+#if (Pism_DEBUG==1)
+  for (unsigned int k = 0; k < n; ++k) {
+    validate_E_P(E[k], P[k]);
+  }
+#endif
+
+  for (unsigned int k = 0; k < n; ++k) {
+    const double T_m = m_T_melting - m_beta * P[k], E_s = m_c_i * (T_m - m_T_0);
+
+    result[k] = E[k] < E_s ? (E[k] / m_c_i) + m_T_0 : T_m;
+  }
+}
+
+//! Compute pressure_adjusted_temperature() for `n` values of enthalpy and pressure.
+void EnthalpyConverter::pressure_adjusted_temperature_n(const double *E, const double *P,
+                                                        unsigned int n, double *result) const {
+  temperature_n(E, P, n, result);
+
+  for (unsigned int k = 0; k < n; ++k) {
+    result[k] = result[k] - (m_T_melting - m_beta * P[k]) + m_T_melting;
+  }
+}
+
+//! Compute water_fraction() for `n` values of enthalpy and pressure.
+void EnthalpyConverter::water_fraction_n(const double *E, const double *P, unsigned int n,
+                                         double *result) const {
+#if (Pism_DEBUG==1)
+  for (unsigned int k = 0; k < n; ++k) {
+    validate_E_P(E[k], P[k]);
+  }
+#endif
+
+  for (unsigned int k = 0; k < n; ++k) {
+    const double T_m = m_T_melting - m_beta * P[k], E_s = m_c_i * (T_m - m_T_0);
+
+    result[k] = E[k] <= E_s ? 0.0 : (E[k] - E_s) / (m_L + (m_c_w - m_c_i) * (T_m - 273.15));
+  }
+}
+
 //! Compute enthalpy from absolute temperature, liquid water fraction, and pressure.
 /*! This is an inverse function to the functions \f$T(E,p)\f$ and
 \f$\omega(E,p)\f$ [\ref AschwandenBuelerKhroulevBlatter].  It returns:
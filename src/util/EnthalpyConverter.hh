@@ -64,6 +64,11 @@ public:
 
   double water_fraction(double E, double P) const;
 
+  void temperature_n(const double *E, const double *P, unsigned int n, double *result) const;
+  void pressure_adjusted_temperature_n(const double *E, const double *P, unsigned int n,
+                                       double *result) const;
+  void water_fraction_n(const double *E, const double *P, unsigned int n, double *result) const;
+
   double enthalpy(double T, double omega, double P) const;
   double enthalpy_cts(double P) const;
   double enthalpy_liquid(double P) const;
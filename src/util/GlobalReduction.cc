@@ -0,0 +1,268 @@
+/* Copyright (C) 2024 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <algorithm> // std::max
+
+#include "pism/util/GlobalReduction.hh"
+#include "pism/util/error_handling.hh"
+
+namespace pism {
+
+namespace {
+
+enum Kind { SUM, MAX, MIN };
+
+/*!
+ * The reduction operation combining sums and maxima.
+ *
+ * The send buffer is a single element of a contiguous datatype containing `N` doubles:
+ * the number of sums `n`, then `n` values to add up, then values to compute maxima of.
+ * Minima are stored as maxima of negated values.
+ *
+ * Treating the whole buffer as one element of a derived datatype ensures that MPI does
+ * not split it into pieces.
+ */
+void sum_and_max(void *input, void *input_output, int *length, MPI_Datatype *type) {
+  int type_size = 0;
+  MPI_Type_size(*type, &type_size);
+  int N = type_size / (int)sizeof(double);
+
+  for (int e = 0; e < *length; ++e) {
+    const double *a = (const double *)input + e * N;
+    double *b       = (double *)input_output + e * N;
+
+    int n_sums = (int)a[0];
+
+    for (int k = 1; k <= n_sums; ++k) {
+      b[k] += a[k];
+    }
+    for (int k = n_sums + 1; k < N; ++k) {
+      b[k] = std::max(a[k], b[k]);
+    }
+  }
+}
+
+} // namespace
+
+struct GlobalReduction::Impl {
+  MPI_Comm comm;
+
+  //! kinds of contributions
+  std::vector<Kind> kind;
+  //! local contributions
+  std::vector<double> local;
+  //! position of each contribution in the send buffer
+  std::vector<int> position;
+
+  std::vector<double> send_buffer;
+  std::vector<double> receive_buffer;
+
+  MPI_Datatype type;
+  MPI_Op op;
+  MPI_Request request;
+
+  bool in_progress;
+  bool done;
+
+  int add(Kind k, const double *values, size_t count) {
+    if (in_progress) {
+      throw RuntimeError(PISM_ERROR_LOCATION, "cannot add a contribution during a reduction");
+    }
+    if (done) {
+      throw RuntimeError(PISM_ERROR_LOCATION,
+                         "cannot add a contribution after a reduction (call reset() first)");
+    }
+
+    int result = (int)local.size();
+    for (size_t n = 0; n < count; ++n) {
+      kind.push_back(k);
+      local.push_back(values[n]);
+    }
+    return result;
+  }
+};
+
+GlobalReduction::GlobalReduction(MPI_Comm comm) : m_impl(new Impl) {
+  m_impl->comm        = comm;
+  m_impl->type        = MPI_DATATYPE_NULL;
+  m_impl->request     = MPI_REQUEST_NULL;
+  m_impl->in_progress = false;
+  m_impl->done        = false;
+
+  int err = MPI_Op_create(sum_and_max, 1 /* commutative */, &m_impl->op);
+  PISM_C_CHK(err, 0, "MPI_Op_create");
+}
+
+GlobalReduction::~GlobalReduction() {
+  if (m_impl->in_progress) {
+    MPI_Wait(&m_impl->request, MPI_STATUS_IGNORE);
+  }
+  if (m_impl->type != MPI_DATATYPE_NULL) {
+    MPI_Type_free(&m_impl->type);
+  }
+  MPI_Op_free(&m_impl->op);
+  delete m_impl;
+}
+
+int GlobalReduction::sum(double local) {
+  return m_impl->add(SUM, &local, 1);
+}
+
+int GlobalReduction::max(double local) {
+  return m_impl->add(MAX, &local, 1);
+}
+
+int GlobalReduction::min(double local) {
+  return m_impl->add(MIN, &local, 1);
+}
+
+int GlobalReduction::sum(const std::vector<double> &local) {
+  return m_impl->add(SUM, local.data(), local.size());
+}
+
+int GlobalReduction::sum(const std::vector<int> &local) {
+  std::vector<double> tmp(local.begin(), local.end());
+  return sum(tmp);
+}
+
+int GlobalReduction::max(const std::vector<double> &local) {
+  return m_impl->add(MAX, local.data(), local.size());
+}
+
+int GlobalReduction::min(const std::vector<double> &local) {
+  return m_impl->add(MIN, local.data(), local.size());
+}
+
+//! Compute all sums, maxima and minima.
+void GlobalReduction::reduce() {
+  begin();
+  end();
+}
+
+//! Start computing all sums, maxima and minima.
+/*!
+ * Contributions are copied, so the caller may re-use local buffers right away.
+ */
+void GlobalReduction::begin() {
+  if (m_impl->in_progress) {
+    throw RuntimeError(PISM_ERROR_LOCATION, "reduction is already in progress");
+  }
+
+  const auto &kind = m_impl->kind;
+  const auto &local = m_impl->local;
+  auto &position = m_impl->position;
+  auto &send = m_impl->send_buffer;
+
+  int N = (int)local.size();
+
+  position.resize(N);
+  send.resize(N + 1);
+  m_impl->receive_buffer.resize(N + 1);
+
+  int n_sums = 0;
+  for (int k = 0; k < N; ++k) {
+    if (kind[k] == SUM) {
+      ++n_sums;
+    }
+  }
+  send[0] = n_sums;
+
+  int s = 1, m = n_sums + 1;
+  for (int k = 0; k < N; ++k) {
+    switch (kind[k]) {
+    case SUM:
+      position[k] = s++;
+      send[position[k]] = local[k];
+      break;
+    case MAX:
+      position[k] = m++;
+      send[position[k]] = local[k];
+      break;
+    case MIN:
+      position[k] = m++;
+      send[position[k]] = -local[k];
+      break;
+    }
+  }
+
+  if (m_impl->type != MPI_DATATYPE_NULL) {
+    MPI_Type_free(&m_impl->type);
+  }
+  int err = MPI_Type_contiguous(N + 1, MPI_DOUBLE, &m_impl->type);
+  PISM_C_CHK(err, 0, "MPI_Type_contiguous");
+  err = MPI_Type_commit(&m_impl->type);
+  PISM_C_CHK(err, 0, "MPI_Type_commit");
+
+  err = MPI_Iallreduce(send.data(), m_impl->receive_buffer.data(), 1, m_impl->type, m_impl->op,
+                       m_impl->comm, &m_impl->request);
+  PISM_C_CHK(err, 0, "MPI_Iallreduce");
+
+  m_impl->in_progress = true;
+}
+
+//! Finish computing all sums, maxima and minima.
+void GlobalReduction::end() {
+  if (not m_impl->in_progress) {
+    throw RuntimeError(PISM_ERROR_LOCATION, "reduction was not started");
+  }
+
+  int err = MPI_Wait(&m_impl->request, MPI_STATUS_IGNORE);
+  PISM_C_CHK(err, 0, "MPI_Wait");
+
+  m_impl->in_progress = false;
+  m_impl->done        = true;
+}
+
+//! Returns the result with index `index`. Valid after end() or reduce().
+double GlobalReduction::operator[](int index) const {
+  if (not m_impl->done) {
+    throw RuntimeError(PISM_ERROR_LOCATION, "reduction is not complete");
+  }
+
+  if (index < 0 or index >= (int)m_impl->local.size()) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION, "invalid index: %d", index);
+  }
+
+  double result = m_impl->receive_buffer[m_impl->position[index]];
+
+  return m_impl->kind[index] == MIN ? -result : result;
+}
+
+//! Returns `count` results starting from the one with index `index`.
+std::vector<double> GlobalReduction::values(int index, int count) const {
+  std::vector<double> result(count);
+  for (int k = 0; k < count; ++k) {
+    result[k] = (*this)[index + k];
+  }
+  return result;
+}
+
+//! Discard all contributions and results to re-use this object.
+void GlobalReduction::reset() {
+  if (m_impl->in_progress) {
+    throw RuntimeError(PISM_ERROR_LOCATION, "cannot reset during a reduction");
+  }
+
+  m_impl->kind.clear();
+  m_impl->local.clear();
+  m_impl->position.clear();
+  m_impl->done = false;
+}
+
+} // end of namespace pism
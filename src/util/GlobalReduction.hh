@@ -0,0 +1,85 @@
+/* Copyright (C) 2024 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PISM_GLOBALREDUCTION_H
+#define PISM_GLOBALREDUCTION_H
+
+#include <vector>
+
+#include <mpi.h>
+
+namespace pism {
+
+/*!
+ * Collects contributions to several global sums, maxima and minima and computes all of
+ * them using *one* call of `MPI_Allreduce` (instead of one call of GlobalSum(),
+ * GlobalMax() or GlobalMin() per quantity).
+ *
+ * Each of sum(), max() and min() returns the index of the (first) result. All ranks have
+ * to add contributions of the same kinds in the same order.
+ *
+ * Usage:
+ *
+ * \code
+ * GlobalReduction r(grid->com);
+ * int area = r.sum(local_area);
+ * int max_speed = r.max(local_max_speed);
+ * r.reduce();
+ * double A = r[area], U = r[max_speed];
+ * \endcode
+ *
+ * Use begin() and end() instead of reduce() to overlap the reduction with computation.
+ * Integer contributions are converted to `double` and are exact if their absolute values
+ * do not exceed 2^53.
+ */
+class GlobalReduction {
+public:
+  GlobalReduction(MPI_Comm comm);
+  ~GlobalReduction();
+
+  int sum(double local);
+  int max(double local);
+  int min(double local);
+
+  int sum(const std::vector<double> &local);
+  int sum(const std::vector<int> &local);
+  int max(const std::vector<double> &local);
+  int min(const std::vector<double> &local);
+
+  void reduce();
+  void begin();
+  void end();
+
+  double operator[](int index) const;
+  std::vector<double> values(int index, int count) const;
+
+  void reset();
+
+private:
+  struct Impl;
+  Impl *m_impl;
+
+  // disable copy constructor and the assignment operator:
+  GlobalReduction(const GlobalReduction &other);
+  GlobalReduction &operator=(const GlobalReduction &);
+};
+
+} // end of namespace pism
+
+#endif /* PISM_GLOBALREDUCTION_H */
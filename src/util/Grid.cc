@@ -18,6 +18,7 @@
 
 #include <cassert>
 
+#include <algorithm>            // std::lower_bound
 #include <array>
 #include <cmath>
 #include <cstddef>
@@ -238,6 +239,12 @@ static std::shared_ptr<Grid> Grid_FromFile(std::shared_ptr<const Context> ctx, c
 
     p.ownership_ranges_from_options(*ctx->config(), ctx->size());
 
+    if (ctx->config()->get_string("grid.partitioning.method") == "ice_extent") {
+      log.message(2, "  choosing ownership ranges to balance ice extent in '%s'\n",
+                  file.name().c_str());
+      p.ownership_ranges_from_ice_extent(*ctx->config(), ctx->unit_system(), file);
+    }
+
     return std::make_shared<Grid>(ctx, p);
   } catch (RuntimeError &e) {
     e.add_context("initializing computational grid from variable \"%s\" in \"%s\"",
@@ -1264,6 +1271,116 @@ void Parameters::ownership_ranges_from_options(const Config &config, unsigned in
   procs_y = py;
 }
 
+/*!
+ * Re-compute ownership ranges so that sub-domains contain similar numbers of ice-covered
+ * grid columns.
+ *
+ * Most of the work (energy balance, age, SIA) is done in icy columns, so the uniform split
+ * computed by ownership_ranges_from_options() leaves ranks owning ice-free areas idle.
+ *
+ * This method reads ice thickness (the last record) from `file` and uses the weight of 1
+ * for icy columns and `grid.partitioning.ice_free_weight` for ice-free ones. Sub-domains
+ * of a PETSc DMDA form a tensor product, so widths in the X direction balance sums of
+ * weights over grid columns and widths in the Y direction balance sums over grid rows.
+ *
+ * Keeps the number of sub-domains in each direction and does not override widths set
+ * using `grid.procs_x` and `grid.procs_y`. Keeps current ranges if `file` does not
+ * contain ice thickness on the same grid.
+ *
+ * This is a collective call.
+ */
+void Parameters::ownership_ranges_from_ice_extent(const Config &config,
+                                                  std::shared_ptr<units::System> unit_system,
+                                                  const File &file) {
+  auto thk = file.find_variable("thk", "land_ice_thickness");
+  if (not thk.exists) {
+    return;
+  }
+
+  MPI_Comm com = file.com();
+  int rank = 0, size = 1;
+  MPI_Comm_rank(com, &rank);
+  MPI_Comm_size(com, &size);
+
+  // each rank reads a band of rows
+  auto rows = ownership_ranges(My, size);
+  unsigned int row_start = std::accumulate(rows.begin(), rows.begin() + rank, 0U);
+  unsigned int n_rows    = rows[rank];
+
+  auto dimensions = file.dimensions(thk.name);
+  std::vector<unsigned int> start(dimensions.size()), count(dimensions.size());
+  int x_dim = -1, y_dim = -1;
+  for (unsigned int k = 0; k < dimensions.size(); ++k) {
+    auto length = file.dimension_length(dimensions[k]);
+
+    switch (file.dimension_type(dimensions[k], unit_system)) {
+    case T_AXIS:
+      start[k] = length > 0 ? length - 1 : 0;
+      count[k] = 1;
+      break;
+    case X_AXIS:
+      if (length != Mx) {
+        return;
+      }
+      start[k] = 0;
+      count[k] = Mx;
+      x_dim    = static_cast<int>(k);
+      break;
+    case Y_AXIS:
+      if (length != My) {
+        return;
+      }
+      start[k] = row_start;
+      count[k] = n_rows;
+      y_dim    = static_cast<int>(k);
+      break;
+    default:
+      start[k] = 0;
+      count[k] = 1;
+    }
+  }
+
+  if (x_dim < 0 or y_dim < 0) {
+    return;
+  }
+
+  std::vector<double> H(static_cast<size_t>(Mx) * n_rows);
+  file.read_variable(thk.name, start, count, H.data());
+
+  // strides corresponding to the storage order in the file
+  std::vector<size_t> stride(count.size(), 1);
+  for (int k = (int)count.size() - 2; k >= 0; --k) {
+    stride[k] = stride[k + 1] * count[k + 1];
+  }
+
+  double ice_free_weight = config.get_number("grid.partitioning.ice_free_weight");
+
+  std::vector<double> column_weights(Mx, 0.0), row_weights(My, 0.0);
+  for (unsigned int j = 0; j < n_rows; ++j) {
+    for (unsigned int i = 0; i < Mx; ++i) {
+      double w = H[i * stride[x_dim] + j * stride[y_dim]] > 0.0 ? 1.0 : ice_free_weight;
+
+      column_weights[i] += w;
+      row_weights[row_start + j] += w;
+    }
+  }
+
+  std::vector<double> wx(Mx), wy(My);
+  GlobalSum(com, column_weights.data(), wx.data(), (int)Mx);
+  GlobalSum(com, row_weights.data(), wy.data(), (int)My);
+
+  auto min_width = static_cast<unsigned int>(config.get_number("grid.max_stencil_width"));
+  min_width = std::max(min_width, 2U);
+
+  if (config.get_string("grid.procs_x").empty()) {
+    procs_x = weighted_ownership_ranges(wx, procs_x.size(), min_width);
+  }
+
+  if (config.get_string("grid.procs_y").empty()) {
+    procs_y = weighted_ownership_ranges(wy, procs_y.size(), min_width);
+  }
+}
+
 Parameters::Parameters(std::shared_ptr<units::System> unit_system, const File &file,
                        const std::string &variable, Registration r) {
   InputGridInfo input_grid(file, variable, unit_system, r);
@@ -1433,6 +1550,50 @@ std::vector<unsigned int> ownership_ranges(unsigned int Mx, unsigned int Nx) {
   return result;
 }
 
+/*!
+ * Computes processor ownership ranges splitting points with given `weights` into `N` parts
+ * with approximately equal sums of weights.
+ *
+ * Each part gets at least `min_width` points.
+ */
+std::vector<unsigned int> weighted_ownership_ranges(const std::vector<double> &weights,
+                                                    unsigned int N, unsigned int min_width) {
+  size_t M = weights.size();
+
+  if (N == 0 or M < (size_t)N * min_width) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "Can't split %d grid points into %d parts"
+                                  " of at least %d points each.",
+                                  (int)M, (int)N, (int)min_width);
+  }
+
+  // partial sums: S[k] is the sum of the first k weights
+  std::vector<double> S(M + 1, 0.0);
+  std::partial_sum(weights.begin(), weights.end(), S.begin() + 1);
+
+  std::vector<unsigned int> result(N);
+  size_t start = 0;
+  for (unsigned int k = 0; k < N - 1; ++k) {
+    double target = S[M] * (k + 1) / N;
+
+    // leave enough points for remaining parts
+    size_t lo = start + min_width;
+    size_t hi = M - (size_t)(N - k - 1) * min_width;
+
+    // the end (exclusive) of the current part: the partial sum closest to the target
+    size_t end = std::lower_bound(S.begin() + lo, S.begin() + hi, target) - S.begin();
+    if (end > lo and target - S[end - 1] < S[end] - target) {
+      end -= 1;
+    }
+
+    result[k] = end - start;
+    start     = end;
+  }
+  result[N - 1] = M - start;
+
+  return result;
+}
+
 } // namespace grid
 
 //! Create a grid using command-line options and (possibly) an input file.
@@ -1618,4 +1779,40 @@ PointsWithGhosts::PointsWithGhosts(const Grid &grid, unsigned int stencil_width)
   m_done = false;
 }
 
+PointsInterior::PointsInterior(const Grid &grid, unsigned int stencil_width) {
+  int W = static_cast<int>(stencil_width);
+  m_i_first = grid.xs() + W;
+  m_i_last  = grid.xs() + grid.xm() - W - 1;
+  m_j_first = grid.ys() + W;
+  m_j_last  = grid.ys() + grid.ym() - W - 1;
+
+  m_i    = m_i_first;
+  m_j    = m_j_first;
+  m_done = (m_i_first > m_i_last or m_j_first > m_j_last);
+}
+
+PointsBoundary::PointsBoundary(const Grid &grid, unsigned int stencil_width) {
+  int W = static_cast<int>(stencil_width);
+  m_i_first = grid.xs();
+  m_i_last  = grid.xs() + grid.xm() - 1;
+  m_j_first = grid.ys();
+  m_j_last  = grid.ys() + grid.ym() - 1;
+
+  m_interior_i_first = m_i_first + W;
+  m_interior_i_last  = m_i_last - W;
+  m_interior_j_first = m_j_first + W;
+  m_interior_j_last  = m_j_last - W;
+
+  if (m_interior_i_first > m_interior_i_last or m_interior_j_first > m_interior_j_last) {
+    // the interior is empty: all points are "boundary" points
+    m_interior_j_first = m_j_last + 1;
+    m_interior_j_last  = m_j_last + 1;
+  }
+
+  m_i = m_i_first;
+  m_j = m_j_first;
+  // if W == 0 all points are "interior" points
+  m_done = (W == 0);
+}
+
 } // end of namespace pism
@@ -141,6 +141,10 @@ public:
   void vertical_grid_from_options(const Config &config);
   //! Re-compute ownership ranges. Uses current values of Mx and My.
   void ownership_ranges_from_options(const Config &config, unsigned int size);
+  //! Re-compute ownership ranges to balance the number of icy columns in `file`.
+  void ownership_ranges_from_ice_extent(const Config &config,
+                                        std::shared_ptr<units::System> unit_system,
+                                        const File &file);
 
   //! Validate data members.
   void validate() const;
@@ -227,6 +231,93 @@ public:
   Points(const Grid &g) : PointsWithGhosts(g, 0) {}
 };
 
+/** Iterator class for traversing grid points owned by this rank that are at least
+ * `stencil_width` points away from the boundary of the sub-domain, i.e. points where a
+ * stencil of this width does not use ghosts.
+ *
+ * Use this together with PointsBoundary to overlap computation and ghost communication:
+ *
+ * \code
+ * x.update_ghosts_begin();
+ * for (auto p = grid.points_interior(1); p; p.next()) { ... }
+ * x.update_ghosts_end();
+ * for (auto p = grid.points_boundary(1); p; p.next()) { ... }
+ * \endcode
+ */
+class PointsInterior {
+public:
+  PointsInterior(const Grid &grid, unsigned int stencil_width);
+
+  int i() const {
+    return m_i;
+  }
+  int j() const {
+    return m_j;
+  }
+
+  void next() {
+    assert(not m_done);
+    m_i += 1;
+    if (m_i > m_i_last) {
+      m_i = m_i_first;        // wrap around
+      m_j += 1;
+    }
+    if (m_j > m_j_last) {
+      m_j = m_j_first;        // ensure that indexes are valid
+      m_done = true;
+    }
+  }
+
+  operator bool() const {
+    return not m_done;
+  }
+private:
+  int m_i, m_j;
+  int m_i_first, m_i_last, m_j_first, m_j_last;
+  bool m_done;
+};
+
+/** Iterator class for traversing grid points owned by this rank that are *less* than
+ * `stencil_width` points away from the boundary of the sub-domain (the complement of
+ * PointsInterior).
+ */
+class PointsBoundary {
+public:
+  PointsBoundary(const Grid &grid, unsigned int stencil_width);
+
+  int i() const {
+    return m_i;
+  }
+  int j() const {
+    return m_j;
+  }
+
+  void next() {
+    assert(not m_done);
+    m_i += 1;
+    if (m_j >= m_interior_j_first and m_j <= m_interior_j_last and m_i == m_interior_i_first) {
+      m_i = m_interior_i_last + 1; // skip interior points in this row
+    }
+    if (m_i > m_i_last) {
+      m_i = m_i_first;        // wrap around
+      m_j += 1;
+    }
+    if (m_j > m_j_last) {
+      m_j = m_j_first;        // ensure that indexes are valid
+      m_done = true;
+    }
+  }
+
+  operator bool() const {
+    return not m_done;
+  }
+private:
+  int m_i, m_j;
+  int m_i_first, m_i_last, m_j_first, m_j_last;
+  int m_interior_i_first, m_interior_i_last, m_interior_j_first, m_interior_j_last;
+  bool m_done;
+};
+
 
 //! Describes the PISM grid and the distribution of data across processors.
 /*!
@@ -376,6 +467,14 @@ public:
     return {*this, stencil_width};
   }
 
+  PointsInterior points_interior(unsigned int stencil_width) const {
+    return {*this, stencil_width};
+  }
+
+  PointsBoundary points_boundary(unsigned int stencil_width) const {
+    return {*this, stencil_width};
+  }
+
 private:
   struct Impl;
   Impl *m_impl;
@@ -415,6 +514,9 @@ std::array<unsigned, 2> nprocs(unsigned int size, unsigned int Mx,
 
 std::vector<unsigned int> ownership_ranges(unsigned int Mx, unsigned int Nx);
 
+std::vector<unsigned int> weighted_ownership_ranges(const std::vector<double> &weights,
+                                                    unsigned int N, unsigned int min_width);
+
 } // namespace grid
 
 } // end of namespace pism
@@ -1,4 +1,4 @@
-/* Copyright (C) 2015, 2016, 2021, 2022, 2023 PISM Authors
+/* Copyright (C) 2015, 2016, 2021, 2022, 2023, 2024 PISM Authors
  *
  * This file is part of PISM.
  *
@@ -20,8 +20,13 @@
 #include <petsclog.h>
 #include <petscviewer.h>
 
+#include <algorithm>            // std::min, std::max
+#include <cstdio>               // fopen, fprintf, fclose
+#include <limits>
+
 #include "pism/util/Profiling.hh"
 #include "pism/util/error_handling.hh"
+#include "pism/util/pism_utilities.hh" // ends_with, split
 
 namespace pism {
 
@@ -42,11 +47,15 @@ void Profiling::start() const {
 }
 
 //! Save detailed profiling data to a Python script.
-void Profiling::report(const std::string &filename) const {
+/*!
+ * This is a collective call on `com`, which has to contain all the ranks running the
+ * model (and *only* those: ranks set aside as I/O servers never get here).
+ */
+void Profiling::report(MPI_Comm com, const std::string &filename) const {
   PetscErrorCode ierr;
   PetscViewer log_viewer;
 
-  ierr = PetscViewerCreate(PETSC_COMM_WORLD, &log_viewer);
+  ierr = PetscViewerCreate(com, &log_viewer);
   PISM_CHK(ierr, "PetscViewerCreate");
 
   ierr = PetscViewerSetType(log_viewer, PETSCVIEWERASCII);
@@ -86,6 +95,9 @@ void Profiling::begin(const char * name) const {
   }
   ierr = PetscLogEventBegin(event, 0, 0, 0, 0);
   PISM_CHK(ierr, "PetscLogEventBegin");
+
+  std::string full_name = m_active.empty() ? name : m_active.back().first + "/" + name;
+  m_active.emplace_back(full_name, MPI_Wtime());
 }
 
 void Profiling::end(const char * name) const {
@@ -98,6 +110,221 @@ void Profiling::end(const char * name) const {
 
   PetscErrorCode ierr = PetscLogEventEnd(m_events[name], 0, 0, 0, 0);
   PISM_CHK(ierr, "PetscLogEventEnd");
+
+  // Find the innermost active event with this name. Events started after it and not
+  // ended (e.g. because of an exception) end here as well.
+  std::string suffix = std::string("/") + name;
+  double now = MPI_Wtime();
+  while (not m_active.empty()) {
+    auto event = m_active.back();
+    m_active.pop_back();
+
+    auto &record = m_records[event.first];
+    record.time += now - event.second;
+    record.calls += 1;
+
+    if (event.first == name or ends_with(event.first, suffix)) {
+      break;
+    }
+  }
+}
+
+/*!
+ * Increment the counter `name` of the innermost active event (or the top-level counter
+ * if no events are active).
+ */
+void Profiling::count(const char *name, double increment) const {
+  const std::string &event = m_active.empty() ? "" : m_active.back().first;
+  m_records[event].counters[name] += increment;
+}
+
+/*!
+ * Return total wall-clock times (on this rank) of events nested directly in the event
+ * `parent` (use an empty string to get top-level events), indexed by short names.
+ */
+std::map<std::string, double> Profiling::times(const std::string &parent) const {
+  std::string prefix = parent.empty() ? "" : parent + "/";
+
+  std::map<std::string, double> result;
+  for (const auto &r : m_records) {
+    const auto &name = r.first;
+    if (name.empty() or name.size() <= prefix.size() or name.compare(0, prefix.size(), prefix) != 0) {
+      continue;
+    }
+
+    auto short_name = name.substr(prefix.size());
+    if (short_name.find('/') == std::string::npos) {
+      result[short_name] = r.second.time;
+    }
+  }
+  return result;
+}
+
+Profiling::Scope::Scope(const Profiling &profiling, const char *name)
+  : m_profiling(profiling), m_name(name) {
+  m_profiling.begin(m_name);
+}
+
+Profiling::Scope::~Scope() {
+  try {
+    m_profiling.end(m_name);
+  } catch (...) {
+    // don't ever throw from here
+  }
+}
+
+namespace {
+
+//! Summary of a quantity across all ranks.
+struct Summary {
+  Summary()
+    : min(std::numeric_limits<double>::max()),
+      max(std::numeric_limits<double>::lowest()),
+      sum(0.0),
+      n_ranks(0) {
+  }
+  double min, max, sum;
+  //! number of ranks that reported this quantity
+  int n_ranks;
+};
+
+std::string escape(const std::string &input) {
+  std::string result;
+  for (char c : input) {
+    if (c == '"' or c == '\\') {
+      result += '\\';
+    }
+    result += c;
+  }
+  return result;
+}
+
+} // end of anonymous namespace
+
+/*!
+ * Save the time, the number of calls, and counters of each event to `filename`.
+ *
+ * Reports minimum, maximum, and average values across all ranks in `com`. Ranks that did
+ * not record an event contribute zeros.
+ *
+ * Uses CSV if `filename` ends with ".csv" and JSON otherwise.
+ *
+ * This is a collective call.
+ */
+void Profiling::save_summary(MPI_Comm com, const std::string &filename) const {
+  int rank = 0, size = 1;
+  MPI_Comm_rank(com, &rank);
+  MPI_Comm_size(com, &size);
+
+  // Flatten local records: each quantity is identified by "event\nquantity".
+  std::string names;
+  std::vector<double> values;
+  for (const auto &r : m_records) {
+    const auto &event  = r.first.empty() ? std::string("total") : r.first;
+    const auto &record = r.second;
+
+    if (not r.first.empty()) {
+      names += event + "\ntime\n";
+      values.push_back(record.time);
+      names += event + "\ncalls\n";
+      values.push_back(record.calls);
+    }
+
+    for (const auto &c : record.counters) {
+      names += event + "\n" + c.first + "\n";
+      values.push_back(c.second);
+    }
+  }
+
+  // gather everything on rank 0
+  int n_chars = static_cast<int>(names.size()), n_values = static_cast<int>(values.size());
+  std::vector<int> chars_per_rank(size), values_per_rank(size);
+  MPI_Gather(&n_chars, 1, MPI_INT, chars_per_rank.data(), 1, MPI_INT, 0, com);
+  MPI_Gather(&n_values, 1, MPI_INT, values_per_rank.data(), 1, MPI_INT, 0, com);
+
+  std::vector<int> chars_displ(size, 0), values_displ(size, 0);
+  for (int k = 1; k < size; ++k) {
+    chars_displ[k]  = chars_displ[k - 1] + chars_per_rank[k - 1];
+    values_displ[k] = values_displ[k - 1] + values_per_rank[k - 1];
+  }
+
+  std::vector<char> all_names(rank == 0 ? chars_displ.back() + chars_per_rank.back() : 0);
+  std::vector<double> all_values(rank == 0 ? values_displ.back() + values_per_rank.back() : 0);
+
+  MPI_Gatherv(names.data(), n_chars, MPI_CHAR, all_names.data(), chars_per_rank.data(),
+              chars_displ.data(), MPI_CHAR, 0, com);
+  MPI_Gatherv(values.data(), n_values, MPI_DOUBLE, all_values.data(), values_per_rank.data(),
+              values_displ.data(), MPI_DOUBLE, 0, com);
+
+  int stat = 0;
+  if (rank == 0) {
+    // (event, quantity) -> summary
+    std::map<std::pair<std::string, std::string>, Summary> summary;
+
+    for (int k = 0; k < size; ++k) {
+      std::string rank_names(all_names.data() + chars_displ[k], chars_per_rank[k]);
+      auto lines = split(rank_names, '\n');
+
+      for (int n = 0; n < values_per_rank[k]; ++n) {
+        double value = all_values[values_displ[k] + n];
+        auto &s      = summary[{ lines[2 * n], lines[2 * n + 1] }];
+
+        s.min = std::min(s.min, value);
+        s.max = std::max(s.max, value);
+        s.sum += value;
+        s.n_ranks += 1;
+      }
+    }
+
+    bool csv = ends_with(filename, ".csv");
+
+    FILE *f = fopen(filename.c_str(), "w");
+    if (f != nullptr) {
+      if (csv) {
+        fprintf(f, "event,quantity,min,max,avg\n");
+      } else {
+        fprintf(f, "{\n  \"n_ranks\": %d,\n  \"events\": [", size);
+      }
+
+      bool first = true;
+      for (const auto &s : summary) {
+        const auto &event    = s.first.first;
+        const auto &quantity = s.first.second;
+        const auto &v        = s.second;
+
+        // ranks that did not report this quantity contribute zeros
+        double min = v.n_ranks < size ? std::min(v.min, 0.0) : v.min;
+        double max = v.n_ranks < size ? std::max(v.max, 0.0) : v.max;
+        double avg = v.sum / size;
+
+        if (csv) {
+          fprintf(f, "\"%s\",%s,%.6g,%.6g,%.6g\n", escape(event).c_str(), quantity.c_str(),
+                  min, max, avg);
+        } else {
+          fprintf(f,
+                  "%s\n    {\"event\": \"%s\", \"quantity\": \"%s\", "
+                  "\"min\": %.6g, \"max\": %.6g, \"avg\": %.6g}",
+                  first ? "" : ",", escape(event).c_str(), escape(quantity).c_str(), min, max,
+                  avg);
+        }
+        first = false;
+      }
+
+      if (not csv) {
+        fprintf(f, "\n  ]\n}\n");
+      }
+
+      stat = fclose(f) == 0 ? 0 : 1;
+    } else {
+      stat = 1;
+    }
+  }
+
+  MPI_Bcast(&stat, 1, MPI_INT, 0, com);
+  if (stat != 0) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION, "failed to write profiling summary to '%s'",
+                                  filename.c_str());
+  }
 }
 
 void Profiling::stage_begin(const char * name) const {
@@ -1,4 +1,4 @@
-/* Copyright (C) 2015 PISM Authors
+/* Copyright (C) 2015, 2024 PISM Authors
  *
  * This file is part of PISM.
  *
@@ -22,23 +22,67 @@
 
 #include <map>
 #include <string>
+#include <vector>
+
+#include <mpi.h>
 #include <petsclog.h>
 
 namespace pism {
 
+//! Profiling events and counters.
+/*!
+ * Every event started using begin() is forwarded to PETSc's logging (see start() and
+ * report()) *and* recorded by PISM.
+ *
+ * PISM's own records do not require PETSc logging: events started while another event is
+ * active are nested in it, so the same event may appear in several places (e.g.
+ * "stress_balance/sia.flux"). Each event keeps track of its wall-clock time, the number
+ * of calls and counters incremented using count() while it is the innermost active event.
+ *
+ * Use save_summary() to save min/max/average values of these across all ranks.
+ */
 class Profiling {
 public:
   Profiling();
   void start() const;
-  void report(const std::string &filename) const;
+  void report(MPI_Comm com, const std::string &filename) const;
   void begin(const char *name) const;
   void end(const char *name) const;
   void stage_begin(const char *name) const;
   void stage_end(const char *name) const;
+
+  void count(const char *name, double increment = 1.0) const;
+
+  void save_summary(MPI_Comm com, const std::string &filename) const;
+
+  std::map<std::string, double> times(const std::string &parent) const;
+
+  //! Calls begin() in the constructor and end() in the destructor.
+  class Scope {
+  public:
+    Scope(const Profiling &profiling, const char *name);
+    ~Scope();
+  private:
+    const Profiling &m_profiling;
+    const char *m_name;
+  };
 private:
   PetscClassId m_classid;
   mutable std::map<std::string, PetscLogEvent> m_events;
   mutable std::map<std::string, PetscLogStage> m_stages;
+
+  struct Record {
+    Record() : time(0.0), calls(0) {}
+    //! total wall-clock time, in seconds
+    double time;
+    int calls;
+    std::map<std::string, double> counters;
+  };
+  //! records indexed by full event names (nested names are separated by "/")
+  mutable std::map<std::string, Record> m_records;
+
+  //! full names and start times of active events
+  mutable std::vector<std::pair<std::string, double> > m_active;
 };
 
 } // end of namespace pism
@@ -372,6 +372,13 @@ void set_default_value_or_stop(const VariableMetadata &variable, io::Default def
   }
 }
 
+//! Size of the part of `array` owned by this rank, in bytes.
+static double local_size_bytes(const Array &array) {
+  auto grid = array.grid();
+  return static_cast<double>(sizeof(double)) * grid->xm() * grid->ym() * array.ndof() *
+         array.levels().size();
+}
+
 //! Gets an Array from a file `file`, interpolating onto the current grid.
 /*! Stops if the variable was not found and `critical` == true.
  */
@@ -613,16 +620,53 @@ void  Array::end_access() const {
 
 //! Updates ghost points.
 void  Array::update_ghosts() {
-  PetscErrorCode ierr;
+  update_ghosts_begin();
+  update_ghosts_end();
+}
+
+/*!
+ * Start updating ghost points.
+ *
+ * Values at owned grid points may be *read* until the matching update_ghosts_end()
+ * call. Do not modify this array and do not use its ghost values until then.
+ *
+ * See PointsInterior and PointsBoundary.
+ */
+void Array::update_ghosts_begin() {
   if (not m_impl->ghosted) {
     return;
   }
 
-  ierr = DMLocalToLocalBegin(*dm(), vec(), INSERT_VALUES, vec());
+  if (m_impl->ghost_update_in_progress) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "ghost update of '%s' is already in progress",
+                                  m_impl->name.c_str());
+  }
+
+  PetscErrorCode ierr = DMLocalToLocalBegin(*dm(), vec(), INSERT_VALUES, vec());
   PISM_CHK(ierr, "DMLocalToLocalBegin");
 
-  ierr = DMLocalToLocalEnd(*dm(), vec(), INSERT_VALUES, vec());
+  m_impl->ghost_update_in_progress = true;
+}
+
+//! Finish updating ghost points (see update_ghosts_begin()).
+void Array::update_ghosts_end() {
+  if (not m_impl->ghosted) {
+    return;
+  }
+
+  if (not m_impl->ghost_update_in_progress) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "ghost update of '%s' was not started",
+                                  m_impl->name.c_str());
+  }
+
+  PetscErrorCode ierr = DMLocalToLocalEnd(*dm(), vec(), INSERT_VALUES, vec());
   PISM_CHK(ierr, "DMLocalToLocalEnd");
+
+  m_impl->ghost_update_in_progress = false;
+
+  m_impl->grid->ctx()->profiling().count("ghost_updates");
 }
 
 //! Result: v[j] <- c for all j.
@@ -811,6 +855,7 @@ void Array::regrid(const File &file, io::Default default_value) {
       check_range(vec(), metadata(0), file.name(), *log, m_impl->report_range);
     }
 
+    m_impl->grid->ctx()->profiling().count("bytes_read", local_size_bytes(*this));
 
   } catch (RuntimeError &e) {
     e.add_context("regridding '%s' from '%s'",
@@ -832,6 +877,8 @@ void Array::regrid(const File &file, io::Default default_value) {
 void Array::read(const File &file, const unsigned int time) {
   this->read_impl(file, time);
   inc_state_counter();          // mark as modified
+
+  m_impl->grid->ctx()->profiling().count("bytes_read", local_size_bytes(*this));
 }
 
 void Array::write(const File &file) const {
@@ -842,6 +889,8 @@ void Array::write(const File &file) const {
   write_impl(file);
   double end_time = get_time(com);
 
+  m_impl->grid->ctx()->profiling().count("bytes_written", local_size_bytes(*this));
+
   const double
     minute     = 60.0,          // one minute in seconds
     time_spent = end_time - start_time,
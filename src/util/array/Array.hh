@@ -243,6 +243,8 @@ public:
   virtual void begin_access() const;
   virtual void end_access() const;
   void update_ghosts();
+  void update_ghosts_begin();
+  void update_ghosts_end();
 
   std::shared_ptr<petsc::Vec> allocate_proc0_copy() const;
   void put_on_proc0(petsc::Vec &onp0) const;
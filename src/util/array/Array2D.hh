@@ -70,8 +70,8 @@ public:
     details::add(*this, alpha, x, result);
   }
 
-  void copy_from(const Array2D<T> &source) {
-    return details::copy(source, *this);
+  void copy_from(const Array2D<T> &source, bool scatter = true) {
+    return details::copy(source, *this, scatter);
   }
 
 protected:
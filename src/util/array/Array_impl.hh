@@ -46,6 +46,7 @@ struct Array::Impl {
     begin_access_use_dof = false;
 
     ghosted = true;
+    ghost_update_in_progress = false;
 
     report_range = true;
 
@@ -85,6 +86,9 @@ struct Array::Impl {
   //! true if this Array is ghosted
   bool ghosted;
 
+  //! true between update_ghosts_begin() and update_ghosts_end() calls
+  bool ghost_update_in_progress;
+
   //! distributed mesh manager (DM)
   //!
   //! Note: do not access this directly (via `m_impl->da`). Use `dm()` instead.
@@ -47,7 +47,10 @@ struct Forcing::Data {
       first(-1),
       n_records(0),
       period(0.0),
-      period_start(0.0) {
+      period_start(0.0),
+      next_first(-1),
+      next_n_records(0),
+      prefetch(0) {
     // empty
   }
   //! all the times available in filename
@@ -92,6 +95,23 @@ struct Forcing::Data {
 
   //! minimum time step length in max_timestep(), in seconds
   double dt_min;
+
+  //! second buffer containing records following the ones in `v` (see Forcing::prefetch())
+  petsc::Vec v_next;
+
+  //! a 2D Vec used to read records into `v_next` (this way reading ahead does not
+  //! overwrite the current value of the field)
+  petsc::Vec v_scratch;
+
+  //! in-file index of the first record stored in `v_next` (-1 if `v_next` is empty)
+  int next_first;
+
+  //! number of records stored in `v_next`
+  unsigned int next_n_records;
+
+  //! number of records to read ahead during an update() call that does not need new
+  //! records (0 disables prefetching)
+  unsigned int prefetch;
 };
 
 /*!
@@ -189,6 +209,8 @@ void Forcing::allocate(unsigned int buffer_size, InterpolationType interpolation
 
   m_data->dt_min = config->get_number("time_stepping.resolution");
 
+  m_data->prefetch = static_cast<unsigned int>(config->get_number("input.forcing.prefetch"));
+
   if (not (m_data->interp_type == PIECEWISE_CONSTANT or
            m_data->interp_type == LINEAR)) {
     throw RuntimeError(PISM_ERROR_LOCATION, "unsupported interpolation type");
@@ -242,6 +264,10 @@ void Forcing::init(const std::string &filename, bool periodic) {
 
     m_data->filename = filename;
 
+    // discard records read ahead of time (if any)
+    m_data->next_first     = -1;
+    m_data->next_n_records = 0;
+
     File file(m_impl->grid->com, m_data->filename, io::PISM_GUESS, io::PISM_READONLY);
     auto var = file.find_variable(m_impl->metadata[0].get_name(),
                                   m_impl->metadata[0]["standard_name"]);
@@ -453,6 +479,7 @@ void Forcing::update(double t, double dt) {
 
     // just return if we have all the data we need:
     if (t >= t0 and t + dt <= t1) {
+      prefetch();
       return;
     }
   }
@@ -524,6 +551,31 @@ void Forcing::update(unsigned int start) {
                  t->date(m_data->time[start + missing - 1]).c_str());
   }
 
+  // use records read ahead of time by prefetch(), if possible
+  unsigned int n_prefetched = 0;
+  if (m_data->next_first >= 0 and start >= (unsigned int)m_data->next_first) {
+    unsigned int next_end = m_data->next_first + m_data->next_n_records;
+
+    while (n_prefetched < missing and start + n_prefetched < next_end) {
+      copy_prefetched_record(start + n_prefetched - m_data->next_first, kept + n_prefetched);
+      n_prefetched += 1;
+    }
+  }
+
+  if (n_prefetched < missing) {
+    read_records(start + n_prefetched, missing - n_prefetched, kept + n_prefetched, false);
+  }
+}
+
+/*!
+ * Read `count` records starting from the in-file index `start` and store them starting at
+ * the index `offset` in the buffer (`v` or `v_next` if `next_buffer` is true).
+ */
+void Forcing::read_records(unsigned int start, unsigned int count, unsigned int offset,
+                           bool next_buffer) {
+  auto t   = m_impl->grid->ctx()->time();
+  auto log = m_impl->grid->ctx()->log();
+
   File file(m_impl->grid->com, m_data->filename, io::PISM_GUESS, io::PISM_READONLY);
 
   auto variable = m_impl->metadata[0];
@@ -533,13 +585,18 @@ void Forcing::update(unsigned int start) {
 
     auto interp = grid()->get_interpolation({0.0}, file, V.name, m_impl->interpolation_type);
 
-    for (unsigned int j = 0; j < missing; ++j) {
-      interp->regrid(variable, file, (int)(start + j), *grid(), vec());
+    for (unsigned int j = 0; j < count; ++j) {
+      interp->regrid(variable, file, (int)(start + j), *grid(),
+                     next_buffer ? m_data->v_scratch : vec());
 
       log->message(5, " %s: reading entry #%02d, year %s...\n", m_impl->name.c_str(), start + j,
                    t->date(m_data->time[start + j]).c_str());
 
-      set_record(kept + j);
+      if (next_buffer) {
+        set_prefetched_record(offset + j);
+      } else {
+        set_record(offset + j);
+      }
     }
   } catch (RuntimeError &e) {
     e.add_context("regridding '%s' from '%s'", this->get_name().c_str(), m_data->filename.c_str());
@@ -547,6 +604,52 @@ void Forcing::update(unsigned int start) {
   }
 }
 
+/*!
+ * Read up to `input.forcing.prefetch` records following the ones currently in memory and
+ * store them in the second buffer.
+ *
+ * This spreads the cost of reading the next window of records over update() calls that
+ * do not need new data, avoiding a long pause when the model time reaches the end of the
+ * records in memory.
+ */
+void Forcing::prefetch() {
+  if (m_data->prefetch == 0 or m_data->first < 0) {
+    return;
+  }
+
+  unsigned int time_size = m_data->time.size();
+
+  // in-file index of the first record that is not in memory
+  unsigned int next = m_data->first + m_data->n_records;
+
+  if (m_data->next_first != (int)next) {
+    // records in the second buffer (if any) will not be used
+    m_data->next_first     = next;
+    m_data->next_n_records = 0;
+  }
+
+  unsigned int start = next + m_data->next_n_records;
+  unsigned int end   = std::min(next + buffer_size(), time_size);
+
+  if (start >= end) {
+    return;
+  }
+
+  if (m_data->v_next.get() == nullptr) {
+    PetscErrorCode ierr = DMCreateGlobalVector(*m_data->da, m_data->v_next.rawptr());
+    PISM_CHK(ierr, "DMCreateGlobalVector");
+
+    ierr = VecDuplicate(vec(), m_data->v_scratch.rawptr());
+    PISM_CHK(ierr, "VecDuplicate");
+  }
+
+  unsigned int N = std::min(m_data->prefetch, end - start);
+
+  read_records(start, N, start - next, true);
+
+  m_data->next_n_records += N;
+}
+
 //! Discard the first N records, shifting the rest of them towards the "beginning".
 void Forcing::discard(int number) {
 
@@ -581,6 +684,35 @@ void Forcing::set_record(int n) {
   }
 }
 
+//! Sets the record number n in the second buffer to the contents of the scratch Vec.
+void Forcing::set_prefetched_record(int n) {
+
+  petsc::DMDAVecArray scratch(dm(), m_data->v_scratch);
+  petsc::DMDAVecArrayDOF next(m_data->da, m_data->v_next);
+
+  double  **a2 = static_cast<double**>(scratch.get());
+  double ***b3 = static_cast<double***>(next.get());
+  for (auto p = m_impl->grid->points(); p; p.next()) {
+    const int i = p.i(), j = p.j();
+    b3[j][i][n] = a2[j][i];
+  }
+}
+
+//! Copies the record number k in the second buffer to the record number n.
+void Forcing::copy_prefetched_record(int k, int n) {
+
+  array::AccessScope l{this};
+
+  petsc::DMDAVecArrayDOF next(m_data->da, m_data->v_next);
+
+  double ***a3 = array3();
+  double ***b3 = static_cast<double***>(next.get());
+  for (auto p = m_impl->grid->points(); p; p.next()) {
+    const int i = p.i(), j = p.j();
+    a3[j][i][n] = b3[j][i][k];
+  }
+}
+
 //! @brief Given the time t determines the maximum possible time-step this Forcing
 //! allows.
 MaxTimestep Forcing::max_timestep(double t) const {
@@ -84,8 +84,13 @@ private:
 
   double*** array3();
   void update(unsigned int start);
+  void read_records(unsigned int start, unsigned int count, unsigned int offset,
+                    bool next_buffer);
+  void prefetch();
   void discard(int N);
   void set_record(int n);
+  void set_prefetched_record(int n);
+  void copy_prefetched_record(int k, int n);
   void init_periodic_data(const File &file);
 };
 
@@ -0,0 +1,430 @@
+/* Copyright (C) 2024 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <algorithm> // std::upper_bound, std::copy_n, std::fill
+#include <map>
+#include <set>
+#include <vector>
+
+#include <mpi.h>
+#include <petscdmda.h>
+
+#include "pism/util/array/GhostExchange.hh"
+#include "pism/util/array/Array.hh"
+#include "pism/util/Context.hh"
+#include "pism/util/Grid.hh"
+#include "pism/util/Profiling.hh"
+#include "pism/util/error_handling.hh"
+#include "pism/util/petscwrappers/DM.hh"
+#include "pism/util/petscwrappers/Vec.hh"
+
+namespace pism {
+namespace array {
+
+namespace {
+
+//! A contiguous block of values in the local (ghosted) Vec of an array.
+struct Block {
+  int array;
+  int offset;
+  int size;
+};
+
+//! Append a block, merging it with the last one if they are adjacent.
+void append(std::vector<Block> &blocks, const Block &block) {
+  if (not blocks.empty()) {
+    auto &last = blocks.back();
+    if (last.array == block.array and last.offset + last.size == block.offset) {
+      last.size += block.size;
+      return;
+    }
+  }
+  blocks.push_back(block);
+}
+
+int total_size(const std::vector<Block> &blocks) {
+  int result = 0;
+  for (const auto &b : blocks) {
+    result += b.size;
+  }
+  return result;
+}
+
+//! Layout of a 2D DMDA (as seen by the current rank).
+struct Layout {
+  Layout(::DM dm, int rank) {
+    PetscInt dim = 0;
+    PetscErrorCode ierr =
+        DMDAGetInfo(dm, &dim, &Mx, &My, nullptr, &m, &n, nullptr, &dof, &width, nullptr,
+                    nullptr, nullptr, nullptr);
+    PISM_CHK(ierr, "DMDAGetInfo");
+
+    const PetscInt *lx = nullptr, *ly = nullptr;
+    ierr = DMDAGetOwnershipRanges(dm, &lx, &ly, nullptr);
+    PISM_CHK(ierr, "DMDAGetOwnershipRanges");
+
+    x_start.resize(m + 1, 0);
+    for (int k = 0; k < m; ++k) {
+      x_start[k + 1] = x_start[k] + lx[k];
+    }
+
+    y_start.resize(n + 1, 0);
+    for (int k = 0; k < n; ++k) {
+      y_start[k + 1] = y_start[k] + ly[k];
+    }
+
+    // PETSc numbers ranks in a DMDA "x first"
+    px = rank % m;
+    py = rank / m;
+  }
+
+  //! Rank owning the grid point (i, j) (indexes may be outside of the grid).
+  int owner(int i, int j) const {
+    int I = wrap(i, Mx), J = wrap(j, My);
+
+    int qx = static_cast<int>(std::upper_bound(x_start.begin(), x_start.end(), I) -
+                              x_start.begin()) - 1;
+    int qy = static_cast<int>(std::upper_bound(y_start.begin(), y_start.end(), J) -
+                              y_start.begin()) - 1;
+    return qy * m + qx;
+  }
+
+  //! Offset of the point (i, j) in the local Vec of the rank (qx, qy).
+  int offset(int qx, int qy, int i, int j) const {
+    int gxs = x_start[qx] - width, gys = y_start[qy] - width,
+        gxm = x_start[qx + 1] - x_start[qx] + 2 * width;
+    return ((j - gys) * gxm + (i - gxs)) * dof;
+  }
+
+  //! Ghost points of the sub-domain (qx, qy), in the order used to pack messages.
+  template <class F>
+  void ghosts(int qx, int qy, F f) const {
+    int xs = x_start[qx], xe = x_start[qx + 1], ys = y_start[qy], ye = y_start[qy + 1];
+    for (int j = ys - width; j < ye + width; ++j) {
+      for (int i = xs - width; i < xe + width; ++i) {
+        if (i >= xs and i < xe and j >= ys and j < ye) {
+          continue; // owned point
+        }
+        f(i, j);
+      }
+    }
+  }
+
+  static int wrap(int k, int N) {
+    return ((k % N) + N) % N;
+  }
+
+  PetscInt Mx = 0, My = 0, m = 1, n = 1, dof = 1, width = 0;
+  int px = 0, py = 0;
+  std::vector<int> x_start, y_start;
+};
+
+} // end of anonymous namespace
+
+struct GhostExchange::Impl {
+  Impl() : comm(MPI_COMM_NULL), plan_is_ready(false), in_progress(false) {
+  }
+
+  //! Messages exchanged with one rank (possibly this rank if the domain is periodic).
+  struct Message {
+    int rank;
+    std::vector<Block> send, receive;
+    std::vector<double> send_buffer, receive_buffer;
+  };
+
+  void make_plan();
+  void pack(Message &message);
+  void unpack(const Message &message);
+  void get_arrays();
+  void restore_arrays();
+  void cancel();
+
+  //! Duplicate of the communicator used by arrays in this group.
+  MPI_Comm comm;
+  std::vector<Array *> arrays;
+  //! Pointers to local (ghosted) Vec data of arrays in this group.
+  std::vector<double *> data;
+  std::vector<Message> messages;
+  std::vector<MPI_Request> requests;
+  bool plan_is_ready;
+  bool in_progress;
+};
+
+/*!
+ * Compute lists of blocks to send to and receive from each neighbor.
+ *
+ * The receiver traverses its ghost points and the sender traverses ghost points of the
+ * receiver in the same order, so blocks match without any additional communication.
+ */
+void GhostExchange::Impl::make_plan() {
+  auto grid = arrays[0]->grid();
+
+  if (comm == MPI_COMM_NULL) {
+    int err = MPI_Comm_dup(grid->com, &comm);
+    if (err != MPI_SUCCESS) {
+      throw RuntimeError(PISM_ERROR_LOCATION, "MPI_Comm_dup failed");
+    }
+  }
+
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  std::map<int, std::vector<Block> > send, receive;
+
+  for (int a = 0; a < (int)arrays.size(); ++a) {
+    Layout L(*arrays[a]->dm(), rank);
+
+    int dof = static_cast<int>(L.dof);
+
+    // ghost points of this sub-domain
+    L.ghosts(L.px, L.py, [&](int i, int j) {
+      append(receive[L.owner(i, j)], { a, L.offset(L.px, L.py, i, j), dof });
+    });
+
+    // ghost points of neighboring sub-domains (this sub-domain is included because it
+    // owns some of its own ghosts if there is only one sub-domain in one of the
+    // directions)
+    std::set<std::pair<int, int> > neighbors;
+    for (int dy = -1; dy <= 1; ++dy) {
+      for (int dx = -1; dx <= 1; ++dx) {
+        neighbors.insert({ Layout::wrap(L.px + dx, L.m), Layout::wrap(L.py + dy, L.n) });
+      }
+    }
+
+    for (const auto &q : neighbors) {
+      int q_rank = q.second * L.m + q.first;
+      L.ghosts(q.first, q.second, [&](int i, int j) {
+        if (L.owner(i, j) == rank) {
+          int I = Layout::wrap(i, L.Mx), J = Layout::wrap(j, L.My);
+          append(send[q_rank], { a, L.offset(L.px, L.py, I, J), dof });
+        }
+      });
+    }
+  }
+
+  messages.clear();
+  std::set<int> ranks;
+  for (const auto &s : send) {
+    ranks.insert(s.first);
+  }
+  for (const auto &r : receive) {
+    ranks.insert(r.first);
+  }
+
+  for (int r : ranks) {
+    Message m;
+    m.rank    = r;
+    m.send    = send[r];
+    m.receive = receive[r];
+    m.send_buffer.resize(total_size(m.send));
+    m.receive_buffer.resize(total_size(m.receive));
+
+    if (r == rank and m.send_buffer.size() != m.receive_buffer.size()) {
+      throw RuntimeError(PISM_ERROR_LOCATION, "inconsistent ghost exchange plan");
+    }
+
+    messages.emplace_back(std::move(m));
+  }
+
+  requests.resize(2 * messages.size());
+
+  plan_is_ready = true;
+}
+
+void GhostExchange::Impl::get_arrays() {
+  data.resize(arrays.size());
+  for (size_t k = 0; k < arrays.size(); ++k) {
+    PetscErrorCode ierr = VecGetArray(arrays[k]->vec(), &data[k]);
+    PISM_CHK(ierr, "VecGetArray");
+  }
+}
+
+void GhostExchange::Impl::restore_arrays() {
+  for (size_t k = 0; k < arrays.size(); ++k) {
+    PetscErrorCode ierr = VecRestoreArray(arrays[k]->vec(), &data[k]);
+    PISM_CHK(ierr, "VecRestoreArray");
+  }
+}
+
+/*!
+ * Cancel pending requests (if any) and wait for them to complete.
+ *
+ * Used when an update is abandoned, e.g. if an exception is thrown between begin() and
+ * end(). Buffers used by pending requests cannot be freed before these requests
+ * complete.
+ */
+void GhostExchange::Impl::cancel() {
+  bool pending = false;
+  for (auto &r : requests) {
+    if (r != MPI_REQUEST_NULL) {
+      MPI_Cancel(&r);
+      pending = true;
+    }
+  }
+
+  if (pending) {
+    MPI_Waitall((int)requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+  }
+
+  in_progress = false;
+}
+
+void GhostExchange::Impl::pack(Message &message) {
+  double *buffer = message.send_buffer.data();
+  for (const auto &b : message.send) {
+    std::copy_n(data[b.array] + b.offset, b.size, buffer);
+    buffer += b.size;
+  }
+}
+
+void GhostExchange::Impl::unpack(const Message &message) {
+  const double *buffer = message.receive_buffer.data();
+  for (const auto &b : message.receive) {
+    std::copy_n(buffer, b.size, data[b.array] + b.offset);
+    buffer += b.size;
+  }
+}
+
+GhostExchange::GhostExchange() : m_impl(new Impl()) {
+  // empty
+}
+
+GhostExchange::GhostExchange(std::initializer_list<Array *> arrays) : m_impl(new Impl()) {
+  for (auto *a : arrays) {
+    add(*a);
+  }
+}
+
+GhostExchange::~GhostExchange() {
+  // complete or cancel requests of an update that was started but not finished
+  m_impl->cancel();
+
+  if (m_impl->comm != MPI_COMM_NULL) {
+    MPI_Comm_free(&m_impl->comm);
+  }
+  delete m_impl;
+}
+
+//! Add an array to the group.
+void GhostExchange::add(Array &array) {
+  if (m_impl->in_progress) {
+    throw RuntimeError(PISM_ERROR_LOCATION, "cannot add an array during a ghost update");
+  }
+
+  if (array.stencil_width() == 0) {
+    // nothing to do
+    return;
+  }
+
+  m_impl->arrays.push_back(&array);
+  m_impl->plan_is_ready = false;
+}
+
+//! Update ghosts of all arrays in the group.
+void GhostExchange::update() {
+  begin();
+  end();
+}
+
+//! Start updating ghosts of all arrays in the group.
+void GhostExchange::begin() {
+  if (m_impl->in_progress) {
+    throw RuntimeError(PISM_ERROR_LOCATION, "ghost update is already in progress");
+  }
+
+  if (m_impl->arrays.empty()) {
+    return;
+  }
+
+  if (not m_impl->plan_is_ready) {
+    m_impl->make_plan();
+  }
+
+  int rank = 0;
+  MPI_Comm_rank(m_impl->comm, &rank);
+
+  const int tag = 0;
+
+  auto &messages = m_impl->messages;
+  auto &requests = m_impl->requests;
+
+  std::fill(requests.begin(), requests.end(), MPI_REQUEST_NULL);
+
+  // requests are pending from here on
+  m_impl->in_progress = true;
+
+  try {
+    for (size_t k = 0; k < messages.size(); ++k) {
+      auto &m = messages[k];
+      if (m.rank != rank and not m.receive_buffer.empty()) {
+        MPI_Irecv(m.receive_buffer.data(), (int)m.receive_buffer.size(), MPI_DOUBLE, m.rank,
+                  tag, m_impl->comm, &requests[2 * k]);
+      }
+    }
+
+    m_impl->get_arrays();
+    for (size_t k = 0; k < messages.size(); ++k) {
+      auto &m = messages[k];
+
+      m_impl->pack(m);
+
+      if (m.rank == rank) {
+        m.receive_buffer = m.send_buffer;
+      } else if (not m.send_buffer.empty()) {
+        MPI_Isend(m.send_buffer.data(), (int)m.send_buffer.size(), MPI_DOUBLE, m.rank, tag,
+                  m_impl->comm, &requests[2 * k + 1]);
+      }
+    }
+    m_impl->restore_arrays();
+  } catch (...) {
+    m_impl->cancel();
+    throw;
+  }
+}
+
+//! Finish updating ghosts of all arrays in the group.
+void GhostExchange::end() {
+  if (m_impl->arrays.empty()) {
+    return;
+  }
+
+  if (not m_impl->in_progress) {
+    throw RuntimeError(PISM_ERROR_LOCATION, "ghost update was not started");
+  }
+
+  auto &requests = m_impl->requests;
+  int err = MPI_Waitall((int)requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+  if (err != MPI_SUCCESS) {
+    m_impl->cancel();
+    throw RuntimeError(PISM_ERROR_LOCATION, "MPI_Waitall failed");
+  }
+
+  m_impl->get_arrays();
+  for (const auto &m : m_impl->messages) {
+    m_impl->unpack(m);
+  }
+  m_impl->restore_arrays();
+
+  m_impl->in_progress = false;
+
+  m_impl->arrays[0]->grid()->ctx()->profiling().count("ghost_updates");
+}
+
+} // end of namespace array
+} // end of namespace pism
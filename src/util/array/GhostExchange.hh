@@ -0,0 +1,79 @@
+/* Copyright (C) 2024 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PISM_GHOSTEXCHANGE_H
+#define PISM_GHOSTEXCHANGE_H
+
+#include <initializer_list>
+
+namespace pism {
+namespace array {
+
+class Array;
+
+/*!
+ * Updates ghosts of a group of arrays, sending *one* message to each neighboring
+ * sub-domain (instead of one message per array).
+ *
+ * Arrays in a group may have different numbers of degrees of freedom and stencil widths.
+ * Arrays without ghosts are ignored.
+ *
+ * The communication plan is computed during the first update and re-used after that, so
+ * it is best to create a group once and use it many times. All ranks have to add the same
+ * arrays in the same order.
+ *
+ * Usage:
+ *
+ * \code
+ * array::GhostExchange ghosts{ &a, &b, &c };
+ * ...
+ * ghosts.update();
+ * \endcode
+ *
+ * Like Array::update_ghosts_begin(), begin() allows reading owned values until the
+ * matching end() call.
+ *
+ * If an update is not finished (e.g. because an exception was thrown between begin() and
+ * end()) the destructor cancels pending requests.
+ */
+class GhostExchange {
+public:
+  GhostExchange();
+  GhostExchange(std::initializer_list<Array *> arrays);
+  ~GhostExchange();
+
+  void add(Array &array);
+
+  void update();
+  void begin();
+  void end();
+
+private:
+  struct Impl;
+  Impl *m_impl;
+
+  // disable copy constructor and the assignment operator:
+  GhostExchange(const GhostExchange &other);
+  GhostExchange &operator=(const GhostExchange &);
+};
+
+} // end of namespace array
+} // end of namespace pism
+
+#endif /* PISM_GHOSTEXCHANGE_H */
@@ -0,0 +1,220 @@
+/* Copyright (C) 2024 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+static char help[] =
+  "\nPISM_LABEL_COMPONENTS_BENCHMARK\n"
+  "  Times parallel and serial connected component labeling using synthetic masks.\n\n";
+
+#include <algorithm> // std::max, std::min
+#include <random>
+
+#include "pism/util/Context.hh"
+#include "pism/util/Grid.hh"
+#include "pism/util/Logger.hh"
+#include "pism/util/array/Scalar.hh"
+#include "pism/util/connected_components/label_components.hh"
+#include "pism/util/error_handling.hh"
+#include "pism/util/petscwrappers/PetscInitializer.hh"
+#include "pism/util/pism_options.hh"
+#include "pism/util/pism_utilities.hh"
+
+namespace pism {
+
+//! Value used to mark "reachable" cells when testing `label_isolated()`.
+static const int reachable = 2;
+
+/*!
+ * Fill `result` with a synthetic mask.
+ *
+ * - "blobs": randomly placed discs (many components of different sizes, some spanning
+ *   sub-domain boundaries),
+ * - "stripes": diagonal stripes (few long components spanning many sub-domains),
+ * - "checkerboard": isolated cells (the largest possible number of components).
+ *
+ * Foreground cells along the southern and western edges of the domain are marked as
+ * "reachable". The mask does not depend on the domain decomposition.
+ */
+static void synthetic_mask(const std::string &pattern, array::Scalar &result) {
+  auto grid = result.grid();
+
+  const int Mx = static_cast<int>(grid->Mx()), My = static_cast<int>(grid->My());
+
+  result.set(0.0);
+
+  array::AccessScope list{ &result };
+
+  if (pattern == "blobs") {
+    // all ranks use the same seed to get the same blobs
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<int> x(0, Mx - 1), y(0, My - 1), radius(1, 10);
+
+    int N = std::max(Mx * My / 200, 1);
+    for (int n = 0; n < N; ++n) {
+      int i0 = x(generator), j0 = y(generator), R = radius(generator);
+
+      // intersection of the bounding box of this blob with the current sub-domain
+      int i_min = std::max(i0 - R, grid->xs());
+      int i_max = std::min(i0 + R, grid->xs() + grid->xm() - 1);
+      int j_min = std::max(j0 - R, grid->ys());
+      int j_max = std::min(j0 + R, grid->ys() + grid->ym() - 1);
+
+      for (int j = j_min; j <= j_max; ++j) {
+        for (int i = i_min; i <= i_max; ++i) {
+          if ((i - i0) * (i - i0) + (j - j0) * (j - j0) <= R * R) {
+            result(i, j) = 1.0;
+          }
+        }
+      }
+    }
+  } else {
+    for (auto p = grid->points(); p; p.next()) {
+      const int i = p.i(), j = p.j();
+
+      bool foreground = (pattern == "stripes") ? ((i + j) / 5) % 2 == 0 : (i + j) % 2 == 0;
+
+      result(i, j) = foreground ? 1.0 : 0.0;
+    }
+  }
+
+  for (auto p = grid->points(); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    if (result(i, j) > 0.0 and (i == 0 or j == 0)) {
+      result(i, j) = reachable;
+    }
+  }
+}
+
+//! Returns the number of grid cells where `a` and `b` differ.
+static int n_differences(const array::Scalar &a, const array::Scalar &b) {
+  auto grid = a.grid();
+
+  array::AccessScope list{ &a, &b };
+
+  int result = 0;
+  for (auto p = grid->points(); p; p.next()) {
+    const int i = p.i(), j = p.j();
+
+    if (a.as_int(i, j) != b.as_int(i, j)) {
+      result += 1;
+    }
+  }
+
+  return GlobalSum(grid->com, result);
+}
+
+/*!
+ * Call `label` `N` times, re-setting `mask` to `input` before each call. Returns the
+ * maximum (over all ranks) total wall-clock time.
+ */
+template <class F>
+static double time_labeling(F label, int N, const array::Scalar &input, array::Scalar1 &mask) {
+  double total = 0.0;
+  for (int k = 0; k < N; ++k) {
+    mask.copy_from(input);
+
+    MPI_Barrier(input.grid()->com);
+    double start = MPI_Wtime();
+    label(mask);
+    total += MPI_Wtime() - start;
+  }
+  return GlobalMax(input.grid()->com, total);
+}
+
+} // end of namespace pism
+
+int main(int argc, char *argv[]) {
+
+  using namespace pism;
+
+  MPI_Comm com = MPI_COMM_WORLD;
+  petsc::Initializer petsc(argc, argv, help);
+
+  try {
+    std::shared_ptr<Context> ctx = context_from_options(com, "pism_label_components_benchmark");
+    auto config = ctx->config();
+    auto log    = ctx->log();
+
+    std::string usage = "\n"
+      "usage of PISM_LABEL_COMPONENTS_BENCHMARK:\n"
+      "  run pism_label_components_benchmark -Mx <number> -My <number>"
+      " [-pattern blobs|stripes|checkerboard] [-repeat <number>] [-compare]\n"
+      "\n";
+
+    bool stop = show_usage_check_req_opts(*log, "pism_label_components_benchmark", {}, usage);
+    if (stop) {
+      return 0;
+    }
+
+    auto pattern = options::Keyword("-pattern", "synthetic mask to label",
+                                    "blobs,stripes,checkerboard", "blobs");
+    int N        = options::Integer("-repeat", "number of times to label each mask", 10);
+    bool compare = options::Bool("-compare", "compare to serial labeling");
+
+    auto grid = Grid::Shallow(ctx, 1e5, 1e5, 0.0, 0.0,
+                              static_cast<unsigned int>(config->get_number("grid.Mx")),
+                              static_cast<unsigned int>(config->get_number("grid.My")),
+                              grid::CELL_CORNER, grid::NOT_PERIODIC);
+    grid->report_parameters();
+
+    array::Scalar input(grid, "input");
+    array::Scalar serial(grid, "serial");
+    array::Scalar1 mask(grid, "mask");
+
+    synthetic_mask(pattern, input);
+
+    log->message(2, "Labeling '%s' (%d x %d grid cells, %d ranks, %d repetitions)...\n",
+                 pattern->c_str(), (int)grid->Mx(), (int)grid->My(), grid->size(), N);
+
+    double T_parallel = time_labeling([](array::Scalar1 &m) { connected_components::label(m); },
+                                      N, input, mask);
+    if (compare) {
+      serial.copy_from(input);
+      connected_components::label_serial(serial, false, -1);
+      // label() and label_serial() number components in different orders
+      log->message(2, "  label():          %d components (label_serial(): %d)\n",
+                   (int)array::max(mask), (int)array::max(serial));
+    }
+
+    double T_isolated = time_labeling(
+        [](array::Scalar1 &m) { connected_components::label_isolated(m, reachable); }, N, input,
+        mask);
+    if (compare) {
+      serial.copy_from(input);
+      connected_components::label_serial(serial, true, reachable);
+      log->message(2, "  label_isolated(): differences from label_serial(): %d\n",
+                   n_differences(mask, serial));
+    }
+
+    double T_serial = time_labeling(
+        [](array::Scalar1 &m) { connected_components::label_serial(m, false, -1); }, N, input,
+        mask);
+
+    log->message(2,
+                 "  label():          %.6f s per call\n"
+                 "  label_isolated(): %.6f s per call\n"
+                 "  label_serial():   %.6f s per call\n",
+                 T_parallel / N, T_isolated / N, T_serial / N);
+  } catch (...) {
+    handle_fatal_errors(com);
+    return 1;
+  }
+
+  return 0;
+}
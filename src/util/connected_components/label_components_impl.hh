@@ -30,8 +30,7 @@ int first_label(const Grid &grid);
 //! Assign new labels to elements of `mask`. Does not touch background grid cells.
 void relabel(array::Scalar &mask, const std::map<int, int> &labels);
 
-std::map<int, int> final_labels(array::Scalar1 &input, bool subdomain_is_not_empty,
-                                bool mark_isolated_patches);
+std::map<int, int> final_labels(array::Scalar1 &input, bool mark_isolated_patches);
 
 } // end of namespace details
 
@@ -53,60 +52,37 @@ std::map<int, int> final_labels(array::Scalar1 &input, bool subdomain_is_not_emp
  *    spanning multiple sub-domains. This defines a graph: each patch on a sub-domain is a
  *    node, two nodes are connected by an edge if and only if they "touch".
  *
- * 3. Gather graph description on all sub-domains that have at least one patch.
+ * 3. Merge labels of connected patches using a distributed union-find: ranks are
+ *    arranged in a binary tree; each rank merges connections between patches owned by
+ *    ranks in its sub-tree and passes the rest (along with representatives of labels
+ *    involved) to its parent.
  *
- * 4. Use breadth-first search to traverse this graph and compute final labels.
+ * 4. Send representatives of connected components back down the tree, then (unless
+ *    `mark_isolated_patches` is set) replace them with consecutive integers using a
+ *    prefix sum over ranks.
  *
  * 5. Apply final labels.
  *
- * This method communicates ghosts (once), number of graph edges per sub-domain (once) and
- * then all graph edges (once, only to sub-domains that have at least one patch).
- *
- * Graph traversal is done "redundantly", i.e. each participating sub-domain traverses the
- * whole graph even if it contains one isolated node. This is needed to ensure that
- * resulting labels use consecutive numbers. (Consecutive labels are useful for indexing
- * elsewhere in the code).
- *
- * We /could/ gather graph information on one MPI processor, traverse the graph to compute
- * final labels, then scatter final labels. It is not clear if this would be better, though.
- *
- * The current implementation uses
- *
- * - MPI_Allgather() to gather number of graph edges per subdomain (send 4 bytes, receive
-     4 bytes per subdomain).
- *
- * - MPI_Allgatherv() to gather edges to all participating subdomains (send 8 bytes per
-     local edge, receive 8-16 bytes per edge).
- *
- * The alternative implementation would use
- *
- * - MPI_Gather() to gather number of graph edges per sub-domain to *one* of sub-domains.
- *   (each sub-domain sends 4 bytes, one sub-domain receives 4 bytes per sub-domain).
- *
- * - MPI_Gatherv() to gather edges from all participating sub-domains. (All sub-domains send
- *   8 bytes per local edge, one sub-domain receives 8 bytes per edge in the whole graph.)
- *
- * - MPI_Bcast() to scatter the mapping from old labels to new labels (8 bytes per local
- *   sub-domain).
- *
- * TO DO: run benchmarks!
+ * Each rank receives at most log2(P) messages with connections across the boundary of its
+ * sub-tree (P is the number of ranks); no rank stores the whole graph. Making labels
+ * consecutive requires MPI_Exscan() and MPI_Alltoall() (4 bytes per rank) plus
+ * MPI_Alltoallv() to look up numbers of components owned by other ranks.
  */
 template <typename T>
 void label_components_impl(const T &input, bool mark_isolated_patches, array::Scalar1 &output) {
 
   // 1. Label patches owned by individual sub-domains (independently and in parallel):
-  bool non_empty_subdomain = false;
   {
     connected_components::details::PISMArray out(output);
 
     using namespace connected_components::details;
     bool assign_final_labels = false;
-    non_empty_subdomain = label(input, mark_isolated_patches, details::first_label(*output.grid()),
-                                assign_final_labels, out);
+    label(input, mark_isolated_patches, details::first_label(*output.grid()),
+          assign_final_labels, out);
   }
 
   // 2. Resolve labels:
-  auto labels = details::final_labels(output, non_empty_subdomain, mark_isolated_patches);
+  auto labels = details::final_labels(output, mark_isolated_patches);
 
   // 3. Apply final labels:
   details::relabel(output, labels);
@@ -22,11 +22,13 @@
 #include "pism/util/Grid.hh"
 #include "pism/util/array/Scalar.hh"
 
-#include <cmath>  // pow, ceil, log10
+#include <algorithm> // std::min
+#include <cmath>     // pow, ceil, log10
 #include <map>
 #include <mpi.h>
-#include <queue>
 #include <set>
+#include <utility> // std::pair, std::swap
+#include <vector>
 
 namespace pism {
 
@@ -56,13 +58,34 @@ static bool south_boundary(const Grid &grid, int j) {
   return (j == j_first) and (j != 0);
 }
 
+//! Number of intermediate labels reserved for each rank (see first_label()).
+static int labels_per_rank(const Grid &grid) {
+  // find the smallest N such that grid.xm()*grid.ym() < 10^N
+  int exponent = static_cast<int>(std::ceil(std::log10(grid.max_patch_size())));
+  return static_cast<int>(std::pow(10, exponent));
+}
+
+//! Rank that created the intermediate label `label` (see first_label()).
+static int label_owner(int label, int labels_per_rank) {
+  return (label - 1) / labels_per_rank;
+}
+
+//! Patches in a sub-domain and connections between them and patches in neighboring
+//! sub-domains.
+struct Connections {
+  //! intermediate labels used in this sub-domain
+  std::set<int> labels;
+  //! pairs (a, b), where `a` is a local label and `b` is a label used by a neighbor
+  std::set<std::pair<int, int> > edges;
+};
+
 /*!
  * Inspect sub-domain edges to detect connections between patches owned by individual
  * sub-domains.
  */
-static std::map<int, std::set<int> > detect_connections(array::Scalar1 &mask) {
+static Connections detect_connections(array::Scalar1 &mask) {
   auto grid = mask.grid();
-  std::map<int, std::set<int> > graph;
+  Connections result;
 
   mask.update_ghosts();
 
@@ -70,7 +93,7 @@ static std::map<int, std::set<int> > detect_connections(array::Scalar1 &mask) {
 
   auto maybe_add_edge = [&](int a, int b) {
     if (a > 0 and b > 0) {
-      graph[std::min(a, b)].insert(std::max(a, b));
+      result.edges.insert({ a, b });
     }
   };
 
@@ -79,13 +102,11 @@ static std::map<int, std::set<int> > detect_connections(array::Scalar1 &mask) {
 
     int M = mask.as_int(i, j);
 
-    // add an edge (M, M) to ensure that the graph contains information about patches that
-    // don't touch sub-domain edges. This is needed to be able to re-label them properly
-    // (i.e. to make labels consecutive).
-    //
-    // Note that this is incompatible with the optimization mentioned in
-    // label_components_parallel()
-    maybe_add_edge(M, M);
+    if (M <= 0) {
+      continue;
+    }
+
+    result.labels.insert(M);
 
     if (north_boundary(*grid, j)) {
       maybe_add_edge(M, mask.as_int(i, j + 1));
@@ -104,167 +125,153 @@ static std::map<int, std::set<int> > detect_connections(array::Scalar1 &mask) {
     }
   } // end of the loop over grid points
 
-  return graph;
+  return result;
 }
 
 /*!
- * Pack information about connections (graph edges) into the form needed for communication.
+ * Disjoint-set forest ("union-find") of intermediate labels.
+ *
+ * The representative of a set is its "attached" (odd) label if there is one and its
+ * smallest label otherwise.
  */
-static std::vector<int> pack_data(const std::map<int, std::set<int> > &graph) {
-  // FIXME (maybe): we could reduce the amount of data we have to send by being more
-  // clever about packing data.
-  std::vector<int> result{};
-  for (const auto &e : graph) {
-    int a = e.first;
-    for (auto b : e.second) {
-      result.push_back(a);
-      result.push_back(b);
+class UnionFind {
+public:
+  int find(int a) {
+    int root = a;
+    for (auto it = m_parent.find(root); it != m_parent.end(); it = m_parent.find(root)) {
+      root = it->second;
     }
+
+    // path compression
+    while (a != root) {
+      auto &parent = m_parent[a];
+      a            = parent;
+      parent       = root;
+    }
+
+    return root;
   }
-  return result;
-}
 
-/*!
- * Unpack data gathered from all the ranks that contain connected components.
- */
-static std::map<int, std::set<int> > unpack_data(const std::vector<int> &buffer) {
-  std::map<int, std::set<int> > result;
-  for (size_t n = 0; n < buffer.size() / 2; ++n) {
-    int a = buffer[2 * n + 0];
-    int b = buffer[2 * n + 1];
-
-    // insert *both* (a,b) and (b,a) because we want to be able to easily get a list
-    // of nodes adjacent to a given node
-    result[a].insert(b);
-    result[b].insert(a);
+  void merge(int a, int b) {
+    a = find(a);
+    b = find(b);
+
+    if (a == b) {
+      return;
+    }
+
+    if (preferred(b, a)) {
+      std::swap(a, b);
+    }
+    m_parent[b] = a;
   }
 
-  return result;
-}
+private:
+  //! Returns true if `a` should be used as the representative instead of `b`.
+  static bool preferred(int a, int b) {
+    bool a_attached = (a % 2 == 1), b_attached = (b % 2 == 1);
+    if (a_attached != b_attached) {
+      return a_attached;
+    }
+    return a < b;
+  }
 
-/*!
- * Assemble complete graph info by gathering edges from all MPI ranks that have at least
- * one patch.
- */
-static std::map<int, std::set<int> > assemble_graph(MPI_Comm comm,
-                                                    const std::map<int, std::set<int> > &subgraph) {
-  int size = 0;
-  MPI_Comm_size(comm, &size);
-  int rank = 0;
-  MPI_Comm_rank(comm, &rank);
+  //! map from a label to its parent; roots are not stored
+  std::map<int, int> m_parent;
+};
 
-  auto message = pack_data(subgraph);
+static const int label_tag = 101;
 
-  // gather message lengths to prepare the buffer:
-  std::vector<int> message_length(size);
-  message_length[rank] = (int)message.size();
-  MPI_Allgather(MPI_IN_PLACE, 1, MPI_INT, message_length.data(), 1, MPI_INT, comm);
+static void send(MPI_Comm comm, int destination, const std::vector<int> &message) {
+  MPI_Send(message.data(), (int)message.size(), MPI_INT, destination, label_tag, comm);
+}
 
-  // compute offsets
-  std::vector<int> offsets(size);
-  offsets[0] = 0;
-  for (int k = 1; k < size; ++k) {
-    offsets[k] = offsets[k - 1] + message_length[k - 1];
-  }
+static std::vector<int> receive(MPI_Comm comm, int source) {
+  MPI_Status status;
+  MPI_Probe(source, label_tag, comm, &status);
 
-  // allocate the buffer
-  int buffer_size = offsets.back() + message_length.back();
-  std::vector<int> buffer(buffer_size);
+  int length = 0;
+  MPI_Get_count(&status, MPI_INT, &length);
 
-  // Gather adjacency info:
-  MPI_Allgatherv(message.data(), (int)message.size(), MPI_INT, buffer.data(), message_length.data(),
-                 offsets.data(), MPI_INT, comm);
+  std::vector<int> result(length);
+  MPI_Recv(result.data(), length, MPI_INT, source, label_tag, comm, MPI_STATUS_IGNORE);
 
-  // unpack messages:
-  return unpack_data(buffer);
+  return result;
 }
 
 /*!
- * Traverse the `graph` using a version of the "breadth first search" algorithm and find
- * final labels for all of its nodes.
- *
- * If `mark_isolated_patches` is true, isolated patches get labeled with `1`, the rest
- * with `0`.
+ * Replace representatives in `labels` (a map from intermediate labels to representatives
+ * of their connected components) with consecutive integers starting from 1.
  *
- * If `mark_isolated_patches` is false, each connected component in the graph gets a
- * unique label starting from `1` and using consecutive integers.
+ * Components are numbered in the order of their representatives, i.e. by the rank that
+ * owns a representative and then by its value.
  */
-static std::map<int, int> resolve_labels(const std::map<int, std::set<int> > &graph,
-                                         bool mark_isolated_patches) {
-
-  // visited[X] == true if we already visited the node with the ID equal to X
-  std::map<int, bool> visited;
-  // map from node IDs to labels
-  std::map<int, int> result;
-
-  // label used for "attached" cells
-  const int attached = 1;
-
-  // Loop over all edges in the graph and start the breadth-first search starting from the
-  // first node of each edge. This is sufficient since if (a,b) is in the graph then (b,a)
-  // is also in the graph (by construction).
-  for (const auto &edge : graph) {
-    int u = edge.first;
+static void make_consecutive(MPI_Comm comm, int labels_per_rank, std::map<int, int> &labels) {
+  int size = 0, rank = 0;
+  MPI_Comm_size(comm, &size);
+  MPI_Comm_rank(comm, &rank);
 
-    if (visited[u]) {
-      continue;
+  // representatives owned by this rank and queries for the rest, sorted by owner
+  std::set<int> owned;
+  std::vector<std::set<int> > foreign(size);
+  for (const auto &p : labels) {
+    int owner = label_owner(p.second, labels_per_rank);
+    if (owner == rank) {
+      owned.insert(p.second);
+    } else {
+      foreign[owner].insert(p.second);
     }
+  }
 
-    // select a provisional label:
-    int label = u;
-
-    std::set<int> equivalent{};
+  // number components owned by this rank
+  int n_owned = static_cast<int>(owned.size()), offset = 0;
+  MPI_Exscan(&n_owned, &offset, 1, MPI_INT, MPI_SUM, comm);
+  if (rank == 0) {
+    offset = 0; // MPI_Exscan() leaves the result on rank 0 undefined
+  }
 
-    std::queue<int> queue;
-    queue.push(u);
-    while (not queue.empty()) {
-      int v = queue.front();
-      queue.pop();
+  std::map<int, int> number;
+  for (int r : owned) {
+    number[r] = ++offset;
+  }
 
-      if (visited[v]) {
-        continue;
-      }
+  // ask owners of remaining representatives for their numbers
+  std::vector<int> n_sent(size), n_received(size);
+  for (int k = 0; k < size; ++k) {
+    n_sent[k] = static_cast<int>(foreign[k].size());
+  }
+  MPI_Alltoall(n_sent.data(), 1, MPI_INT, n_received.data(), 1, MPI_INT, comm);
 
-      // Odd labels are used to mark "attached" cells; replace this label with "1". Note
-      // that this is the smallest label we use, so `min(label, v)` will preserve it.
-      label = (v % 2 == 1) ? attached : std::min(label, v);
+  std::vector<int> sent_offsets(size, 0), received_offsets(size, 0);
+  for (int k = 1; k < size; ++k) {
+    sent_offsets[k]     = sent_offsets[k - 1] + n_sent[k - 1];
+    received_offsets[k] = received_offsets[k - 1] + n_received[k - 1];
+  }
 
-      equivalent.insert(v);
-      visited[v] = true;
+  std::vector<int> queries;
+  for (const auto &f : foreign) {
+    queries.insert(queries.end(), f.begin(), f.end());
+  }
+  std::vector<int> received(received_offsets.back() + n_received.back());
 
-      auto it = graph.find(v);
-      if (it != graph.end()) {
-        for (int w : it->second) {
-          queue.push(w);
-        }
-      }
-    }
+  MPI_Alltoallv(queries.data(), n_sent.data(), sent_offsets.data(), MPI_INT, received.data(),
+                n_received.data(), received_offsets.data(), MPI_INT, comm);
 
-    // record the label for all the "equivalent" nodes (i.e. all the nodes in a particular
-    // connected component)
-    for (int v : equivalent) {
-      result[v] = label;
-    }
+  for (auto &r : received) {
+    r = number[r];
   }
 
-  if (mark_isolated_patches) {
-    // mark "attached" cells with `0` and the rest with `1`:
-    for (auto &p : result) {
-      p.second = (p.second == attached) ? 0 : 1;
-    }
-  } else {
-    // make labels consecutive:
-    int current_label = 1;
-    std::map<int, int> new_labels;
-    for (auto &p : result) {
-      if (new_labels.find(p.second) == new_labels.end()) {
-        new_labels[p.second] = current_label++;
-      }
-      p.second = new_labels[p.second];
-    }
+  std::vector<int> replies(queries.size());
+  MPI_Alltoallv(received.data(), n_received.data(), received_offsets.data(), MPI_INT,
+                replies.data(), n_sent.data(), sent_offsets.data(), MPI_INT, comm);
+
+  for (size_t k = 0; k < queries.size(); ++k) {
+    number[queries[k]] = replies[k];
   }
 
-  return result;
+  for (auto &p : labels) {
+    p.second = number[p.second];
+  }
 }
 
 //! Assign new labels to elements of `mask`. Does not touch background grid cells.
@@ -297,57 +304,146 @@ void relabel(array::Scalar &mask, const std::map<int, int> &labels) {
 /*!
  * Compute the map from intermediate to final labels given a ghosted array `input`.
  *
- * The value of the flag `subdomain_is_not_empty` varies from one subdomain to the next
- * depending on whether it has any foreground pixels.
+ * Uses a distributed union-find: connections across sub-domain boundaries are merged
+ * using a binary tree reduction over ranks. At step `s` (1, 2, 4, ...) rank `r` such that
+ * `r % (2*s) == s` sends connections it could not resolve to rank `r - s`, which merges
+ * sets of labels owned by ranks in `[r - s, r + s)`. Representatives are then sent back
+ * down the same tree.
+ *
+ * Each rank handles only the labels on its sub-domain and connections crossing the
+ * boundary of its sub-tree, so no rank has to store the whole graph.
  */
-std::map<int, int> final_labels(array::Scalar1 &input, bool subdomain_is_not_empty,
-                                bool mark_isolated_patches) {
+std::map<int, int> final_labels(array::Scalar1 &input, bool mark_isolated_patches) {
+  auto grid = input.grid();
+
+  MPI_Comm comm = grid->com;
+  const int size = grid->size(), rank = grid->rank();
+  const int N = labels_per_rank(*grid);
+
   // Iterate over the grid to find connections between patches owned by individual
   // sub-domains. Updates the ghosts of `mask`.
-  auto edges = details::detect_connections(input);
-
-  // We create a sub-communicator containing *only* the ranks with at least one patch to
-  // reduce the amount of data sent around by the rest of this algorithm. We may be able
-  // to reduce this even further by excluding sub-domains with patches that are *entirely*
-  // contained within a sub-domain. On the other hand, this would make it impossible to
-  // ensure that patches are labeled with consecutive numbers starting from 1 (this
-  // simplifies the code elsewhere).
-  //
-  // This optimization *is* an option if `mark_isolated_patches` is set since in that case
-  // the only values used are `1` for isolated patches and `0` for the rest of the domain.
-  //
-  // Note: depending on the cost of MPI_Comm_split() it may be more efficient to use the
-  // original communicator instead of creating a sub-communicator. We need to do some
-  // profiling...
-  std::map<int, int> labels;
-  {
-    MPI_Comm comm = MPI_COMM_NULL;
-    MPI_Comm_split(input.grid()->com, subdomain_is_not_empty ? 1 : 0, 0, &comm);
-
-    // the following block is executed by ranks that have at least one patch
-    if (subdomain_is_not_empty) {
-      auto graph = details::assemble_graph(comm, edges);
-
-      labels = details::resolve_labels(graph, mark_isolated_patches);
+  auto connections = details::detect_connections(input);
+
+  UnionFind forest;
+
+  // connections (a, b) such that `a` is owned by a rank in the current sub-tree
+  std::vector<std::pair<int, int> > pending(connections.edges.begin(), connections.edges.end());
+
+  // children of this rank in the reduction tree and labels they asked about
+  std::vector<std::pair<int, std::vector<int> > > children;
+
+  int parent = -1;
+  for (int step = 1; step < size; step *= 2) {
+    if (rank % (2 * step) != 0) {
+      parent = rank - step;
+      break;
+    }
+
+    int child = rank + step;
+    if (child >= size) {
+      // no child at this step, but this rank may still have a parent
+      continue;
+    }
+
+    // the current sub-tree contains ranks in [rank, last); the child's sub-tree contains
+    // [child, child_last)
+    int last = std::min(rank + 2 * step, size), child_last = std::min(child + step, size);
+
+    auto message = receive(comm, child);
+
+    std::set<int> requested;
+    for (size_t k = 0; k < message.size() / 2; ++k) {
+      int a = message[2 * k + 0], b = message[2 * k + 1];
+      pending.emplace_back(a, b);
+
+      for (int c : { a, b }) {
+        int owner = label_owner(c, N);
+        if (owner >= child and owner < child_last) {
+          requested.insert(c);
+        }
+      }
+    }
+    children.emplace_back(child, std::vector<int>(requested.begin(), requested.end()));
+
+    std::vector<std::pair<int, int> > external;
+    for (const auto &e : pending) {
+      int owner = label_owner(e.second, N);
+      if (owner >= rank and owner < last) {
+        forest.merge(e.first, e.second);
+      } else {
+        external.push_back(e);
+      }
     }
+    pending = external;
+  }
+
+  if (parent >= 0) {
+    // send unresolved connections and representatives of labels involved in them
+    std::set<std::pair<int, int> > message_pairs(pending.begin(), pending.end());
+    for (const auto &e : pending) {
+      int root = forest.find(e.first);
+      if (root != e.first) {
+        message_pairs.insert({ e.first, root });
+      }
+    }
+
+    std::vector<int> message;
+    message.reserve(2 * message_pairs.size());
+    for (const auto &e : message_pairs) {
+      message.push_back(e.first);
+      message.push_back(e.second);
+    }
+    send(comm, parent, message);
+  }
+
+  // representatives of connected components spanning more than this sub-tree
+  std::map<int, int> inherited;
+  if (parent >= 0) {
+    auto message = receive(comm, parent);
+    for (size_t k = 0; k < message.size() / 2; ++k) {
+      inherited[message[2 * k + 0]] = message[2 * k + 1];
+    }
+  }
+
+  auto representative = [&](int label) {
+    int root = forest.find(label);
+    auto it  = inherited.find(root);
+    return it == inherited.end() ? root : it->second;
+  };
+
+  for (auto c = children.rbegin(); c != children.rend(); ++c) {
+    std::vector<int> message;
+    message.reserve(2 * c->second.size());
+    for (int label : c->second) {
+      message.push_back(label);
+      message.push_back(representative(label));
+    }
+    send(comm, c->first, message);
+  }
+
+  std::map<int, int> result;
+  for (int label : connections.labels) {
+    result[label] = representative(label);
+  }
 
-    MPI_Comm_free(&comm);
+  if (mark_isolated_patches) {
+    // mark "attached" cells with `0` and the rest with `1`:
+    for (auto &p : result) {
+      p.second = (p.second % 2 == 1) ? 0 : 1;
+    }
+  } else {
+    make_consecutive(comm, N, result);
   }
-  return labels;
+
+  return result;
 }
 
 //! Compute the first label a particular rank can use. This is supposed to ensure that all
 //! labels are unique (i.e. different ranks do not use the same label).
 int first_label(const Grid &grid) {
-
-  // Here we set `first_label` to ensure that all ranks use *different* labels.
-  // find the smallest N such that grid.xm()*grid.ym() < 10^N
-  int exponent        = static_cast<int>(std::ceil(std::log10(grid.max_patch_size())));
-  int labels_per_rank = static_cast<int>(std::pow(10, exponent));
-
   // FIXME: this is very unlikely, but I should still check for integer overflow.
 
-  return grid.rank() * labels_per_rank + 1;
+  return grid.rank() * labels_per_rank(grid) + 1;
 }
 
 } // end of namespace details
@@ -0,0 +1,129 @@
+/* Copyright (C) 2024 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cstdio>               // fopen, fwrite, fclose, rename, fprintf
+#include <cstdlib>              // free
+#include <algorithm>            // std::copy
+#include <functional>           // std::ref
+#include <vector>
+
+#include "pism/util/io/BackgroundWriter.hh"
+#include "pism/util/error_handling.hh"
+#include "pism/util/pism_utilities.hh"
+
+namespace pism {
+namespace io {
+
+/*!
+ * Write `image` to `filename`, then free it.
+ *
+ * Runs in the background thread, so it reports errors using `error` instead of throwing.
+ */
+static void write_image(const std::string &filename, void *image, size_t image_size,
+                        std::string &error) {
+  std::string tmp_filename = filename + ".tmp";
+
+  FILE *f = fopen(tmp_filename.c_str(), "wb");
+  if (f == nullptr) {
+    error = pism::printf("cannot create '%s'", tmp_filename.c_str());
+    free(image);
+    return;
+  }
+
+  size_t n_written = fwrite(image, 1, image_size, f);
+  int close_stat = fclose(f);
+  free(image);
+
+  if (n_written != image_size or close_stat != 0) {
+    error = pism::printf("failed to write %lu bytes to '%s'",
+                         (unsigned long)image_size, tmp_filename.c_str());
+    return;
+  }
+
+  if (rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+    error = pism::printf("can't move '%s' to '%s'", tmp_filename.c_str(), filename.c_str());
+  }
+}
+
+BackgroundWriter::BackgroundWriter(MPI_Comm com)
+  : m_com(com) {
+  // empty
+}
+
+BackgroundWriter::~BackgroundWriter() {
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+
+  if (not m_error.empty()) {
+    // don't throw from here
+    fprintf(stderr, "PISM ERROR: %s\n", m_error.c_str());
+  }
+}
+
+/*!
+ * Start writing `image` (an in-memory NetCDF file of size `image_size`) to `filename`.
+ *
+ * Takes ownership of `image`, which has to be allocated using `malloc()`.
+ *
+ * Called on rank 0 only (the only rank that has an image to write).
+ */
+void BackgroundWriter::submit(const std::string &filename, void *image, size_t image_size) {
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+
+  m_thread = std::thread(write_image, filename, image, image_size, std::ref(m_error));
+}
+
+/*!
+ * Wait for the background thread to finish writing. Throws if writing failed.
+ *
+ * This is a collective call.
+ */
+void BackgroundWriter::wait() {
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+
+  int rank = 0;
+  MPI_Comm_rank(m_com, &rank);
+
+  // Only rank 0 writes, so only rank 0 knows if writing failed. Broadcast the error
+  // message to make sure that all ranks throw.
+  int length = static_cast<int>(m_error.size());
+  MPI_Bcast(&length, 1, MPI_INT, 0, m_com);
+
+  if (length == 0) {
+    return;
+  }
+
+  std::vector<char> message(length + 1, '\0');
+  if (rank == 0) {
+    std::copy(m_error.begin(), m_error.end(), message.begin());
+  }
+  MPI_Bcast(message.data(), length, MPI_CHAR, 0, m_com);
+  m_error.clear();
+
+  throw RuntimeError::formatted(PISM_ERROR_LOCATION, "background write failed: %s",
+                                message.data());
+}
+
+} // end of namespace io
+} // end of namespace pism
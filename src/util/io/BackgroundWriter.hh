@@ -0,0 +1,61 @@
+/* Copyright (C) 2024 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PISM_BACKGROUNDWRITER_H
+#define PISM_BACKGROUNDWRITER_H
+
+#include <cstddef>              // size_t
+#include <string>
+#include <thread>
+
+#include <mpi.h>
+
+namespace pism {
+namespace io {
+
+//! Writes in-memory images of NetCDF files to disk using a background thread.
+/*!
+ * Images are created by NC_Memory on rank 0. This class takes ownership of an image,
+ * writes it to a temporary file and renames the temporary file once it is complete, so
+ * a partially-written file never has the requested name.
+ *
+ * At most one image is written at a time: submitting a new image waits for the previous
+ * one. The background thread does not make any MPI or NetCDF calls.
+ */
+class BackgroundWriter {
+public:
+  BackgroundWriter(MPI_Comm com);
+  ~BackgroundWriter();
+
+  void submit(const std::string &filename, void *image, size_t image_size);
+
+  void wait();
+private:
+  MPI_Comm m_com;
+
+  std::thread m_thread;
+
+  // error message reported by the background thread (empty on success)
+  std::string m_error;
+};
+
+} // end of namespace io
+} // end of namespace pism
+
+#endif /* PISM_BACKGROUNDWRITER_H */
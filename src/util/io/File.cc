@@ -28,6 +28,8 @@
 #include "pism/util/Grid.hh"
 #include "pism/util/io/NC_Serial.hh"
 #include "pism/util/io/NC4_Serial.hh"
+#include "pism/util/io/NC_Memory.hh"
+#include "pism/util/io/BackgroundWriter.hh"
 
 #include "pism/pism_config.hh"
 
@@ -114,7 +116,7 @@ static io::Backend choose_backend(MPI_Comm com, const std::string &filename) {
   return io::PISM_NETCDF3;
 }
 
-static std::shared_ptr<io::NCFile> create_backend(MPI_Comm com, io::Backend backend) {
+std::shared_ptr<io::NCFile> create_backend(MPI_Comm com, io::Backend backend) {
   int size = 1;
   MPI_Comm_size(com, &size);
 
@@ -169,6 +171,54 @@ File::File(MPI_Comm com, const std::string &filename, io::Backend backend, io::M
   this->open(filename, mode);
 }
 
+/*!
+ * Create a NetCDF-3 file in memory; `writer` writes it to disk in the background when this
+ * file is closed.
+ *
+ * Waits for `writer` to finish writing the previous file, if any.
+ */
+File::File(MPI_Comm com, const std::string &filename,
+           std::shared_ptr<io::BackgroundWriter> writer, io::Mode mode)
+  : m_impl(new Impl) {
+
+  if (filename.empty()) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "cannot open file: provided file name is empty");
+  }
+
+  if (not (mode == io::PISM_READWRITE_CLOBBER or mode == io::PISM_READWRITE_MOVE)) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "cannot open '%s': in-memory files can only be created",
+                                  filename.c_str());
+  }
+
+  // the previous file may have the same name
+  writer->wait();
+
+  m_impl->com = com;
+  m_impl->nc  = std::make_shared<io::NC_Memory>(m_impl->com, writer);
+
+  this->open(filename, mode);
+}
+
+/*!
+ * Open a file using a backend created by the caller (e.g. by io::IOServer::create_file()).
+ */
+File::File(MPI_Comm com, const std::string &filename, std::shared_ptr<io::NCFile> backend,
+           io::Mode mode)
+  : m_impl(new Impl) {
+
+  if (filename.empty()) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "cannot open file: provided file name is empty");
+  }
+
+  m_impl->com = com;
+  m_impl->nc  = backend;
+
+  this->open(filename, mode);
+}
+
 File::~File() {
   if (m_impl->nc and not name().empty()) {
     try {
@@ -190,6 +240,10 @@ void File::set_compression_level(int level) const {
   m_impl->nc->set_compression_level(level);
 }
 
+void File::set_aggregator_count(int count) const {
+  m_impl->nc->set_aggregator_count(count);
+}
+
 void File::open(const std::string &filename, io::Mode mode) {
   try {
 
@@ -19,6 +19,7 @@
 #ifndef _PISM_FILE_ACCESS_H_
 #define _PISM_FILE_ACCESS_H_
 
+#include <memory>
 #include <vector>
 #include <string>
 #include <mpi.h>
@@ -33,6 +34,8 @@ namespace io {
 enum Type : int;
 enum Backend : int;
 enum Mode : int;
+class BackgroundWriter;
+class NCFile;
 } // namespace io
 
 class Grid;
@@ -42,6 +45,11 @@ class Grid;
  */
 io::Backend string_to_backend(const std::string &backend);
 
+/*!
+ * Create a NetCDF backend of a given type.
+ */
+std::shared_ptr<io::NCFile> create_backend(MPI_Comm com, io::Backend backend);
+
 struct VariableLookupData {
   bool exists;
   std::string name;
@@ -55,6 +63,10 @@ class File
 {
 public:
   File(MPI_Comm com, const std::string &filename, io::Backend backend, io::Mode mode);
+  File(MPI_Comm com, const std::string &filename, std::shared_ptr<io::BackgroundWriter> writer,
+       io::Mode mode);
+  File(MPI_Comm com, const std::string &filename, std::shared_ptr<io::NCFile> backend,
+       io::Mode mode);
   ~File();
 
   MPI_Comm com() const;
@@ -123,6 +135,8 @@ public:
 
   void set_compression_level(int level) const;
 
+  void set_aggregator_count(int count) const;
+
   // attributes
 
   void remove_attribute(const std::string &variable_name, const std::string &att_name) const;
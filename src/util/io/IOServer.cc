@@ -0,0 +1,760 @@
+/* Copyright (C) 2024 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cstring>              // memcpy
+#include <list>
+#include <map>
+
+#include "pism/util/io/IOServer.hh"
+#include "pism/util/io/IOServerProtocol.hh"
+#include "pism/util/io/NC_Remote.hh"
+#include "pism/util/io/NCFile.hh"
+#include "pism/util/io/IO_Flags.hh"
+#include "pism/util/io/File.hh"    // create_backend()
+#include "pism/util/error_handling.hh"
+
+namespace pism {
+namespace io {
+
+namespace server {
+
+Message::Message()
+  : m_position(0) {
+  // empty
+}
+
+Message::Message(std::vector<char> &&buffer)
+  : m_buffer(std::move(buffer)), m_position(0) {
+  // empty
+}
+
+const std::vector<char> &Message::buffer() const {
+  return m_buffer;
+}
+
+void Message::put_bytes(const void *data, size_t size) {
+  const char *bytes = static_cast<const char *>(data);
+  m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+}
+
+void Message::get_bytes(void *data, size_t size) {
+  if (m_position + size > m_buffer.size()) {
+    throw RuntimeError(PISM_ERROR_LOCATION, "I/O server: truncated message");
+  }
+  memcpy(data, m_buffer.data() + m_position, size);
+  m_position += size;
+}
+
+Message &Message::put(int value) {
+  put_bytes(&value, sizeof(value));
+  return *this;
+}
+
+Message &Message::put(double value) {
+  put_bytes(&value, sizeof(value));
+  return *this;
+}
+
+Message &Message::put(const std::string &value) {
+  put(static_cast<int>(value.size()));
+  put_bytes(value.data(), value.size());
+  return *this;
+}
+
+Message &Message::put(const std::vector<unsigned int> &value) {
+  put(static_cast<int>(value.size()));
+  put_bytes(value.data(), value.size() * sizeof(unsigned int));
+  return *this;
+}
+
+Message &Message::put(const std::vector<double> &value) {
+  put(static_cast<int>(value.size()));
+  put_bytes(value.data(), value.size() * sizeof(double));
+  return *this;
+}
+
+Message &Message::put(const std::vector<std::string> &value) {
+  put(static_cast<int>(value.size()));
+  for (const auto &v : value) {
+    put(v);
+  }
+  return *this;
+}
+
+int Message::get_int() {
+  int result = 0;
+  get_bytes(&result, sizeof(result));
+  return result;
+}
+
+double Message::get_double() {
+  double result = 0.0;
+  get_bytes(&result, sizeof(result));
+  return result;
+}
+
+std::string Message::get_string() {
+  std::string result(get_int(), '\0');
+  get_bytes(&result[0], result.size());
+  return result;
+}
+
+std::vector<unsigned int> Message::get_unsigned_vector() {
+  std::vector<unsigned int> result(get_int());
+  get_bytes(result.data(), result.size() * sizeof(unsigned int));
+  return result;
+}
+
+std::vector<double> Message::get_double_vector() {
+  std::vector<double> result(get_int());
+  get_bytes(result.data(), result.size() * sizeof(double));
+  return result;
+}
+
+std::vector<std::string> Message::get_string_vector() {
+  std::vector<std::string> result(get_int());
+  for (auto &v : result) {
+    v = get_string();
+  }
+  return result;
+}
+
+Dimension *Metadata::find_dimension(const std::string &name) {
+  for (auto &d : dimensions) {
+    if (d.name == name) {
+      return &d;
+    }
+  }
+  return nullptr;
+}
+
+Variable *Metadata::find_variable(const std::string &name) {
+  for (auto &v : variables) {
+    if (v.name == name) {
+      return &v;
+    }
+  }
+  return nullptr;
+}
+
+/*!
+ * Returns attributes of a variable or global attributes if `variable_name` is
+ * "PISM_GLOBAL". Returns `nullptr` if the variable does not exist.
+ */
+std::vector<Attribute> *Metadata::attributes(const std::string &variable_name) {
+  if (variable_name == "PISM_GLOBAL") {
+    return &global_attributes;
+  }
+
+  auto *v = find_variable(variable_name);
+  return v != nullptr ? &v->attributes : nullptr;
+}
+
+static void pack(const std::vector<Attribute> &attributes, Message &message) {
+  message.put(static_cast<int>(attributes.size()));
+  for (const auto &a : attributes) {
+    message.put(a.name).put(static_cast<int>(a.type)).put(a.numbers).put(a.text);
+  }
+}
+
+static void unpack(Message &message, std::vector<Attribute> &attributes) {
+  attributes.resize(message.get_int());
+  for (auto &a : attributes) {
+    a.name    = message.get_string();
+    a.type    = static_cast<io::Type>(message.get_int());
+    a.numbers = message.get_double_vector();
+    a.text    = message.get_string();
+  }
+}
+
+void Metadata::pack(Message &message) const {
+  message.put(static_cast<int>(dimensions.size()));
+  for (const auto &d : dimensions) {
+    message.put(d.name).put(static_cast<int>(d.length));
+  }
+  message.put(unlimited_dimension);
+
+  message.put(static_cast<int>(variables.size()));
+  for (const auto &v : variables) {
+    message.put(v.name).put(v.dimensions);
+    server::pack(v.attributes, message);
+  }
+
+  server::pack(global_attributes, message);
+}
+
+void Metadata::unpack(Message &message) {
+  dimensions.resize(message.get_int());
+  for (auto &d : dimensions) {
+    d.name   = message.get_string();
+    d.length = static_cast<unsigned int>(message.get_int());
+  }
+  unlimited_dimension = message.get_string();
+
+  variables.resize(message.get_int());
+  for (auto &v : variables) {
+    v.name       = message.get_string();
+    v.dimensions = message.get_string_vector();
+    server::unpack(message, v.attributes);
+  }
+
+  server::unpack(message, global_attributes);
+}
+
+static std::vector<Attribute> read_attributes(const NCFile &file, const std::string &variable_name) {
+  int n_attributes = 0;
+  file.inq_varnatts(variable_name, n_attributes);
+
+  std::vector<Attribute> result(n_attributes);
+  for (int k = 0; k < n_attributes; ++k) {
+    auto &a = result[k];
+    file.inq_attname(variable_name, k, a.name);
+    file.inq_atttype(variable_name, a.name, a.type);
+
+    // NetCDF-4 string attributes are reported as PISM_NAT
+    if (a.type == io::PISM_CHAR or a.type == io::PISM_NAT) {
+      a.type = io::PISM_CHAR;
+      file.get_att_text(variable_name, a.name, a.text);
+    } else {
+      file.get_att_double(variable_name, a.name, a.numbers);
+    }
+  }
+  return result;
+}
+
+/*!
+ * Read the metadata of an open file.
+ *
+ * Note: NCFile does not provide a way to list dimensions, so this function only finds
+ * dimensions used by at least one variable.
+ */
+Metadata read_metadata(const NCFile &file) {
+  Metadata result;
+
+  int n_variables = 0;
+  file.inq_nvars(n_variables);
+
+  result.variables.resize(n_variables);
+  for (int j = 0; j < n_variables; ++j) {
+    auto &v = result.variables[j];
+
+    file.inq_varname(j, v.name);
+    file.inq_vardimid(v.name, v.dimensions);
+    v.attributes = read_attributes(file, v.name);
+
+    for (const auto &d : v.dimensions) {
+      if (result.find_dimension(d) == nullptr) {
+        unsigned int length = 0;
+        file.inq_dimlen(d, length);
+        result.dimensions.push_back({d, length});
+      }
+    }
+  }
+
+  file.inq_unlimdim(result.unlimited_dimension);
+
+  result.global_attributes = read_attributes(file, "PISM_GLOBAL");
+
+  return result;
+}
+
+/*!
+ * Decode a block of data sent by a compute rank: the number of dimensions `N`, `N`
+ * numbers of `start`, `N` numbers of `count`, followed by data.
+ */
+static const double *decode_block(const std::vector<double> &block,
+                                  std::vector<unsigned int> &start,
+                                  std::vector<unsigned int> &count) {
+  int ndims = static_cast<int>(block.at(0));
+
+  start.resize(ndims);
+  count.resize(ndims);
+  for (int k = 0; k < ndims; ++k) {
+    start[k] = static_cast<unsigned int>(block.at(1 + k));
+    count[k] = static_cast<unsigned int>(block.at(1 + ndims + k));
+  }
+
+  return block.data() + 1 + 2 * ndims;
+}
+
+} // end of namespace server
+
+struct IOServer::Impl {
+  //! A message that may not have been delivered yet (compute ranks)
+  struct PendingSend {
+    std::vector<MPI_Request> requests;
+    std::vector<char> bytes;
+    std::vector<double> data;
+  };
+  mutable std::list<PendingSend> pending;
+
+  //! Open files (server ranks)
+  std::map<int, std::shared_ptr<NCFile> > files;
+
+  //! The first error that has not been reported to compute ranks yet (server ranks)
+  std::string error;
+
+  //! Remove completed sends from `pending`.
+  void cleanup() const {
+    auto it = pending.begin();
+    while (it != pending.end()) {
+      int done = 0;
+      MPI_Testall(static_cast<int>(it->requests.size()), it->requests.data(), &done,
+                  MPI_STATUSES_IGNORE);
+      if (done != 0) {
+        it = pending.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+};
+
+IOServer::IOServer(MPI_Comm com, int n_server_ranks)
+  : m_com(com),
+    m_local_comm(MPI_COMM_NULL),
+    m_intercomm(MPI_COMM_NULL),
+    m_is_server(false),
+    m_n_server_ranks(n_server_ranks),
+    m_n_compute_ranks(0),
+    m_rank(0),
+    m_done(false),
+    m_n_files(0),
+    m_impl(new Impl) {
+
+  int size = 0, rank = 0;
+  MPI_Comm_size(com, &size);
+  MPI_Comm_rank(com, &rank);
+
+  // each server rank has to receive data from at least one compute rank
+  if (n_server_ranks < 1 or 2 * n_server_ranks > size) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "cannot use %d I/O server ranks out of %d"
+                                  " (need at least as many compute ranks as server ranks)",
+                                  n_server_ranks, size);
+  }
+
+  m_n_compute_ranks = size - n_server_ranks;
+  m_is_server       = rank >= m_n_compute_ranks;
+
+  MPI_Comm_split(com, m_is_server ? 1 : 0, rank, &m_local_comm);
+  MPI_Comm_rank(m_local_comm, &m_rank);
+
+  // the leader of the other group (rank in `com`)
+  int remote_leader = m_is_server ? 0 : m_n_compute_ranks;
+  MPI_Intercomm_create(m_local_comm, 0, com, remote_leader, 0, &m_intercomm);
+}
+
+IOServer::~IOServer() {
+  int finalized = 0;
+  MPI_Finalized(&finalized);
+  if (finalized == 0) {
+    try {
+      // make sure server ranks exit even if the caller did not call shutdown()
+      shutdown();
+    } catch (...) {
+      // don't ever throw from here
+    }
+
+    if (m_intercomm != MPI_COMM_NULL) {
+      MPI_Comm_free(&m_intercomm);
+    }
+    if (m_local_comm != MPI_COMM_NULL) {
+      MPI_Comm_free(&m_local_comm);
+    }
+  }
+}
+
+bool IOServer::is_server() const {
+  return m_is_server;
+}
+
+//! Communicator containing compute ranks (`MPI_COMM_NULL` on server ranks).
+MPI_Comm IOServer::compute_comm() const {
+  return m_is_server ? MPI_COMM_NULL : m_local_comm;
+}
+
+/*!
+ * Create a NetCDF backend forwarding I/O to the server. The server uses `backend` to
+ * access the file.
+ *
+ * This is a collective call (on compute ranks).
+ */
+std::shared_ptr<NCFile> IOServer::create_file(io::Backend backend) {
+  if (m_is_server) {
+    throw RuntimeError(PISM_ERROR_LOCATION, "server ranks cannot create remote files");
+  }
+
+  return std::make_shared<NC_Remote>(shared_from_this(), m_n_files++, backend);
+}
+
+/*!
+ * Tell server ranks to stop and report errors that have not been reported yet.
+ *
+ * This is a collective call (on compute ranks).
+ */
+void IOServer::shutdown() {
+  if (m_is_server or m_done) {
+    return;
+  }
+
+  server::Message command;
+  command.put(static_cast<int>(server::SHUTDOWN));
+  send_command(command);
+  wait();
+
+  m_done = true;
+
+  auto error = receive_reply().get_string();
+  if (not error.empty()) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION, "I/O server: %s", error.c_str());
+  }
+}
+
+//! Send a command to all server ranks (compute rank 0 only; no-op on other ranks).
+void IOServer::send_command(const server::Message &command) const {
+  m_impl->cleanup();
+
+  if (m_rank != 0) {
+    return;
+  }
+
+  m_impl->pending.emplace_back();
+  auto &message = m_impl->pending.back();
+
+  message.bytes = command.buffer();
+  message.requests.resize(m_n_server_ranks);
+  for (int s = 0; s < m_n_server_ranks; ++s) {
+    MPI_Isend(message.bytes.data(), static_cast<int>(message.bytes.size()), MPI_CHAR, s,
+              server::COMMAND_TAG, m_intercomm, &message.requests[s]);
+  }
+}
+
+//! Send a block of data to the server rank responsible for this compute rank.
+void IOServer::send_block(std::vector<double> &&block) const {
+  m_impl->cleanup();
+
+  m_impl->pending.emplace_back();
+  auto &message = m_impl->pending.back();
+
+  message.data = std::move(block);
+  message.requests.resize(1);
+  MPI_Isend(message.data.data(), static_cast<int>(message.data.size()), MPI_DOUBLE,
+            m_rank % m_n_server_ranks, server::DATA_TAG, m_intercomm, message.requests.data());
+}
+
+//! Send a request to the server and wait for the reply.
+std::vector<double> IOServer::exchange_block(const std::vector<double> &request) const {
+  int server_rank = m_rank % m_n_server_ranks;
+
+  MPI_Send(request.data(), static_cast<int>(request.size()), MPI_DOUBLE, server_rank,
+           server::REQUEST_TAG, m_intercomm);
+
+  MPI_Status status;
+  int size = 0;
+  MPI_Probe(server_rank, server::REPLY_TAG, m_intercomm, &status);
+  MPI_Get_count(&status, MPI_DOUBLE, &size);
+
+  std::vector<double> result(size);
+  MPI_Recv(result.data(), size, MPI_DOUBLE, server_rank, server::REPLY_TAG, m_intercomm,
+           MPI_STATUS_IGNORE);
+
+  return result;
+}
+
+/*!
+ * Receive a reply sent by server rank 0 and broadcast it to all compute ranks.
+ */
+server::Message IOServer::receive_reply() const {
+  int size = 0;
+  std::vector<char> buffer;
+
+  if (m_rank == 0) {
+    MPI_Status status;
+    MPI_Probe(0, server::STATUS_TAG, m_intercomm, &status);
+    MPI_Get_count(&status, MPI_CHAR, &size);
+
+    buffer.resize(size);
+    MPI_Recv(buffer.data(), size, MPI_CHAR, 0, server::STATUS_TAG, m_intercomm,
+             MPI_STATUS_IGNORE);
+  }
+
+  MPI_Bcast(&size, 1, MPI_INT, 0, m_local_comm);
+  buffer.resize(size);
+  MPI_Bcast(buffer.data(), size, MPI_CHAR, 0, m_local_comm);
+
+  return server::Message(std::move(buffer));
+}
+
+//! Wait for all pending sends to complete.
+void IOServer::wait() const {
+  for (auto &message : m_impl->pending) {
+    MPI_Waitall(static_cast<int>(message.requests.size()), message.requests.data(),
+                MPI_STATUSES_IGNORE);
+  }
+  m_impl->pending.clear();
+}
+
+//! Send a reply from server rank 0 to compute rank 0.
+void IOServer::send_reply(const server::Message &reply) const {
+  if (m_rank == 0) {
+    const auto &buffer = reply.buffer();
+    MPI_Send(buffer.data(), static_cast<int>(buffer.size()), MPI_CHAR, 0, server::STATUS_TAG,
+             m_intercomm);
+  }
+}
+
+/*!
+ * Receive one block from each compute rank this server rank is responsible for.
+ */
+std::vector<std::vector<double> > IOServer::receive_blocks(int tag) const {
+  std::vector<std::vector<double> > result;
+
+  for (int r = m_rank; r < m_n_compute_ranks; r += m_n_server_ranks) {
+    MPI_Status status;
+    int size = 0;
+    MPI_Probe(r, tag, m_intercomm, &status);
+    MPI_Get_count(&status, MPI_DOUBLE, &size);
+
+    result.emplace_back(size);
+    MPI_Recv(result.back().data(), size, MPI_DOUBLE, r, tag, m_intercomm, MPI_STATUS_IGNORE);
+  }
+
+  return result;
+}
+
+/*!
+ * The main loop of a server rank. Returns when compute ranks call shutdown().
+ */
+void IOServer::run() {
+  if (not m_is_server) {
+    throw RuntimeError(PISM_ERROR_LOCATION, "only server ranks can run the I/O server");
+  }
+
+  while (true) {
+    MPI_Status status;
+    int size = 0;
+    MPI_Probe(0, server::COMMAND_TAG, m_intercomm, &status);
+    MPI_Get_count(&status, MPI_CHAR, &size);
+
+    std::vector<char> buffer(size);
+    MPI_Recv(buffer.data(), size, MPI_CHAR, 0, server::COMMAND_TAG, m_intercomm,
+             MPI_STATUS_IGNORE);
+
+    server::Message message(std::move(buffer));
+    int command = message.get_int();
+
+    if (command == server::SHUTDOWN) {
+      send_reply(server::Message().put(m_impl->error));
+      break;
+    }
+
+    serve(command, message);
+  }
+
+  m_done = true;
+}
+
+//! Process a command sent by compute rank 0.
+void IOServer::serve(int command, server::Message &message) {
+  using namespace server;
+
+  int file_id = message.get_int();
+
+  // Blocks have to be received (and replies sent) even if processing this command fails.
+  std::vector<std::vector<double> > blocks;
+  if (command == PUT_VARA) {
+    blocks = receive_blocks(DATA_TAG);
+  } else if (command == GET_VARA) {
+    blocks = receive_blocks(REQUEST_TAG);
+  }
+  // Every server rank has at least one block, but server rank 0 may have one more than
+  // others. Collective calls below have to be made the same number of times on all ranks.
+  int n_blocks = (m_n_compute_ranks + m_n_server_ranks - 1) / m_n_server_ranks;
+
+  std::vector<std::vector<double> > replies(blocks.size());
+  Metadata metadata;
+  try {
+    std::shared_ptr<NCFile> file;
+    if (command == CREATE or command == OPEN) {
+      auto backend = static_cast<io::Backend>(message.get_int());
+
+      file = create_backend(m_local_comm, backend);
+      m_impl->files[file_id] = file;
+    } else {
+      auto it = m_impl->files.find(file_id);
+      if (it == m_impl->files.end()) {
+        throw RuntimeError::formatted(PISM_ERROR_LOCATION, "invalid file ID: %d", file_id);
+      }
+      file = it->second;
+    }
+
+    switch (command) {
+    case CREATE:
+      file->create(message.get_string());
+      break;
+    case OPEN:
+      {
+        auto filename = message.get_string();
+        auto mode     = static_cast<io::Mode>(message.get_int());
+        file->open(filename, mode);
+        metadata = read_metadata(*file);
+      }
+      break;
+    case CLOSE:
+      m_impl->files.erase(file_id);
+      file->close();
+      break;
+    case SYNC:
+      file->sync();
+      break;
+    case ENDDEF:
+      file->enddef();
+      break;
+    case REDEF:
+      file->redef();
+      break;
+    case DEF_DIM:
+      {
+        auto name   = message.get_string();
+        auto length = message.get_int();
+        file->def_dim(name, length);
+      }
+      break;
+    case DEF_VAR:
+      {
+        auto name = message.get_string();
+        auto type = static_cast<io::Type>(message.get_int());
+        auto dims = message.get_string_vector();
+        file->def_var(name, type, dims);
+      }
+      break;
+    case PUT_VARA:
+      {
+        auto name = message.get_string();
+        std::vector<unsigned int> start, count, start0, count0;
+        decode_block(blocks[0], start0, count0);
+
+        for (int k = 0; k < n_blocks; ++k) {
+          if (k < (int)blocks.size()) {
+            const double *data = decode_block(blocks[k], start, count);
+            file->put_vara_double(name, start, count, data);
+          } else {
+            // nothing to write
+            std::vector<unsigned int> zeros(start0.size(), 0);
+            file->put_vara_double(name, start0, zeros, nullptr);
+          }
+        }
+      }
+      break;
+    case GET_VARA:
+      {
+        auto name = message.get_string();
+        std::vector<unsigned int> start, count, start0, count0;
+        decode_block(blocks[0], start0, count0);
+
+        for (int k = 0; k < n_blocks; ++k) {
+          if (k < (int)blocks.size()) {
+            decode_block(blocks[k], start, count);
+
+            size_t size = 1;
+            for (auto c : count) {
+              size *= c;
+            }
+            // the first element is the status (0 on success)
+            replies[k].resize(1 + size, 0.0);
+            file->get_vara_double(name, start, count, replies[k].data() + 1);
+          } else {
+            std::vector<unsigned int> zeros(start0.size(), 0);
+            double dummy = 0.0;
+            file->get_vara_double(name, start0, zeros, &dummy);
+          }
+        }
+      }
+      break;
+    case SET_COMPRESSION_LEVEL:
+      file->set_compression_level(message.get_int());
+      break;
+    case SET_AGGREGATOR_COUNT:
+      file->set_aggregator_count(message.get_int());
+      break;
+    case PUT_ATT_DOUBLE:
+      {
+        auto variable_name = message.get_string();
+        auto att_name      = message.get_string();
+        auto type          = static_cast<io::Type>(message.get_int());
+        auto data          = message.get_double_vector();
+        file->put_att_double(variable_name, att_name, type, data);
+      }
+      break;
+    case PUT_ATT_TEXT:
+      {
+        auto variable_name = message.get_string();
+        auto att_name      = message.get_string();
+        auto text          = message.get_string();
+        file->put_att_text(variable_name, att_name, text);
+      }
+      break;
+    case DEL_ATT:
+      {
+        auto variable_name = message.get_string();
+        auto att_name      = message.get_string();
+        file->del_att(variable_name, att_name);
+      }
+      break;
+    case SET_FILL:
+      {
+        int old_mode = 0;
+        file->set_fill(message.get_int(), old_mode);
+      }
+      break;
+    default:
+      throw RuntimeError::formatted(PISM_ERROR_LOCATION, "invalid command: %d", command);
+    }
+  } catch (RuntimeError &e) {
+    if (m_impl->error.empty()) {
+      m_impl->error = e.what();
+    }
+  }
+
+  if (command == GET_VARA) {
+    for (size_t k = 0; k < blocks.size(); ++k) {
+      if (not m_impl->error.empty()) {
+        replies[k] = {1.0};
+      }
+      int r = m_rank + static_cast<int>(k) * m_n_server_ranks;
+      MPI_Send(replies[k].data(), static_cast<int>(replies[k].size()), MPI_DOUBLE, r,
+               REPLY_TAG, m_intercomm);
+    }
+  }
+
+  if (command == OPEN or command == CLOSE) {
+    // report errors (if any) and the metadata of the file that was opened
+    Message status;
+    status.put(m_impl->error);
+    if (m_impl->error.empty() and command == OPEN) {
+      metadata.pack(status);
+    }
+    send_reply(status);
+    m_impl->error.clear();
+  }
+}
+
+} // end of namespace io
+} // end of namespace pism
@@ -0,0 +1,111 @@
+/* Copyright (C) 2024 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PISM_IOSERVER_H
+#define PISM_IOSERVER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+
+namespace pism {
+namespace io {
+
+class NCFile;
+enum Backend : int;
+
+namespace server {
+class Message;
+}
+
+//! Ranks set aside to write output files on behalf of the rest of the ranks.
+/*!
+ * The constructor splits a communicator into "compute" ranks and "I/O server" ranks
+ * (the last `n_server_ranks` ranks). Server ranks call run() and wait for requests;
+ * compute ranks use the communicator returned by compute_comm() to run the model and
+ * create_file() to get a NetCDF backend (see NC_Remote) that forwards I/O to the server.
+ *
+ * Compute ranks answer metadata queries using a local copy of the file's metadata and
+ * send data using non-blocking sends, so they don't wait for the server to finish
+ * writing.
+ *
+ * Compute rank `r` sends its data to the server rank `r % n_server_ranks`.
+ */
+class IOServer : public std::enable_shared_from_this<IOServer> {
+public:
+  IOServer(MPI_Comm com, int n_server_ranks);
+  ~IOServer();
+
+  bool is_server() const;
+
+  MPI_Comm compute_comm() const;
+
+  void run();
+
+  void shutdown();
+
+  std::shared_ptr<NCFile> create_file(io::Backend backend);
+
+  // The following methods are used by NC_Remote on compute ranks.
+
+  void send_command(const server::Message &command) const;
+
+  void send_block(std::vector<double> &&block) const;
+
+  std::vector<double> exchange_block(const std::vector<double> &request) const;
+
+  server::Message receive_reply() const;
+
+  void wait() const;
+private:
+  void serve(int command, server::Message &message);
+
+  std::vector<std::vector<double> > receive_blocks(int tag) const;
+
+  void send_reply(const server::Message &reply) const;
+
+  //! communicator containing all ranks
+  MPI_Comm m_com;
+  //! communicator containing ranks of the same kind (compute or server)
+  MPI_Comm m_local_comm;
+  //! inter-communicator connecting compute and server ranks
+  MPI_Comm m_intercomm;
+
+  bool m_is_server;
+  int m_n_server_ranks;
+  int m_n_compute_ranks;
+  //! rank in m_local_comm
+  int m_rank;
+
+  //! true if the server was shut down
+  bool m_done;
+
+  //! number of files created so far (used to assign file IDs)
+  int m_n_files;
+
+  struct Impl;
+  std::unique_ptr<Impl> m_impl;
+};
+
+} // end of namespace io
+} // end of namespace pism
+
+#endif /* PISM_IOSERVER_H */
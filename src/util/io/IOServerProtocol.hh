@@ -0,0 +1,135 @@
+/* Copyright (C) 2024 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PISM_IOSERVERPROTOCOL_H
+#define PISM_IOSERVERPROTOCOL_H
+
+#include <cstddef>              // size_t
+#include <string>
+#include <vector>
+
+#include "pism/util/io/IO_Flags.hh"
+
+namespace pism {
+namespace io {
+
+class NCFile;
+
+//! Messages exchanged by IOServer and NC_Remote.
+namespace server {
+
+//! Requests sent by compute rank 0 to all server ranks.
+enum Command : int {
+  SHUTDOWN = 0,
+  CREATE,
+  OPEN,
+  CLOSE,
+  SYNC,
+  ENDDEF,
+  REDEF,
+  DEF_DIM,
+  DEF_VAR,
+  PUT_VARA,
+  GET_VARA,
+  SET_COMPRESSION_LEVEL,
+  SET_AGGREGATOR_COUNT,
+  PUT_ATT_DOUBLE,
+  PUT_ATT_TEXT,
+  DEL_ATT,
+  SET_FILL
+};
+
+//! MPI tags used on the inter-communicator
+enum Tag : int { COMMAND_TAG = 1, DATA_TAG, REQUEST_TAG, REPLY_TAG, STATUS_TAG };
+
+//! A buffer used to serialize requests.
+class Message {
+public:
+  Message();
+  explicit Message(std::vector<char> &&buffer);
+
+  const std::vector<char> &buffer() const;
+
+  Message &put(int value);
+  Message &put(double value);
+  Message &put(const std::string &value);
+  Message &put(const std::vector<unsigned int> &value);
+  Message &put(const std::vector<double> &value);
+  Message &put(const std::vector<std::string> &value);
+
+  int get_int();
+  double get_double();
+  std::string get_string();
+  std::vector<unsigned int> get_unsigned_vector();
+  std::vector<double> get_double_vector();
+  std::vector<std::string> get_string_vector();
+
+private:
+  void put_bytes(const void *data, size_t size);
+  void get_bytes(void *data, size_t size);
+
+  std::vector<char> m_buffer;
+  size_t m_position;
+};
+
+struct Attribute {
+  std::string name;
+  io::Type type;
+  //! values of a numeric attribute
+  std::vector<double> numbers;
+  //! value of a text attribute
+  std::string text;
+};
+
+struct Variable {
+  std::string name;
+  std::vector<std::string> dimensions;
+  std::vector<Attribute> attributes;
+};
+
+struct Dimension {
+  std::string name;
+  unsigned int length;
+};
+
+//! A copy of the metadata of a NetCDF file.
+/*!
+ * Used by NC_Remote to answer queries without waiting for the server.
+ */
+struct Metadata {
+  std::vector<Dimension> dimensions;
+  std::string unlimited_dimension;
+  std::vector<Variable> variables;
+  std::vector<Attribute> global_attributes;
+
+  Dimension *find_dimension(const std::string &name);
+  Variable *find_variable(const std::string &name);
+  std::vector<Attribute> *attributes(const std::string &variable_name);
+
+  void pack(Message &message) const;
+  void unpack(Message &message);
+};
+
+Metadata read_metadata(const NCFile &file);
+
+} // end of namespace server
+} // end of namespace io
+} // end of namespace pism
+
+#endif /* PISM_IOSERVERPROTOCOL_H */
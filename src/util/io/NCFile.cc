@@ -49,6 +49,20 @@ void NCFile::set_compression_level_impl(int level) const {
   // the default implementation does nothing
 }
 
+/*!
+ * Set the number of ranks aggregating data written by put_vara_double().
+ *
+ * This is a collective call. It has no effect on backends that write in parallel.
+ */
+void NCFile::set_aggregator_count(int count) const {
+  set_aggregator_count_impl(count);
+}
+
+void NCFile::set_aggregator_count_impl(int count) const {
+  (void) count;
+  // the default implementation does nothing
+}
+
 void NCFile::def_var_chunking_impl(const std::string &name,
                                    std::vector<size_t> &dimensions) const {
   (void) name;
@@ -111,6 +111,8 @@ public:
 
   void set_compression_level(int level) const;
 
+  void set_aggregator_count(int count) const;
+
   // att
   void get_att_double(const std::string &variable_name, const std::string &att_name,
                       std::vector<double> &result) const;
@@ -192,6 +194,8 @@ protected:
 
   virtual void set_compression_level_impl(int level) const = 0;
 
+  virtual void set_aggregator_count_impl(int count) const;
+
   // att
   virtual void get_att_double_impl(const std::string &variable_name, const std::string &att_name,
                                    std::vector<double> &result) const = 0;
@@ -0,0 +1,107 @@
+/* Copyright (C) 2024 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "pism/util/io/NC_Memory.hh"
+#include "pism/util/io/BackgroundWriter.hh"
+
+// The following is a stupid kludge necessary to make NetCDF 4.x work in
+// serial mode in an MPI program:
+#ifndef MPI_INCLUDED
+#define MPI_INCLUDED 1
+#endif
+#include <netcdf.h>
+#include <netcdf_meta.h>
+
+#define PISM_NETCDF_HAS_MEMIO                                                             \
+  (NC_VERSION_MAJOR * 10000 + NC_VERSION_MINOR * 100 + NC_VERSION_PATCH >= 40602)
+
+#if (PISM_NETCDF_HAS_MEMIO == 1)
+#include <netcdf_mem.h>
+#endif
+
+#include "pism/util/error_handling.hh"
+
+namespace pism {
+namespace io {
+
+static void check(const ErrorLocation &where, int return_code) {
+  if (return_code != NC_NOERR) {
+    throw RuntimeError(where, nc_strerror(return_code));
+  }
+}
+
+NC_Memory::NC_Memory(MPI_Comm com, std::shared_ptr<BackgroundWriter> writer)
+  : NC_Serial(com), m_writer(writer) {
+#if (PISM_NETCDF_HAS_MEMIO == 0)
+  throw RuntimeError(PISM_ERROR_LOCATION,
+                     "writing files in the background requires NetCDF 4.6.2 or newer");
+#endif
+}
+
+void NC_Memory::open_impl(const std::string &filename, io::Mode mode) {
+  (void) mode;
+  throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                "cannot open '%s': in-memory files can only be created",
+                                filename.c_str());
+}
+
+//! \brief Create a NetCDF file in rank 0's memory.
+void NC_Memory::create_impl(const std::string &filename) {
+  int stat = NC_NOERR;
+
+#if (PISM_NETCDF_HAS_MEMIO == 1)
+  if (m_rank == 0) {
+    // Use the default initial size: the image grows as needed.
+    stat = nc_create_mem(filename.c_str(), NC_64BIT_OFFSET, 0, &m_file_id);
+  }
+#else
+  (void) filename;
+#endif
+
+  MPI_Bcast(&m_file_id, 1, MPI_INT, 0, m_com);
+  MPI_Bcast(&stat, 1, MPI_INT, 0, m_com);
+
+  check(PISM_ERROR_LOCATION, stat);
+}
+
+//! \brief Close the in-memory file and start writing it to disk in the background.
+void NC_Memory::close_impl() {
+  int stat = NC_NOERR;
+
+#if (PISM_NETCDF_HAS_MEMIO == 1)
+  if (m_rank == 0) {
+    NC_memio image;
+    stat = nc_close_memio(m_file_id, &image);
+
+    if (stat == NC_NOERR) {
+      // m_writer takes ownership of image.memory
+      m_writer->submit(m_filename, image.memory, image.size);
+    }
+  }
+#endif
+
+  m_file_id = -1;
+
+  MPI_Bcast(&stat, 1, MPI_INT, 0, m_com);
+
+  check(PISM_ERROR_LOCATION, stat);
+}
+
+} // end of namespace io
+} // end of namespace pism
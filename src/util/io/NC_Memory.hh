@@ -0,0 +1,59 @@
+/* Copyright (C) 2024 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PISM_NC_MEMORY_H
+#define PISM_NC_MEMORY_H
+
+#include <memory>
+
+#include "pism/util/io/NC_Serial.hh"
+
+namespace pism {
+namespace io {
+
+class BackgroundWriter;
+
+//! NetCDF-3 file created in rank 0's memory and written to disk in the background.
+/*!
+ * Uses NetCDF's in-memory files (NetCDF 4.6.2 or newer). Data are gathered on rank 0 as
+ * in NC_Serial, but all the writing is done in memory; when the file is closed the
+ * image is handed to a BackgroundWriter.
+ *
+ * This class only supports creating new files.
+ */
+class NC_Memory : public NC_Serial
+{
+public:
+  NC_Memory(MPI_Comm com, std::shared_ptr<BackgroundWriter> writer);
+  virtual ~NC_Memory() = default;
+
+protected:
+  void open_impl(const std::string &filename, io::Mode mode);
+
+  void create_impl(const std::string &filename);
+
+  void close_impl();
+
+  std::shared_ptr<BackgroundWriter> m_writer;
+};
+
+} // end of namespace io
+} // end of namespace pism
+
+#endif /* PISM_NC_MEMORY_H */
@@ -0,0 +1,457 @@
+/* Copyright (C) 2024 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <algorithm>            // std::copy
+#include <cmath>                // std::trunc
+#include <cstdio>               // stderr, fprintf
+
+#include "pism/util/io/NC_Remote.hh"
+#include "pism/util/io/IOServer.hh"
+#include "pism/util/io/IO_Flags.hh"
+#include "pism/util/error_handling.hh"
+
+namespace pism {
+namespace io {
+
+NC_Remote::NC_Remote(std::shared_ptr<const IOServer> server, int file_id, io::Backend backend)
+  : NCFile(server->compute_comm()),
+    m_server(server),
+    m_id(file_id),
+    m_backend(backend),
+    m_fill_mode(PISM_FILL) {
+  // empty
+}
+
+NC_Remote::~NC_Remote() {
+  if (m_file_id >= 0) {
+    int rank = 0;
+    MPI_Comm_rank(m_com, &rank);
+    if (rank == 0) {
+      fprintf(stderr, "NC_Remote::~NC_Remote: NetCDF file %s is still open\n",
+              m_filename.c_str());
+    }
+    m_file_id = -1;
+  }
+}
+
+//! Start a message containing a command for the server.
+server::Message NC_Remote::command(server::Command type) const {
+  server::Message result;
+  result.put(static_cast<int>(type)).put(m_id);
+  return result;
+}
+
+/*!
+ * Wait for the status reply sent by the server in response to OPEN and CLOSE and throw
+ * if the server reported an error.
+ *
+ * Returns the rest of the reply.
+ */
+server::Message NC_Remote::check_status() const {
+  auto reply = m_server->receive_reply();
+
+  auto error = reply.get_string();
+  if (not error.empty()) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION, "I/O server: %s", error.c_str());
+  }
+
+  return reply;
+}
+
+const server::Variable &NC_Remote::variable(const std::string &name) const {
+  auto *result = m_metadata.find_variable(name);
+  if (result == nullptr) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION, "variable '%s' not found in '%s'",
+                                  name.c_str(), m_filename.c_str());
+  }
+  return *result;
+}
+
+/*!
+ * Find an attribute, creating it if it does not exist.
+ */
+server::Attribute &NC_Remote::attribute(const std::string &variable_name,
+                                        const std::string &att_name) const {
+  auto *attributes = m_metadata.attributes(variable_name);
+  if (attributes == nullptr) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION, "variable '%s' not found in '%s'",
+                                  variable_name.c_str(), m_filename.c_str());
+  }
+
+  for (auto &a : *attributes) {
+    if (a.name == att_name) {
+      return a;
+    }
+  }
+
+  attributes->push_back({att_name, PISM_NAT, {}, ""});
+  return attributes->back();
+}
+
+// open/create/close
+
+void NC_Remote::open_impl(const std::string &filename, io::Mode mode) {
+  auto message = command(server::OPEN);
+  message.put(static_cast<int>(m_backend)).put(filename).put(static_cast<int>(mode));
+  m_server->send_command(message);
+
+  // opening a file requires a round trip: we need a copy of its metadata
+  auto reply = check_status();
+
+  m_metadata = server::Metadata();
+  m_metadata.unpack(reply);
+  m_fill_mode = PISM_FILL;
+  m_file_id   = m_id;
+}
+
+void NC_Remote::create_impl(const std::string &filename) {
+  auto message = command(server::CREATE);
+  message.put(static_cast<int>(m_backend)).put(filename);
+  m_server->send_command(message);
+
+  m_metadata  = server::Metadata();
+  m_fill_mode = PISM_FILL;
+  m_file_id   = m_id;
+}
+
+void NC_Remote::sync_impl() const {
+  m_server->send_command(command(server::SYNC));
+}
+
+/*!
+ * Closes the file and reports errors the server encountered while processing requests
+ * for this file.
+ */
+void NC_Remote::close_impl() {
+  m_server->send_command(command(server::CLOSE));
+  m_server->wait();
+
+  m_metadata = server::Metadata();
+  m_file_id  = -1;
+
+  check_status();
+}
+
+// redef/enddef
+
+void NC_Remote::enddef_impl() const {
+  m_server->send_command(command(server::ENDDEF));
+}
+
+void NC_Remote::redef_impl() const {
+  m_server->send_command(command(server::REDEF));
+}
+
+// dim
+
+void NC_Remote::def_dim_impl(const std::string &name, size_t length) const {
+  if (m_metadata.find_dimension(name) != nullptr) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION, "dimension '%s' already exists in '%s'",
+                                  name.c_str(), m_filename.c_str());
+  }
+
+  auto message = command(server::DEF_DIM);
+  message.put(name).put(static_cast<int>(length));
+  m_server->send_command(message);
+
+  m_metadata.dimensions.push_back({name, static_cast<unsigned int>(length)});
+  if (length == PISM_UNLIMITED) {
+    m_metadata.unlimited_dimension = name;
+  }
+}
+
+void NC_Remote::inq_dimid_impl(const std::string &dimension_name, bool &exists) const {
+  exists = (m_metadata.find_dimension(dimension_name) != nullptr);
+}
+
+void NC_Remote::inq_dimlen_impl(const std::string &dimension_name, unsigned int &result) const {
+  auto *dimension = m_metadata.find_dimension(dimension_name);
+  if (dimension == nullptr) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION, "dimension '%s' not found in '%s'",
+                                  dimension_name.c_str(), m_filename.c_str());
+  }
+  result = dimension->length;
+}
+
+void NC_Remote::inq_unlimdim_impl(std::string &result) const {
+  result = m_metadata.unlimited_dimension;
+}
+
+// var
+
+void NC_Remote::def_var_impl(const std::string &name, io::Type nctype,
+                             const std::vector<std::string> &dims) const {
+  if (m_metadata.find_variable(name) != nullptr) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION, "variable '%s' already exists in '%s'",
+                                  name.c_str(), m_filename.c_str());
+  }
+
+  for (const auto &d : dims) {
+    if (m_metadata.find_dimension(d) == nullptr) {
+      throw RuntimeError::formatted(PISM_ERROR_LOCATION, "dimension '%s' not found in '%s'",
+                                    d.c_str(), m_filename.c_str());
+    }
+  }
+
+  auto message = command(server::DEF_VAR);
+  message.put(name).put(static_cast<int>(nctype)).put(dims);
+  m_server->send_command(message);
+
+  m_metadata.variables.push_back({name, dims, {}});
+}
+
+/*!
+ * Reading data requires a round trip: each compute rank sends its `start` and `count`
+ * to its server rank and waits for the data.
+ */
+void NC_Remote::get_vara_double_impl(const std::string &variable_name,
+                                     const std::vector<unsigned int> &start,
+                                     const std::vector<unsigned int> &count, double *ip) const {
+  auto message = command(server::GET_VARA);
+  message.put(variable_name);
+  m_server->send_command(message);
+
+  std::vector<double> request{ (double)start.size() };
+  request.insert(request.end(), start.begin(), start.end());
+  request.insert(request.end(), count.begin(), count.end());
+
+  auto reply = m_server->exchange_block(request);
+
+  size_t size = 1;
+  for (auto c : count) {
+    size *= c;
+  }
+
+  if (reply.empty() or reply[0] != 0.0 or reply.size() != size + 1) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "I/O server failed to read '%s' from '%s'",
+                                  variable_name.c_str(), m_filename.c_str());
+  }
+
+  std::copy(reply.begin() + 1, reply.end(), ip);
+}
+
+/*!
+ * Sends data to the server without waiting for it to be written.
+ */
+void NC_Remote::put_vara_double_impl(const std::string &variable_name,
+                                     const std::vector<unsigned int> &start,
+                                     const std::vector<unsigned int> &count,
+                                     const double *op) const {
+  const auto &var = variable(variable_name);
+
+  size_t size = 1;
+  for (auto c : count) {
+    size *= c;
+  }
+
+  // pack start, count, and data into one block
+  std::vector<double> block{ (double)start.size() };
+  block.reserve(1 + 2 * start.size() + size);
+  block.insert(block.end(), start.begin(), start.end());
+  block.insert(block.end(), count.begin(), count.end());
+  block.insert(block.end(), op, op + size);
+
+  m_server->send_block(std::move(block));
+
+  auto message = command(server::PUT_VARA);
+  message.put(variable_name);
+  m_server->send_command(message);
+
+  // keep track of the length of the unlimited dimension
+  if (not var.dimensions.empty() and var.dimensions[0] == m_metadata.unlimited_dimension) {
+    unsigned int length = count[0] > 0 ? start[0] + count[0] : 0, global_length = 0;
+    MPI_Allreduce(&length, &global_length, 1, MPI_UNSIGNED, MPI_MAX, m_com);
+
+    auto *dimension   = m_metadata.find_dimension(var.dimensions[0]);
+    dimension->length = std::max(dimension->length, global_length);
+  }
+}
+
+void NC_Remote::inq_nvars_impl(int &result) const {
+  result = static_cast<int>(m_metadata.variables.size());
+}
+
+void NC_Remote::inq_vardimid_impl(const std::string &variable_name,
+                                  std::vector<std::string> &result) const {
+  result = variable(variable_name).dimensions;
+}
+
+void NC_Remote::inq_varnatts_impl(const std::string &variable_name, int &result) const {
+  auto *attributes = m_metadata.attributes(variable_name);
+  if (attributes == nullptr) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION, "variable '%s' not found in '%s'",
+                                  variable_name.c_str(), m_filename.c_str());
+  }
+  result = static_cast<int>(attributes->size());
+}
+
+void NC_Remote::inq_varid_impl(const std::string &variable_name, bool &exists) const {
+  exists = (m_metadata.find_variable(variable_name) != nullptr);
+}
+
+void NC_Remote::inq_varname_impl(unsigned int j, std::string &result) const {
+  if (j >= m_metadata.variables.size()) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION, "invalid variable index %d in '%s'",
+                                  (int)j, m_filename.c_str());
+  }
+  result = m_metadata.variables[j].name;
+}
+
+void NC_Remote::set_compression_level_impl(int level) const {
+  auto message = command(server::SET_COMPRESSION_LEVEL);
+  message.put(level);
+  m_server->send_command(message);
+}
+
+void NC_Remote::set_aggregator_count_impl(int count) const {
+  auto message = command(server::SET_AGGREGATOR_COUNT);
+  message.put(count);
+  m_server->send_command(message);
+}
+
+// att
+
+void NC_Remote::get_att_double_impl(const std::string &variable_name, const std::string &att_name,
+                                    std::vector<double> &result) const {
+  io::Type type = PISM_NAT;
+  inq_atttype_impl(variable_name, att_name, type);
+
+  if (type == PISM_NAT) {
+    result.clear();
+    return;
+  }
+
+  if (type == PISM_CHAR) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "attribute %s:%s in '%s' is not numeric",
+                                  variable_name.c_str(), att_name.c_str(), m_filename.c_str());
+  }
+
+  result = attribute(variable_name, att_name).numbers;
+}
+
+void NC_Remote::get_att_text_impl(const std::string &variable_name, const std::string &att_name,
+                                  std::string &result) const {
+  io::Type type = PISM_NAT;
+  inq_atttype_impl(variable_name, att_name, type);
+
+  result = (type == PISM_CHAR) ? attribute(variable_name, att_name).text : "";
+}
+
+void NC_Remote::put_att_double_impl(const std::string &variable_name, const std::string &att_name,
+                                    io::Type xtype, const std::vector<double> &data) const {
+  auto &a = attribute(variable_name, att_name);
+
+  auto message = command(server::PUT_ATT_DOUBLE);
+  message.put(variable_name).put(att_name).put(static_cast<int>(xtype)).put(data);
+  m_server->send_command(message);
+
+  // store values the way they will be stored in the file
+  a.type = xtype;
+  a.text.clear();
+  a.numbers.resize(data.size());
+  for (size_t k = 0; k < data.size(); ++k) {
+    switch (xtype) {
+    case PISM_FLOAT:
+      a.numbers[k] = static_cast<float>(data[k]);
+      break;
+    case PISM_BYTE:
+    case PISM_SHORT:
+    case PISM_INT:
+      a.numbers[k] = std::trunc(data[k]);
+      break;
+    default:
+      a.numbers[k] = data[k];
+    }
+  }
+}
+
+void NC_Remote::put_att_text_impl(const std::string &variable_name, const std::string &att_name,
+                                  const std::string &value) const {
+  auto &a = attribute(variable_name, att_name);
+
+  auto message = command(server::PUT_ATT_TEXT);
+  message.put(variable_name).put(att_name).put(value);
+  m_server->send_command(message);
+
+  a.type = PISM_CHAR;
+  a.numbers.clear();
+  a.text = value;
+}
+
+void NC_Remote::inq_attname_impl(const std::string &variable_name, unsigned int n,
+                                 std::string &result) const {
+  auto *attributes = m_metadata.attributes(variable_name);
+  if (attributes == nullptr or n >= attributes->size()) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION,
+                                  "attribute %d of the variable '%s' not found in '%s'", (int)n,
+                                  variable_name.c_str(), m_filename.c_str());
+  }
+  result = (*attributes)[n].name;
+}
+
+void NC_Remote::inq_atttype_impl(const std::string &variable_name, const std::string &att_name,
+                                 io::Type &result) const {
+  auto *attributes = m_metadata.attributes(variable_name);
+  if (attributes == nullptr) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION, "variable '%s' not found in '%s'",
+                                  variable_name.c_str(), m_filename.c_str());
+  }
+
+  result = PISM_NAT;
+  for (const auto &a : *attributes) {
+    if (a.name == att_name) {
+      result = a.type;
+      break;
+    }
+  }
+}
+
+// misc
+
+void NC_Remote::set_fill_impl(int fillmode, int &old_modep) const {
+  auto message = command(server::SET_FILL);
+  message.put(fillmode);
+  m_server->send_command(message);
+
+  old_modep   = m_fill_mode;
+  m_fill_mode = fillmode;
+}
+
+void NC_Remote::del_att_impl(const std::string &variable_name, const std::string &att_name) const {
+  auto *attributes = m_metadata.attributes(variable_name);
+  if (attributes == nullptr) {
+    throw RuntimeError::formatted(PISM_ERROR_LOCATION, "variable '%s' not found in '%s'",
+                                  variable_name.c_str(), m_filename.c_str());
+  }
+
+  auto message = command(server::DEL_ATT);
+  message.put(variable_name).put(att_name);
+  m_server->send_command(message);
+
+  attributes->erase(std::remove_if(attributes->begin(), attributes->end(),
+                                   [&att_name](const server::Attribute &a) {
+                                     return a.name == att_name;
+                                   }),
+                    attributes->end());
+}
+
+} // end of namespace io
+} // end of namespace pism
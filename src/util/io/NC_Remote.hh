@@ -0,0 +1,145 @@
+/* Copyright (C) 2024 PISM Authors
+ *
+ * This file is part of PISM.
+ *
+ * PISM is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PISM; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PISM_NC_REMOTE_H
+#define PISM_NC_REMOTE_H
+
+#include <memory>
+
+#include "pism/util/io/NCFile.hh"
+#include "pism/util/io/IOServerProtocol.hh"
+
+namespace pism {
+namespace io {
+
+class IOServer;
+
+//! NetCDF backend forwarding all I/O to an IOServer.
+/*!
+ * Metadata queries are answered using a local copy of the file's metadata. Data and
+ * metadata changes are sent to the server without waiting for it to process them.
+ * Errors reported by the server are re-thrown when the file is closed.
+ *
+ * Reading data requires a round trip to the server.
+ */
+class NC_Remote : public NCFile
+{
+public:
+  NC_Remote(std::shared_ptr<const IOServer> server, int file_id, io::Backend backend);
+  virtual ~NC_Remote();
+
+protected:
+  // open/create/close
+  void open_impl(const std::string &filename, io::Mode mode);
+
+  void create_impl(const std::string &filename);
+
+  void sync_impl() const;
+
+  void close_impl();
+
+  // redef/enddef
+  void enddef_impl() const;
+
+  void redef_impl() const;
+
+  // dim
+  void def_dim_impl(const std::string &name, size_t length) const;
+
+  void inq_dimid_impl(const std::string &dimension_name, bool &exists) const;
+
+  void inq_dimlen_impl(const std::string &dimension_name, unsigned int &result) const;
+
+  void inq_unlimdim_impl(std::string &result) const;
+
+  // var
+  void def_var_impl(const std::string &name, io::Type nctype,
+                    const std::vector<std::string> &dims) const;
+
+  void get_vara_double_impl(const std::string &variable_name,
+                            const std::vector<unsigned int> &start,
+                            const std::vector<unsigned int> &count,
+                            double *ip) const;
+
+  void put_vara_double_impl(const std::string &variable_name,
+                            const std::vector<unsigned int> &start,
+                            const std::vector<unsigned int> &count,
+                            const double *op) const;
+
+  void inq_nvars_impl(int &result) const;
+
+  void inq_vardimid_impl(const std::string &variable_name, std::vector<std::string> &result) const;
+
+  void inq_varnatts_impl(const std::string &variable_name, int &result) const;
+
+  void inq_varid_impl(const std::string &variable_name, bool &exists) const;
+
+  void inq_varname_impl(unsigned int j, std::string &result) const;
+
+  void set_compression_level_impl(int level) const;
+
+  void set_aggregator_count_impl(int count) const;
+
+  // att
+  void get_att_double_impl(const std::string &variable_name, const std::string &att_name,
+                           std::vector<double> &result) const;
+
+  void get_att_text_impl(const std::string &variable_name, const std::string &att_name,
+                         std::string &result) const;
+
+  void put_att_double_impl(const std::string &variable_name, const std::string &att_name,
+                           io::Type xtype, const std::vector<double> &data) const;
+
+  void put_att_text_impl(const std::string &variable_name, const std::string &att_name,
+                         const std::string &value) const;
+
+  void inq_attname_impl(const std::string &variable_name, unsigned int n,
+                        std::string &result) const;
+
+  void inq_atttype_impl(const std::string &variable_name, const std::string &att_name,
+                        io::Type &result) const;
+
+  // misc
+  void set_fill_impl(int fillmode, int &old_modep) const;
+
+  void del_att_impl(const std::string &variable_name, const std::string &att_name) const;
+
+private:
+  server::Message command(server::Command type) const;
+
+  const server::Variable &variable(const std::string &name) const;
+
+  server::Attribute &attribute(const std::string &variable_name,
+                               const std::string &att_name) const;
+
+  server::Message check_status() const;
+
+  std::shared_ptr<const IOServer> m_server;
+  int m_id;
+  io::Backend m_backend;
+  //! a copy of the fill mode set on the server
+  mutable int m_fill_mode;
+
+  mutable server::Metadata m_metadata;
+};
+
+} // end of namespace io
+} // end of namespace pism
+
+#endif /* PISM_NC_REMOTE_H */
@@ -27,6 +27,7 @@
 #endif
 #include <netcdf.h>
 
+#include <algorithm>            // std::copy, std::min, std::max
 #include <cstdio>               // stderr, fprintf
 
 #include "pism/util/pism_utilities.hh" // join
@@ -53,7 +54,7 @@ static void check_and_abort(MPI_Comm com, const ErrorLocation &where, int return
 }
 
 NC_Serial::NC_Serial(MPI_Comm c)
-  : NCFile(c), m_rank(0) {
+  : NCFile(c), m_rank(0), m_n_aggregators(0), m_group_com(MPI_COMM_NULL) {
   MPI_Comm_rank(m_com, &m_rank);
 }
 
@@ -66,6 +67,14 @@ NC_Serial::~NC_Serial() {
     }
     m_file_id = -1;
   }
+
+  if (m_group_com != MPI_COMM_NULL) {
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if (not finalized) {
+      MPI_Comm_free(&m_group_com);
+    }
+  }
 }
 
 void NC_Serial::set_compression_level_impl(int level) const {
@@ -73,6 +82,34 @@ void NC_Serial::set_compression_level_impl(int level) const {
   // NetCDF-3 does not support compression.
 }
 
+/*!
+ * Split the communicator into `count` groups of consecutive ranks. Each group sends its
+ * data to the first rank in the group (the "aggregator").
+ *
+ * Set `count` to zero to disable aggregation.
+ */
+void NC_Serial::set_aggregator_count_impl(int count) const {
+  int com_size = 1;
+  MPI_Comm_size(m_com, &com_size);
+
+  count = std::min(std::max(count, 0), com_size);
+
+  if (count == m_n_aggregators) {
+    return;
+  }
+
+  if (m_group_com != MPI_COMM_NULL) {
+    MPI_Comm_free(&m_group_com);
+  }
+
+  m_n_aggregators = count;
+
+  if (m_n_aggregators > 0) {
+    int group_size = (com_size + m_n_aggregators - 1) / m_n_aggregators;
+    MPI_Comm_split(m_com, m_rank / group_size, m_rank, &m_group_com);
+  }
+}
+
 // open/create/close
 void NC_Serial::open_impl(const std::string &fname, io::Mode mode) {
   int stat = NC_NOERR;
@@ -369,6 +406,11 @@ void NC_Serial::put_vara_double_impl(const std::string &variable_name,
                                      const std::vector<unsigned int> &start_input,
                                      const std::vector<unsigned int> &count_input,
                                      const double *op) const {
+  if (m_n_aggregators > 0 and not start_input.empty()) {
+    put_vara_double_aggregated(variable_name, start_input, count_input, op);
+    return;
+  }
+
   // make copies of start and count so that we can use them in MPI_Recv() calls below
   std::vector<unsigned int> start = start_input;
   std::vector<unsigned int> count = count_input;
@@ -440,6 +482,272 @@ void NC_Serial::put_vara_double_impl(const std::string &variable_name,
   }
 }
 
+/*!
+ * Compute the bounding box of `n_blocks` blocks described by `slabs` (start and count of
+ * each block, `2 * ndims` numbers per block).
+ *
+ * Returns true if non-empty blocks tile the bounding box, i.e. if they can be written
+ * using one nc_put_vara_double() call.
+ *
+ * Non-empty blocks tile the box if and only if they don't overlap and their total size is
+ * equal to the volume of the box. Blocks written by PISM usually either don't overlap
+ * (parts of a distributed array) or are identical (variables written by all ranks);
+ * overlapping blocks are not aggregated.
+ */
+static bool bounding_box(int ndims, int n_blocks, const unsigned int *slabs,
+                         std::vector<unsigned int> &box_start,
+                         std::vector<unsigned int> &box_count) {
+  std::vector<unsigned int> box_end(ndims, 0);
+  box_start.resize(ndims);
+  box_count.resize(ndims);
+
+  // indexes of non-empty blocks
+  std::vector<int> non_empty;
+
+  size_t total_size = 0;
+  bool empty = true;
+  for (int r = 0; r < n_blocks; ++r) {
+    const unsigned int *start = slabs + 2 * ndims * r;
+    const unsigned int *count = start + ndims;
+
+    size_t block_size = 1;
+    for (int k = 0; k < ndims; ++k) {
+      block_size *= count[k];
+    }
+
+    if (block_size == 0) {
+      continue;
+    }
+
+    for (int k = 0; k < ndims; ++k) {
+      box_start[k] = empty ? start[k] : std::min(box_start[k], start[k]);
+      box_end[k]   = empty ? start[k] + count[k] : std::max(box_end[k], start[k] + count[k]);
+    }
+    total_size += block_size;
+    empty = false;
+    non_empty.push_back(r);
+  }
+
+  if (empty) {
+    return false;
+  }
+
+  size_t box_size = 1;
+  for (int k = 0; k < ndims; ++k) {
+    box_count[k] = box_end[k] - box_start[k];
+    box_size *= box_count[k];
+  }
+
+  if (total_size != box_size) {
+    return false;
+  }
+
+  // check that non-empty blocks don't overlap
+  for (size_t a = 0; a < non_empty.size(); ++a) {
+    const unsigned int *start_r = slabs + 2 * ndims * non_empty[a];
+    const unsigned int *count_r = start_r + ndims;
+
+    for (size_t b = a + 1; b < non_empty.size(); ++b) {
+      const unsigned int *start_s = slabs + 2 * ndims * non_empty[b];
+      const unsigned int *count_s = start_s + ndims;
+
+      // two blocks overlap if their projections onto each axis overlap
+      bool overlap = true;
+      for (int k = 0; k < ndims; ++k) {
+        if (start_r[k] >= start_s[k] + count_s[k] or start_s[k] >= start_r[k] + count_r[k]) {
+          overlap = false;
+          break;
+        }
+      }
+
+      if (overlap) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+/*!
+ * Copy a non-empty block with the corner `start` and size `count` into the box with the
+ * corner `box_start` and size `box_count`. Both use the C (row-major) storage order.
+ */
+static void copy_block(const unsigned int *start, const unsigned int *count,
+                       const std::vector<unsigned int> &box_start,
+                       const std::vector<unsigned int> &box_count,
+                       const double *input, double *output) {
+  int ndims = static_cast<int>(box_count.size());
+
+  // the last dimension is contiguous in both the block and the box
+  size_t run_length = count[ndims - 1], n_runs = 1;
+  for (int k = 0; k < ndims - 1; ++k) {
+    n_runs *= count[k];
+  }
+
+  // multi-index of the first element of a run (relative to the block)
+  std::vector<unsigned int> index(ndims, 0);
+  for (size_t n = 0; n < n_runs; ++n) {
+    size_t offset = 0;
+    for (int k = 0; k < ndims; ++k) {
+      offset = offset * box_count[k] + (start[k] + index[k] - box_start[k]);
+    }
+
+    std::copy(input + n * run_length, input + (n + 1) * run_length, output + offset);
+
+    for (int k = ndims - 2; k >= 0; --k) {
+      if (++index[k] < count[k]) {
+        break;
+      }
+      index[k] = 0;
+    }
+  }
+}
+
+/*!
+ * Write data using a two-phase aggregated scheme.
+ *
+ * 1. Each group of ranks (see set_aggregator_count_impl()) sends its blocks to the
+ *    aggregator using one MPI_Gatherv() call. If the blocks tile a hyperslab (e.g. a
+ *    stripe of rows of a distributed array) the aggregator assembles them into one
+ *    contiguous buffer.
+ *
+ * 2. Aggregators send assembled hyperslabs to rank 0, which writes each using one
+ *    nc_put_vara_double() call.
+ *
+ * The number of NetCDF calls on rank 0 is equal to the number of aggregators instead of
+ * the number of ranks. With one aggregator rank 0 writes a whole record at once.
+ *
+ * Note that PETSc numbers ranks in the X direction first, so groups form stripes of rows
+ * if the number of aggregators divides the number of ranks in the Y direction.
+ */
+void NC_Serial::put_vara_double_aggregated(const std::string &variable_name,
+                                           const std::vector<unsigned int> &start,
+                                           const std::vector<unsigned int> &count,
+                                           const double *op) const {
+  const int header_tag = 5, data_tag = 6;
+  int stat = NC_NOERR, com_size = 1, group_rank = 0, group_size = 1,
+      ndims = static_cast<int>(start.size());
+  MPI_Status mpi_stat;
+
+  MPI_Comm_size(m_com, &com_size);
+  MPI_Comm_rank(m_group_com, &group_rank);
+  MPI_Comm_size(m_group_com, &group_size);
+
+  int local_chunk_size = 1;
+  std::vector<unsigned int> local_slab(2 * ndims);
+  for (int k = 0; k < ndims; ++k) {
+    local_slab[k]         = start[k];
+    local_slab[ndims + k] = count[k];
+    local_chunk_size *= count[k];
+  }
+
+  // Phase 1: gather blocks on the aggregator
+  std::vector<unsigned int> slabs;
+  std::vector<int> chunk_sizes, displacements;
+  std::vector<double> blocks;
+  if (group_rank == 0) {
+    slabs.resize(2 * ndims * group_size);
+    chunk_sizes.resize(group_size);
+    displacements.resize(group_size);
+  }
+
+  MPI_Gather(local_slab.data(), 2 * ndims, MPI_UNSIGNED,
+             slabs.data(), 2 * ndims, MPI_UNSIGNED, 0, m_group_com);
+
+  if (group_rank == 0) {
+    int total_size = 0;
+    for (int r = 0; r < group_size; ++r) {
+      int chunk_size = 1;
+      for (int k = 0; k < ndims; ++k) {
+        chunk_size *= slabs[2 * ndims * r + ndims + k];
+      }
+      chunk_sizes[r]   = chunk_size;
+      displacements[r] = total_size;
+      total_size += chunk_size;
+    }
+    blocks.resize(total_size);
+  }
+
+  MPI_Gatherv(const_cast<double *>(op), local_chunk_size, MPI_DOUBLE, blocks.data(),
+              chunk_sizes.data(), displacements.data(), MPI_DOUBLE, 0, m_group_com);
+
+  if (group_rank != 0) {
+    return;
+  }
+
+  std::vector<unsigned int> box_start, box_count;
+  if (bounding_box(ndims, group_size, slabs.data(), box_start, box_count)) {
+    std::vector<double> box(blocks.size());
+
+    for (int r = 0; r < group_size; ++r) {
+      if (chunk_sizes[r] > 0) {
+        const unsigned int *block_start = &slabs[2 * ndims * r];
+        copy_block(block_start, block_start + ndims, box_start, box_count,
+                   &blocks[displacements[r]], box.data());
+      }
+    }
+
+    slabs = box_start;
+    slabs.insert(slabs.end(), box_count.begin(), box_count.end());
+    blocks.swap(box);
+  }
+
+  // Phase 2: send hyperslabs to rank 0
+  if (m_rank != 0) {
+    MPI_Send(slabs.data(), (int)slabs.size(), MPI_UNSIGNED, 0, header_tag, m_com);
+    MPI_Send(blocks.data(), (int)blocks.size(), MPI_DOUBLE, 0, data_tag, m_com);
+    return;
+  }
+
+  int varid = 0;
+  stat = nc_inq_varid(m_file_id, variable_name.c_str(), &varid);
+  check_and_abort(m_com, PISM_ERROR_LOCATION, stat);
+
+  std::vector<size_t> nc_start(ndims), nc_count(ndims);
+  int group_stride = (com_size + m_n_aggregators - 1) / m_n_aggregators;
+  for (int aggregator = 0; aggregator < com_size; aggregator += group_stride) {
+
+    if (aggregator != 0) {
+      int header_size = 0;
+      MPI_Probe(aggregator, header_tag, m_com, &mpi_stat);
+      MPI_Get_count(&mpi_stat, MPI_UNSIGNED, &header_size);
+
+      slabs.resize(header_size);
+      MPI_Recv(slabs.data(), header_size, MPI_UNSIGNED, aggregator, header_tag, m_com,
+               &mpi_stat);
+
+      int data_size = 0;
+      MPI_Probe(aggregator, data_tag, m_com, &mpi_stat);
+      MPI_Get_count(&mpi_stat, MPI_DOUBLE, &data_size);
+
+      blocks.resize(data_size);
+      MPI_Recv(blocks.data(), data_size, MPI_DOUBLE, aggregator, data_tag, m_com, &mpi_stat);
+    }
+
+    size_t offset = 0;
+    int n_slabs = static_cast<int>(slabs.size()) / (2 * ndims);
+    for (int s = 0; s < n_slabs; ++s) {
+      size_t slab_size = 1;
+      for (int k = 0; k < ndims; ++k) {
+        nc_start[k] = slabs[2 * ndims * s + k];
+        nc_count[k] = slabs[2 * ndims * s + ndims + k];
+        slab_size *= nc_count[k];
+      }
+
+      if (slab_size == 0) {
+        continue;
+      }
+
+      stat = nc_put_vara_double(m_file_id, varid, nc_start.data(), nc_count.data(),
+                                &blocks[offset]);
+      check(PISM_ERROR_LOCATION, stat);
+
+      offset += slab_size;
+    }
+  }
+}
+
 //! \brief Get the number of variables.
 void NC_Serial::inq_nvars_impl(int &result) const {
   int stat = NC_NOERR;
@@ -82,6 +82,8 @@ protected:
 
   virtual void set_compression_level_impl(int level) const;
 
+  void set_aggregator_count_impl(int count) const;
+
   // att
   void get_att_double_impl(const std::string &variable_name, const std::string &att_name, std::vector<double> &result) const;
 
@@ -107,6 +109,16 @@ protected:
 private:
   void get_var_double(const std::string &variable_name, const std::vector<unsigned int> &start,
                       const std::vector<unsigned int> &count, double *ip) const;
+
+  void put_vara_double_aggregated(const std::string &variable_name,
+                                  const std::vector<unsigned int> &start,
+                                  const std::vector<unsigned int> &count,
+                                  const double *op) const;
+
+  //! number of ranks aggregating data in put_vara_double() (0 disables aggregation)
+  mutable int m_n_aggregators;
+  //! communicator connecting ranks that send data to the same aggregator
+  mutable MPI_Comm m_group_com;
 };
 
 } // end of namespace io
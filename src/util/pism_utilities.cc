@@ -48,6 +48,10 @@
 #include <jansson.h>            // JANSSON_VERSION
 #endif
 
+#if (Pism_USE_OPENMP==1)
+#include <omp.h>                // omp_get_max_threads(), omp_get_thread_num()
+#endif
+
 #include <petsctime.h>          // PetscTime
 
 #include <cstdlib>              // strtol(), strtod()
@@ -222,6 +226,23 @@ double GlobalSum(MPI_Comm comm, double local) {
   return result;
 }
 
+int thread_count(int requested) {
+#if (Pism_USE_OPENMP==1)
+  return std::max(requested, 1);
+#else
+  (void) requested;
+  return 1;
+#endif
+}
+
+int thread_index() {
+#if (Pism_USE_OPENMP==1)
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+}
+
 static const int TEMPORARY_STRING_LENGTH = 32768;
 
 std::string version() {
@@ -261,6 +282,10 @@ std::string version() {
   result += pism::printf("Jansson %s.\n", JANSSON_VERSION);
 #endif
 
+#if (Pism_USE_OPENMP==1)
+  result += pism::printf("OpenMP %d (up to %d threads).\n", _OPENMP, omp_get_max_threads());
+#endif
+
 #if (Pism_BUILD_PYTHON_BINDINGS==1)
   result += pism::printf("SWIG %s.\n", pism::swig_version);
   result += pism::printf("petsc4py %s.\n", pism::petsc4py_version);
@@ -134,6 +134,19 @@ unsigned int GlobalSum(MPI_Comm comm, unsigned int input);
 
 int GlobalSum(MPI_Comm comm, int input);
 
+// threads
+
+/*!
+ * Returns the number of OpenMP threads to use if `requested` threads were requested (always
+ * 1 if PISM was built without OpenMP).
+ */
+int thread_count(int requested);
+
+/*!
+ * Returns the index of the calling OpenMP thread (always 0 if PISM was built without OpenMP).
+ */
+int thread_index();
+
 std::string version();
 
 //! return NetCDF version as an integer
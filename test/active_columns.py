@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+"""Tests of computations using lists of active columns maintained by Geometry: results
+have to match the ones computed by sweeping the whole grid.
+"""
+
+import PISM
+import numpy as np
+
+ctx = PISM.Context()
+config = ctx.config
+
+def create_grid(Mx=21, My=21, Mz=21):
+    P = PISM.GridParameters(config, Mx, My, 100e3, 100e3)
+    P.z = PISM.DoubleVector(np.linspace(0, 2000, Mz))
+    P.registration = PISM.CELL_CORNER
+    P.ownership_ranges_from_options(config, ctx.size)
+
+    return PISM.Grid(ctx.ctx, P)
+
+def create_geometry(grid):
+    "An ice cap surrounded by ice-free land."
+    geometry = PISM.Geometry(grid)
+
+    geometry.bed_elevation.set(100.0)
+    geometry.sea_level_elevation.set(0.0)
+    geometry.ice_area_specific_volume.set(0.0)
+
+    R = 50e3
+    with PISM.vec.Access(nocomm=geometry.ice_thickness):
+        for (i, j) in grid.points():
+            r = np.hypot(grid.x(i), grid.y(j))
+            geometry.ice_thickness[i, j] = max(1500.0 * (1.0 - (r / R)**2), 0.0)
+    geometry.ice_thickness.update_ghosts()
+
+    geometry.ensure_consistency(0.0)
+
+    return geometry
+
+def mark_all_active(geometry):
+    "Mark all columns as active, so that the code using active columns sweeps the whole grid."
+    grid = geometry.ice_thickness.grid()
+
+    H = PISM.Scalar1(grid, "H")
+    H.set(1.0)
+
+    geometry.active_columns.update(H)
+
+def sia_model(grid, geometry, sliding_speed):
+    "Create the SIA model and update it."
+    sia = PISM.SIAFD(grid)
+    sia.init()
+
+    enthalpy = PISM.Array3D(grid, "enthalpy", PISM.WITHOUT_GHOSTS, grid.z())
+    enthalpy.set(1e5)
+
+    inputs = PISM.StressBalanceInputs()
+    inputs.geometry = geometry
+    inputs.enthalpy = enthalpy
+
+    sliding_velocity = PISM.Vector1(grid, "sliding_velocity")
+    sliding_velocity.set(sliding_speed)
+
+    sia.update(sliding_velocity, inputs, True)
+
+    return sia
+
+def sia_velocity(grid, geometry):
+    "Compute the SIA velocity, returning local parts of its components."
+    # non-zero sliding velocity to check values in ice-free columns
+    sia = sia_model(grid, geometry, 1e-6)
+
+    return sia.velocity_u().local_part().copy(), sia.velocity_v().local_part().copy()
+
+def test_active_columns():
+    "Lists of active and inactive columns"
+    grid = create_grid()
+    geometry = create_geometry(grid)
+
+    H = geometry.ice_thickness
+
+    n_active = 0
+    with PISM.vec.Access(nocomm=H):
+        for (i, j) in grid.points():
+            if max(H[i, j], H[i + 1, j], H[i - 1, j], H[i, j + 1], H[i, j - 1]) > 0.0:
+                n_active += 1
+
+    assert geometry.active_columns.n_active() == n_active
+
+def test_sia():
+    "SIA velocity computed in active columns only"
+    config.set_string("stress_balance.sia.flow_law", "isothermal_glen")
+
+    grid = create_grid()
+    geometry = create_geometry(grid)
+
+    u, v = sia_velocity(grid, geometry)
+
+    mark_all_active(geometry)
+    u_full, v_full = sia_velocity(grid, geometry)
+
+    np.testing.assert_array_equal(u, u_full)
+    np.testing.assert_array_equal(v, v_full)
+
+    # check that the velocity is not trivial
+    assert np.max(np.abs(u - 1e-6)) > 0.0
+
+def isochrones(grid, geometry, u, v):
+    "Run the isochrone tracing model for one time step."
+    time = ctx.ctx.time()
+
+    config.set_number("isochrones.bootstrapping.n_layers", 2)
+    config.set_string("isochrones.deposition_times",
+                      ",".join([time.date(time.start()), time.date(time.end())]))
+
+    model = PISM.Isochrones(grid, None)
+    model.bootstrap(geometry.ice_thickness)
+
+    smb = PISM.Scalar(grid, "smb")
+    smb.set(0.5)
+
+    bmb = PISM.Scalar(grid, "bmb")
+    bmb.set(-0.1)
+
+    model.update(time.start(), PISM.util.convert(10, "years", "seconds"),
+                 u, v, geometry, smb, bmb)
+
+    return model.layer_thicknesses().local_part().copy()
+
+def test_isochrones():
+    "Isochrone tracing in active columns only"
+    config.set_string("stress_balance.sia.flow_law", "isothermal_glen")
+
+    grid = create_grid()
+    geometry = create_geometry(grid)
+
+    sia = sia_model(grid, geometry, 0.0)
+    u, v = sia.velocity_u(), sia.velocity_v()
+
+    d = isochrones(grid, geometry, u, v)
+
+    mark_all_active(geometry)
+    d_full = isochrones(grid, geometry, u, v)
+
+    np.testing.assert_array_equal(d, d_full)
@@ -148,6 +148,45 @@ def errors(plot_results=True, T_final_years=1000.0, dt_years=100, Mz=101):
 
     return max_error, avg_error
 
+def test_batch():
+    "Compare solutions computed in batches to column-by-column ones"
+    np.random.seed(1)
+
+    Mz = 11
+    dz = 10.0
+    dt = convert(100, "years", "seconds")
+
+    column = PISM.BedrockColumn("btu", ctx.config, dz, Mz)
+
+    width = PISM.TridiagonalBatch.width
+
+    for n_columns in [1, width // 2 + 1, width]:
+        Q_bottom = np.random.uniform(0.02, 0.1, n_columns)
+        T_top = np.random.uniform(240, 270, n_columns)
+        T = np.random.uniform(240, 270, (n_columns, Mz))
+
+        T_batch = np.array(column.solve_batch(dt, Q_bottom, T_top, T.flatten()))
+
+        for n in range(n_columns):
+            x = column.solve(dt, Q_bottom[n], T_top[n], T[n])
+
+            np.testing.assert_allclose(T_batch[n * Mz:(n + 1) * Mz], x, rtol=1e-12)
+
+            # compare to the solution of the same system assembled explicitly
+            R = alpha2 * dt / dz**2
+            G = -Q_bottom[n] / k
+
+            system = PISM.TridiagonalSystem(Mz, "btu")
+            system.set_row(0, 0.0, 1.0 + 2.0 * R, -2.0 * R, T[n][0] - 2.0 * G * dz * R)
+            for j in range(1, Mz - 1):
+                system.set_row(j, -R, 1.0 + 2.0 * R, -R, T[n][j])
+            system.set_row(Mz - 1, 0.0, 1.0, 0.0, T_top[n])
+
+            y = PISM.DoubleVector()
+            system.solve(Mz, y)
+
+            np.testing.assert_allclose(list(y)[:Mz], x, rtol=1e-12)
+
 def test(plot=False):
     assert convergence_rate_time(errors, plot)[1] > 0.94
     assert convergence_rate_space(errors, plot)[1] > 1.89
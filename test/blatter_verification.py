@@ -41,6 +41,45 @@ def expt(ns, errors):
     "Compute the convergence rate using a polynomial fit."
     return -np.polyfit(np.log(ns), np.log(errors), 1)[0]
 
+def check_matrix_free_jacobian(model):
+    """Check that the matrix-free Jacobian (on the finest multigrid level) and the assembled
+    one give the same products and diagonals (up to round-off), evaluated at the current
+    solution.
+
+    Includes rows corresponding to Dirichlet nodes and nodes outside the domain (if any).
+    """
+    snes = model.snes()
+
+    J_mf = snes.getJacobian()[0]
+    assert J_mf.getName() == "bp_jacobian_mf"
+
+    x = snes.getSolution().copy()
+
+    J = snes.getDM().createMatrix()
+    snes.computeJacobian(x, J, J)
+    snes.computeJacobian(x, J_mf, J_mf)
+
+    def check(a, b):
+        diff = a.copy()
+        diff.axpy(-1.0, b)
+        assert diff.norm(PISM.PETSc.NormType.NORM_INFINITY) <= 1e-10 * b.norm(PISM.PETSc.NormType.NORM_INFINITY)
+
+    # products
+    v = x.duplicate()
+    v.setRandom()
+    y, y_mf = x.duplicate(), x.duplicate()
+    J.mult(v, y)
+    J_mf.mult(v, y_mf)
+    check(y_mf, y)
+
+    # diagonals
+    d, d_mf = x.duplicate(), x.duplicate()
+    J.getDiagonal(d)
+    J_mf.getDiagonal(d_mf)
+    check(d_mf, d)
+
+    return d.getArray()
+
 class TestXY(TestCase):
     """2D (x-y) verification test using a manufactured solution.
 
@@ -358,8 +397,8 @@ class TestXZ(TestCase):
 
         return exact
 
-    def error_norm(self, N, n_mg):
-        "Return the infinity norm of errors for the u component."
+    def solve(self, N, n_mg):
+        "Solve the problem using N grid points and n_mg multigrid levels"
         geometry, enthalpy, yield_stress = self.inputs(N)
 
         # set the number of multigrid levels
@@ -383,6 +422,14 @@ class TestXZ(TestCase):
         # run the solver
         model.update(inputs, True)
 
+        return model, geometry
+
+    def error_norm(self, N, n_mg):
+        "Return the infinity norm of errors for the u component."
+        model, geometry = self.solve(N, n_mg)
+
+        grid = model.velocity_u_sigma().grid()
+
         u_model_z = model.velocity_u_sigma().levels()
 
         u_model = PISM.Array3D(grid, "u_model", PISM.WITHOUT_GHOSTS, u_model_z)
@@ -417,6 +464,32 @@ class TestXZ(TestCase):
         # The convergence rate should be close to quadratic.
         assert expt_u >= 2.0
 
+    def test_matrix_free(self):
+        "Test that the matrix-free Jacobian gives the same solution"
+
+        N, n_mg = 21, 2
+
+        error_assembled = self.error_norm(N, n_mg)
+
+        config.set_flag("stress_balance.blatter.matrix_free", True)
+        error_matrix_free = self.error_norm(N, n_mg)
+
+        print("errors: assembled: {}, matrix-free: {}".format(error_assembled, error_matrix_free))
+
+        np.testing.assert_allclose(error_matrix_free, error_assembled, rtol=1e-3)
+
+    def test_matrix_free_jacobian(self):
+        "Test that the matrix-free Jacobian is the same as the assembled one"
+
+        config.set_flag("stress_balance.blatter.matrix_free", True)
+        model, _ = self.solve(21, 2)
+
+        diagonal = check_matrix_free_jacobian(model)
+
+        # rows corresponding to Dirichlet nodes (x = -Lx and x = Lx) are scaled rows of
+        # the identity matrix
+        assert np.any(diagonal == 1.0)
+
     def plot(self):
         Ns = [11, 21, 49, 129]
         mg_levels = [1, 2, 3, 4]
@@ -948,6 +1021,179 @@ class TestXZHalfar(TestCase):
         f.line(Mzs, fit, legend_label=f"O(Mz^{p[0]:1.2f})")
         show(f)
 
+def ice_cap_grid(Mx=21):
+    "Create the grid used by flow line ice cap tests"
+    Lx = 50e3
+
+    # compute dx and set Ly so that dy == dx
+    dx = (2 * Lx) / (Mx - 1)
+
+    P = PISM.GridParameters(config, int(Mx), 3, Lx, dx)
+    P.periodicity = PISM.Y_PERIODIC
+    P.x0 = Lx
+    P.y0 = 0
+    P.registration = PISM.CELL_CORNER
+    P.z = PISM.DoubleVector([0, 1000])
+    P.ownership_ranges_from_options(ctx.config, ctx.com.size)
+
+    return PISM.Grid(ctx.ctx, P)
+
+def ice_cap_inputs(grid):
+    """Allocate and initialize inputs of the flow line ice cap test (an ice cap on a flat
+    bed with basal sliding)."""
+    tauc = PISM.Scalar(grid, "tauc")
+    tauc.set(1e10)
+
+    enthalpy = PISM.Array3D(grid, "enthalpy", PISM.WITHOUT_GHOSTS, grid.z())
+    enthalpy.set(0.0)
+
+    geometry = PISM.Geometry(grid)
+    geometry.bed_elevation.set(0.0)
+    geometry.sea_level_elevation.set(-100.0)
+
+    set_ice_cap_thickness(geometry, 1000.0)
+
+    inputs = PISM.StressBalanceInputs()
+    inputs.geometry = geometry
+    inputs.basal_yield_stress = tauc
+    inputs.enthalpy = enthalpy
+
+    return inputs, (geometry, enthalpy, tauc)
+
+def set_ice_cap_thickness(geometry, H_max):
+    "Set ice thickness of the ice cap (ice-free near the edges of the domain)"
+    grid = geometry.ice_thickness.grid()
+
+    x_c = grid.x0()
+    R = 40e3
+
+    with PISM.vec.Access(geometry.ice_thickness):
+        for (i, j) in grid.points():
+            r = min(abs(grid.x(i) - x_c) / R, 1.0)
+            geometry.ice_thickness[i, j] = H_max * (1.0 - r**(4.0 / 3.0))**(3.0 / 7.0)
+    geometry.ensure_consistency(0.0)
+
+def set_ice_cap_sliding_law():
+    "Set sliding law parameters to make 'tauc' equivalent to 'beta'"
+    config.set_flag("basal_resistance.pseudo_plastic.enabled", True)
+    config.set_number("basal_resistance.pseudo_plastic.q", 1.0)
+    config.set_number("basal_resistance.pseudo_plastic.u_threshold",
+                      PISM.util.convert(1.0, "m / s", "m / year"))
+
+class TestMatrixFreeIceCap(TestCase):
+    """Compare the matrix-free Jacobian to the assembled one using an ice cap with ice-free
+    areas near the edges of the domain (i.e. with nodes outside the domain) and basal
+    sliding.
+    """
+    def setUp(self):
+        self.opt = PISM.PETSc.Options()
+
+        self.opts = {"-bp_pc_type": "mg",
+                     "-bp_pc_mg_levels": "2"}
+
+        for k, v in self.opts.items():
+            self.opt.setValue(k, v)
+
+        set_ice_cap_sliding_law()
+        config.set_flag("stress_balance.blatter.matrix_free", True)
+
+    def tearDown(self):
+        for k in self.opts.keys():
+            self.opt.delValue(k)
+        config.import_from(config_clean)
+
+    def test(self):
+        "Test that the matrix-free Jacobian is the same as the assembled one"
+        grid = ice_cap_grid()
+
+        # note: `fields` keeps arrays used by `inputs` alive
+        inputs, fields = ice_cap_inputs(grid)
+
+        Mz = 9
+        coarsening_factor = 2
+        model = PISM.Blatter(grid, Mz, coarsening_factor)
+        model.init()
+
+        model.update(inputs, True)
+
+        diagonal = check_matrix_free_jacobian(model)
+
+        # rows corresponding to nodes outside the domain are rows of the identity matrix
+        assert np.any(diagonal == 1.0)
+
+class TestExtrapolation(TestCase):
+    """Several time steps of a flow line case (an ice cap on a flat bed with basal
+    sliding) that changes in time.
+
+    Runs that extrapolate the initial guess in time and lag the Jacobian and the
+    preconditioner have to converge to the same solutions as the run that does not.
+    """
+    def setUp(self):
+        self.opt = PISM.PETSc.Options()
+
+        self.opts = {"-bp_ksp_type": "preonly",
+                     "-bp_pc_type": "lu"}
+
+        for k, v in self.opts.items():
+            self.opt.setValue(k, v)
+
+        set_ice_cap_sliding_law()
+
+        self.t0 = ctx.time.current()
+
+    def tearDown(self):
+        for k in self.opts.keys():
+            self.opt.delValue(k)
+        config.import_from(config_clean)
+        ctx.time.set(self.t0)
+
+    def solve(self, n_steps=3):
+        """Run `n_steps` time steps, changing ice thickness between them. Returns the list
+        of velocities (one per time step)."""
+        grid = ice_cap_grid()
+
+        inputs, (geometry, _, _) = ice_cap_inputs(grid)
+
+        Mz = 5
+        coarsening_factor = 1
+        model = PISM.Blatter(grid, Mz, coarsening_factor)
+        model.init()
+
+        dt = PISM.util.convert(1.0, "year", "second")
+
+        result = []
+        for step in range(n_steps):
+            ctx.time.set(self.t0 + step * dt)
+
+            set_ice_cap_thickness(geometry, 1000.0 * (1.0 + 0.1 * step))
+
+            model.update(inputs, True)
+
+            result.append(model.velocity_u_sigma().to_numpy().copy())
+
+        return result
+
+    def check(self, lags):
+        "Compare to the run without extrapolation and lagging"
+        u_ref = self.solve()
+
+        config.set_flag("stress_balance.blatter.extrapolate_initial_guess", True)
+        config.set_number("stress_balance.blatter.lag_jacobian", lags)
+        config.set_number("stress_balance.blatter.lag_preconditioner", lags)
+        u = self.solve()
+
+        for u_k, u_ref_k in zip(u, u_ref):
+            np.testing.assert_allclose(u_k, u_ref_k, rtol=0,
+                                       atol=1e-5 * np.max(np.fabs(u_ref_k)))
+
+    def test_extrapolation(self):
+        "Extrapolating the initial guess in time does not change the solution"
+        self.check(lags=1)
+
+    def test_extrapolation_lagging(self):
+        "Lagging the Jacobian and the preconditioner does not change the solution"
+        self.check(lags=2)
+
 if __name__ == "__main__":
 
     for test in [TestXY(),
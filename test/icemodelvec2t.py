@@ -343,6 +343,28 @@ class ForcingInput(unittest.TestCase):
         # fourth month
         check(3)
 
+    def test_prefetch(self):
+        "update() calls reading records ahead of time"
+        ctx.config.set_number("input.forcing.prefetch", 1)
+        try:
+            forcing = self.forcing(self.filename, buffer_size=3)
+        finally:
+            ctx.config.set_number("input.forcing.prefetch", 0)
+
+        # short time steps: some update() calls don't need new records and read the next
+        # record into the second buffer
+        for month in range(12):
+            t = seconds(self.tb[month]) + 1
+            dt = seconds(0.5)
+            forcing.update(t, dt)
+            forcing.interp(t)
+
+            compare(forcing, self.f[month])
+
+            # reading records ahead of time should not change the current value
+            forcing.update(t + 0.5 * dt, 0.5 * dt)
+            compare(forcing, self.f[month])
+
     def test_max_timestep(self):
         "Maximum time step"
         forcing = self.forcing(self.filename, buffer_size=1)
@@ -136,7 +136,7 @@ def run(Mx, My, t_final, part_grid, C=1.0):
         j += 1
     profiling.stage_end("ge")
 
-    profiling.report("profiling_%d_%d.py" % (Mx, My))
+    profiling.report(ctx.com(), "profiling_%d_%d.py" % (Mx, My))
 
     return geometry
 
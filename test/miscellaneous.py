@@ -615,6 +615,7 @@ def check_flow_law(factory, flow_law_name, EC, stored_data):
     Tm = EC.melting_temperature(p)
 
     data = []
+    S_n, E_n, p_n, gs_n = [], [], [], []
     print("  Flow table for %s" % law.name())
     print("| Sigma        | Temperature  | Omega        | Flow factor  |")
     print("|--------------+--------------+--------------+--------------|")
@@ -625,6 +626,11 @@ def check_flow_law(factory, flow_law_name, EC, stored_data):
             F = law.flow(S, E, p, gs)
             data.append(F)
 
+            S_n.append(S)
+            E_n.append(E)
+            p_n.append(p)
+            gs_n.append(gs)
+
             print("| %e | %e | %e | %e |" % (S, T, O, F))
     print("|--------------+--------------+--------------+--------------|")
     print("")
@@ -633,6 +639,10 @@ def check_flow_law(factory, flow_law_name, EC, stored_data):
 
     assert np.max(np.fabs(data - stored_data)) < 1e-16
 
+    # the batched version has to match the one evaluating the flow law at one point
+    data_n = np.array(law.flow_n(S_n, E_n, p_n, gs_n))
+    assert np.max(np.fabs(data_n - data) / data) < 1e-13
+
 
 def flowlaw_test():
     data = {}
@@ -1575,3 +1585,376 @@ def grounding_line_flux_test():
 
     NORM_INFINITY = 3
     np.testing.assert_almost_equal(gl_flux.norm(NORM_INFINITY), 0.0)
+
+def test_weighted_ownership_ranges():
+    "Ownership ranges balancing sums of weights"
+    # uniform weights: same as the uniform split
+    assert list(PISM.weighted_ownership_ranges([1.0] * 10, 2, 2)) == [5, 5]
+
+    # all the work is in the last 4 points
+    weights = [0.0] * 6 + [1.0] * 4
+    assert list(PISM.weighted_ownership_ranges(weights, 2, 2)) == [8, 2]
+
+    # each part gets at least min_width points
+    weights = [0.0] * 8 + [1.0] * 2
+    assert list(PISM.weighted_ownership_ranges(weights, 3, 2)) == [6, 2, 2]
+
+    try:
+        PISM.weighted_ownership_ranges([1.0] * 5, 3, 2)
+        assert False, "failed to catch an error"
+    except RuntimeError:
+        pass
+
+def test_label_components():
+    "Parallel connected component labeling"
+    grid = PISM.Grid.Shallow(PISM.Context().ctx, 1e5, 1e5, 0, 0, 41, 31,
+                             PISM.CELL_CORNER, PISM.NOT_PERIODIC)
+
+    mask = PISM.Scalar1(grid, "mask")
+    serial = PISM.Scalar(grid, "serial")
+
+    reachable = 2
+
+    def fill(array):
+        "Diagonal stripes; foreground cells in the first column are 'reachable'"
+        with PISM.vec.Access(nocomm=array):
+            for (i, j) in grid.points():
+                foreground = ((i + 2 * j) // 3) % 2 == 0
+                if not foreground:
+                    array[i, j] = 0
+                elif i == 0:
+                    array[i, j] = reachable
+                else:
+                    array[i, j] = 1
+
+    fill(mask)
+    PISM.label(mask)
+    fill(serial)
+    PISM.label_serial(serial, False, -1)
+
+    # components are numbered in a different order, but the number of components should
+    # be the same
+    assert PISM.max(mask) == PISM.max(serial)
+
+    fill(mask)
+    PISM.label_isolated(mask, reachable)
+    fill(serial)
+    PISM.label_serial(serial, True, reachable)
+
+    serial.add(-1.0, mask)
+    assert PISM.absmax(serial) == 0.0
+
+def test_split_ghost_update():
+    "Split-phase ghost updates"
+    grid = PISM.Grid.Shallow(PISM.Context().ctx, 1e5, 1e5, 0, 0, 21, 11,
+                             PISM.CELL_CORNER, PISM.NOT_PERIODIC)
+
+    a = PISM.Scalar1(grid, "a")
+    b = PISM.Scalar1(grid, "b")
+
+    with PISM.vec.Access(nocomm=a):
+        for (i, j) in grid.points():
+            a[i, j] = i + 100 * j
+
+    # copy_from() uses update_ghosts()
+    b.copy_from(a)
+
+    a.update_ghosts_begin()
+    a.update_ghosts_end()
+
+    with PISM.vec.Access(nocomm=[a, b]):
+        for (i, j) in grid.points_with_ghosts(1):
+            assert a[i, j] == b[i, j]
+
+    try:
+        a.update_ghosts_end()
+        assert False, "failed to catch an error"
+    except RuntimeError:
+        pass
+
+def test_points_interior_boundary():
+    "Grid.points_interior() and Grid.points_boundary() split Grid.points()"
+    ctx = PISM.Context().ctx
+
+    def collect(p):
+        result = []
+        while p:
+            result.append((p.i(), p.j()))
+            p.next()
+        return result
+
+    for Mx, My in [(21, 11), (5, 4)]:
+        grid = PISM.Grid.Shallow(ctx, 1e5, 1e5, 0, 0, Mx, My,
+                                 PISM.CELL_CORNER, PISM.NOT_PERIODIC)
+
+        xs, xm, ys, ym = grid.xs(), grid.xm(), grid.ys(), grid.ym()
+
+        points = set(grid.points())
+
+        for w in range(5):
+            interior = collect(grid.points_interior(w))
+            boundary = collect(grid.points_boundary(w))
+
+            # no point is visited twice
+            assert len(set(interior)) == len(interior)
+            assert len(set(boundary)) == len(boundary)
+
+            # the two sets are disjoint and cover all points owned by this rank
+            assert set(interior).isdisjoint(boundary)
+            assert set(interior) | set(boundary) == points
+
+            # a stencil of width w does not use ghosts at interior points
+            for (i, j) in interior:
+                assert xs + w <= i < xs + xm - w
+                assert ys + w <= j < ys + ym - w
+
+            for (i, j) in boundary:
+                assert not (xs + w <= i < xs + xm - w and ys + w <= j < ys + ym - w)
+
+def test_ghost_exchange():
+    "Updating ghosts of a group of arrays"
+    grid = PISM.Grid.Shallow(PISM.Context().ctx, 1e5, 1e5, 0, 0, 21, 11,
+                             PISM.CELL_CORNER, PISM.XY_PERIODIC)
+
+    a = PISM.Scalar1(grid, "a")
+    b = PISM.Scalar2(grid, "b")
+    a_copy = PISM.Scalar1(grid, "a_copy")
+    b_copy = PISM.Scalar2(grid, "b_copy")
+
+    with PISM.vec.Access(nocomm=[a, b]):
+        for (i, j) in grid.points():
+            a[i, j] = i + 100 * j
+            b[i, j] = -(i + 100 * j)
+
+    # copy_from() uses update_ghosts()
+    a_copy.copy_from(a)
+    b_copy.copy_from(b)
+
+    ghosts = PISM.GhostExchange()
+    ghosts.add(a)
+    ghosts.add(b)
+
+    # the second update re-uses the communication plan
+    for _ in range(2):
+        ghosts.update()
+
+        with PISM.vec.Access(nocomm=[a, a_copy]):
+            for (i, j) in grid.points_with_ghosts(1):
+                assert a[i, j] == a_copy[i, j]
+
+        with PISM.vec.Access(nocomm=[b, b_copy]):
+            for (i, j) in grid.points_with_ghosts(2):
+                assert b[i, j] == b_copy[i, j]
+
+    # an update that is started but never finished: the destructor has to cancel pending
+    # requests
+    abandoned = PISM.GhostExchange()
+    abandoned.add(a)
+    abandoned.begin()
+    try:
+        abandoned.begin()
+        assert False, "failed to detect an update that is already in progress"
+    except RuntimeError:
+        pass
+    del abandoned
+
+    # updates that follow are not affected
+    a.set(0.0)
+    with PISM.vec.Access(nocomm=[a]):
+        for (i, j) in grid.points():
+            a[i, j] = i + 100 * j
+    ghosts.update()
+    with PISM.vec.Access(nocomm=[a, a_copy]):
+        for (i, j) in grid.points_with_ghosts(1):
+            assert a[i, j] == a_copy[i, j]
+
+def test_global_reduction():
+    "Computing sums, maxima and minima using one reduction"
+    com = PISM.Context().com
+    rank = com.rank
+    size = com.size
+
+    r = PISM.GlobalReduction(com)
+    a = r.sum(1.0)
+    b = r.max(float(rank))
+    c = r.min(float(rank) + 1.0)
+    d = r.sum([1, 2, 3])
+    r.reduce()
+
+    assert r[a] == size
+    assert r[b] == size - 1
+    assert r[c] == 1.0
+    assert list(r.values(d, 3)) == [size, 2 * size, 3 * size]
+
+    # contributions have to be added before a reduction
+    try:
+        r.sum(1.0)
+        assert False, "failed to catch an error"
+    except RuntimeError:
+        pass
+
+    # re-use the same object (with the non-blocking version)
+    r.reset()
+    e = r.max(-float(rank))
+    r.begin()
+    r.end()
+    assert r[e] == 0.0
+
+def test_profiling():
+    "Profiling: nested events and counters"
+    import csv
+    import time
+
+    ctx = PISM.Context().ctx
+    com = PISM.Context().com
+    size = com.size
+    profiling = ctx.profiling()
+
+    M = 5
+    grid = PISM.Grid.Shallow(ctx, 1e5, 1e5, 0, 0, M, M, PISM.CELL_CORNER, PISM.NOT_PERIODIC)
+
+    v = PISM.Scalar(grid, "v")
+    v.set(1.0)
+
+    output = filename("profiling")
+    summary = filename("profiling-summary") + ".csv"
+    try:
+        profiling.begin("test_profiling")
+        for k in range(2):
+            profiling.begin("inner")
+            time.sleep(0.01)
+            profiling.end("inner")
+
+        profiling.begin("io")
+        f = PISM.util.prepare_output(output)
+        v.write(f)
+        v.read(f, 0)
+        f.close()
+        profiling.end("io")
+        profiling.end("test_profiling")
+
+        profiling.save_summary(ctx.com(), summary)
+
+        with open(summary) as f:
+            rows = {(r["event"], r["quantity"]) : r for r in csv.DictReader(f)}
+    finally:
+        com.barrier()
+        if com.rank == 0:
+            os.remove(output)
+            os.remove(summary)
+
+    def get(event, quantity, stat="avg"):
+        return float(rows[(event, quantity)][stat])
+
+    # nested events are recorded using full names
+    assert get("test_profiling/inner", "calls", "min") == 2
+    assert get("test_profiling/inner", "calls", "max") == 2
+    assert get("test_profiling/inner", "time", "min") >= 0.02
+    assert get("test_profiling", "time", "min") >= get("test_profiling/inner", "time", "max")
+    assert ("inner", "calls") not in rows
+
+    # counters are attributed to the innermost active event
+    n_bytes = 8.0 * M * M
+    assert get("test_profiling/io", "bytes_written") * size == n_bytes
+    assert get("test_profiling/io", "bytes_read") * size == n_bytes
+    assert ("test_profiling", "bytes_written") not in rows
+
+def test_tridiagonal_batch():
+    "Compare TridiagonalBatch to TridiagonalSystem"
+    np.random.seed(1)
+
+    width = PISM.TridiagonalBatch.width
+    max_size = 20
+
+    batch = PISM.TridiagonalBatch(max_size)
+
+    def random_system(size):
+        "Create a random diagonally dominant system."
+        system = PISM.TridiagonalSystem(max_size, "test")
+
+        L = np.random.uniform(-1, 1, size)
+        U = np.random.uniform(-1, 1, size)
+        D = (np.abs(L) + np.abs(U) + np.random.uniform(0.1, 1, size)) * np.random.choice([-1, 1], size)
+        rhs = np.random.uniform(-1, 1, size)
+
+        for k in range(size):
+            system.set_row(k, L[k], D[k], U[k], rhs[k])
+
+        return system
+
+    for size in [1, 2, 3, 11, max_size]:
+        for n_lanes in [1, width // 2 + 1, width]:
+            systems = [random_system(size) for _ in range(n_lanes)]
+
+            for n, system in enumerate(systems):
+                batch.set(n, system, size)
+
+            batch.solve(size, n_lanes)
+            assert batch.zero_pivot_lane() == -1
+
+            for n, system in enumerate(systems):
+                x = PISM.DoubleVector()
+                system.solve(size, x)
+
+                np.testing.assert_allclose([batch.x(k, n) for k in range(size)],
+                                           list(x)[:size], rtol=1e-12)
+
+    # a zero pivot in one of the lanes
+    size = 5
+    systems = [random_system(size) for _ in range(width)]
+    systems[2].set_row(0, 0.0, 0.0, 1.0, 1.0)
+    for n, system in enumerate(systems):
+        batch.set(n, system, size)
+
+    try:
+        batch.solve(size, width)
+        assert False, "failed to detect a zero pivot"
+    except RuntimeError:
+        assert batch.zero_pivot_lane() == 2
+
+def test_eikonal_equation():
+    "Distances computed by eikonal_equation()"
+    Mx, My = 31, 21
+    grid = PISM.Grid.Shallow(PISM.Context().ctx, 1e5, 1e5, 0, 0, Mx, My,
+                             PISM.CELL_CORNER, PISM.NOT_PERIODIC)
+
+    # Walls the "wave" has to go around. They cross sub-domain boundaries when this test
+    # runs on several MPI processes (see test/regression/eikonal_equation.sh), so shortest
+    # paths cross these boundaries several times.
+    def initial(i, j):
+        if i == 0 or i == Mx - 1 or j == 0 or j == My - 1:
+            return -1           # outside the domain
+        if i == 15 and j < 15:
+            return -1           # a vertical wall
+        if j == 10 and 5 <= i <= 27:
+            return -1           # a horizontal wall
+        if i == 1:
+            return 1            # the "wave front"
+        if i == 25 and j == 5:
+            return -1           # an isolated point outside the domain
+        return 0
+
+    # breadth-first search using the same (4-neighbor) connectivity
+    expected = {(i, j) : initial(i, j) for i in range(Mx) for j in range(My)}
+    front = [p for p, v in expected.items() if v == 1]
+    while front:
+        new_front = []
+        for (i, j) in front:
+            for n in [(i + 1, j), (i - 1, j), (i, j + 1), (i, j - 1)]:
+                if expected.get(n, -1) == 0:
+                    expected[n] = expected[(i, j)] + 1
+                    new_front.append(n)
+        front = new_front
+
+    mask = PISM.Scalar1(grid, "mask")
+    with PISM.vec.Access(nocomm=mask):
+        for (i, j) in grid.points():
+            mask[i, j] = initial(i, j)
+    mask.update_ghosts()
+
+    PISM.eikonal_equation(mask)
+
+    with PISM.vec.Access(nocomm=mask):
+        for (i, j) in grid.points_with_ghosts(1):
+            if 0 <= i < Mx and 0 <= j < My:
+                assert mask[i, j] == expected[(i, j)]
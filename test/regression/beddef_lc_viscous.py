@@ -200,6 +200,26 @@ def steady_state_test():
     return np.testing.assert_almost_equal(diff, stored)
 
 
+def fftw_mpi_test():
+    "Distributed (FFTW-MPI) and serial implementations produce the same results"
+    if not PISM.Pism_USE_FFTW_MPI:
+        return
+
+    try:
+        config.set_flag("bed_deformation.lc.fftw_mpi", False)
+        r, z_serial = modeled_time_dependent(disc_radius, disc_thickness, t_final, Lx, 34, dt)
+        _, u_serial = modeled_steady_state(disc_radius, disc_thickness, T, Lx, 21)
+
+        config.set_flag("bed_deformation.lc.fftw_mpi", True)
+        r, z_parallel = modeled_time_dependent(disc_radius, disc_thickness, t_final, Lx, 34, dt)
+        _, u_parallel = modeled_steady_state(disc_radius, disc_thickness, T, Lx, 21)
+    finally:
+        config.set_flag("bed_deformation.lc.fftw_mpi", False)
+
+    np.testing.assert_allclose(z_parallel, z_serial, rtol=1e-10, atol=1e-8)
+    np.testing.assert_allclose(u_parallel, u_serial, rtol=1e-10, atol=1e-8)
+
+
 def verify_steady_state():
     "Set up a grid refinement study and produce convergence plots."
 
@@ -0,0 +1,31 @@
+#!/bin/bash
+
+# Tests eikonal_equation() (PICO distances) using several MPI processes: shortest paths
+# cross sub-domain boundaries.
+
+PISM_PATH=$1
+MPIEXEC=$2
+PISM_SOURCE_DIR=$3
+
+if [ $# -ge 4 ] && [ "$4" == "-python" ]
+then
+  PYTHONEXEC=$5
+  export PYTHONPATH=${PISM_PATH}/site-packages:${PYTHONPATH}
+else
+  exit 1
+fi
+
+# create a temporary directory and set up automatic cleanup
+temp_dir=$(mktemp -d --tmpdir pism-test-XXXX)
+trap 'rm -rf "$temp_dir"' EXIT
+cd $temp_dir
+
+set -e
+set -u
+set -x
+
+for n in 2 3 4;
+do
+  $MPIEXEC -n $n ${PYTHONEXEC} -m nose -v \
+           ${PISM_SOURCE_DIR}/test/miscellaneous.py:test_eikonal_equation
+done
@@ -332,6 +332,60 @@ class File(TestCase):
     def test_write_distributed_array(self):
         raise SkipTest("disable this in Python bindings")
 
+    def test_write_variable_aggregated(self):
+        "File.write_variable() with aggregation"
+        rank = ctx.rank()
+        size = ctx.size()
+        My, Mx = 5, 3
+
+        def expected(j, i):
+            return 10.0 * j + i
+
+        for n_aggregators in [0, 1, 2, size]:
+            f = PISM.File(ctx.com(), self.file_without_time, PISM.PISM_NETCDF3, PISM.PISM_READWRITE)
+            f.set_aggregator_count(n_aggregators)
+
+            # each rank writes a stripe of rows; some ranks may not write anything
+            ys = (My * rank) // size
+            ym = (My * (rank + 1)) // size - ys
+            data = [expected(j, i) for j in range(ys, ys + ym) for i in range(Mx)]
+            f.write_variable("v", [ys, 0], [ym, Mx], data)
+            f.sync()
+
+            result = f.read_variable("v", [0, 0], [My, Mx])
+            assert result == tuple(expected(j, i) for j in range(My) for i in range(Mx))
+
+            # all ranks write the same value (blocks overlap)
+            f.write_variable("v", [1, 1], [1, 1], [100.0])
+            f.sync()
+            assert f.read_variable("v", [1, 1], [1, 1]) == (100.0,)
+
+            f.close()
+
+    def test_background_writer(self):
+        "File(..., BackgroundWriter, ...)"
+        filename = "test_background_writer.nc"
+        writer = PISM.BackgroundWriter(ctx.com())
+
+        try:
+            # the in-memory file is written to disk by the background writer on close()
+            f = PISM.File(ctx.com(), filename, writer, PISM.PISM_READWRITE_CLOBBER)
+            f.define_dimension("x", 3)
+            f.define_variable("v", PISM.PISM_DOUBLE, ["x"])
+            f.write_attribute("v", "units", "m")
+            f.write_variable("v", [0], [3], [1.0, 2.0, 3.0])
+            f.close()
+
+            writer.wait()
+
+            f = PISM.File(ctx.com(), filename, PISM.PISM_NETCDF3, PISM.PISM_READONLY)
+            assert f.read_text_attribute("v", "units") == "m"
+            assert f.read_variable("v", [0], [3]) == (1.0, 2.0, 3.0)
+            f.close()
+        finally:
+            if ctx.rank() == 0:
+                os.remove(filename)
+
     def test_remove_attribute(self):
         "File.remove_attribute()"
         for backend in backends:
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""Writes and reads a file using I/O server ranks (NC_Remote) and compares to the
+NetCDF-3 backend.
+
+Run using at least 2 MPI processes: the last rank is used as an I/O server.
+"""
+
+import PISM
+import numpy as np
+
+ctx = PISM.Context().ctx
+
+Mx, My = 5, 3
+
+def write(f, data):
+    "Write a small file using the File instance `f`."
+    f.define_dimension("x", Mx)
+    f.define_dimension("y", My)
+    f.define_variable("v", PISM.PISM_DOUBLE, ["y", "x"])
+    f.write_attribute("v", "units", "m")
+    f.write_attribute("v", "valid_range", PISM.PISM_DOUBLE, [-1.0, 100.0])
+    f.write_attribute("PISM_GLOBAL", "comment", "I/O server test")
+    f.write_variable("v", [0, 0], [My, Mx], data)
+
+def read(f):
+    "Read everything written by write()."
+    return (f.dimension_length("x"),
+            f.dimension_length("y"),
+            f.read_text_attribute("v", "units"),
+            f.read_double_attribute("v", "valid_range"),
+            f.read_text_attribute("PISM_GLOBAL", "comment"),
+            f.read_variable("v", [0, 0], [My, Mx]))
+
+def compare(a, b):
+    assert a[:5] == b[:5], (a[:5], b[:5])
+    np.testing.assert_array_equal(a[5], b[5])
+
+def test_io_server():
+    server = PISM.IOServer(ctx.com(), 1)
+
+    if server.is_server():
+        server.run()
+        return
+
+    com = server.compute_comm()
+
+    data = [10.0 * j + i for j in range(My) for i in range(Mx)]
+
+    try:
+        # write using the serial backend
+        f = PISM.File(com, "io_server_serial.nc", PISM.PISM_NETCDF3, PISM.PISM_READWRITE_MOVE)
+        write(f, data)
+        expected = read(f)
+        f.close()
+
+        # write using I/O server ranks and read while the file is open (this needs a
+        # round trip)
+        f = PISM.File(com, "io_server_remote.nc", server.create_file(PISM.PISM_NETCDF3),
+                      PISM.PISM_READWRITE_MOVE)
+        write(f, data)
+        compare(read(f), expected)
+        f.close()
+
+        # re-open and read using I/O server ranks
+        f = PISM.File(com, "io_server_remote.nc", server.create_file(PISM.PISM_NETCDF3),
+                      PISM.PISM_READONLY)
+        compare(read(f), expected)
+        f.close()
+    finally:
+        # report errors on server ranks (if any) and let them exit
+        server.shutdown()
+
+    # read the file written by the server using the serial backend
+    f = PISM.File(com, "io_server_remote.nc", PISM.PISM_NETCDF3, PISM.PISM_READONLY)
+    compare(read(f), expected)
+    f.close()
+
+if __name__ == "__main__":
+    test_io_server()
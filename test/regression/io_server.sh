@@ -0,0 +1,27 @@
+#!/bin/bash
+
+# Tests writing and reading files using I/O server ranks (output.extra.io_ranks).
+
+PISM_PATH=$1
+MPIEXEC=$2
+PISM_SOURCE_DIR=$3
+
+if [ $# -ge 4 ] && [ "$4" == "-python" ]
+then
+  PYTHONEXEC=$5
+  export PYTHONPATH=${PISM_PATH}/site-packages:${PYTHONPATH}
+else
+  exit 1
+fi
+
+# create a temporary directory and set up automatic cleanup
+temp_dir=$(mktemp -d --tmpdir pism-test-XXXX)
+trap 'rm -rf "$temp_dir"' EXIT
+cd $temp_dir
+
+set -e
+set -u
+set -x
+
+# one compute rank and one I/O server rank
+$MPIEXEC -n 2 ${PYTHONEXEC} ${PISM_SOURCE_DIR}/test/regression/io_server.py
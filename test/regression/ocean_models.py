@@ -558,6 +558,111 @@ class DeltaSL2D(TestCase):
     def tearDown(self):
         os.remove(self.filename)
 
+class PicoGeometryTest(TestCase):
+    "PicoGeometry re-uses masks if inputs did not change"
+
+    # counter used to create unique profiling event names
+    n_updates = 0
+
+    def setUp(self):
+        ctx = PISM.Context().ctx
+        self.grid = PISM.Grid.Shallow(ctx, 1000e3, 1000e3, 0, 0, 21, 21,
+                                      PISM.CELL_CORNER, PISM.NOT_PERIODIC)
+        grid = self.grid
+
+        # an ice shelf between grounded ice on the left and open ocean on the right
+        self.geometry = PISM.Geometry(grid)
+        geometry = self.geometry
+        geometry.sea_level_elevation.set(0.0)
+        with PISM.vec.Access(nocomm=[geometry.bed_elevation, geometry.ice_thickness]):
+            for (i, j) in grid.points():
+                x = grid.x(i)
+                geometry.bed_elevation[i, j] = 100.0 if x < -500e3 else -1000.0
+                geometry.ice_thickness[i, j] = 500.0 if x < 200e3 else 0.0
+        geometry.ensure_consistency(0.0)
+
+        self.filename = tmp_name("pico_basins")
+        PISM.util.prepare_output(self.filename)
+
+        basins = PISM.Scalar(grid, "basins")
+        basins.set(1.0)
+        basins.write(self.filename)
+
+        config.set_string("ocean.pico.file", self.filename)
+
+    def update(self, pico, bed_elevation):
+        "Update PicoGeometry and return True if all masks were re-computed."
+        profiling = PISM.Context().ctx.profiling()
+
+        PicoGeometryTest.n_updates += 1
+        event = "pico_geometry_update_{}".format(PicoGeometryTest.n_updates)
+
+        profiling.begin(event)
+        try:
+            pico.update(bed_elevation, self.geometry.cell_type)
+        finally:
+            profiling.end(event)
+
+        return "ocean.distances_gl" in profiling.times(event)
+
+    def check(self, pico, bed_elevation):
+        "Compare masks to the ones computed from scratch."
+        fresh = PISM.PicoGeometry(self.grid)
+        fresh.init()
+        fresh.update(bed_elevation, self.geometry.cell_type)
+
+        for name in ["box_mask", "ice_shelf_mask", "ice_rise_mask", "continental_shelf_mask"]:
+            np.testing.assert_array_equal(getattr(pico, name)().local_part(),
+                                          getattr(fresh, name)().local_part())
+
+    def test_pico_geometry(self):
+        "PicoGeometry: skipping and re-computing masks"
+        grid = self.grid
+        geometry = self.geometry
+        bed = PISM.Scalar(grid, "bed")
+        bed.copy_from(geometry.bed_elevation)
+
+        pico = PISM.PicoGeometry(grid)
+        pico.init()
+
+        # the first update re-computes everything
+        assert self.update(pico, bed)
+        self.check(pico, bed)
+
+        # nothing changed
+        assert not self.update(pico, bed)
+        self.check(pico, bed)
+
+        # bed changes that do not change the mask of areas above the continental shelf
+        # depth (-800 m by default) are ignored
+        bed.shift(-100.0)
+        assert not self.update(pico, bed)
+        self.check(pico, bed)
+
+        # a shallow area in the open ocean changes the continental shelf mask only
+        with PISM.vec.Access(nocomm=bed):
+            for (i, j) in grid.points():
+                if grid.x(i) > 600e3:
+                    bed[i, j] = -500.0
+        assert not self.update(pico, bed)
+        self.check(pico, bed)
+
+        # extend the ice shelf
+        with PISM.vec.Access(nocomm=geometry.ice_thickness):
+            for (i, j) in grid.points():
+                if grid.x(i) < 400e3:
+                    geometry.ice_thickness[i, j] = 500.0
+        geometry.ensure_consistency(0.0)
+        assert self.update(pico, bed)
+        self.check(pico, bed)
+
+        # init() ensures that the next update re-computes everything
+        pico.init()
+        assert self.update(pico, bed)
+        self.check(pico, bed)
+
+    def tearDown(self):
+        os.remove(self.filename)
 
 if __name__ == "__main__":
     PISM.Context().log.set_threshold(3)
@@ -0,0 +1,209 @@
+#!/usr/bin/env python3
+"""Tests of the finite difference SSA solver (SSAFD): all solver strategies have to
+converge to the same solution.
+
+Uses Schoof's "ice stream on a plastic bed" (verification test I).
+"""
+
+import re
+import PISM
+import numpy as np
+from unittest import SkipTest
+
+ctx = PISM.Context()
+
+m_schoof = 10                    # (pure number)
+L_schoof = 40e3                  # meters
+H0_schoof = 0.05 * L_schoof      # 2000 m thickness
+B_schoof = 3.7e8                 # Pa s^{1/3}; hardness
+
+def create_context():
+    """Create a context with its own copy of the configuration and a logger that keeps all
+    messages (used to check which code paths were taken).
+    """
+    com = ctx.com
+    system = ctx.unit_system
+
+    log = PISM.StringLogger(com, 3)
+
+    config = PISM.DefaultConfig(com, "pism_config", "-config", system)
+    config.init_with_default(log)
+
+    EC = PISM.EnthalpyConverter(config)
+    time = PISM.Time(com, config, log, system)
+
+    return PISM.cpp.Context(com, system, config, EC, time, log, "ssafd_test"), config, log
+
+def create_grid(context, Mx, My):
+    "Create the grid used by test I."
+    Ly = 3 * L_schoof
+    Lx = max(60.0e3, ((Mx - 1) / 2.0) * (2.0 * Ly / (My - 1)))
+    return PISM.Grid.Shallow(context, Lx, Ly, 0, 0, Mx, My,
+                             PISM.CELL_CORNER, PISM.NOT_PERIODIC)
+
+def solve(Mx=5, My=61, settings={}, options={}):
+    """Solve test I using SSAFD.
+
+    `settings` are configuration parameters, `options` are PETSc options (without the
+    leading "-").
+
+    Returns the SSA object, the local part of the velocity and the log.
+    """
+    context, config, log = create_context()
+
+    config.set_flag("basal_resistance.pseudo_plastic.enabled", False)
+    config.set_string("stress_balance.ssa.flow_law", "isothermal_glen")
+    config.set_number("flow_law.isothermal_Glen.ice_softness",
+                      B_schoof**(-config.get_number("stress_balance.ssa.Glen_exponent")))
+    config.set_flag("stress_balance.ssa.compute_surface_gradient_inward", True)
+    config.set_number("stress_balance.ssa.epsilon", 0.0)
+    config.set_number("stress_balance.ssa.fd.relative_convergence", 5e-7)
+
+    for name, value in settings.items():
+        config.set_number(name, value)
+
+    petsc_options = PISM.PETSc.Options()
+    all_options = {"ssafd_ksp_rtol": 1e-12}
+    all_options.update(options)
+    for name, value in all_options.items():
+        petsc_options.setValue(name, value)
+
+    try:
+        grid = create_grid(context, Mx, My)
+
+        geometry = PISM.Geometry(grid)
+        geometry.ice_thickness.set(H0_schoof)
+        # make sure that all ice is grounded
+        geometry.sea_level_elevation.set(-1e4)
+
+        enthalpy = PISM.model.createEnthalpyVec(grid)
+        enthalpy.set(1e5)
+
+        tauc = PISM.model.createYieldStressVec(grid)
+        bc_mask = PISM.model.createBCMaskVec(grid)
+        bc_values = PISM.model.create2dVelocityVec(grid, "_bc")
+
+        standard_gravity = config.get_number("constants.standard_gravity")
+        ice_density = config.get_number("constants.ice.density")
+        f = ice_density * standard_gravity * H0_schoof * 0.001  # tan(atan(0.001))
+
+        bc_mask.set(0.0)
+        with PISM.vec.Access(nocomm=[geometry.bed_elevation, tauc, bc_mask, bc_values]):
+            for (i, j) in grid.points():
+                p = PISM.exactI(m_schoof, grid.x(i), grid.y(j))
+
+                geometry.bed_elevation[i, j] = p.bed
+                tauc[i, j] = f * abs(grid.y(j) / L_schoof)**m_schoof
+
+                edge = i in (0, grid.Mx() - 1) or j in (0, grid.My() - 1)
+                if edge:
+                    bc_mask[i, j] = 1
+                    bc_values[i, j].u = p.u
+                    bc_values[i, j].v = p.v
+
+        for v in [geometry.bed_elevation, tauc, bc_mask, bc_values]:
+            v.update_ghosts()
+
+        geometry.ensure_consistency(0.0)
+
+        inputs = PISM.StressBalanceInputs()
+        inputs.geometry = geometry
+        inputs.enthalpy = enthalpy
+        inputs.basal_yield_stress = tauc
+        inputs.bc_mask = bc_mask
+        inputs.bc_values = bc_values
+
+        ssa = PISM.SSAFD(grid, False)
+        ssa.init()
+        ssa.update(inputs, True)
+
+        return ssa, ssa.velocity().local_part().copy(), log.get()
+    finally:
+        for name in all_options:
+            petsc_options.delValue(name)
+
+def iterations(ssa):
+    "Return the number of outer iterations and the average number of KSP iterations."
+    match = re.search(r"(\d+) outer iterations, ~([0-9.]+) KSP iterations each",
+                      ssa.stdout_report())
+    return int(match.group(1)), float(match.group(2))
+
+def compare(u, v, tolerance):
+    "Compare velocities u and v relative to the maximum of v."
+    scale = np.max(np.abs(v))
+    np.testing.assert_allclose(u, v, rtol=0, atol=tolerance * scale)
+
+def test_anderson_acceleration():
+    "SSAFD: Anderson acceleration of Picard iterations"
+    ssa_picard, u_picard, _ = solve()
+    ssa_anderson, u_anderson, _ = solve(settings={"stress_balance.ssa.fd.anderson_depth": 5})
+
+    n_picard, _ = iterations(ssa_picard)
+    n_anderson, _ = iterations(ssa_anderson)
+
+    assert n_anderson < n_picard, (n_anderson, n_picard)
+
+    compare(u_anderson, u_picard, 1e-4)
+
+def test_pc_reuse():
+    "SSAFD: re-using the preconditioner"
+    ssa_0, u_0, _ = solve()
+    ssa_5, u_5, _ = solve(settings={"stress_balance.ssa.fd.pc_reuse.max_age": 5})
+
+    assert "preconditioner re-used in" in ssa_5.stdout_report()
+
+    compare(u_5, u_0, 1e-6)
+
+def test_pc_reuse_divergence():
+    "SSAFD: re-building the preconditioner after a lagged solve diverges"
+    if ctx.size > 1:
+        raise SkipTest("uses a sequential LU factorization")
+
+    # An LU factorization of the current matrix solves the system in one iteration. With an
+    # old factorization one iteration is not enough, so every lagged solve diverges
+    # (DIVERGED_ITS) and the preconditioner has to be re-built.
+    options = {"ssafd_pc_type": "lu", "ssafd_ksp_max_it": 1, "ssafd_ksp_rtol": 1e-6}
+
+    ssa_0, u_0, _ = solve(options=options)
+    ssa_5, u_5, log = solve(options=options,
+                            settings={"stress_balance.ssa.fd.pc_reuse.max_age": 5})
+
+    assert "lagged preconditioner diverged" in log
+    assert "Additive Schwarz" not in log
+
+    # lagged solves start from the same initial guess, so the iterates are the same
+    compare(u_5, u_0, 1e-8)
+
+    # iterations of failed lagged solves are counted
+    n_0, ksp_0 = iterations(ssa_0)
+    n_5, ksp_5 = iterations(ssa_5)
+    assert n_0 == n_5
+    assert ksp_5 > ksp_0
+
+def test_multigrid():
+    "SSAFD: the geometric multigrid preconditioner"
+    _, u_bjacobi, _ = solve()
+
+    # Mx - 1 = 4 and My - 1 = 60 are divisible by 2^(N - 1) for N = 2, 3
+    for N in [2, 3]:
+        _, u_mg, log = solve(settings={"stress_balance.ssa.fd.multigrid_levels": N})
+
+        assert "using the geometric multigrid preconditioner with {} levels".format(N) in log
+        assert "Additive Schwarz" not in log
+
+        compare(u_mg, u_bjacobi, 1e-6)
+
+def test_multigrid_incompatible_grid():
+    "SSAFD: the grid size has to be compatible with the number of multigrid levels"
+    context, config, _ = create_context()
+
+    config.set_number("stress_balance.ssa.fd.multigrid_levels", 2)
+
+    # Mx - 1 = 5 is not divisible by 2
+    grid = create_grid(context, 6, 61)
+
+    try:
+        PISM.SSAFD(grid, False)
+        assert False, "created SSAFD using an incompatible grid"
+    except RuntimeError as e:
+        assert "is not compatible with" in str(e)